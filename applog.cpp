@@ -0,0 +1,307 @@
+#include "applog.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSettings>
+#include <QThread>
+#include <QVariantMap>
+#include <QVector>
+#include <QWaitCondition>
+
+Q_LOGGING_CATEGORY(lcPlayback, "oldplayer.playback")
+Q_LOGGING_CATEGORY(lcPlaylist, "oldplayer.playlist")
+Q_LOGGING_CATEGORY(lcImport, "oldplayer.import")
+Q_LOGGING_CATEGORY(lcIpc, "oldplayer.ipc")
+Q_LOGGING_CATEGORY(lcTranscode, "oldplayer.transcode")
+Q_LOGGING_CATEGORY(lcTags, "oldplayer.tags")
+Q_LOGGING_CATEGORY(lcCover, "oldplayer.cover")
+Q_LOGGING_CATEGORY(lcNet, "oldplayer.net")
+
+namespace {
+
+const int BufferCapacity = 8192;              // 环形缓冲区能容纳的条数
+const int FlushInterval = 200;                // 毫秒，后台线程至少这么久写一次
+const qint64 MaxLogSize = 4 * 1024 * 1024;    // 超过后改名为 oldplayer.log.1，重新开始
+const int DefaultRateLimit = 100;
+
+// 发布版本默认不记录本程序的调试信息，需要时用 setLevel() 打开
+#ifdef QT_DEBUG
+const bool DebugBuild = true;
+#else
+const bool DebugBuild = false;
+#endif
+
+const QStringList LevelNames = {"debug", "info", "warning", "critical", "off"};
+
+// 按分类统计一秒内的条数
+struct RateWindow {
+    qint64 start = 0;
+    int count = 0;
+    int suppressed = 0;
+};
+
+QMutex g_mutex;
+QWaitCondition g_wake;
+QVector<QString> g_ring;
+int g_head = 0;
+int g_size = 0;
+qint64 g_pendingDropped = 0;     // 缓冲区满时被覆盖、还没报告的条数
+qint64 g_totalDropped = 0;
+qint64 g_totalSuppressed = 0;
+QHash<const char*, RateWindow> g_rates;   // 分类名是静态字符串，直接用指针作键
+int g_rateLimit = DefaultRateLimit;
+bool g_running = false;
+
+QThread* g_writer = nullptr;
+QString g_logPath;
+QtMessageHandler g_previousHandler = nullptr;
+bool g_forwardToConsole = DebugBuild;
+QElapsedTimer g_clock;
+QMap<QString, QString> g_levels;          // 只在界面线程中修改
+
+// 调用者持有 g_mutex
+void pushLocked(const QString& line)
+{
+    if (g_size == BufferCapacity) {
+        // 满了：覆盖最旧的一条，日志不能反过来拖慢调用者
+        g_ring[g_head] = line;
+        g_head = (g_head + 1) % BufferCapacity;
+        ++g_pendingDropped;
+        ++g_totalDropped;
+    } else {
+        g_ring[(g_head + g_size) % BufferCapacity] = line;
+        ++g_size;
+    }
+    if (g_size >= BufferCapacity / 2) {
+        g_wake.wakeOne();
+    }
+}
+
+QString formatLine(QtMsgType type, const char* category, const QString& message)
+{
+    static const char Letters[] = {'D', 'W', 'C', 'F', 'I'};   // 与 QtMsgType 的取值对应
+    const char letter = (type >= 0 && type < int(sizeof(Letters))) ? Letters[type] : '?';
+
+    QThread* thread = QThread::currentThread();
+    QString threadName = thread ? thread->objectName() : QString();
+    if (threadName.isEmpty()) {
+        threadName = QString::number(quintptr(QThread::currentThreadId()), 16);
+    }
+
+    // 一次替换所有占位符，消息中出现的 %1 之类不会被再次替换
+    return QString("%1 %2 %3 [%4] %5").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz"),
+                                           QString(QChar(letter)), QString::fromLatin1(category),
+                                           threadName, message);
+}
+
+void messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message)
+{
+    const char* category = context.category ? context.category : "default";
+
+    // 调试和提示信息按分类限流，警告和错误全部保留
+    QString summary;
+    if (type == QtDebugMsg || type == QtInfoMsg) {
+        QMutexLocker locker(&g_mutex);
+        RateWindow& window = g_rates[category];
+        const qint64 now = g_clock.elapsed();
+        if (now - window.start >= 1000) {
+            if (window.suppressed > 0) {
+                summary = formatLine(QtInfoMsg, category,
+                                     QString("上一秒有 %1 条日志超过频率限制，未记录").arg(window.suppressed));
+            }
+            window.start = now;
+            window.count = 0;
+            window.suppressed = 0;
+        }
+        if (g_rateLimit > 0 && ++window.count > g_rateLimit) {
+            ++window.suppressed;
+            ++g_totalSuppressed;
+            return;
+        }
+    }
+
+    // 在锁外格式化，缩短其他线程等待的时间
+    QString line = formatLine(type, category, message);
+    {
+        QMutexLocker locker(&g_mutex);
+        if (!summary.isEmpty()) pushLocked(summary);
+        pushLocked(line);
+    }
+
+    if (type == QtFatalMsg) {
+        // 程序马上就要终止，先把缓冲区写完
+        AppLog::shutdown();
+    }
+    if ((g_forwardToConsole || type == QtFatalMsg) && g_previousHandler) {
+        g_previousHandler(type, context, message);
+    }
+}
+
+void rotateIfNeeded(QFile& file)
+{
+    if (file.size() <= MaxLogSize) return;
+
+    file.close();
+    QFile::remove(g_logPath + ".1");
+    QFile::rename(g_logPath, g_logPath + ".1");
+    file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+}
+
+// 后台线程：定期取出缓冲区中的全部日志，一次写入文件
+void writerLoop()
+{
+    QFile file(g_logPath);
+    file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+
+    QVector<QString> batch;
+    bool running = true;
+    while (running) {
+        qint64 dropped = 0;
+        batch.clear();
+        {
+            QMutexLocker locker(&g_mutex);
+            if (g_running && g_size == 0) {
+                g_wake.wait(&g_mutex, FlushInterval);
+            }
+            batch.reserve(g_size);
+            for (int i = 0; i < g_size; ++i) {
+                batch.append(std::move(g_ring[(g_head + i) % BufferCapacity]));
+            }
+            g_head = 0;
+            g_size = 0;
+            dropped = g_pendingDropped;
+            g_pendingDropped = 0;
+            running = g_running;
+        }
+
+        if (!file.isOpen()) continue;   // 无法写文件时照样清空缓冲区
+        if (dropped > 0) {
+            file.write(QString("（日志缓冲区已满，丢弃了 %1 条较早的日志）\n").arg(dropped).toUtf8());
+        }
+        for (const QString& line : batch) {
+            file.write(line.toUtf8());
+            file.write("\n");
+        }
+        if (!batch.isEmpty() || dropped > 0) {
+            file.flush();
+            rotateIfNeeded(file);
+        }
+    }
+}
+
+// 把各分类的级别转换成 QLoggingCategory 的过滤规则
+void applyRules()
+{
+    QStringList rules;
+    if (!DebugBuild) {
+        rules.append("oldplayer.*.debug=false");
+    }
+    for (auto it = g_levels.constBegin(); it != g_levels.constEnd(); ++it) {
+        const int minimum = LevelNames.indexOf(it.value());
+        for (int i = 0; i < 4; ++i) {
+            rules.append(QString("%1.%2=%3").arg(it.key(), LevelNames[i], i >= minimum ? "true" : "false"));
+        }
+    }
+    QLoggingCategory::setFilterRules(rules.join('\n'));
+}
+
+} // namespace
+
+void AppLog::install(const QString& logDir)
+{
+    if (g_writer) return;
+
+    QDir().mkpath(logDir);
+    g_logPath = logDir + "/oldplayer.log";
+    g_clock.start();
+    g_ring.resize(BufferCapacity);
+
+    // 配置文件中保存的级别和限流设置
+    QSettings settings;
+    const QVariantMap levels = settings.value("Logging/levels").toMap();
+    for (auto it = levels.constBegin(); it != levels.constEnd(); ++it) {
+        if (LevelNames.contains(it.value().toString())) {
+            g_levels.insert(it.key(), it.value().toString());
+        }
+    }
+    g_rateLimit = qMax(0, settings.value("Logging/rateLimit", DefaultRateLimit).toInt());
+    g_forwardToConsole = settings.value("Logging/console", DebugBuild).toBool();
+    applyRules();
+
+    g_running = true;
+    g_writer = QThread::create(writerLoop);
+    g_writer->setObjectName("LogWriter");
+    g_writer->start(QThread::LowPriority);
+
+    g_previousHandler = qInstallMessageHandler(messageHandler);
+}
+
+void AppLog::shutdown()
+{
+    if (!g_writer) return;
+
+    qInstallMessageHandler(g_previousHandler);
+    {
+        QMutexLocker locker(&g_mutex);
+        g_running = false;
+        g_wake.wakeAll();
+    }
+    // 致命错误可能发生在写日志的线程自己身上，那时不能等待自己
+    if (QThread::currentThread() != g_writer) {
+        g_writer->wait();
+        delete g_writer;
+    }
+    g_writer = nullptr;
+}
+
+bool AppLog::setLevel(const QString& category, const QString& level)
+{
+    const QString name = category.trimmed();
+    const QString normalized = level.trimmed().toLower();
+    if (name.isEmpty() || (!normalized.isEmpty() && !LevelNames.contains(normalized))) {
+        return false;
+    }
+
+    if (normalized.isEmpty()) {
+        g_levels.remove(name);
+    } else {
+        g_levels.insert(name, normalized);
+    }
+    applyRules();
+
+    QVariantMap levels;
+    for (auto it = g_levels.constBegin(); it != g_levels.constEnd(); ++it) {
+        levels.insert(it.key(), it.value());
+    }
+    QSettings().setValue("Logging/levels", levels);
+    return true;
+}
+
+void AppLog::setRateLimit(int messagesPerSecond)
+{
+    QMutexLocker locker(&g_mutex);
+    g_rateLimit = qMax(0, messagesPerSecond);
+}
+
+QJsonObject AppLog::status()
+{
+    QJsonObject levels;
+    for (auto it = g_levels.constBegin(); it != g_levels.constEnd(); ++it) {
+        levels.insert(it.key(), it.value());
+    }
+
+    QJsonObject result;
+    result.insert("file", g_logPath);
+    result.insert("levels", levels);
+    QMutexLocker locker(&g_mutex);
+    result.insert("rateLimit", g_rateLimit);
+    result.insert("dropped", g_totalDropped);
+    result.insert("suppressed", g_totalSuppressed);
+    return result;
+}
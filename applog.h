@@ -0,0 +1,41 @@
+#ifndef APPLOG_H
+#define APPLOG_H
+
+#include <QString>
+#include <QJsonObject>
+#include <QLoggingCategory>
+
+// 分类日志
+// 各模块用 qCDebug(lcImport) 等宏输出，分类被关闭时只判断一次标志，不会格式化消息。
+// install() 之后所有日志（包括未分类的 qDebug）先放进内存中的环形缓冲区，
+// 由后台线程批量写入 config/logs/oldplayer.log，调用方不等待磁盘；
+// 缓冲区满时丢弃最旧的记录，同一分类每秒超过上限的消息只记录被省略的条数。
+// 各分类的级别可以在运行时修改（设置菜单没有入口，用 --remote log 或 HTTP 接口），并保存到配置文件
+Q_DECLARE_LOGGING_CATEGORY(lcPlayback)   // oldplayer.playback  播放、切歌、随机顺序
+Q_DECLARE_LOGGING_CATEGORY(lcPlaylist)   // oldplayer.playlist  播放列表的加载和保存
+Q_DECLARE_LOGGING_CATEGORY(lcImport)     // oldplayer.import    文件夹导入、标签扫描
+Q_DECLARE_LOGGING_CATEGORY(lcIpc)        // oldplayer.ipc       单实例通道和远程命令
+Q_DECLARE_LOGGING_CATEGORY(lcTranscode)  // oldplayer.transcode 转码队列、内置转码引擎、转码清单
+Q_DECLARE_LOGGING_CATEGORY(lcTags)       // oldplayer.tags      批量写标签、从路径猜测标签
+Q_DECLARE_LOGGING_CATEGORY(lcCover)      // oldplayer.cover     封面缩略图缓存
+Q_DECLARE_LOGGING_CATEGORY(lcNet)        // oldplayer.net       HTTP 控制接口和局域网串流
+
+class AppLog
+{
+public:
+    // main() 中在设置好配置目录后调用；logDir 不存在时自动创建
+    static void install(const QString& logDir);
+    // 退出前调用：写完缓冲区中剩余的日志并结束后台线程
+    static void shutdown();
+
+    // 修改分类的级别：debug / info / warning / critical / off，分类名可以带通配符（oldplayer.*）
+    // level 为空表示恢复默认；返回 false 表示级别名无效
+    static bool setLevel(const QString& category, const QString& level);
+    // 当前的级别设置、日志文件路径以及丢弃 / 省略的条数
+    static QJsonObject status();
+
+    // 每个分类每秒最多记录的条数（警告和错误不受限制），0 表示不限制
+    static void setRateLimit(int messagesPerSecond);
+};
+
+#endif // APPLOG_H
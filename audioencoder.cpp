@@ -0,0 +1,411 @@
+#include "audioencoder.h"
+#include <QFile>
+#include <QVector>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QtEndian>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+bool isSupportedDepth(int bitsPerSample)
+{
+    return bitsPerSample == 16 || bitsPerSample == 24;
+}
+
+// 按小端序写出每个样本的低 bytesPerSample 字节（WAV 数据和 FLAC 的 MD5 都用这种排列）
+QByteArray packLittleEndian(const qint32* samples, int sampleCount, int bytesPerSample)
+{
+    QByteArray data(qint64(sampleCount) * bytesPerSample, Qt::Uninitialized);
+    char* p = data.data();
+    for (int i = 0; i < sampleCount; ++i) {
+        quint32 value = quint32(samples[i]);
+        for (int b = 0; b < bytesPerSample; ++b) {
+            *p++ = char((value >> (8 * b)) & 0xff);
+        }
+    }
+    return data;
+}
+
+// ==========================================
+// WAV：RIFF 头 + 16 / 24 位 PCM 数据
+// ==========================================
+class WavEncoder : public AudioEncoder
+{
+public:
+    bool open(const QString& filePath, int sampleRate, int channelCount, int bitsPerSample) override
+    {
+        if (!isSupportedDepth(bitsPerSample)) return false;
+
+        m_file.setFileName(filePath);
+        if (!m_file.open(QIODevice::WriteOnly)) return false;
+
+        m_sampleRate = sampleRate;
+        m_channelCount = channelCount;
+        m_bitsPerSample = bitsPerSample;
+        m_dataSize = 0;
+        // 先写入数据大小为 0 的文件头，结束时再回填
+        return m_file.write(header()) == 44;
+    }
+
+    bool write(const qint32* samples, int frameCount) override
+    {
+        QByteArray data = packLittleEndian(samples, frameCount * m_channelCount, m_bitsPerSample / 8);
+        if (m_file.write(data) != data.size()) return false;
+        m_dataSize += data.size();
+        return true;
+    }
+
+    bool close() override
+    {
+        bool ok = m_file.seek(0) && m_file.write(header()) == 44;
+        m_file.close();
+        return ok;
+    }
+
+private:
+    QByteArray header() const
+    {
+        QByteArray data(44, '\0');
+        char* p = data.data();
+        int blockAlign = m_channelCount * (m_bitsPerSample / 8);
+        memcpy(p, "RIFF", 4);
+        qToLittleEndian<quint32>(quint32(36 + m_dataSize), p + 4);
+        memcpy(p + 8, "WAVEfmt ", 8);
+        qToLittleEndian<quint32>(16, p + 16);                           // fmt 块大小
+        qToLittleEndian<quint16>(1, p + 20);                            // PCM
+        qToLittleEndian<quint16>(quint16(m_channelCount), p + 22);
+        qToLittleEndian<quint32>(quint32(m_sampleRate), p + 24);
+        qToLittleEndian<quint32>(quint32(m_sampleRate * blockAlign), p + 28);
+        qToLittleEndian<quint16>(quint16(blockAlign), p + 32);
+        qToLittleEndian<quint16>(quint16(m_bitsPerSample), p + 34);     // 位深
+        memcpy(p + 36, "data", 4);
+        qToLittleEndian<quint32>(quint32(m_dataSize), p + 40);
+        return data;
+    }
+
+    QFile m_file;
+    int m_sampleRate = 0;
+    int m_channelCount = 0;
+    int m_bitsPerSample = 16;
+    qint64 m_dataSize = 0;
+};
+
+// ==========================================
+// FLAC：固定预测器（0-4 阶）+ Rice 编码
+// 压缩率略低于 FFmpeg 的 LPC 编码，但实现简单、速度很快
+// ==========================================
+
+// 按位写入，高位在前
+class BitWriter
+{
+public:
+    void write(quint32 value, int bits)
+    {
+        if (bits == 0) return;
+        m_acc = (m_acc << bits) | (value & ((quint64(1) << bits) - 1));
+        m_bits += bits;
+        while (m_bits >= 8) {
+            m_bits -= 8;
+            m_data.append(char((m_acc >> m_bits) & 0xff));
+        }
+        m_acc &= (quint64(1) << m_bits) - 1;
+    }
+
+    void writeUnary(quint32 zeros)
+    {
+        while (zeros >= 32) {
+            write(0, 32);
+            zeros -= 32;
+        }
+        write(1, zeros + 1);
+    }
+
+    void alignToByte()
+    {
+        if (m_bits > 0) write(0, 8 - m_bits);
+    }
+
+    QByteArray& data() { return m_data; }
+
+private:
+    QByteArray m_data;
+    quint64 m_acc = 0;
+    int m_bits = 0;
+};
+
+quint8 crc8(const char* data, int length)
+{
+    quint8 crc = 0;
+    for (int i = 0; i < length; ++i) {
+        crc ^= quint8(data[i]);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? quint8((crc << 1) ^ 0x07) : quint8(crc << 1);
+        }
+    }
+    return crc;
+}
+
+quint16 crc16(const char* data, int length)
+{
+    quint16 crc = 0;
+    for (int i = 0; i < length; ++i) {
+        crc ^= quint16(quint8(data[i])) << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? quint16((crc << 1) ^ 0x8005) : quint16(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// 残差按 "之字形" 映射为无符号数：0, -1, 1, -2, 2 ... -> 0, 1, 2, 3, 4 ...
+inline quint32 zigzag(qint32 value)
+{
+    return value >= 0 ? quint32(value) << 1 : (quint32(-(value + 1)) << 1) | 1;
+}
+
+class FlacEncoder : public AudioEncoder
+{
+public:
+    bool open(const QString& filePath, int sampleRate, int channelCount, int bitsPerSample) override
+    {
+        if (channelCount < 1 || channelCount > 8 || sampleRate <= 0 || sampleRate >= (1 << 20)
+            || !isSupportedDepth(bitsPerSample)) {
+            return false;
+        }
+
+        m_file.setFileName(filePath);
+        if (!m_file.open(QIODevice::WriteOnly)) return false;
+
+        m_sampleRate = sampleRate;
+        m_channelCount = channelCount;
+        m_bitsPerSample = bitsPerSample;
+        m_totalFrames = 0;
+        m_frameNumber = 0;
+        m_minFrameSize = 0;
+        m_maxFrameSize = 0;
+        m_pending.clear();
+        m_md5.reset();
+
+        // STREAMINFO 中的总样本数、MD5 等在结束时回填
+        return m_file.write("fLaC", 4) == 4 && m_file.write(streamInfo()) == 38;
+    }
+
+    bool write(const qint32* samples, int frameCount) override
+    {
+        int sampleCount = frameCount * m_channelCount;
+        // STREAMINFO 中的 MD5 按源位深的小端样本计算
+        m_md5.addData(packLittleEndian(samples, sampleCount, m_bitsPerSample / 8));
+        int oldSize = m_pending.size();
+        m_pending.resize(oldSize + sampleCount);
+        std::copy(samples, samples + sampleCount, m_pending.data() + oldSize);
+        m_totalFrames += frameCount;
+
+        int blockSamples = kBlockSize * m_channelCount;
+        int offset = 0;
+        while (m_pending.size() - offset >= blockSamples) {
+            if (!encodeFrame(m_pending.constData() + offset, kBlockSize)) return false;
+            offset += blockSamples;
+        }
+        m_pending.remove(0, offset);
+        return true;
+    }
+
+    bool close() override
+    {
+        bool ok = true;
+        if (!m_pending.isEmpty()) {
+            ok = encodeFrame(m_pending.constData(), m_pending.size() / m_channelCount);
+            m_pending.clear();
+        }
+        ok = ok && m_file.seek(4) && m_file.write(streamInfo()) == 38;
+        m_file.close();
+        return ok;
+    }
+
+private:
+    static const int kBlockSize = 4096;
+
+    // 元数据块头 + 34 字节的 STREAMINFO
+    QByteArray streamInfo()
+    {
+        BitWriter writer;
+        writer.write(1, 1);                       // 最后一个元数据块
+        writer.write(0, 7);                       // STREAMINFO
+        writer.write(34, 24);
+        writer.write(kBlockSize, 16);             // 最小块大小
+        writer.write(kBlockSize, 16);             // 最大块大小
+        writer.write(quint32(m_minFrameSize), 24);
+        writer.write(quint32(m_maxFrameSize), 24);
+        writer.write(quint32(m_sampleRate), 20);
+        writer.write(quint32(m_channelCount - 1), 3);
+        writer.write(quint32(m_bitsPerSample - 1), 5);
+        writer.write(quint32(quint64(m_totalFrames) >> 32) & 0xf, 4);
+        writer.write(quint32(m_totalFrames & 0xffffffff), 32);
+
+        QByteArray md5(16, '\0');
+        if (m_totalFrames > 0) md5 = m_md5.result();   // 全 0 表示未知
+        writer.data().append(md5);
+        return writer.data();
+    }
+
+    bool encodeFrame(const qint32* interleaved, int blockSize)
+    {
+        BitWriter writer;
+
+        // 帧头
+        bool standardSize = (blockSize == kBlockSize);
+        writer.write(0x3ffe, 14);                 // 同步码
+        writer.write(0, 1);
+        writer.write(0, 1);                       // 固定块大小
+        writer.write(standardSize ? 0xc : 0x7, 4); // 0xc = 4096，0x7 = 帧头末尾的 16 位块大小
+        writer.write(0, 4);                       // 采样率取自 STREAMINFO
+        writer.write(quint32(m_channelCount - 1), 4); // 各声道独立编码
+        writer.write(0, 3);                       // 位深取自 STREAMINFO
+        writer.write(0, 1);
+        writeUtf8(writer, m_frameNumber++);
+        if (!standardSize) {
+            writer.write(quint32(blockSize - 1), 16);
+        }
+        writer.write(crc8(writer.data().constData(), writer.data().size()), 8);
+
+        // 每个声道一个子帧
+        QVector<qint32> channel(blockSize);
+        for (int c = 0; c < m_channelCount; ++c) {
+            for (int i = 0; i < blockSize; ++i) {
+                channel[i] = interleaved[i * m_channelCount + c];
+            }
+            encodeSubframe(writer, channel.constData(), blockSize, m_bitsPerSample);
+        }
+
+        writer.alignToByte();
+        writer.write(crc16(writer.data().constData(), writer.data().size()), 16);
+
+        const QByteArray& frame = writer.data();
+        if (m_minFrameSize == 0 || frame.size() < m_minFrameSize) m_minFrameSize = frame.size();
+        if (frame.size() > m_maxFrameSize) m_maxFrameSize = frame.size();
+        return m_file.write(frame) == frame.size();
+    }
+
+    static void writeUtf8(BitWriter& writer, quint32 value)
+    {
+        if (value < 0x80) {
+            writer.write(value, 8);
+            return;
+        }
+        // 后续字节数
+        int extra = value < 0x800 ? 1 : value < 0x10000 ? 2 : value < 0x200000 ? 3 : value < 0x4000000 ? 4 : 5;
+        quint32 lead = (0xff00 >> (extra + 1)) & 0xff;
+        writer.write(lead | (value >> (6 * extra)), 8);
+        for (int i = extra - 1; i >= 0; --i) {
+            writer.write(0x80 | ((value >> (6 * i)) & 0x3f), 8);
+        }
+    }
+
+    static void computeResidual(const qint32* x, int n, int order, qint32* residual)
+    {
+        for (int i = order; i < n; ++i) {
+            switch (order) {
+                case 0: residual[i] = x[i]; break;
+                case 1: residual[i] = x[i] - x[i - 1]; break;
+                case 2: residual[i] = x[i] - 2 * x[i - 1] + x[i - 2]; break;
+                case 3: residual[i] = x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3]; break;
+                default: residual[i] = x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4]; break;
+            }
+        }
+    }
+
+    static void encodeSubframe(BitWriter& writer, const qint32* x, int n, int bitsPerSample)
+    {
+        // 24 位样本的残差较大，改用 5 位 Rice 参数（编码方式 1），16 位时用 4 位就够了
+        const bool wideParam = bitsPerSample > 16;
+        const int maxParam = wideParam ? 30 : 14;
+
+        // 选择残差绝对值之和最小的预测阶数
+        QVector<qint32> residual(n);
+        int bestOrder = 0;
+        quint64 bestSum = ~quint64(0);
+        for (int order = 0; order <= 4 && order < n; ++order) {
+            computeResidual(x, n, order, residual.data());
+            quint64 sum = 0;
+            for (int i = order; i < n; ++i) sum += quint64(std::abs(residual[i]));
+            if (sum < bestSum) {
+                bestSum = sum;
+                bestOrder = order;
+            }
+        }
+        computeResidual(x, n, bestOrder, residual.data());
+
+        // 在估计值附近选择编码后位数最少的 Rice 参数
+        int count = n - bestOrder;
+        quint64 zigzagSum = 0;
+        for (int i = bestOrder; i < n; ++i) zigzagSum += zigzag(residual[i]);
+        int estimate = 0;
+        if (count > 0) {
+            quint64 mean = zigzagSum / quint64(count);
+            while (estimate < maxParam && (quint64(1) << (estimate + 1)) <= mean) ++estimate;
+        }
+        int bestParam = estimate;
+        quint64 bestBits = ~quint64(0);
+        for (int k = qMax(0, estimate - 1); k <= qMin(maxParam, estimate + 1); ++k) {
+            quint64 bits = quint64(count) * (k + 1);
+            for (int i = bestOrder; i < n; ++i) bits += zigzag(residual[i]) >> k;
+            if (bits < bestBits) {
+                bestBits = bits;
+                bestParam = k;
+            }
+        }
+
+        // 压缩后反而更大时（例如白噪声）直接存原始样本
+        const int paramBits = wideParam ? 5 : 4;
+        quint64 fixedBits = quint64(bestOrder) * bitsPerSample + 6 + paramBits + bestBits;
+        if (fixedBits >= quint64(n) * bitsPerSample) {
+            writer.write(0, 1);
+            writer.write(0x01, 6);                // VERBATIM
+            writer.write(0, 1);
+            for (int i = 0; i < n; ++i) writer.write(quint32(x[i]), bitsPerSample);
+            return;
+        }
+
+        writer.write(0, 1);
+        writer.write(0x08 | bestOrder, 6);        // FIXED
+        writer.write(0, 1);
+        for (int i = 0; i < bestOrder; ++i) writer.write(quint32(x[i]), bitsPerSample);
+
+        writer.write(wideParam ? 1 : 0, 2);       // 0：4 位 Rice 参数，1：5 位
+        writer.write(0, 4);                       // 分区阶数 0（整个块一个分区）
+        writer.write(quint32(bestParam), paramBits);
+        for (int i = bestOrder; i < n; ++i) {
+            quint32 u = zigzag(residual[i]);
+            writer.writeUnary(u >> bestParam);
+            writer.write(u, bestParam);
+        }
+    }
+
+    QFile m_file;
+    int m_sampleRate = 0;
+    int m_channelCount = 0;
+    int m_bitsPerSample = 16;
+    qint64 m_totalFrames = 0;
+    quint32 m_frameNumber = 0;
+    int m_minFrameSize = 0;
+    int m_maxFrameSize = 0;
+    QVector<qint32> m_pending;   // 不足一个块的样本
+    QCryptographicHash m_md5{QCryptographicHash::Md5};
+};
+
+} // namespace
+
+std::unique_ptr<AudioEncoder> AudioEncoder::create(const QString& codecName)
+{
+    if (codecName == "pcm_s16le") return std::make_unique<WavEncoder>();
+    if (codecName == "flac") return std::make_unique<FlacEncoder>();
+    return nullptr;
+}
+
+bool AudioEncoder::isSupported(const QString& codecName)
+{
+    return codecName == "pcm_s16le" || codecName == "flac";
+}
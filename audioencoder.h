@@ -0,0 +1,29 @@
+#ifndef AUDIOENCODER_H
+#define AUDIOENCODER_H
+
+#include <QString>
+#include <memory>
+
+// 内置音频编码器：把 16 位或 24 位交错 PCM 写成 WAV 或 FLAC 文件，不依赖 FFmpeg
+// 编码器名称与 FFmpeg 的 -c:a 参数一致（pcm_s16le / flac），方便和外部转码互换；
+// 实际位深由 open() 指定，高位深的源文件不会被截成 16 位
+class AudioEncoder
+{
+public:
+    virtual ~AudioEncoder() = default;
+
+    // 不支持的编码器（例如有损格式）返回 nullptr，调用者应退回使用 FFmpeg
+    static std::unique_ptr<AudioEncoder> create(const QString& codecName);
+    static bool isSupported(const QString& codecName);
+
+    static constexpr int MaxBitsPerSample = 24;
+
+    // bitsPerSample 为 16 或 24
+    virtual bool open(const QString& filePath, int sampleRate, int channelCount, int bitsPerSample) = 0;
+    // samples 为交错排列的样本，共 frameCount * channelCount 个，取值范围与 open() 时的位深一致
+    virtual bool write(const qint32* samples, int frameCount) = 0;
+    // 写入剩余数据并补全文件头
+    virtual bool close() = 0;
+};
+
+#endif // AUDIOENCODER_H
@@ -0,0 +1,247 @@
+#include "batchtagdialog.h"
+#include "tagwriter.h"
+#include "playlistmanager.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QMessageBox>
+#include <QIntValidator>
+
+BatchTagDialog::BatchTagDialog(PlaylistManager* manager, const QVector<int>& songIds, QWidget* parent)
+    : QDialog(parent)
+    , m_playlistManager(manager)
+    , m_songIds(songIds)
+    , m_hasUpdatedSongs(false)
+{
+    setWindowTitle(QString("批量编辑歌曲信息（%1 首）").arg(songIds.size()));
+    setMinimumWidth(480);
+    setModal(true);
+
+    m_writer = new TagWriter(this);
+    connect(m_writer, &TagWriter::progressChanged, this, &BatchTagDialog::onProgressChanged);
+    connect(m_writer, &TagWriter::finished, this, &BatchTagDialog::onWriteFinished);
+
+    setupUI();
+}
+
+BatchTagDialog::~BatchTagDialog()
+{
+    // m_writer 的析构函数会等待后台线程退出
+    m_writer->cancel();
+}
+
+void BatchTagDialog::setupUI()
+{
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setSpacing(12);
+    mainLayout->setContentsMargins(16, 16, 16, 16);
+
+    QLabel* hintLabel = new QLabel("勾选 \"保持不变\" 的字段不会被修改；清空输入框并取消勾选将删除该字段。");
+    hintLabel->setWordWrap(true);
+    hintLabel->setStyleSheet("color: #888; font-size: 11px;");
+    mainLayout->addWidget(hintLabel);
+
+    QGroupBox* fieldGroup = new QGroupBox("歌曲信息");
+    QFormLayout* fieldLayout = new QFormLayout(fieldGroup);
+    fieldLayout->setSpacing(8);
+    fieldLayout->setContentsMargins(12, 16, 12, 12);
+
+    addField(fieldLayout, "艺术家：", "ARTIST", "演唱/演奏者");
+    addField(fieldLayout, "专辑：", "ALBUM", "所属专辑");
+    addField(fieldLayout, "专辑艺术家：", "ALBUMARTIST", "专辑艺术家");
+    addField(fieldLayout, "流派：", "GENRE", "如：Pop, Rock, Classical");
+    addField(fieldLayout, "年份：", "DATE", "如：2024");
+    addField(fieldLayout, "备注：", "COMMENT", "自定义备注");
+    mainLayout->addWidget(fieldGroup);
+
+    // 年份只允许输入数字
+    for (const Field& field : m_fields) {
+        if (field.key == "DATE") {
+            field.edit->setValidator(new QIntValidator(0, 9999, field.edit));
+        }
+    }
+
+    // 所有选中歌曲的艺术家 / 专辑相同时预先填入，方便在此基础上修改
+    const SongLibrary* library = m_playlistManager->library();
+    if (!m_songIds.isEmpty()) {
+        bool sameArtist = true;
+        bool sameAlbum = true;
+        const QString& firstArtist = library->artist(m_songIds.first());
+        const QString& firstAlbum = library->album(m_songIds.first());
+        for (int id : m_songIds) {
+            if (library->artist(id) != firstArtist) sameArtist = false;
+            if (library->album(id) != firstAlbum) sameAlbum = false;
+            if (!sameArtist && !sameAlbum) break;
+        }
+        for (const Field& field : m_fields) {
+            if (field.key == "ARTIST") {
+                if (sameArtist) field.edit->setText(firstArtist);
+                else field.edit->setPlaceholderText("（多个值）");
+            } else if (field.key == "ALBUM") {
+                if (sameAlbum) field.edit->setText(firstAlbum);
+                else field.edit->setPlaceholderText("（多个值）");
+            }
+        }
+    }
+
+    // 进度
+    m_statusLabel = new QLabel(QString("将修改 %1 首歌曲").arg(m_songIds.size()));
+    mainLayout->addWidget(m_statusLabel);
+    m_progressBar = new QProgressBar();
+    m_progressBar->setRange(0, qMax(1, m_songIds.size()));
+    m_progressBar->setValue(0);
+    mainLayout->addWidget(m_progressBar);
+
+    // ========== 按钮区域 ==========
+    mainLayout->addSpacing(8);
+    QHBoxLayout* btnLayout = new QHBoxLayout();
+    btnLayout->addStretch();
+
+    m_cancelBtn = new QPushButton("取消");
+    m_cancelBtn->setFixedWidth(80);
+    connect(m_cancelBtn, &QPushButton::clicked, this, &BatchTagDialog::onCancelClicked);
+    btnLayout->addWidget(m_cancelBtn);
+
+    m_applyBtn = new QPushButton("保存");
+    m_applyBtn->setFixedWidth(80);
+    m_applyBtn->setDefault(true);
+    connect(m_applyBtn, &QPushButton::clicked, this, &BatchTagDialog::onApplyClicked);
+    btnLayout->addWidget(m_applyBtn);
+
+    mainLayout->addLayout(btnLayout);
+}
+
+void BatchTagDialog::addField(QFormLayout* layout, const QString& label, const QString& key,
+                              const QString& placeholder)
+{
+    QHBoxLayout* rowLayout = new QHBoxLayout();
+    QLineEdit* edit = new QLineEdit();
+    edit->setPlaceholderText(placeholder);
+    QCheckBox* keepCheck = new QCheckBox("保持不变");
+    keepCheck->setChecked(true);
+    rowLayout->addWidget(edit);
+    rowLayout->addWidget(keepCheck);
+    layout->addRow(label, rowLayout);
+
+    // 用户动手修改了某个字段，就认为要写入它
+    connect(edit, &QLineEdit::textEdited, keepCheck, [keepCheck]() {
+        keepCheck->setChecked(false);
+    });
+
+    m_fields.append({key, edit, keepCheck});
+}
+
+QString BatchTagDialog::fieldValue(const QString& key, bool* keep) const
+{
+    for (const Field& field : m_fields) {
+        if (field.key == key) {
+            *keep = field.keepCheck->isChecked();
+            return field.edit->text().trimmed();
+        }
+    }
+    *keep = true;
+    return QString();
+}
+
+void BatchTagDialog::onApplyClicked()
+{
+    QMap<QString, QString> fields;
+    for (const Field& field : m_fields) {
+        if (!field.keepCheck->isChecked()) {
+            fields.insert(field.key, field.edit->text().trimmed());
+        }
+    }
+    if (fields.isEmpty()) {
+        QMessageBox::information(this, "提示", "所有字段都是 \"保持不变\"，没有需要修改的内容。");
+        return;
+    }
+
+    const SongLibrary* library = m_playlistManager->library();
+    QVector<TagWriter::Change> changes;
+    changes.reserve(m_songIds.size());
+    QVector<int> virtualTrackIds;
+    for (int id : m_songIds) {
+        // CUE 音轨的信息只保存在歌曲库中，文件标签属于整张专辑
+        if (library->isVirtualTrack(id)) {
+            virtualTrackIds.append(id);
+            continue;
+        }
+        if (library->isMissing(id)) continue;   // 文件不存在，无法写入
+        changes.append({id, library->filePath(id), fields});
+    }
+    if (changes.isEmpty()) {
+        if (!virtualTrackIds.isEmpty()) {
+            onWriteFinished(virtualTrackIds, QStringList());
+            return;
+        }
+        QMessageBox::warning(this, "提示", "选中的歌曲文件都不存在，无法写入。");
+        return;
+    }
+    m_virtualTrackIds = virtualTrackIds;
+    m_progressBar->setRange(0, changes.size());
+
+    for (const Field& field : m_fields) {
+        field.edit->setEnabled(false);
+        field.keepCheck->setEnabled(false);
+    }
+    m_applyBtn->setEnabled(false);
+    m_statusLabel->setText("正在写入...");
+    m_writer->start(changes);
+}
+
+void BatchTagDialog::onCancelClicked()
+{
+    if (m_writer->isBusy()) {
+        // 已经写完的文件会在 onWriteFinished 中更新到歌曲库
+        m_writer->cancel();
+        m_cancelBtn->setEnabled(false);
+        return;
+    }
+    reject();
+}
+
+void BatchTagDialog::onProgressChanged(int done, int total)
+{
+    m_progressBar->setValue(done);
+    m_statusLabel->setText(QString("正在写入... %1/%2").arg(done).arg(total));
+}
+
+void BatchTagDialog::onWriteFinished(const QVector<int>& succeededIds, const QStringList& failedPaths)
+{
+    // 歌曲库中只保存了标题、艺术家和专辑，其余字段只写入文件
+    bool keepArtist = true;
+    bool keepAlbum = true;
+    QString artist = fieldValue("ARTIST", &keepArtist);
+    QString album = fieldValue("ALBUM", &keepAlbum);
+    if (!keepArtist && artist.isEmpty()) artist = "未知艺术家";
+    if (!keepAlbum && album.isEmpty()) album = "未知专辑";
+
+    // 所有成功的歌曲一次性更新，包含它们的播放列表共享同一份记录
+    if (!keepArtist || !keepAlbum) {
+        SongLibrary* library = m_playlistManager->library();
+        for (int id : succeededIds + m_virtualTrackIds) {
+            library->updateMetaData(id, QString(),
+                                    keepArtist ? QString() : artist,
+                                    keepAlbum ? QString() : album);
+        }
+        m_hasUpdatedSongs = !succeededIds.isEmpty() || !m_virtualTrackIds.isEmpty();
+    }
+
+    m_progressBar->setValue(m_progressBar->maximum());
+    if (!failedPaths.isEmpty()) {
+        QString message = QString("成功 %1 首，失败 %2 首：\n\n%3")
+                          .arg(succeededIds.size()).arg(failedPaths.size())
+                          .arg(failedPaths.mid(0, 10).join("\n"));
+        if (failedPaths.size() > 10) {
+            message += "\n...";
+        }
+        QMessageBox::warning(this, "部分文件写入失败", message);
+    }
+    accept();
+}
@@ -0,0 +1,64 @@
+#ifndef BATCHTAGDIALOG_H
+#define BATCHTAGDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+#include <QStringList>
+
+class PlaylistManager;
+class TagWriter;
+class QLineEdit;
+class QCheckBox;
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QFormLayout;
+
+// 批量编辑标签：同时修改多首歌曲的艺术家、专辑、流派、年份等
+// 每个字段都可以选择 "保持不变"，写入在后台线程池中进行
+class BatchTagDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    BatchTagDialog(PlaylistManager* manager, const QVector<int>& songIds, QWidget* parent = nullptr);
+    ~BatchTagDialog();
+
+    // 是否修改了歌曲库中的元数据（调用者据此保存并刷新界面）
+    bool hasUpdatedSongs() const { return m_hasUpdatedSongs; }
+
+private slots:
+    void onApplyClicked();
+    void onCancelClicked();
+    void onProgressChanged(int done, int total);
+    void onWriteFinished(const QVector<int>& succeededIds, const QStringList& failedPaths);
+
+private:
+    // 一个可编辑字段：输入框 + "保持不变" 复选框
+    struct Field {
+        QString key;         // TagLib 属性名
+        QLineEdit* edit;
+        QCheckBox* keepCheck;
+    };
+
+    void setupUI();
+    void addField(QFormLayout* layout, const QString& label, const QString& key,
+                  const QString& placeholder);
+    QString fieldValue(const QString& key, bool* keep) const;
+
+    PlaylistManager* m_playlistManager;
+    QVector<int> m_songIds;
+    QVector<int> m_virtualTrackIds;   // CUE 音轨：不写文件，只更新歌曲库
+    TagWriter* m_writer;
+    bool m_hasUpdatedSongs;
+
+    QVector<Field> m_fields;
+
+    // UI 组件
+    QLabel* m_statusLabel;
+    QProgressBar* m_progressBar;
+    QPushButton* m_applyBtn;
+    QPushButton* m_cancelBtn;
+};
+
+#endif // BATCHTAGDIALOG_H
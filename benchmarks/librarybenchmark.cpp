@@ -0,0 +1,532 @@
+// 歌曲库规模的基准测试
+// 用合成的 1k / 10k / 100k / 1M 首歌曲测量热点路径：播放列表的加载和保存、按名称排序、
+// 重建歌曲列表、生成随机顺序；文件夹导入和标签扫描需要真实文件，默认只测 1k / 10k 个。
+// 另有 20 万首歌的内存测试：与改为列式存储之前每首歌四个 QString 的 QList<Song> 对比常驻内存，
+// 要求至少减少到原来的 1/3。
+// 上限可以用环境变量调整：OLDPLAYER_BENCH_MAX_SONGS、OLDPLAYER_BENCH_MAX_FILES。
+//
+// 编译：cmake -DOLDPLAYER_BUILD_BENCHMARKS=ON，运行：QT_QPA_PLATFORM=offscreen ./librarybenchmark
+// 配置文件写在程序目录的 config 下，不会影响正常使用的 OldPlayer。
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QSettings>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QFile>
+#include <QMap>
+#include <QUrl>
+#include <QSet>
+#include "mainwindow.h"
+#include "playlistmanager.h"
+#include "songlibrary.h"
+
+#if defined(Q_OS_WIN)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+namespace {
+
+const int DefaultMaxSongs = 1000000;
+const int MemorySongs = 200000;
+const double MemoryTarget = 3.0;     // 列式存储的目标：常驻内存至少减少到原来的 1/3
+const int DefaultMaxFiles = 10000;
+const int FilesPerFolder = 100;
+const int MaxLoadIterations = 50;                 // loadPlaylists 最多测这么多轮
+const qint64 MinLoadTimeNs = 1000 * 1000 * 1000;  // 累计计时达到 1 秒就不再重复
+
+QtMessageHandler g_previousHandler = nullptr;
+
+// 导入、保存等操作的调试输出会混在测试结果中，只保留警告和错误
+void quietMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message)
+{
+    if (type == QtDebugMsg) return;
+    if (g_previousHandler) g_previousHandler(type, context, message);
+}
+
+int limitFromEnvironment(const char* name, int fallback)
+{
+    bool ok = false;
+    int value = qEnvironmentVariableIntValue(name, &ok);
+    return (ok && value > 0) ? value : fallback;
+}
+
+QString sizeLabel(int count)
+{
+    if (count >= 1000000 && count % 1000000 == 0) return QString("%1M").arg(count / 1000000);
+    if (count >= 1000 && count % 1000 == 0) return QString("%1k").arg(count / 1000);
+    return QString::number(count);
+}
+
+// 改为列式存储之前的歌曲记录：四个 QString 加时长（当时还没有 CUE 音轨的起止位置）
+struct LegacySong {
+    QString title;
+    QString artist;
+    QString album;
+    QString filePath;
+    qint64 duration;
+};
+
+// 合成歌曲：500 位歌手，每位 10 张专辑，中英文标题混合（排序走 localeAwareCompare）
+// 固定随机种子，每次运行的数据相同
+QList<LegacySong> makeLegacySongs(int count)
+{
+    QRandomGenerator rng(20240101);
+    QList<LegacySong> songs;
+    songs.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        int artist = rng.bounded(500);
+        int album = rng.bounded(10);
+        QString title = (i % 3 == 0) ? QString("第%1首歌").arg(rng.bounded(100000))
+                                     : QString("Track %1").arg(rng.bounded(100000));
+
+        LegacySong song;
+        song.filePath = QString("/music/Artist %1/Album %2/%3 %4.mp3")
+                        .arg(artist).arg(album).arg(i, 7, 10, QChar('0')).arg(title);
+        song.title = title;
+        song.artist = QString("Artist %1").arg(artist);
+        song.album = QString("Album %1-%2").arg(artist).arg(album);
+        song.duration = 180000 + rng.bounded(120000);
+        songs.append(song);
+    }
+    return songs;
+}
+
+Song toSong(const LegacySong& legacy)
+{
+    Song song(legacy.filePath);
+    song.title = legacy.title;
+    song.artist = legacy.artist;
+    song.album = legacy.album;
+    song.duration = legacy.duration;
+    return song;
+}
+
+QList<Song> makeSongs(int count)
+{
+    const QList<LegacySong> legacy = makeLegacySongs(count);
+    QList<Song> songs;
+    songs.reserve(count);
+    for (const LegacySong& song : legacy) {
+        songs.append(toSong(song));
+    }
+    return songs;
+}
+
+// 最小的 MP3：ID3v2.3 标签（标题、艺术家、专辑）加两个 MPEG-1 Layer III 帧
+QByteArray makeMp3(const QString& title, const QString& artist, const QString& album)
+{
+    auto textFrame = [](const char* id, const QString& text) {
+        QByteArray data = QByteArray(1, '\0') + text.toLatin1();   // 编码 0：ISO-8859-1
+        const quint32 size = data.size();
+        QByteArray frame(id, 4);
+        frame.append(char(size >> 24)).append(char(size >> 16)).append(char(size >> 8)).append(char(size));
+        frame.append(2, '\0');   // 帧标志
+        return frame + data;
+    };
+    QByteArray frames = textFrame("TIT2", title) + textFrame("TPE1", artist) + textFrame("TALB", album);
+
+    // 标签头中的长度是 synchsafe 整数（每字节 7 位）
+    const int size = frames.size();
+    QByteArray file("ID3\x03\x00\x00", 6);
+    file.append(char((size >> 21) & 0x7F)).append(char((size >> 14) & 0x7F))
+        .append(char((size >> 7) & 0x7F)).append(char(size & 0x7F));
+    file.append(frames);
+
+    // 128 kbps、44.1 kHz 的帧长 417 字节，TagLib 需要连续两个帧头才认为找到了音频
+    QByteArray mpegFrame(417, '\0');
+    mpegFrame[0] = char(0xFF);
+    mpegFrame[1] = char(0xFB);
+    mpegFrame[2] = char(0x90);
+    file.append(mpegFrame).append(mpegFrame);
+    return file;
+}
+
+// 进程当前的常驻内存（字节），不支持的平台返回 -1
+qint64 residentBytes()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.WorkingSetSize);
+    }
+#elif defined(Q_OS_LINUX)
+    // statm 的第二项是常驻页数
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return -1;
+}
+
+// 与 SongStore::memoryUsage() 相同的估算方法：字符串头 16 字节加字符数据，共享的字符串只算一次
+qint64 songListBytes(const QList<LegacySong>& songs)
+{
+    qint64 bytes = 16 + songs.capacity() * qint64(sizeof(LegacySong));
+    QSet<const QChar*> seen;
+    for (const LegacySong& song : songs) {
+        for (const QString* str : {&song.title, &song.artist, &song.album, &song.filePath}) {
+            if (str->isNull() || seen.contains(str->constData())) continue;
+            seen.insert(str->constData());
+            bytes += 16 + (str->capacity() + 1) * qint64(sizeof(QChar));
+        }
+    }
+    return bytes;
+}
+
+QString megabytes(qint64 bytes)
+{
+    return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MB";
+}
+
+} // namespace
+
+class LibraryBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // 放在最前面，这时堆里还没有其他测试释放的大块内存，常驻内存的增量比较可靠
+    void memoryFootprint();
+
+    // 用到真实文件的放在前面，这时主窗口的歌曲库里还没有大量合成歌曲，
+    // 导入和扫描之后的保存不会被上百万首歌拖慢
+    void folderImport_data() { addFileRows(); }
+    void folderImport();
+    void metaDataScan_data() { addFileRows(); }
+    void metaDataScan();
+
+    void loadPlaylists_data() { addSongRows(); }
+    void loadPlaylists();
+    void savePlaylists_data() { addSongRows(); }
+    void savePlaylists();
+    void sortByName_data() { addSongRows(); }
+    void sortByName();
+    void updateSongListView_data() { addSongRows(); }
+    void updateSongListView();
+    void generateShuffledPlaylist_data() { addSongRows(); }
+    void generateShuffledPlaylist();
+
+private:
+    void addRows(int maxCount);
+    void addSongRows() { addRows(m_maxSongs); }
+    void addFileRows() { addRows(m_maxFiles); }
+
+    QString configFilePath() const;
+    QString audioFolder(int count);           // 含 count 个 MP3 的文件夹，第一次调用时生成
+    int windowPlaylist(int count);            // 主窗口中由前 count 首合成歌曲组成的列表
+
+    int m_maxSongs = DefaultMaxSongs;
+    int m_maxFiles = DefaultMaxFiles;
+    MainWindow* m_window = nullptr;
+    QVector<int> m_windowSongIds;             // 主窗口歌曲库中的合成歌曲
+    QMap<int, int> m_windowPlaylists;         // 歌曲数 -> 播放列表索引
+    QMap<int, QString> m_audioFolders;
+    QTemporaryDir m_fileRoot;
+};
+
+void LibraryBenchmark::initTestCase()
+{
+    g_previousHandler = qInstallMessageHandler(quietMessageHandler);
+
+    m_maxSongs = limitFromEnvironment("OLDPLAYER_BENCH_MAX_SONGS", DefaultMaxSongs);
+    m_maxFiles = limitFromEnvironment("OLDPLAYER_BENCH_MAX_FILES", DefaultMaxFiles);
+    QVERIFY(m_fileRoot.isValid());
+
+    // 与 main() 相同的设置方式，但使用单独的应用名和干净的配置目录
+    QCoreApplication::setOrganizationName("OldCheung");
+    QCoreApplication::setApplicationName("OldPlayerBenchmark");
+    QString configPath = QCoreApplication::applicationDirPath() + "/config";
+    QDir(configPath).removeRecursively();
+    QDir().mkpath(configPath);
+    QSettings::setDefaultFormat(QSettings::IniFormat);
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, configPath);
+
+    // 不显示窗口：托盘、网络服务等推迟初始化的部分不会启动
+    m_window = new MainWindow();
+}
+
+void LibraryBenchmark::cleanupTestCase()
+{
+    if (!m_window) return;
+
+    // 先删掉合成的大列表，析构时保存就不必写上百万首歌
+    PlaylistManager* manager = m_window->m_playlistManager;
+    for (int index = manager->playlistCount() - 1; index > 0; --index) {
+        manager->removePlaylist(index);
+    }
+    delete m_window;
+    m_window = nullptr;
+}
+
+void LibraryBenchmark::addRows(int maxCount)
+{
+    QTest::addColumn<int>("count");
+    for (int count : {1000, 10000, 100000, 1000000}) {
+        if (count <= maxCount) {
+            QTest::newRow(qPrintable(sizeLabel(count))) << count;
+        }
+    }
+}
+
+QString LibraryBenchmark::configFilePath() const
+{
+    return QCoreApplication::applicationDirPath() + "/config/playlists.json";
+}
+
+QString LibraryBenchmark::audioFolder(int count)
+{
+    if (m_audioFolders.contains(count)) {
+        return m_audioFolders.value(count);
+    }
+
+    // 每 100 首一个子文件夹，模拟按专辑整理的音乐目录
+    QString root = m_fileRoot.filePath(QString("music-%1").arg(sizeLabel(count)));
+    for (int i = 0; i < count; ++i) {
+        QString folder = QString("%1/Album %2").arg(root).arg(i / FilesPerFolder, 5, 10, QChar('0'));
+        if (i % FilesPerFolder == 0) {
+            QDir().mkpath(folder);
+        }
+        QFile file(QString("%1/%2 Track.mp3").arg(folder).arg(i, 7, 10, QChar('0')));
+        if (!file.open(QIODevice::WriteOnly)) {
+            qWarning() << "无法创建测试文件:" << file.fileName();
+            return QString();
+        }
+        file.write(makeMp3(QString("Track %1").arg(i),
+                           QString("Artist %1").arg((i / FilesPerFolder) % 50),
+                           QString("Album %1").arg(i / FilesPerFolder)));
+    }
+    m_audioFolders.insert(count, root);
+    return root;
+}
+
+int LibraryBenchmark::windowPlaylist(int count)
+{
+    PlaylistManager* manager = m_window->m_playlistManager;
+
+    // 合成歌曲只登记一次，各个规模的列表取其中的前 count 首
+    if (m_windowSongIds.isEmpty()) {
+        manager->addPlaylist("合成歌曲");
+        Playlist* all = manager->getPlaylist(manager->playlistCount() - 1);
+        all->addSongs(makeSongs(m_maxSongs));
+        m_windowSongIds = all->getSongIds();
+    }
+
+    if (!m_windowPlaylists.contains(count)) {
+        manager->addPlaylist(QString("前 %1 首").arg(sizeLabel(count)));
+        int index = manager->playlistCount() - 1;
+        manager->getPlaylist(index)->setSongIds(m_windowSongIds.mid(0, count));
+        m_windowPlaylists.insert(count, index);
+    }
+
+    // 直接切换当前列表，不经过界面选择（选择会触发对这些并不存在的文件的标签扫描）
+    int index = m_windowPlaylists.value(count);
+    m_window->m_currentPlaylistIndex = index;
+    return index;
+}
+
+// 同一批歌曲分别以旧布局（QList<LegacySong>，每首四个 QString）和 SongLibrary 保存，比较两者的内存
+// 先建旧布局并保持存活，再从它建歌曲库，这样歌曲库的增量不会复用旧布局释放的内存
+void LibraryBenchmark::memoryFootprint()
+{
+    const int count = qMin(MemorySongs, m_maxSongs);
+
+    const qint64 before = residentBytes();
+    const QList<LegacySong> songs = makeLegacySongs(count);
+    const qint64 afterList = residentBytes();
+
+    SongLibrary library;
+    library.reserve(count);
+    for (const LegacySong& song : songs) {
+        library.addSong(toSong(song));
+    }
+    const qint64 afterLibrary = residentBytes();
+    QCOMPARE(library.songCount(), count);
+
+    const qint64 listEstimate = songListBytes(songs);
+    const qint64 libraryEstimate = library.memoryUsage();
+    const double estimateRatio = double(listEstimate) / libraryEstimate;
+    qInfo().noquote() << QString("%1 首歌曲的堆内存估算：QList<LegacySong> %2，SongLibrary（含路径索引）%3，减少到 1/%4")
+                         .arg(count).arg(megabytes(listEstimate), megabytes(libraryEstimate))
+                         .arg(estimateRatio, 0, 'f', 2);
+
+    // 能读取常驻内存时以实测值为准，否则用估算值
+    double ratio = estimateRatio;
+    if (before >= 0) {
+        const qint64 listResident = afterList - before;
+        const qint64 libraryResident = afterLibrary - afterList;
+        QVERIFY(libraryResident > 0);
+        ratio = double(listResident) / libraryResident;
+        qInfo().noquote() << QString("%1 首歌曲的常驻内存增量：QList<LegacySong> %2，SongLibrary（含路径索引）%3，减少到 1/%4")
+                             .arg(count).arg(megabytes(listResident), megabytes(libraryResident))
+                             .arg(ratio, 0, 'f', 2);
+    } else {
+        qInfo() << "这个平台上无法读取常驻内存，只检查估算值";
+    }
+
+    QVERIFY2(ratio >= MemoryTarget,
+             qPrintable(QString("内存减少比例 %1 低于目标 %2").arg(ratio, 0, 'f', 2).arg(MemoryTarget)));
+}
+
+// 拖入一个文件夹：扫描目录、创建列表、读取新文件的标签、保存、刷新界面
+// 第二次导入时歌曲已在库中，不会再读标签，所以只测一次
+void LibraryBenchmark::folderImport()
+{
+    QFETCH(int, count);
+    QString folder = audioFolder(count);
+    QVERIFY(!folder.isEmpty());
+
+    PlaylistManager* manager = m_window->m_playlistManager;
+    const int playlistIndex = manager->playlistCount();
+
+    QBENCHMARK_ONCE {
+        m_window->onFoldersDropped({QUrl::fromLocalFile(folder)});
+    }
+
+    Playlist* imported = manager->getPlaylist(playlistIndex);
+    QVERIFY(imported);
+    QCOMPARE(imported->songCount(), count);
+}
+
+// 只测标签扫描：每轮先把这些歌曲标记为未扫描（文件内容会在系统缓存中，测的是热缓存）
+void LibraryBenchmark::metaDataScan()
+{
+    QFETCH(int, count);
+    QString folder = audioFolder(count);
+    QVERIFY(!folder.isEmpty());
+
+    PlaylistManager* manager = m_window->m_playlistManager;
+    manager->addPlaylist(QString("扫描 %1").arg(sizeLabel(count)));
+    const int playlistIndex = manager->playlistCount() - 1;
+    Playlist* playlist = manager->getPlaylist(playlistIndex);
+
+    QStringList files;
+    QDirIterator it(folder, {"*.mp3"}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        files.append(it.next());
+    }
+    QList<Song> songs;
+    songs.reserve(files.size());
+    for (const QString& file : files) {
+        songs.append(Song(file));
+    }
+    playlist->addSongs(songs);
+    QCOMPARE(playlist->songCount(), count);
+
+    SongLibrary* library = manager->library();
+    QBENCHMARK {
+        for (int id : playlist->getSongIds()) {
+            library->setMetaDataLoaded(id, false);
+        }
+        QVERIFY(m_window->loadPlaylistMetaData(playlistIndex));
+    }
+
+    QVERIFY(library->title(playlist->songId(0)).startsWith("Track "));
+}
+
+// 启动时读取 playlists.json（包括建立路径索引）
+void LibraryBenchmark::loadPlaylists()
+{
+    QFETCH(int, count);
+
+    QFile::remove(configFilePath());
+    {
+        PlaylistManager fixture;
+        fixture.getPlaylist(0)->addSongs(makeSongs(count));
+    } // 析构时保存
+
+    // 每轮都在同一个干净的堆上构造、用完即析构；析构时会保存一次，不计入时间，
+    // 所以不用 QBENCHMARK，而是只对构造计时，再把平均值报告给测试框架
+    qint64 totalNs = 0;
+    int iterations = 0;
+    do {
+        QElapsedTimer timer;
+        timer.start();
+        auto* loaded = new PlaylistManager();
+        totalNs += timer.nsecsElapsed();
+        ++iterations;
+
+        if (iterations == 1) {
+            QCOMPARE(loaded->getPlaylist(0)->songCount(), count);
+            qInfo().noquote() << QString("%1 首歌曲的歌曲表占用 %2 MB")
+                                 .arg(count)
+                                 .arg(loaded->library()->memoryUsage() / (1024.0 * 1024.0), 0, 'f', 1);
+        }
+        delete loaded;
+    } while (iterations < MaxLoadIterations && totalNs < MinLoadTimeNs);
+
+    QTest::setBenchmarkResult(totalNs / 1e6 / iterations, QTest::WalltimeMilliseconds);
+}
+
+void LibraryBenchmark::savePlaylists()
+{
+    QFETCH(int, count);
+
+    QFile::remove(configFilePath());
+    PlaylistManager manager;
+    manager.getPlaylist(0)->addSongs(makeSongs(count));
+
+    QBENCHMARK {
+        manager.savePlaylists();
+    }
+    QVERIFY(QFileInfo(configFilePath()).size() > 0);
+}
+
+// 每轮从同一个乱序开始排序（复制的是 ID 数组，相对排序可以忽略）
+void LibraryBenchmark::sortByName()
+{
+    QFETCH(int, count);
+
+    SongLibrary library;
+    Playlist playlist(&library, "排序");
+    playlist.addSongs(makeSongs(count));
+    const QVector<int> unsorted = playlist.getSongIds();
+
+    QBENCHMARK {
+        playlist.setSongIds(unsorted);
+        playlist.sortByName();
+    }
+
+    QCOMPARE(playlist.songCount(), count);
+    QVERIFY(QString::localeAwareCompare(playlist.songTitle(0), playlist.songTitle(count - 1)) <= 0);
+}
+
+void LibraryBenchmark::updateSongListView()
+{
+    QFETCH(int, count);
+    windowPlaylist(count);
+
+    QBENCHMARK {
+        m_window->updateSongListView();
+    }
+    QCOMPARE(m_window->m_songListWidget->count(), count);
+
+    m_window->m_songListWidget->clear();
+}
+
+void LibraryBenchmark::generateShuffledPlaylist()
+{
+    QFETCH(int, count);
+    windowPlaylist(count);
+
+    QBENCHMARK {
+        m_window->generateShuffledPlaylist();
+    }
+    QCOMPARE(m_window->m_shuffledIndices.size(), count);
+}
+
+QTEST_MAIN(LibraryBenchmark)
+#include "librarybenchmark.moc"
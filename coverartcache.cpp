@@ -0,0 +1,330 @@
+#include "coverartcache.h"
+#include "applog.h"
+#include "diagnostics.h"
+#include "tracerecorder.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QBuffer>
+#include <QImageReader>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QVector>
+#include <QPair>
+#include <algorithm>
+
+// TagLib 头文件
+#include <taglib/fileref.h>
+#include <taglib/tvariant.h>
+
+namespace {
+
+const qsizetype MemoryCacheBytes = 16 * 1024 * 1024;   // 内存缓存上限
+const qint64 DiskCacheBytes = 64 * 1024 * 1024;        // 磁盘缓存上限
+const int DiskCacheEntries = 20000;                    // 磁盘缓存文件数上限（包括没有封面的标记文件）
+const qint64 MarkerBytes = 4096;                       // 空的标记文件也要占一个磁盘块，按这个大小计算
+const int NoCoverEntries = 20000;                      // 内存中记住的 "没有封面" 的键数
+
+// 没有内嵌封面时依次查找的图片文件名（不区分大小写）
+const char* const FolderImageNames[] = {
+    "folder.jpg", "cover.jpg", "front.jpg", "album.jpg", "folder.png", "cover.png"
+};
+
+} // namespace
+
+CoverArtCache::CoverArtCache(QObject* parent)
+    : QObject(parent)
+    , m_running(0)
+    , m_cancelled(false)
+    , m_diskBytes(0)
+{
+    // 和播放列表一样保存在软件目录下的 config 文件夹中
+    m_cacheDir = QCoreApplication::applicationDirPath() + "/config/covers";
+    QDir().mkpath(m_cacheDir);
+
+    m_memoryCache.setMaxCost(MemoryCacheBytes);
+    m_noCover.setMaxCost(NoCoverEntries);
+
+    // 解码图片很占 CPU，两个线程足够跟上滚动，又不会和播放抢资源
+    m_pool.setMaxThreadCount(2);
+    m_pool.start([this]() { loadDiskIndex(); });
+}
+
+CoverArtCache::~CoverArtCache()
+{
+    m_cancelled = true;
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QString CoverArtCache::cacheKey(const QString& filePath, int size)
+{
+    return filePath + '@' + QString::number(size);
+}
+
+QPixmap CoverArtCache::cover(const QString& filePath, int size)
+{
+    if (filePath.isEmpty()) return QPixmap();
+
+    QString key = cacheKey(filePath, size);
+    if (QPixmap* pixmap = m_memoryCache.object(key)) {
+        return *pixmap;
+    }
+    if (m_noCover.contains(key) || m_pending.contains(key)) {
+        return QPixmap();
+    }
+
+    m_pending.insert(key);
+    m_queue.append({filePath, size});
+    startQueued();
+    return QPixmap();
+}
+
+void CoverArtCache::cancelPending(int size)
+{
+    for (int i = m_queue.size() - 1; i >= 0; --i) {
+        if (m_queue.at(i).size != size) continue;
+        m_pending.remove(cacheKey(m_queue.at(i).filePath, size));
+        m_queue.removeAt(i);
+    }
+}
+
+void CoverArtCache::startQueued()
+{
+    while (m_running < m_pool.maxThreadCount() && !m_queue.isEmpty()) {
+        Request request = m_queue.takeFirst();
+        ++m_running;
+        m_pool.start([this, request]() { load(request.filePath, request.size); });
+    }
+}
+
+// 缓存文件名包含原文件的大小和修改时间，原文件变化后旧的缓存自然失效，由淘汰机制清理
+QString CoverArtCache::diskCachePath(const QString& filePath, int size) const
+{
+    QFileInfo fileInfo(filePath);
+    QByteArray source = filePath.toUtf8() + '|' + QByteArray::number(size) + '|'
+                        + QByteArray::number(fileInfo.size()) + '|'
+                        + QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch());
+    QByteArray hash = QCryptographicHash::hash(source, QCryptographicHash::Md5).toHex();
+    return m_cacheDir + '/' + QString::fromLatin1(hash) + ".jpg";
+}
+
+void CoverArtCache::load(const QString& filePath, int size)
+{
+    if (m_cancelled) return;
+    TraceRecorder::setThreadName("CoverArt pool");
+    TraceRecorder::Span span("loadCover", "cover");
+
+    QString cachePath = diskCachePath(filePath, size);
+    QImage image;
+    bool found = false;
+
+    // 1. 磁盘缓存：空文件表示之前确认过没有封面
+    QFile cacheFile(cachePath);
+    if (cacheFile.exists()) {
+        const qint64 bytes = cacheFile.size();
+        found = bytes == 0 || image.load(cachePath);
+        if (found) {
+            // 更新修改时间，下次启动时按它恢复使用顺序
+            if (cacheFile.open(QIODevice::ReadWrite)) {
+                cacheFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+                cacheFile.close();
+            }
+            touchDiskEntry(cachePath, bytes);
+        } else {
+            // 解不出来的缓存文件（旧版本写到一半留下的等）删掉重新生成，不能当成 "没有封面"
+            QFile::remove(cachePath);
+            forgetDiskEntry(cachePath);
+        }
+    }
+
+    // 2. 从音频文件或目录图片中提取并缩放，写入磁盘缓存
+    if (!found) {
+        image = extractCover(filePath, size);
+        if (m_cancelled) return;
+
+        // 先写临时文件再改名，崩溃或磁盘写满时不会留下不完整的缓存文件
+        QSaveFile out(cachePath);
+        bool saved = out.open(QIODevice::WriteOnly)
+                     && (image.isNull() || image.save(&out, "JPG", 90))
+                     && out.commit();
+        if (saved) {
+            touchDiskEntry(cachePath, QFileInfo(cachePath).size());
+        }
+    }
+
+    // QPixmap 只能在主线程中创建
+    QMetaObject::invokeMethod(this, [this, filePath, size, image]() {
+        QString key = cacheKey(filePath, size);
+        m_pending.remove(key);
+        --m_running;
+        startQueued();
+
+        QPixmap pixmap;
+        if (image.isNull()) {
+            m_noCover.insert(key, new bool(true));
+        } else {
+            pixmap = QPixmap::fromImage(image);
+            m_memoryCache.insert(key, new QPixmap(pixmap),
+                                 qMax<qsizetype>(1, qsizetype(pixmap.width()) * pixmap.height() * 4));
+        }
+        emit coverReady(filePath, size, pixmap);
+    }, Qt::QueuedConnection);
+}
+
+QImage CoverArtCache::extractCover(const QString& filePath, int size)
+{
+    // 内嵌封面：优先使用 "Front Cover"，没有就用第一张图片
+    QByteArray data;
+    {
+        Diagnostics::ScopedTimer timer(Diagnostics::TagRead);
+        TagLib::FileRef file(filePath.toStdWString().c_str(), false);
+        if (!file.isNull()) {
+            const TagLib::List<TagLib::VariantMap> pictures = file.complexProperties("PICTURE");
+            for (const TagLib::VariantMap& picture : pictures) {
+                TagLib::ByteVector bytes = picture.value("data").toByteVector();
+                if (bytes.isEmpty()) continue;
+                bool isFront = picture.value("pictureType").toString() == "Front Cover";
+                if (data.isEmpty() || isFront) {
+                    data = QByteArray(bytes.data(), bytes.size());
+                }
+                if (isFront) break;
+            }
+        }
+    }
+
+    if (!data.isEmpty()) {
+        QImage image = decodeScaled(data, size);
+        if (!image.isNull()) return image;
+    }
+
+    // 目录图片
+    QDir dir = QFileInfo(filePath).absoluteDir();
+    const QStringList entries = dir.entryList(QDir::Files);
+    for (const char* name : FolderImageNames) {
+        for (const QString& entry : entries) {
+            if (entry.compare(QLatin1String(name), Qt::CaseInsensitive) != 0) continue;
+            QFile imageFile(dir.filePath(entry));
+            if (imageFile.open(QIODevice::ReadOnly)) {
+                QImage image = decodeScaled(imageFile.readAll(), size);
+                if (!image.isNull()) return image;
+            }
+        }
+    }
+    return QImage();
+}
+
+// 解码时直接缩放：JPEG 解码器可以按比例只解出缩小后的图像，不必先解出整张原图
+QImage CoverArtCache::decodeScaled(const QByteArray& data, int size)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+
+    QImageReader reader(&buffer);
+    QSize original = reader.size();
+    if (original.isValid() && (original.width() > size || original.height() > size)) {
+        reader.setScaledSize(original.scaled(size, size, Qt::KeepAspectRatio));
+    }
+
+    QImage image = reader.read();
+    if (image.isNull()) return image;
+
+    // 部分格式不支持 setScaledSize，再补一次缩放
+    if (image.width() > size || image.height() > size) {
+        image = image.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image.convertToFormat(QImage::Format_RGB32);
+}
+
+// 启动时列一次目录建立索引，之后的增删都只更新索引
+void CoverArtCache::loadDiskIndex()
+{
+    const QFileInfoList files = QDir(m_cacheDir).entryInfoList(QDir::Files);
+
+    QStringList expired;
+    {
+        QMutexLocker locker(&m_diskMutex);
+        for (const QFileInfo& file : files) {
+            if (m_cancelled) return;
+            // 启动后已经登记过的文件以索引中的为准
+            if (m_diskEntries.contains(file.fileName())) continue;
+            qint64 bytes = qMax(file.size(), MarkerBytes);
+            m_diskEntries.insert(file.fileName(), {bytes, file.lastModified().toMSecsSinceEpoch()});
+            m_diskBytes += bytes;
+        }
+        expired = takeExpiredLocked();
+    }
+    removeDiskFiles(expired);
+}
+
+void CoverArtCache::touchDiskEntry(const QString& cachePath, qint64 bytes)
+{
+    const QString name = QFileInfo(cachePath).fileName();
+    const qint64 charged = qMax(bytes, MarkerBytes);
+
+    QStringList expired;
+    {
+        QMutexLocker locker(&m_diskMutex);
+        auto it = m_diskEntries.find(name);
+        if (it != m_diskEntries.end()) {
+            m_diskBytes -= it->bytes;
+            it->bytes = charged;
+            it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+        } else {
+            m_diskEntries.insert(name, {charged, QDateTime::currentMSecsSinceEpoch()});
+        }
+        m_diskBytes += charged;
+        expired = takeExpiredLocked();
+    }
+    removeDiskFiles(expired);
+}
+
+void CoverArtCache::forgetDiskEntry(const QString& cachePath)
+{
+    QMutexLocker locker(&m_diskMutex);
+    auto it = m_diskEntries.find(QFileInfo(cachePath).fileName());
+    if (it != m_diskEntries.end()) {
+        m_diskBytes -= it->bytes;
+        m_diskEntries.erase(it);
+    }
+}
+
+// 总大小或文件数超过上限时，从索引中取出最久没有用过的文件，直到两者都降到上限的 3/4
+// 一次淘汰 1/4，排序的开销分摊到之后的大量写入上
+QStringList CoverArtCache::takeExpiredLocked()
+{
+    QStringList expired;
+    if (m_diskBytes <= DiskCacheBytes && m_diskEntries.size() <= DiskCacheEntries) return expired;
+
+    QVector<QPair<qint64, QString>> byAge;
+    byAge.reserve(m_diskEntries.size());
+    for (auto it = m_diskEntries.constBegin(); it != m_diskEntries.constEnd(); ++it) {
+        byAge.append(qMakePair(it->lastUsed, it.key()));
+    }
+    std::sort(byAge.begin(), byAge.end());
+
+    const qint64 targetBytes = DiskCacheBytes * 3 / 4;
+    const int targetEntries = DiskCacheEntries * 3 / 4;
+    for (const auto& entry : byAge) {
+        if (m_diskBytes <= targetBytes && m_diskEntries.size() <= targetEntries) break;
+        m_diskBytes -= m_diskEntries.take(entry.second).bytes;
+        expired.append(entry.second);
+    }
+    qCDebug(lcCover) << "封面缓存淘汰" << expired.size() << "个文件，剩余" << m_diskEntries.size()
+                     << "个，" << m_diskBytes / 1024 << "KB";
+    return expired;
+}
+
+void CoverArtCache::removeDiskFiles(const QStringList& names)
+{
+    for (const QString& name : names) {
+        // 退出时不再等它删完，剩下的文件已经不在索引中，下次启动时重新登记、淘汰
+        if (m_cancelled) return;
+        QFile::remove(m_cacheDir + '/' + name);
+    }
+}
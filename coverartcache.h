@@ -0,0 +1,81 @@
+#ifndef COVERARTCACHE_H
+#define COVERARTCACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QImage>
+#include <QPixmap>
+#include <QCache>
+#include <QSet>
+#include <QHash>
+#include <QVector>
+#include <QMutex>
+#include <QThreadPool>
+#include <atomic>
+
+// 专辑封面缩略图缓存
+// 封面来自音频文件内嵌的图片（ID3 APIC、FLAC PICTURE、MP4 covr 等，通过 TagLib 读取），
+// 没有内嵌图片时使用同目录下的 folder.jpg / cover.jpg。
+// 解码和缩放在后台线程中进行，结果同时保存在内存（按字节数限制的 LRU）和
+// 磁盘（config/covers，按总大小和文件数淘汰最久未使用的文件，"没有封面" 的标记文件也计入）中，
+// 之后再显示同一张封面不需要重新解码几 MB 的原图
+class CoverArtCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CoverArtCache(QObject* parent = nullptr);
+    ~CoverArtCache();
+
+    // 返回内存中已有的缩略图；没有时返回空 QPixmap，并在后台开始加载，
+    // 加载完成后发出 coverReady（没有封面的文件不会重复加载）
+    QPixmap cover(const QString& filePath, int size);
+    // 放弃这个尺寸还在排队、没有开始加载的请求（例如已经滚出视野的行）
+    void cancelPending(int size);
+
+signals:
+    // pixmap 为空表示该文件没有封面
+    void coverReady(const QString& filePath, int size, const QPixmap& pixmap);
+
+private:
+    void startQueued();
+    void load(const QString& filePath, int size);   // 运行在线程池中
+    void loadDiskIndex();                            // 运行在线程池中，启动时列一次目录
+    void touchDiskEntry(const QString& cachePath, qint64 bytes);   // 运行在线程池中
+    void forgetDiskEntry(const QString& cachePath);                 // 运行在线程池中
+    QStringList takeExpiredLocked();                 // 调用者持有 m_diskMutex，返回要删除的文件名
+    void removeDiskFiles(const QStringList& names);  // 在锁外删除，不挡住另一个加载线程
+    QString diskCachePath(const QString& filePath, int size) const;   // 运行在线程池中
+
+    static QImage extractCover(const QString& filePath, int size);
+    static QImage decodeScaled(const QByteArray& data, int size);
+    static QString cacheKey(const QString& filePath, int size);
+
+    QString m_cacheDir;
+    QCache<QString, QPixmap> m_memoryCache;   // 键 -> 缩略图，成本为字节数
+    QCache<QString, bool> m_noCover;          // 确认没有封面的键，数量有上限
+    QSet<QString> m_pending;                  // 排队中和正在后台加载的键
+
+    // 请求先在界面线程中排队，线程池中同时只放线程数那么多个任务，
+    // 这样滚出视野的请求还能撤回，不会在线程池里积压
+    struct Request {
+        QString filePath;
+        int size;
+    };
+    QVector<Request> m_queue;
+    int m_running;
+    QThreadPool m_pool;
+    std::atomic_bool m_cancelled;
+
+    // 磁盘缓存的索引：文件名 -> 计入的字节数和最近使用时间，淘汰时不必再列目录
+    struct DiskEntry {
+        qint64 bytes;
+        qint64 lastUsed;
+    };
+    QMutex m_diskMutex;
+    QHash<QString, DiskEntry> m_diskEntries;
+    qint64 m_diskBytes;
+};
+
+#endif // COVERARTCACHE_H
@@ -0,0 +1,236 @@
+#include "cuesheet.h"
+#include "applog.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSet>
+#include <QHash>
+#include <QStringDecoder>
+#include <QDebug>
+
+// TagLib 头文件
+#include <taglib/fileref.h>
+#include <taglib/audioproperties.h>
+
+namespace {
+
+// 音频文件名与 CUE 中写的不一致时（例如抓轨后把 .wav 压成了 .flac）依次尝试的扩展名
+const char* const AudioSuffixes[] = {"flac", "wav", "ape", "wv", "mp3", "m4a", "ogg", "tta"};
+
+// 比较路径用的键：Windows 上不区分大小写
+QString pathKey(const QString& path)
+{
+    QString key = QFileInfo(path).absoluteFilePath();
+#ifdef Q_OS_WIN
+    key = key.toLower();
+#endif
+    return key;
+}
+
+// 取出命令后面的参数：带引号的取引号内的内容，否则取第一个单词
+QString firstArgument(const QString& rest)
+{
+    if (rest.startsWith('"')) {
+        int close = rest.indexOf('"', 1);
+        return close > 0 ? rest.mid(1, close - 1) : rest.mid(1);
+    }
+    int space = rest.indexOf(' ');
+    return space > 0 ? rest.left(space) : rest;
+}
+
+struct CueTrack {
+    int number = 0;
+    QString title;
+    QString performer;
+    QString filePath;
+    qint64 start = -1;   // INDEX 01，毫秒
+};
+
+} // namespace
+
+bool CueSheet::isCueFile(const QString& filePath)
+{
+    return filePath.endsWith(".cue", Qt::CaseInsensitive);
+}
+
+// CUE 文件常见 UTF-8（带或不带 BOM）和本地编码（中文系统上为 GBK）两种
+QString CueSheet::decode(const QByteArray& data)
+{
+    QStringDecoder utf8(QStringDecoder::Utf8);
+    QString text = utf8(data);
+    if (!utf8.hasError()) {
+        return text;
+    }
+    return QString::fromLocal8Bit(data);
+}
+
+QString CueSheet::resolveAudioFile(const QString& cueDir, const QString& name)
+{
+    QDir dir(cueDir);
+    QString path = dir.filePath(QDir::fromNativeSeparators(name));
+    if (QFileInfo::exists(path)) {
+        return QDir::toNativeSeparators(path);
+    }
+
+    QString base = QFileInfo(path).completeBaseName();
+    QString parent = QFileInfo(path).absolutePath();
+    for (const char* suffix : AudioSuffixes) {
+        QString candidate = parent + '/' + base + '.' + QLatin1String(suffix);
+        if (QFileInfo::exists(candidate)) {
+            return QDir::toNativeSeparators(candidate);
+        }
+    }
+    return QString();
+}
+
+// "mm:ss:ff"，ff 为帧（每秒 75 帧）
+qint64 CueSheet::parseIndexTime(const QString& text)
+{
+    QStringList parts = text.split(':');
+    if (parts.size() != 3) return -1;
+
+    bool okMins = false, okSecs = false, okFrames = false;
+    qint64 mins = parts[0].toLongLong(&okMins);
+    qint64 secs = parts[1].toLongLong(&okSecs);
+    qint64 frames = parts[2].toLongLong(&okFrames);
+    if (!okMins || !okSecs || !okFrames) return -1;
+
+    return (mins * 60 + secs) * 1000 + frames * 1000 / 75;
+}
+
+qint64 CueSheet::audioLength(const QString& filePath)
+{
+    TagLib::FileRef file(filePath.toStdWString().c_str(), true, TagLib::AudioProperties::Fast);
+    if (file.isNull() || !file.audioProperties()) return 0;
+    return file.audioProperties()->lengthInMilliseconds();
+}
+
+bool CueSheet::load(const QString& cuePath)
+{
+    m_tracks.clear();
+    m_audioFiles.clear();
+
+    QFile file(cuePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(lcImport) << "无法打开 CUE 文件:" << cuePath;
+        return false;
+    }
+    QString text = decode(file.readAll());
+    QString cueDir = QFileInfo(cuePath).absolutePath();
+
+    QString albumTitle;
+    QString albumPerformer;
+    QString currentFile;
+    bool fileFound = false;
+    QList<CueTrack> tracks;
+    bool inTrack = false;
+
+    const QStringList lines = text.split('\n');
+    for (const QString& rawLine : lines) {
+        QString line = rawLine.trimmed();
+        if (line.isEmpty()) continue;
+
+        int space = line.indexOf(' ');
+        QString command = (space > 0 ? line.left(space) : line).toUpper();
+        QString rest = space > 0 ? line.mid(space + 1).trimmed() : QString();
+
+        if (command == "FILE") {
+            QString name = firstArgument(rest);
+            currentFile = resolveAudioFile(cueDir, name);
+            fileFound = !currentFile.isEmpty();
+            if (fileFound) {
+                if (!m_audioFiles.contains(currentFile)) m_audioFiles.append(currentFile);
+            } else {
+                qCWarning(lcImport) << "CUE 引用的音频文件不存在:" << name;
+            }
+            inTrack = false;
+        } else if (command == "TRACK") {
+            // 只处理音频轨，数据轨等跳过；所在的 FILE 不存在时也跳过
+            inTrack = fileFound && rest.endsWith("AUDIO", Qt::CaseInsensitive);
+            if (inTrack) {
+                CueTrack track;
+                track.number = firstArgument(rest).toInt();
+                track.filePath = currentFile;
+                tracks.append(track);
+            }
+        } else if (command == "TITLE") {
+            if (inTrack) tracks.last().title = firstArgument(rest);
+            else if (tracks.isEmpty()) albumTitle = firstArgument(rest);
+        } else if (command == "PERFORMER") {
+            if (inTrack) tracks.last().performer = firstArgument(rest);
+            else if (tracks.isEmpty()) albumPerformer = firstArgument(rest);
+        } else if (command == "INDEX" && inTrack) {
+            // INDEX 00 为前置间隙，算在上一首的末尾，这样相邻两首首尾相接，播放时没有空隙
+            QStringList parts = rest.split(' ', Qt::SkipEmptyParts);
+            if (parts.size() == 2 && parts[0].toInt() == 1) {
+                tracks.last().start = parseIndexTime(parts[1]);
+            }
+        }
+    }
+
+    // 每首歌结束于同一文件中下一首的开始，文件中的最后一首结束于文件末尾
+    QHash<QString, qint64> lengths;
+    for (int i = 0; i < tracks.size(); ++i) {
+        const CueTrack& track = tracks[i];
+        if (track.start < 0) continue;
+
+        qint64 end = 0;
+        for (int j = i + 1; j < tracks.size(); ++j) {
+            if (tracks[j].filePath != track.filePath) break;
+            if (tracks[j].start > track.start) {
+                end = tracks[j].start;
+                break;
+            }
+        }
+        if (end == 0) {
+            if (!lengths.contains(track.filePath)) {
+                lengths.insert(track.filePath, audioLength(track.filePath));
+            }
+            qint64 length = lengths.value(track.filePath);
+            if (length > track.start) end = length;
+        }
+
+        Song song(track.filePath);
+        song.title = !track.title.isEmpty() ? track.title
+                                            : QString("音轨 %1").arg(track.number, 2, 10, QChar('0'));
+        QString performer = !track.performer.isEmpty() ? track.performer : albumPerformer;
+        if (!performer.isEmpty()) song.artist = performer;
+        if (!albumTitle.isEmpty()) song.album = albumTitle;
+        song.startOffset = track.start;
+        song.endOffset = end;
+        song.duration = end > 0 ? end - track.start : 0;
+        m_tracks.append(song);
+    }
+
+    qCDebug(lcImport) << "解析 CUE 文件" << cuePath << "得到" << m_tracks.size() << "条音轨";
+    return !m_tracks.isEmpty();
+}
+
+QList<Song> CueSheet::expandFiles(const QStringList& filePaths)
+{
+    // 1. 先解析所有 CUE，记下它们引用的音频文件
+    QHash<QString, QList<Song>> cueTracks;
+    QSet<QString> covered;
+    for (const QString& path : filePaths) {
+        if (!isCueFile(path)) continue;
+        CueSheet sheet;
+        if (sheet.load(path)) {
+            cueTracks.insert(path, sheet.tracks());
+            for (const QString& audioFile : sheet.audioFiles()) {
+                covered.insert(pathKey(audioFile));
+            }
+        }
+    }
+
+    // 2. 按原顺序输出；没有 CUE 时不必逐个计算路径键
+    QList<Song> songs;
+    songs.reserve(filePaths.size());
+    for (const QString& path : filePaths) {
+        if (isCueFile(path)) {
+            songs.append(cueTracks.value(path));
+        } else if (covered.isEmpty() || !covered.contains(pathKey(path))) {
+            songs.append(Song(path));
+        }
+    }
+    return songs;
+}
@@ -0,0 +1,38 @@
+#ifndef CUESHEET_H
+#define CUESHEET_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include "playlist.h"
+
+// CUE 文件解析
+// 整张专辑抓成一个音频文件（.flac / .wav / .ape 等）时，CUE 文件记录了每首歌的起始位置，
+// 这里把它展开为多条虚拟音轨（Song::startOffset / endOffset），播放时在同一个文件中跳转
+class CueSheet
+{
+public:
+    // 读取并解析 CUE 文件，没有找到任何可用音轨时返回 false
+    bool load(const QString& cuePath);
+
+    const QList<Song>& tracks() const { return m_tracks; }
+    // CUE 中引用的、确实存在的音频文件
+    const QStringList& audioFiles() const { return m_audioFiles; }
+
+    static bool isCueFile(const QString& filePath);
+
+    // 展开一批要导入的文件：.cue 展开为虚拟音轨，被某个 CUE 引用的音频文件不再单独添加，
+    // 其余文件原样作为普通歌曲，顺序保持不变
+    static QList<Song> expandFiles(const QStringList& filePaths);
+
+private:
+    static QString decode(const QByteArray& data);
+    static QString resolveAudioFile(const QString& cueDir, const QString& name);
+    static qint64 parseIndexTime(const QString& text);
+    static qint64 audioLength(const QString& filePath);
+
+    QList<Song> m_tracks;
+    QStringList m_audioFiles;
+};
+
+#endif // CUESHEET_H
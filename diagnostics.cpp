@@ -0,0 +1,184 @@
+#include "diagnostics.h"
+#include "startupprofiler.h"
+#include <QJsonArray>
+#include <QDateTime>
+#include <atomic>
+
+namespace {
+
+struct Counter {
+    std::atomic<quint64> count{0};
+    std::atomic<quint64> totalUs{0};
+    std::atomic<quint64> maxUs{0};
+    std::atomic<quint64> buckets[Diagnostics::BucketCount];
+};
+
+// 静态存储，启动时全部为 0
+Counter g_counters[Diagnostics::MetricCount];
+
+// 进程启动后第一次使用时开始计时
+QElapsedTimer& uptimeTimer()
+{
+    static QElapsedTimer timer = []() {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer;
+}
+
+int bucketOf(quint64 us)
+{
+    int bucket = 0;
+    while (us > 1 && bucket < Diagnostics::BucketCount - 1) {
+        us >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+} // namespace
+
+quint64 Diagnostics::Snapshot::percentileUs(double p) const
+{
+    quint64 total = 0;
+    for (quint64 n : buckets) total += n;
+    if (total == 0) return 0;
+
+    const quint64 target = qMax<quint64>(1, quint64(total * p + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= target) {
+            // 估算值不超过实际观察到的最大值
+            return qMin(maxUs, (quint64(1) << (i + 1)) - 1);
+        }
+    }
+    return maxUs;
+}
+
+void Diagnostics::record(Metric metric, qint64 durationUs)
+{
+    if (metric < 0 || metric >= MetricCount) return;
+    uptimeTimer();
+
+    Counter& counter = g_counters[metric];
+    counter.count.fetch_add(1, std::memory_order_relaxed);
+    if (durationUs < 0) return;
+
+    const quint64 us = quint64(durationUs);
+    counter.totalUs.fetch_add(us, std::memory_order_relaxed);
+    counter.buckets[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+
+    quint64 currentMax = counter.maxUs.load(std::memory_order_relaxed);
+    while (us > currentMax
+           && !counter.maxUs.compare_exchange_weak(currentMax, us, std::memory_order_relaxed)) {
+    }
+}
+
+Diagnostics::Snapshot Diagnostics::snapshot(Metric metric)
+{
+    Snapshot result;
+    result.name = metricName(metric);
+    if (metric < 0 || metric >= MetricCount) return result;
+
+    // 各字段分别读取，并发记录时可能有一两次的出入，对统计没有影响
+    const Counter& counter = g_counters[metric];
+    result.count = counter.count.load(std::memory_order_relaxed);
+    result.totalUs = counter.totalUs.load(std::memory_order_relaxed);
+    result.maxUs = counter.maxUs.load(std::memory_order_relaxed);
+    result.buckets.resize(BucketCount);
+    for (int i = 0; i < BucketCount; ++i) {
+        result.buckets[i] = counter.buckets[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+QString Diagnostics::metricName(Metric metric)
+{
+    switch (metric) {
+    case TagRead:         return "tagRead";
+    case PlaylistSave:    return "playlistSave";
+    case ListRebuild:     return "listRebuild";
+    case FileOpen:        return "fileOpen";
+    case DecoderUnderrun: return "decoderUnderrun";
+    case IpcMessage:      return "ipcMessage";
+    case HttpRequest:     return "httpRequest";
+    default:              return QString();
+    }
+}
+
+QString Diagnostics::metricLabel(Metric metric)
+{
+    switch (metric) {
+    case TagRead:         return "读取标签";
+    case PlaylistSave:    return "保存播放列表";
+    case ListRebuild:     return "重建歌曲列表";
+    case FileOpen:        return "打开文件";
+    case DecoderUnderrun: return "解码卡顿";
+    case IpcMessage:      return "IPC 消息";
+    case HttpRequest:     return "HTTP 请求";
+    default:              return QString();
+    }
+}
+
+qint64 Diagnostics::uptimeMs()
+{
+    return uptimeTimer().elapsed();
+}
+
+void Diagnostics::reset()
+{
+    for (Counter& counter : g_counters) {
+        counter.count.store(0, std::memory_order_relaxed);
+        counter.totalUs.store(0, std::memory_order_relaxed);
+        counter.maxUs.store(0, std::memory_order_relaxed);
+        for (auto& bucket : counter.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+QJsonObject Diagnostics::toJson()
+{
+    QJsonObject metrics;
+    for (int i = 0; i < MetricCount; ++i) {
+        Snapshot s = snapshot(Metric(i));
+        QJsonObject object;
+        object["count"] = double(s.count);
+        if (s.hasLatency()) {
+            object["totalUs"] = double(s.totalUs);
+            object["maxUs"] = double(s.maxUs);
+            object["avgUs"] = qRound64(s.averageUs());
+            object["p50Us"] = double(s.percentileUs(0.50));
+            object["p95Us"] = double(s.percentileUs(0.95));
+            object["p99Us"] = double(s.percentileUs(0.99));
+
+            // 只导出非空的桶，键为桶的下界（微秒）
+            QJsonObject histogram;
+            for (int b = 0; b < s.buckets.size(); ++b) {
+                if (s.buckets[b] > 0) {
+                    histogram[QString::number(b == 0 ? 0 : quint64(1) << b)] = double(s.buckets[b]);
+                }
+            }
+            object["histogram"] = histogram;
+        }
+        metrics[s.name] = object;
+    }
+
+    QJsonArray startup;
+    for (const StartupProfiler::Phase& phase : StartupProfiler::phases()) {
+        QJsonObject object;
+        object["phase"] = phase.name;
+        object["durationUs"] = phase.durationUs;
+        object["endUs"] = phase.endUs;
+        startup.append(object);
+    }
+
+    QJsonObject root;
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["uptimeMs"] = Diagnostics::uptimeMs();
+    root["metrics"] = metrics;
+    root["startup"] = startup;
+    return root;
+}
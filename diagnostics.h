@@ -0,0 +1,70 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <QString>
+#include <QVector>
+#include <QJsonObject>
+#include <QElapsedTimer>
+
+// 运行时诊断计数
+// 记录标签读取、播放列表保存、列表重建、打开文件等操作的次数和耗时分布，
+// 以及解码卡顿、IPC / HTTP 消息等事件的次数。
+// 全部用原子变量记录（relaxed），任意线程都可以调用，不加锁，开销只有几次原子加法。
+// 耗时按 2 的幂分桶（微秒），分位数由直方图估算。
+class Diagnostics
+{
+public:
+    enum Metric {
+        TagRead,            // TagLib 读取一个文件的标签 / 封面
+        PlaylistSave,       // 保存 playlists.json
+        ListRebuild,        // 重建歌曲列表控件
+        FileOpen,           // 播放器打开文件到可以播放
+        DecoderUnderrun,    // 播放中数据不足而卡顿（只计次数）
+        IpcMessage,         // 单实例通道收到的命令
+        HttpRequest,        // HTTP 控制接口收到的请求
+        MetricCount
+    };
+
+    static const int BucketCount = 26;   // 最后一个桶约 33 秒以上
+
+    struct Snapshot {
+        QString name;
+        quint64 count = 0;
+        quint64 totalUs = 0;
+        quint64 maxUs = 0;
+        QVector<quint64> buckets;   // buckets[i]：耗时在 [2^i, 2^(i+1)) 微秒之间（第 0 个桶包括 0）
+
+        bool hasLatency() const { return totalUs > 0 || maxUs > 0; }
+        double averageUs() const { return count > 0 ? double(totalUs) / count : 0.0; }
+        quint64 percentileUs(double p) const;   // 所在桶的上界
+    };
+
+    static void record(Metric metric, qint64 durationUs);
+    static void count(Metric metric) { record(metric, -1); }   // 不带耗时的事件
+
+    static Snapshot snapshot(Metric metric);
+    static QString metricName(Metric metric);   // JSON 中使用的英文名
+    static QString metricLabel(Metric metric);  // 界面上显示的中文名
+    static qint64 uptimeMs();
+    static void reset();
+
+    // 所有计数和启动阶段耗时，供诊断面板导出和 diagnostics 命令使用
+    static QJsonObject toJson();
+
+    // 在作用域结束时记录耗时
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Metric metric) : m_metric(metric) { m_timer.start(); }
+        ~ScopedTimer() { record(m_metric, m_timer.nsecsElapsed() / 1000); }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Metric m_metric;
+        QElapsedTimer m_timer;
+    };
+};
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,165 @@
+#include "diagnosticsdialog.h"
+#include "diagnostics.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QHeaderView>
+#include <QTimer>
+#include <QFile>
+#include <QDir>
+#include <QDateTime>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace {
+
+// 微秒转成便于阅读的文字
+QString formatUs(double us)
+{
+    if (us < 1000) return QString("%1 µs").arg(qRound64(us));
+    if (us < 1000 * 1000) return QString("%1 ms").arg(us / 1000.0, 0, 'f', 1);
+    return QString("%1 s").arg(us / 1000000.0, 0, 'f', 2);
+}
+
+} // namespace
+
+DiagnosticsDialog::DiagnosticsDialog(SnapshotProvider provider, QWidget* parent)
+    : QDialog(parent)
+    , m_provider(std::move(provider))
+{
+    setWindowTitle("诊断信息");
+    setMinimumSize(680, 480);
+
+    setupUI();
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, &DiagnosticsDialog::refresh);
+    m_refreshTimer->start();
+
+    refresh();
+}
+
+void DiagnosticsDialog::setupUI()
+{
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setSpacing(12);
+
+    m_summaryLabel = new QLabel();
+    m_summaryLabel->setWordWrap(true);
+    mainLayout->addWidget(m_summaryLabel);
+
+    // 各项操作的计数和耗时
+    m_metricTree = new QTreeWidget();
+    m_metricTree->setColumnCount(7);
+    m_metricTree->setHeaderLabels({"项目", "次数", "平均", "P50", "P95", "P99", "最长"});
+    m_metricTree->setRootIsDecorated(false);
+    m_metricTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    for (int column = 1; column < 7; ++column) {
+        m_metricTree->header()->setSectionResizeMode(column, QHeaderView::ResizeToContents);
+    }
+    mainLayout->addWidget(m_metricTree, 2);
+
+    // 本次启动各阶段的耗时
+    mainLayout->addWidget(new QLabel("启动耗时:"));
+    m_startupTree = new QTreeWidget();
+    m_startupTree->setColumnCount(3);
+    m_startupTree->setHeaderLabels({"阶段", "耗时", "累计"});
+    m_startupTree->setRootIsDecorated(false);
+    m_startupTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    mainLayout->addWidget(m_startupTree, 1);
+
+    // 按钮
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    m_resetBtn = new QPushButton("清零");
+    connect(m_resetBtn, &QPushButton::clicked, this, &DiagnosticsDialog::onResetClicked);
+    buttonLayout->addWidget(m_resetBtn);
+
+    m_exportBtn = new QPushButton("导出 JSON...");
+    connect(m_exportBtn, &QPushButton::clicked, this, &DiagnosticsDialog::onExportClicked);
+    buttonLayout->addWidget(m_exportBtn);
+    buttonLayout->addStretch();
+
+    m_closeBtn = new QPushButton("关闭");
+    connect(m_closeBtn, &QPushButton::clicked, this, &DiagnosticsDialog::accept);
+    buttonLayout->addWidget(m_closeBtn);
+    mainLayout->addLayout(buttonLayout);
+}
+
+void DiagnosticsDialog::refresh()
+{
+    QJsonObject snapshot = m_provider ? m_provider() : Diagnostics::toJson();
+
+    // 概要：运行时间和调用者补充的当前状态
+    QStringList summary;
+    summary.append(QString("已运行 %1").arg(formatUs(snapshot.value("uptimeMs").toDouble() * 1000.0)));
+    const QJsonObject gauges = snapshot.value("gauges").toObject();
+    for (auto it = gauges.constBegin(); it != gauges.constEnd(); ++it) {
+        summary.append(QString("%1: %2").arg(it.key(), it.value().toVariant().toString()));
+    }
+    m_summaryLabel->setText(summary.join("    "));
+
+    // 只更新文字，不重建列表项，保留用户的选中状态
+    const QJsonObject metrics = snapshot.value("metrics").toObject();
+    for (int i = 0; i < Diagnostics::MetricCount; ++i) {
+        Diagnostics::Metric metric = Diagnostics::Metric(i);
+        QJsonObject object = metrics.value(Diagnostics::metricName(metric)).toObject();
+
+        QTreeWidgetItem* item = m_metricTree->topLevelItem(i);
+        if (!item) {
+            item = new QTreeWidgetItem(m_metricTree);
+            item->setText(0, Diagnostics::metricLabel(metric));
+            for (int column = 1; column < 7; ++column) {
+                item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+            }
+        }
+
+        item->setText(1, QString::number(qint64(object.value("count").toDouble())));
+        const bool hasLatency = object.contains("maxUs");
+        item->setText(2, hasLatency ? formatUs(object.value("avgUs").toDouble()) : "-");
+        item->setText(3, hasLatency ? formatUs(object.value("p50Us").toDouble()) : "-");
+        item->setText(4, hasLatency ? formatUs(object.value("p95Us").toDouble()) : "-");
+        item->setText(5, hasLatency ? formatUs(object.value("p99Us").toDouble()) : "-");
+        item->setText(6, hasLatency ? formatUs(object.value("maxUs").toDouble()) : "-");
+    }
+
+    // 启动阶段在本次运行中不再变化，只填一次
+    if (m_startupTree->topLevelItemCount() == 0) {
+        for (const QJsonValue& value : snapshot.value("startup").toArray()) {
+            QJsonObject phase = value.toObject();
+            QTreeWidgetItem* item = new QTreeWidgetItem(m_startupTree);
+            item->setText(0, phase.value("phase").toString());
+            item->setText(1, formatUs(phase.value("durationUs").toDouble()));
+            item->setText(2, formatUs(phase.value("endUs").toDouble()));
+        }
+    }
+}
+
+void DiagnosticsDialog::onResetClicked()
+{
+    Diagnostics::reset();
+    refresh();
+}
+
+void DiagnosticsDialog::onExportClicked()
+{
+    QString filePath = QFileDialog::getSaveFileName(
+        this,
+        "导出诊断信息",
+        QDir::homePath() + "/OldPlayer-diagnostics-"
+            + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".json",
+        "JSON 文件 (*.json)"
+    );
+    if (filePath.isEmpty()) return;
+
+    QJsonObject snapshot = m_provider ? m_provider() : Diagnostics::toJson();
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || file.write(QJsonDocument(snapshot).toJson(QJsonDocument::Indented)) < 0) {
+        QMessageBox::warning(this, "导出失败", QString("无法写入 %1：\n%2").arg(filePath, file.errorString()));
+    }
+}
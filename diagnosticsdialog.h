@@ -0,0 +1,45 @@
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+#include <QJsonObject>
+#include <functional>
+
+class QLabel;
+class QPushButton;
+class QTimer;
+class QTreeWidget;
+
+// 诊断面板
+// 每秒刷新一次各项操作的次数和耗时分位数（数据见 diagnostics.h），可以导出为 JSON 文件。
+// 数据由调用者提供，主窗口会在 Diagnostics::toJson() 的基础上补充歌曲数、串流连接数等当前状态
+class DiagnosticsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    using SnapshotProvider = std::function<QJsonObject()>;
+
+    explicit DiagnosticsDialog(SnapshotProvider provider, QWidget* parent = nullptr);
+
+private slots:
+    void refresh();
+    void onResetClicked();
+    void onExportClicked();
+
+private:
+    void setupUI();
+
+    SnapshotProvider m_provider;
+    QTimer* m_refreshTimer;
+
+    // UI 组件
+    QLabel* m_summaryLabel;
+    QTreeWidget* m_metricTree;
+    QTreeWidget* m_startupTree;
+    QPushButton* m_resetBtn;
+    QPushButton* m_exportBtn;
+    QPushButton* m_closeBtn;
+};
+
+#endif // DIAGNOSTICSDIALOG_H
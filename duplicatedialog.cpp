@@ -0,0 +1,334 @@
+#include "duplicatedialog.h"
+#include "duplicatefinder.h"
+#include "playlistmanager.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QComboBox>
+#include <QProgressBar>
+#include <QLabel>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+// 同一首歌在当前列表中重复出现时，记录它在列表中的位置
+const int PositionRole = Qt::UserRole + 1;
+}
+
+DuplicateDialog::DuplicateDialog(PlaylistManager* manager, int currentPlaylistIndex, QWidget* parent)
+    : QDialog(parent)
+    , m_playlistManager(manager)
+    , m_currentPlaylistIndex(currentPlaylistIndex)
+    , m_hasRemovedSongs(false)
+{
+    setWindowTitle("查找重复歌曲");
+    setMinimumSize(600, 450);
+
+    m_finder = new DuplicateFinder(this);
+    connect(m_finder, &DuplicateFinder::progressChanged, this, &DuplicateDialog::onProgressChanged);
+    connect(m_finder, &DuplicateFinder::finished, this, &DuplicateDialog::onFinished);
+    connect(m_finder, &DuplicateFinder::cancelled, this, &DuplicateDialog::onCancelled);
+
+    setupUI();
+}
+
+DuplicateDialog::~DuplicateDialog()
+{
+    // m_finder 的析构函数会等待后台线程退出
+    m_finder->cancel();
+}
+
+void DuplicateDialog::setupUI()
+{
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setSpacing(12);
+
+    // 查找范围
+    QHBoxLayout* scopeLayout = new QHBoxLayout();
+    scopeLayout->addWidget(new QLabel("查找范围:"));
+    m_scopeCombo = new QComboBox();
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (playlist) {
+        m_scopeCombo->addItem(QString("当前播放列表 (%1)").arg(playlist->getName()));
+    }
+    m_scopeCombo->addItem("整个歌曲库");
+    scopeLayout->addWidget(m_scopeCombo);
+    scopeLayout->addStretch();
+
+    m_startBtn = new QPushButton("开始查找");
+    m_startBtn->setDefault(true);
+    connect(m_startBtn, &QPushButton::clicked, this, &DuplicateDialog::onStartClicked);
+    scopeLayout->addWidget(m_startBtn);
+
+    m_cancelBtn = new QPushButton("停止");
+    m_cancelBtn->setEnabled(false);
+    connect(m_cancelBtn, &QPushButton::clicked, this, &DuplicateDialog::onCancelClicked);
+    scopeLayout->addWidget(m_cancelBtn);
+    mainLayout->addLayout(scopeLayout);
+
+    // 进度
+    m_statusLabel = new QLabel("内容相同的歌曲会被分为一组，每组默认保留第一首");
+    mainLayout->addWidget(m_statusLabel);
+
+    m_progressBar = new QProgressBar();
+    m_progressBar->setRange(0, 100);
+    m_progressBar->setValue(0);
+    mainLayout->addWidget(m_progressBar);
+
+    // 结果
+    m_resultTree = new QTreeWidget();
+    m_resultTree->setColumnCount(2);
+    m_resultTree->setHeaderLabels({"歌曲", "路径"});
+    m_resultTree->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    mainLayout->addWidget(m_resultTree);
+
+    // 按钮
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    m_removeBtn = new QPushButton("从播放列表中移除勾选的歌曲");
+    m_removeBtn->setEnabled(false);
+    connect(m_removeBtn, &QPushButton::clicked, this, &DuplicateDialog::onRemoveCheckedClicked);
+    buttonLayout->addWidget(m_removeBtn);
+    buttonLayout->addStretch();
+
+    m_closeBtn = new QPushButton("关闭");
+    connect(m_closeBtn, &QPushButton::clicked, this, &DuplicateDialog::accept);
+    buttonLayout->addWidget(m_closeBtn);
+    mainLayout->addLayout(buttonLayout);
+}
+
+bool DuplicateDialog::isLibraryScope() const
+{
+    // 没有当前列表时只有 "整个歌曲库" 一项
+    return m_scopeCombo->currentIndex() == m_scopeCombo->count() - 1;
+}
+
+void DuplicateDialog::setSearching(bool searching)
+{
+    m_scopeCombo->setEnabled(!searching);
+    m_startBtn->setEnabled(!searching);
+    m_cancelBtn->setEnabled(searching);
+    m_removeBtn->setEnabled(!searching && m_resultTree->topLevelItemCount() > 0);
+}
+
+void DuplicateDialog::onStartClicked()
+{
+    if (m_finder->isBusy()) {
+        return;
+    }
+
+    // 收集要比较的歌曲，同一首歌只算一次（在多个列表中，或在同一列表中出现多次）
+    QVector<int> songIds;
+    QSet<int> seen;
+    m_repeatedPositions.clear();
+    if (isLibraryScope()) {
+        for (Playlist* playlist : m_playlistManager->getPlaylists()) {
+            for (int id : playlist->getSongIds()) {
+                if (!seen.contains(id)) {
+                    seen.insert(id);
+                    songIds.append(id);
+                }
+            }
+        }
+    } else if (Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex)) {
+        const QVector<int>& playlistIds = playlist->getSongIds();
+        QHash<int, QVector<int>> positions;
+        for (int pos = 0; pos < playlistIds.size(); ++pos) {
+            int id = playlistIds[pos];
+            positions[id].append(pos);
+            if (!seen.contains(id)) {
+                seen.insert(id);
+                songIds.append(id);
+            }
+        }
+        // 重复出现的条目单独成组，不交给查找线程
+        for (auto it = positions.constBegin(); it != positions.constEnd(); ++it) {
+            if (it.value().size() > 1) {
+                m_repeatedPositions.insert(it.key(), it.value());
+            }
+        }
+    }
+
+    const SongLibrary* library = m_playlistManager->library();
+    QVector<DuplicateFinder::Entry> entries;
+    entries.reserve(songIds.size());
+    for (int id : songIds) {
+        // CUE 音轨共用同一个文件，按文件内容比较没有意义
+        if (library->isMissing(id) || library->isVirtualTrack(id)) continue;
+        entries.append({id, library->filePath(id), library->duration(id)});
+    }
+
+    m_resultTree->clear();
+    m_progressBar->setValue(0);
+    m_statusLabel->setText(QString("共 %1 首歌曲").arg(entries.size()));
+    setSearching(true);
+    m_finder->start(entries);
+}
+
+void DuplicateDialog::onCancelClicked()
+{
+    m_finder->cancel();
+    m_cancelBtn->setEnabled(false);
+}
+
+void DuplicateDialog::onProgressChanged(int done, int total, const QString& stage)
+{
+    m_statusLabel->setText(QString("%1... %2/%3").arg(stage).arg(done).arg(total));
+    m_progressBar->setValue(total > 0 ? done * 100 / total : 100);
+}
+
+void DuplicateDialog::onFinished(const QVector<QVector<int>>& groups)
+{
+    const SongLibrary* library = m_playlistManager->library();
+    int duplicateCount = 0;
+    int groupNumber = 0;
+
+    // 同一首歌在当前列表中出现多次：保留第一次出现的位置
+    QList<int> repeatedIds = m_repeatedPositions.keys();
+    std::sort(repeatedIds.begin(), repeatedIds.end(), [this](int a, int b) {
+        return m_repeatedPositions.value(a).first() < m_repeatedPositions.value(b).first();
+    });
+    for (int id : repeatedIds) {
+        const QVector<int>& positions = m_repeatedPositions.value(id);
+        QTreeWidgetItem* groupItem = new QTreeWidgetItem(m_resultTree);
+        groupItem->setText(0, QString("第 %1 组（同一首歌出现 %2 次）").arg(++groupNumber).arg(positions.size()));
+        groupItem->setFirstColumnSpanned(true);
+
+        for (int i = 0; i < positions.size(); ++i) {
+            QTreeWidgetItem* songItem = new QTreeWidgetItem(groupItem);
+            songItem->setText(0, QString("#%1  %2 - %3").arg(positions[i] + 1)
+                                     .arg(library->artist(id), library->title(id)));
+            songItem->setText(1, library->filePath(id));
+            songItem->setToolTip(1, library->filePath(id));
+            songItem->setData(0, Qt::UserRole, id);
+            songItem->setData(0, PositionRole, positions[i]);
+            songItem->setCheckState(0, i == 0 ? Qt::Unchecked : Qt::Checked);
+        }
+        duplicateCount += positions.size() - 1;
+    }
+
+    for (int g = 0; g < groups.size(); ++g) {
+        const QVector<int>& group = groups[g];
+        QTreeWidgetItem* groupItem = new QTreeWidgetItem(m_resultTree);
+        groupItem->setText(0, QString("第 %1 组（%2 首）").arg(++groupNumber).arg(group.size()));
+        groupItem->setFirstColumnSpanned(true);
+
+        for (int i = 0; i < group.size(); ++i) {
+            int id = group[i];
+            QTreeWidgetItem* songItem = new QTreeWidgetItem(groupItem);
+            songItem->setText(0, library->artist(id) + " - " + library->title(id));
+            songItem->setText(1, library->filePath(id));
+            songItem->setToolTip(1, library->filePath(id));
+            songItem->setData(0, Qt::UserRole, id);
+            // 每组保留第一首，其余默认勾选为待移除
+            songItem->setCheckState(0, i == 0 ? Qt::Unchecked : Qt::Checked);
+        }
+        duplicateCount += group.size() - 1;
+    }
+    m_resultTree->expandAll();
+
+    m_progressBar->setValue(100);
+    if (groupNumber == 0) {
+        m_statusLabel->setText("没有找到重复的歌曲");
+    } else {
+        m_statusLabel->setText(QString("找到 %1 组重复歌曲，共 %2 首多余的副本")
+                                   .arg(groupNumber).arg(duplicateCount));
+    }
+    setSearching(false);
+}
+
+void DuplicateDialog::onCancelled()
+{
+    m_statusLabel->setText("查找已停止");
+    setSearching(false);
+}
+
+void DuplicateDialog::onRemoveCheckedClicked()
+{
+    // 内容重复的不同文件按 ID 移除；同一首歌重复出现的条目按位置移除
+    QSet<int> toRemove;
+    QSet<int> positionsToRemove;
+    for (int g = 0; g < m_resultTree->topLevelItemCount(); ++g) {
+        QTreeWidgetItem* groupItem = m_resultTree->topLevelItem(g);
+        for (int i = 0; i < groupItem->childCount(); ++i) {
+            QTreeWidgetItem* songItem = groupItem->child(i);
+            if (songItem->checkState(0) != Qt::Checked) continue;
+            QVariant position = songItem->data(0, PositionRole);
+            if (position.isValid()) {
+                positionsToRemove.insert(position.toInt());
+            } else {
+                toRemove.insert(songItem->data(0, Qt::UserRole).toInt());
+            }
+        }
+    }
+    if (toRemove.isEmpty() && positionsToRemove.isEmpty()) {
+        return;
+    }
+
+    QString scopeText = isLibraryScope() ? "所有播放列表" : "当前播放列表";
+    auto reply = QMessageBox::question(this, "移除重复歌曲",
+        QString("确定要从%1中移除勾选的 %2 首歌曲吗？\n（磁盘上的文件不会被删除）")
+            .arg(scopeText).arg(toRemove.size() + positionsToRemove.size()),
+        QMessageBox::Yes | QMessageBox::No);
+    if (reply != QMessageBox::Yes) {
+        return;
+    }
+
+    // 每个列表只过滤一遍，不逐首删除
+    QList<Playlist*> playlists;
+    if (isLibraryScope()) {
+        playlists = m_playlistManager->getPlaylists();
+    } else if (Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex)) {
+        playlists.append(playlist);
+    }
+
+    // 位置只对当前列表有效，移除后剩下的条目位置会前移
+    Playlist* currentPlaylist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    QVector<int> newPositions;
+    int removedCount = 0;
+    for (Playlist* playlist : playlists) {
+        const QVector<int>& songIds = playlist->getSongIds();
+        const bool byPosition = (playlist == currentPlaylist);
+        QVector<int> kept;
+        kept.reserve(songIds.size());
+        if (byPosition) newPositions.fill(-1, songIds.size());
+        for (int pos = 0; pos < songIds.size(); ++pos) {
+            int id = songIds[pos];
+            if (toRemove.contains(id) || (byPosition && positionsToRemove.contains(pos))) continue;
+            if (byPosition) newPositions[pos] = kept.size();
+            kept.append(id);
+        }
+        if (kept.size() != songIds.size()) {
+            removedCount += songIds.size() - kept.size();
+            playlist->setSongIds(kept);
+            m_hasRemovedSongs = true;
+        }
+    }
+
+    // 从结果中去掉已移除的歌曲，只剩一首的组也一并去掉；剩下的条目更新位置
+    for (int g = m_resultTree->topLevelItemCount() - 1; g >= 0; --g) {
+        QTreeWidgetItem* groupItem = m_resultTree->topLevelItem(g);
+        for (int i = groupItem->childCount() - 1; i >= 0; --i) {
+            QTreeWidgetItem* songItem = groupItem->child(i);
+            QVariant position = songItem->data(0, PositionRole);
+            int newPosition = -1;
+            if (position.isValid() && position.toInt() < newPositions.size()) {
+                newPosition = newPositions[position.toInt()];
+            }
+            if (songItem->checkState(0) == Qt::Checked || (position.isValid() && newPosition < 0)) {
+                delete groupItem->takeChild(i);
+            } else if (position.isValid()) {
+                songItem->setData(0, PositionRole, newPosition);
+            }
+        }
+        if (groupItem->childCount() < 2) {
+            delete m_resultTree->takeTopLevelItem(g);
+        }
+    }
+    m_repeatedPositions.clear();
+
+    m_statusLabel->setText(QString("已移除 %1 首歌曲").arg(removedCount));
+    m_removeBtn->setEnabled(m_resultTree->topLevelItemCount() > 0);
+}
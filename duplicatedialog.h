@@ -0,0 +1,60 @@
+#ifndef DUPLICATEDIALOG_H
+#define DUPLICATEDIALOG_H
+
+#include <QDialog>
+#include <QHash>
+#include <QVector>
+
+class PlaylistManager;
+class DuplicateFinder;
+class QComboBox;
+class QProgressBar;
+class QLabel;
+class QPushButton;
+class QTreeWidget;
+
+// 查找重复歌曲对话框
+// 可以只查当前播放列表，也可以查整个歌曲库（所有播放列表中的歌曲）
+class DuplicateDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DuplicateDialog(PlaylistManager* manager, int currentPlaylistIndex, QWidget* parent = nullptr);
+    ~DuplicateDialog();
+
+    // 是否从播放列表中移除过歌曲（调用者据此保存并刷新界面）
+    bool hasRemovedSongs() const { return m_hasRemovedSongs; }
+
+private slots:
+    void onStartClicked();
+    void onCancelClicked();
+    void onProgressChanged(int done, int total, const QString& stage);
+    void onFinished(const QVector<QVector<int>>& groups);
+    void onCancelled();
+    void onRemoveCheckedClicked();
+
+private:
+    void setupUI();
+    void setSearching(bool searching);
+    bool isLibraryScope() const;
+
+    PlaylistManager* m_playlistManager;
+    int m_currentPlaylistIndex;
+    DuplicateFinder* m_finder;
+    bool m_hasRemovedSongs;
+    // 当前列表中重复出现的同一首歌：歌曲 ID -> 所在位置，按位置移除，不会连同保留的那一份一起删掉
+    QHash<int, QVector<int>> m_repeatedPositions;
+
+    // UI 组件
+    QComboBox* m_scopeCombo;
+    QPushButton* m_startBtn;
+    QPushButton* m_cancelBtn;
+    QLabel* m_statusLabel;
+    QProgressBar* m_progressBar;
+    QTreeWidget* m_resultTree;
+    QPushButton* m_removeBtn;
+    QPushButton* m_closeBtn;
+};
+
+#endif // DUPLICATEDIALOG_H
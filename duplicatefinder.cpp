@@ -0,0 +1,252 @@
+#include "duplicatefinder.h"
+#include "tracerecorder.h"
+#include <QThread>
+#include <QFile>
+#include <QHash>
+#include <QCryptographicHash>
+#include <QtEndian>
+#include <cstring>
+
+// TagLib 头文件
+#include <taglib/fileref.h>
+#include <taglib/audioproperties.h>
+
+namespace {
+
+// 部分内容哈希时每段读取的字节数
+const qint64 kSampleSize = 64 * 1024;
+
+// 文件中真正的音频数据所在的区间 [start, end)
+struct AudioRange {
+    qint64 start = 0;
+    qint64 end = 0;
+    qint64 size() const { return end - start; }
+};
+
+quint32 syncSafeToInt(const char* data) {
+    return (quint32(quint8(data[0]) & 0x7f) << 21) |
+           (quint32(quint8(data[1]) & 0x7f) << 14) |
+           (quint32(quint8(data[2]) & 0x7f) << 7)  |
+           (quint32(quint8(data[3]) & 0x7f));
+}
+
+// 跳过文件头尾的标签块，只保留音频数据
+// 只读取几十个字节的头尾信息，不解析标签内容
+AudioRange findAudioRange(QFile& file) {
+    AudioRange range;
+    range.end = file.size();
+
+    // 文件开头的 ID3v2 标签（可能连续有多个）
+    char header[10];
+    while (file.seek(range.start) && file.read(header, 10) == 10 &&
+           header[0] == 'I' && header[1] == 'D' && header[2] == '3') {
+        qint64 tagSize = 10 + syncSafeToInt(header + 6);
+        if (quint8(header[5]) & 0x10) tagSize += 10;  // 带页脚
+        range.start += tagSize;
+    }
+
+    // FLAC：跳过所有元数据块（其中包含 Vorbis 注释和封面）
+    char marker[4];
+    if (file.seek(range.start) && file.read(marker, 4) == 4 && memcmp(marker, "fLaC", 4) == 0) {
+        qint64 pos = range.start + 4;
+        char blockHeader[4];
+        while (file.seek(pos) && file.read(blockHeader, 4) == 4) {
+            bool isLast = quint8(blockHeader[0]) & 0x80;
+            qint64 length = (qint64(quint8(blockHeader[1])) << 16) |
+                            (qint64(quint8(blockHeader[2])) << 8) |
+                            qint64(quint8(blockHeader[3]));
+            pos += 4 + length;
+            if (isLast) break;
+        }
+        range.start = pos;
+    }
+
+    // 文件末尾的 ID3v1 标签
+    char tail[128];
+    if (range.end - range.start >= 128 && file.seek(range.end - 128) && file.read(tail, 128) == 128 &&
+        tail[0] == 'T' && tail[1] == 'A' && tail[2] == 'G') {
+        range.end -= 128;
+    }
+
+    // 文件末尾的 APEv2 标签
+    char apeFooter[32];
+    if (range.end - range.start >= 32 && file.seek(range.end - 32) && file.read(apeFooter, 32) == 32 &&
+        memcmp(apeFooter, "APETAGEX", 8) == 0) {
+        qint64 tagSize = qFromLittleEndian<quint32>(apeFooter + 12);
+        quint32 flags = qFromLittleEndian<quint32>(apeFooter + 20);
+        if (flags & 0x80000000u) tagSize += 32;  // 带头部
+        range.end -= tagSize;
+    }
+
+    // 解析出的区间不合理时（文件损坏或格式不认识），退回整个文件
+    if (range.start < 0 || range.start >= range.end || range.end > file.size()) {
+        range.start = 0;
+        range.end = file.size();
+    }
+    return range;
+}
+
+// 对音频数据的开头、中间、结尾各取一段做哈希；数据较小时直接哈希全部
+QByteArray hashAudioRange(QFile& file, const AudioRange& range) {
+    QCryptographicHash hash(QCryptographicHash::Md5);
+
+    auto addSample = [&](qint64 offset, qint64 length) {
+        if (!file.seek(offset)) return;
+        hash.addData(file.read(length));
+    };
+
+    if (range.size() <= 3 * kSampleSize) {
+        addSample(range.start, range.size());
+    } else {
+        addSample(range.start, kSampleSize);
+        addSample(range.start + (range.size() - kSampleSize) / 2, kSampleSize);
+        addSample(range.end - kSampleSize, kSampleSize);
+    }
+    return hash.result();
+}
+
+} // namespace
+
+DuplicateFinder::DuplicateFinder(QObject* parent)
+    : QObject(parent)
+    , m_thread(nullptr)
+    , m_cancelled(false)
+{
+    m_pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+DuplicateFinder::~DuplicateFinder()
+{
+    m_cancelled = true;
+    if (m_thread) {
+        m_thread->disconnect(this);
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void DuplicateFinder::start(const QVector<Entry>& entries)
+{
+    if (m_thread) return;
+
+    m_cancelled = false;
+    m_thread = QThread::create([this, entries]() { run(entries); });
+    m_thread->setObjectName("DuplicateFinder");   // 调试器和性能跟踪中显示的线程名
+    connect(m_thread, &QThread::finished, this, [this]() {
+        m_thread->deleteLater();
+        m_thread = nullptr;
+    });
+    m_thread->start(QThread::LowPriority);
+}
+
+void DuplicateFinder::cancel()
+{
+    m_cancelled = true;
+}
+
+void DuplicateFinder::reportProgress(int done, int total, const QString& stage)
+{
+    QMetaObject::invokeMethod(this, [this, done, total, stage]() {
+        emit progressChanged(done, total, stage);
+    }, Qt::QueuedConnection);
+}
+
+bool DuplicateFinder::runParallel(int count, const QString& stage, const std::function<void(int)>& job)
+{
+    std::atomic_int next(0);
+    std::atomic_int done(0);
+
+    // 每个线程循环领取下一个下标，直到全部完成或被取消
+    for (int i = 0; i < m_pool.maxThreadCount(); ++i) {
+        m_pool.start([&]() {
+            while (!m_cancelled) {
+                int index = next++;
+                if (index >= count) break;
+                job(index);
+                done++;
+            }
+        });
+    }
+
+    while (!m_pool.waitForDone(100)) {
+        reportProgress(done, count, stage);
+    }
+    reportProgress(done, count, stage);
+    return !m_cancelled;
+}
+
+void DuplicateFinder::run(const QVector<Entry>& entries)
+{
+    TraceRecorder::Span span("findDuplicates", "scan");
+    const int count = entries.size();
+
+    // 第一阶段：计算每个文件的音频数据区间和时长
+    // 各线程只写自己领取的下标，直接通过裸指针写入，避免并发调用 QVector 的非 const 接口
+    QVector<AudioRange> ranges(count);
+    QVector<qint64> durations(count);
+    AudioRange* rangeData = ranges.data();
+    qint64* durationData = durations.data();
+    bool ok = runParallel(count, "正在分析文件", [&](int i) {
+        QFile file(entries[i].filePath);
+        if (!file.open(QIODevice::ReadOnly)) return;
+        rangeData[i] = findAudioRange(file);
+
+        durationData[i] = entries[i].duration;
+        if (durationData[i] <= 0) {
+            TagLib::FileRef ref(entries[i].filePath.toStdWString().c_str(), true,
+                                TagLib::AudioProperties::Fast);
+            if (!ref.isNull() && ref.audioProperties()) {
+                durationData[i] = ref.audioProperties()->lengthInMilliseconds();
+            }
+        }
+    });
+    if (!ok) {
+        QMetaObject::invokeMethod(this, [this]() { emit cancelled(); }, Qt::QueuedConnection);
+        return;
+    }
+
+    // 按 "音频数据大小 + 时长（秒）" 分组，只保留有两个以上成员的组
+    QHash<QPair<qint64, qint64>, QVector<int>> sizeGroups;
+    for (int i = 0; i < count; ++i) {
+        if (ranges[i].size() <= 0) continue;   // 打不开的文件
+        sizeGroups[qMakePair(ranges[i].size(), durations[i] / 1000)].append(i);
+    }
+
+    QVector<int> candidates;
+    for (auto it = sizeGroups.cbegin(); it != sizeGroups.cend(); ++it) {
+        if (it.value().size() > 1) candidates.append(it.value());
+    }
+
+    // 第二阶段：只对候选文件做部分内容哈希
+    QVector<QByteArray> hashes(candidates.size());
+    QByteArray* hashData = hashes.data();
+    ok = runParallel(candidates.size(), "正在比对内容", [&](int c) {
+        int i = candidates.at(c);
+        QFile file(entries[i].filePath);
+        if (!file.open(QIODevice::ReadOnly)) return;
+        hashData[c] = hashAudioRange(file, ranges.at(i));
+    });
+    if (!ok) {
+        QMetaObject::invokeMethod(this, [this]() { emit cancelled(); }, Qt::QueuedConnection);
+        return;
+    }
+
+    // 大小、时长、哈希都相同的才算重复
+    QHash<QByteArray, QVector<int>> hashGroups;
+    for (int c = 0; c < candidates.size(); ++c) {
+        if (hashes[c].isEmpty()) continue;
+        int i = candidates[c];
+        QByteArray key = hashes[c];
+        key.append(QByteArray::number(ranges[i].size())).append(':').append(QByteArray::number(durations[i] / 1000));
+        hashGroups[key].append(entries[i].songId);
+    }
+
+    QVector<QVector<int>> groups;
+    for (auto it = hashGroups.cbegin(); it != hashGroups.cend(); ++it) {
+        if (it.value().size() > 1) groups.append(it.value());
+    }
+
+    QMetaObject::invokeMethod(this, [this, groups]() {
+        emit finished(groups);
+    }, Qt::QueuedConnection);
+}
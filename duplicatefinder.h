@@ -0,0 +1,53 @@
+#ifndef DUPLICATEFINDER_H
+#define DUPLICATEFINDER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+
+class QThread;
+
+// 重复歌曲查找
+// 1. 先按 "音频数据大小 + 时长" 分组，只有落在同一组的文件才可能重复；
+//    音频数据大小不含 ID3v2 / ID3v1 / APE 标签和 FLAC 元数据块，所以重新编辑过标签的副本也能匹配
+// 2. 再对候选文件的音频数据做部分内容哈希（开头、中间、结尾各取一段）确认
+// 两个阶段都在线程池中并行执行，支持进度报告和随时取消
+class DuplicateFinder : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry {
+        int songId;
+        QString filePath;
+        qint64 duration;    // 毫秒，0 表示未知，会在后台读取
+    };
+
+    explicit DuplicateFinder(QObject* parent = nullptr);
+    ~DuplicateFinder();
+
+    bool isBusy() const { return m_thread != nullptr; }
+    void start(const QVector<Entry>& entries);
+    void cancel();
+
+signals:
+    void progressChanged(int done, int total, const QString& stage);
+    // 每组为内容相同的歌曲 ID（至少两首）
+    void finished(const QVector<QVector<int>>& groups);
+    void cancelled();
+
+private:
+    void run(const QVector<Entry>& entries);    // 运行在工作线程中
+    // 在线程池中对 [0, count) 并行执行 job，期间定期报告进度
+    bool runParallel(int count, const QString& stage, const std::function<void(int)>& job);
+    void reportProgress(int done, int total, const QString& stage);
+
+    QThread* m_thread;
+    QThreadPool m_pool;
+    std::atomic_bool m_cancelled;
+};
+
+#endif // DUPLICATEFINDER_H
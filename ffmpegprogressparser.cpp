@@ -0,0 +1,95 @@
+#include "ffmpegprogressparser.h"
+#include <QList>
+
+FFmpegProgressParser::FFmpegProgressParser()
+    : m_duration(0)
+    , m_outTimeUs(0)
+    , m_speed(0)
+    , m_bitrate(0)
+    , m_end(false)
+{
+}
+
+bool FFmpegProgressParser::feed(const QByteArray& data)
+{
+    m_buffer.append(data);
+
+    // FFmpeg 的日志行可能以 \r 结尾（状态行），进度信息以 \n 结尾，两者都当作行结束
+    bool blockFinished = false;
+    int start = 0;
+    for (int i = 0; i < m_buffer.size(); ++i) {
+        char c = m_buffer.at(i);
+        if (c != '\n' && c != '\r') continue;
+        if (i > start && parseLine(m_buffer.mid(start, i - start))) {
+            blockFinished = true;
+        }
+        start = i + 1;
+    }
+    m_buffer.remove(0, start);
+    return blockFinished;
+}
+
+int FFmpegProgressParser::percent() const
+{
+    if (m_end) return 100;
+    if (m_duration <= 0) return -1;
+    qint64 progress = (m_outTimeUs / 1000) * 100 / m_duration;
+    return static_cast<int>(qBound<qint64>(0, progress, 100));
+}
+
+bool FFmpegProgressParser::parseLine(const QByteArray& line)
+{
+    int equals = line.indexOf('=');
+    if (equals <= 0) {
+        // 不是进度信息，只关心日志中的 "Duration: 00:03:45.67, start: ..." 行
+        if (m_duration == 0) {
+            QByteArray trimmed = line.trimmed();
+            if (trimmed.startsWith("Duration:")) {
+                m_duration = parseDuration(trimmed.mid(9).trimmed());
+            }
+        }
+        return false;
+    }
+
+    QByteArray key = line.left(equals).trimmed();
+    QByteArray value = line.mid(equals + 1).trimmed();
+
+    // out_time_ms 名不副实，和 out_time_us 一样是微秒
+    if (key == "out_time_us" || key == "out_time_ms") {
+        bool ok = false;
+        qint64 us = value.toLongLong(&ok);
+        if (ok && us >= 0) m_outTimeUs = us;
+    } else if (key == "speed") {
+        // 例如 "12.3x"，开始时可能是 "N/A"
+        if (value.endsWith('x')) value.chop(1);
+        bool ok = false;
+        double speed = value.toDouble(&ok);
+        if (ok) m_speed = speed;
+    } else if (key == "bitrate") {
+        // 例如 "320.0kbits/s"
+        if (value.endsWith("kbits/s")) value.chop(7);
+        bool ok = false;
+        double bitrate = value.toDouble(&ok);
+        if (ok) m_bitrate = bitrate;
+    } else if (key == "progress") {
+        m_end = (value == "end");
+        return true;
+    }
+    return false;
+}
+
+// 解析 "hh:mm:ss.xx"，格式不对时返回 0
+qint64 FFmpegProgressParser::parseDuration(const QByteArray& text)
+{
+    int comma = text.indexOf(',');
+    QList<QByteArray> parts = (comma >= 0 ? text.left(comma) : text).split(':');
+    if (parts.size() != 3) return 0;
+
+    bool okHours = false, okMins = false, okSecs = false;
+    qint64 hours = parts[0].toLongLong(&okHours);
+    qint64 mins = parts[1].toLongLong(&okMins);
+    double secs = parts[2].toDouble(&okSecs);
+    if (!okHours || !okMins || !okSecs) return 0;
+
+    return (hours * 3600 + mins * 60) * 1000 + static_cast<qint64>(secs * 1000);
+}
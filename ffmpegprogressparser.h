@@ -0,0 +1,38 @@
+#ifndef FFMPEGPROGRESSPARSER_H
+#define FFMPEGPROGRESSPARSER_H
+
+#include <QByteArray>
+
+// 解析 FFmpeg "-progress pipe:2" 输出的 key=value 进度信息
+// 输入按行缓存，一行被拆成两次读取也能正确处理；不使用正则表达式
+// 每收到一个完整的进度块（以 progress=continue / progress=end 结尾）更新一次结果
+class FFmpegProgressParser
+{
+public:
+    FFmpegProgressParser();
+
+    // 预先知道的总时长（毫秒），为 0 时从 FFmpeg 日志中的 "Duration:" 行解析
+    void setDuration(qint64 durationMs) { m_duration = durationMs; }
+    qint64 duration() const { return m_duration; }
+
+    // 追加新读到的数据，返回是否解析到了至少一个完整的进度块
+    bool feed(const QByteArray& data);
+
+    int percent() const;                          // 0-100，时长未知时为 -1
+    double speed() const { return m_speed; }      // 相对实时的倍数，未知时为 0
+    double bitrate() const { return m_bitrate; }  // kbps，未知时为 0
+    bool isEnd() const { return m_end; }
+
+private:
+    bool parseLine(const QByteArray& line);
+    static qint64 parseDuration(const QByteArray& text);
+
+    QByteArray m_buffer;    // 尚未遇到换行符的不完整行
+    qint64 m_duration;
+    qint64 m_outTimeUs;
+    double m_speed;
+    double m_bitrate;
+    bool m_end;
+};
+
+#endif // FFMPEGPROGRESSPARSER_H
@@ -0,0 +1,209 @@
+#include "folderwatcher.h"
+#include "tracerecorder.h"
+#include <QFileSystemWatcher>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QThread>
+#include <QTimer>
+#include <QDir>
+
+namespace {
+
+// 最后一次事件后等待的安静时间
+const int kDebounceMsecs = 1500;
+// 持续有事件（例如正在复制大量文件）时，最长多久也要扫描一次
+const int kMaxDelayMsecs = 10000;
+// 定期修改时间扫描的间隔
+const int kPeriodicScanMsecs = 10 * 60 * 1000;
+
+// CUE 文件也要列出，同步时展开为虚拟音轨
+const QStringList kAudioFilters = {"*.mp3", "*.flac", "*.wav", "*.ogg", "*.m4a", "*.cue"};
+
+bool isUnder(const QString& path, const QString& root) {
+    return path == root || path.startsWith(root + '/');
+}
+
+} // namespace
+
+FolderWatcher::FolderWatcher(QObject* parent)
+    : QObject(parent)
+    , m_thread(nullptr)
+    , m_cancelled(false)
+{
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &FolderWatcher::onDirectoryChanged);
+
+    m_debounceTimer = new QTimer(this);
+    m_debounceTimer->setSingleShot(true);
+    m_debounceTimer->setInterval(kDebounceMsecs);
+    connect(m_debounceTimer, &QTimer::timeout, this, &FolderWatcher::startScan);
+
+    m_periodicTimer = new QTimer(this);
+    m_periodicTimer->setInterval(kPeriodicScanMsecs);
+    connect(m_periodicTimer, &QTimer::timeout, this, &FolderWatcher::rescanAll);
+    m_periodicTimer->start();
+}
+
+FolderWatcher::~FolderWatcher()
+{
+    m_cancelled = true;
+    if (m_thread) {
+        m_thread->disconnect(this);
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void FolderWatcher::setFolders(const QStringList& folders)
+{
+    QStringList cleaned;
+    for (const QString& folder : folders) {
+        QString path = QDir::cleanPath(QDir::fromNativeSeparators(folder));
+        if (!path.isEmpty() && !cleaned.contains(path)) {
+            cleaned.append(path);
+        }
+    }
+
+    // 不再需要的根目录：移除其下所有目录的监听
+    const QStringList watchedDirs = m_watcher->directories();
+    for (const QString& oldRoot : m_folders) {
+        if (cleaned.contains(oldRoot)) continue;
+        QStringList toRemove;
+        for (const QString& dir : watchedDirs) {
+            if (isUnder(dir, oldRoot)) toRemove.append(dir);
+        }
+        if (!toRemove.isEmpty()) m_watcher->removePaths(toRemove);
+        m_dirtyFolders.remove(oldRoot);
+    }
+
+    // 新加入的根目录：先监听根目录本身，子目录在扫描后补上
+    QStringList added;
+    for (const QString& root : cleaned) {
+        if (!m_folders.contains(root)) added.append(root);
+    }
+    m_folders = cleaned;
+
+    for (const QString& root : added) {
+        if (QFileInfo(root).isDir()) {
+            m_watcher->addPath(root);
+        }
+        m_dirtyFolders.insert(root);
+    }
+    if (!added.isEmpty()) {
+        startScan();
+    }
+}
+
+void FolderWatcher::rescanAll()
+{
+    for (const QString& root : m_folders) {
+        m_dirtyFolders.insert(root);
+    }
+    startScan();
+}
+
+void FolderWatcher::onDirectoryChanged(const QString& path)
+{
+    QString changed = QDir::cleanPath(path);
+    for (const QString& root : m_folders) {
+        if (isUnder(changed, root)) {
+            markDirty(root);
+        }
+    }
+}
+
+void FolderWatcher::markDirty(const QString& folder)
+{
+    if (m_dirtyFolders.isEmpty()) {
+        m_dirtySince.start();
+    }
+    m_dirtyFolders.insert(folder);
+
+    // 事件持续不断时也不能无限推迟
+    if (m_dirtySince.isValid() && m_dirtySince.elapsed() >= kMaxDelayMsecs) {
+        startScan();
+    } else {
+        m_debounceTimer->start();
+    }
+}
+
+void FolderWatcher::startScan()
+{
+    // 正在扫描时，新的变化留到本次扫描结束后再处理
+    if (m_thread || m_dirtyFolders.isEmpty()) {
+        return;
+    }
+
+    m_debounceTimer->stop();
+    m_dirtySince.invalidate();
+
+    QStringList roots(m_dirtyFolders.begin(), m_dirtyFolders.end());
+    m_dirtyFolders.clear();
+
+    m_thread = QThread::create([this, roots]() { scanFolders(roots); });
+    m_thread->setObjectName("FolderScan");   // 调试器和性能跟踪中显示的线程名
+    connect(m_thread, &QThread::finished, this, [this]() {
+        m_thread->deleteLater();
+        m_thread = nullptr;
+        if (!m_dirtyFolders.isEmpty()) {
+            m_debounceTimer->start();
+        }
+    });
+    m_thread->start(QThread::LowPriority);
+}
+
+// 运行在工作线程中：列出每个根目录下的所有子目录和音频文件
+void FolderWatcher::scanFolders(const QStringList& roots)
+{
+    TraceRecorder::Span span("scanWatchedFolders", "scan");
+    for (const QString& root : roots) {
+        if (m_cancelled) return;
+        if (!QFileInfo(root).isDir()) continue;   // 整个文件夹不可用（例如移动硬盘未连接）时不做任何删除
+
+        QVector<WatchedFile> files;
+        QStringList dirs;
+        dirs.append(root);
+
+        // AllDirs 表示名称过滤器只作用于文件，目录全部列出
+        QDirIterator it(root, kAudioFilters,
+                        QDir::Files | QDir::AllDirs | QDir::NoDotAndDotDot,
+                        QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            if (m_cancelled) return;
+            it.next();
+            QFileInfo fileInfo = it.fileInfo();
+            if (fileInfo.isDir()) {
+                dirs.append(it.filePath());
+            } else {
+                files.append({it.filePath(), fileInfo.lastModified().toMSecsSinceEpoch()});
+            }
+        }
+
+        QMetaObject::invokeMethod(this, [this, root, files, dirs]() {
+            onScanResult(root, files, dirs);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void FolderWatcher::onScanResult(const QString& root, const QVector<WatchedFile>& files, const QStringList& dirs)
+{
+    // 扫描期间该目录可能已被取消监视
+    if (!m_folders.contains(root)) {
+        return;
+    }
+
+    // 补上新出现的子目录的监听（已删除的子目录会被自动移除）
+    const QStringList watched = m_watcher->directories();
+    QSet<QString> watchedSet(watched.begin(), watched.end());
+    QStringList toAdd;
+    for (const QString& dir : dirs) {
+        if (!watchedSet.contains(dir)) toAdd.append(dir);
+    }
+    if (!toAdd.isEmpty()) {
+        m_watcher->addPaths(toAdd);
+    }
+
+    emit folderScanned(root, files);
+}
@@ -0,0 +1,65 @@
+#ifndef FOLDERWATCHER_H
+#define FOLDERWATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QSet>
+#include <QElapsedTimer>
+#include <atomic>
+
+class QFileSystemWatcher;
+class QThread;
+class QTimer;
+
+// 监视文件夹中的一个音频文件
+struct WatchedFile {
+    QString filePath;
+    qint64 modified;    // 最后修改时间（毫秒时间戳）
+};
+
+// 监视文件夹：用 QFileSystemWatcher（Linux 上即 inotify）监听所有子目录，
+// 再加上定期的修改时间扫描兜底。短时间内的大量文件系统事件会被合并，
+// 例如往文件夹里复制一万个文件，只会触发一次后台扫描和一次结果通知
+class FolderWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FolderWatcher(QObject* parent = nullptr);
+    ~FolderWatcher();
+
+    // 设置需要监视的根目录，新加入的目录会立即扫描一次
+    void setFolders(const QStringList& folders);
+    QStringList folders() const { return m_folders; }
+
+    // 立即重新扫描所有监视的文件夹
+    void rescanAll();
+
+signals:
+    // 某个根目录扫描完成，files 为其中当前存在的全部音频文件和 CUE 文件
+    void folderScanned(const QString& folder, const QVector<WatchedFile>& files);
+
+private slots:
+    void onDirectoryChanged(const QString& path);
+    void startScan();
+
+private:
+    void markDirty(const QString& folder);
+    void scanFolders(const QStringList& roots);   // 运行在工作线程中
+    void onScanResult(const QString& root, const QVector<WatchedFile>& files, const QStringList& dirs);
+
+    QFileSystemWatcher* m_watcher;
+    QTimer* m_debounceTimer;       // 最后一次事件后安静一段时间才扫描
+    QTimer* m_periodicTimer;       // 定期修改时间扫描
+    QElapsedTimer m_dirtySince;    // 持续有事件时，最长等待时间的计时
+
+    QStringList m_folders;
+    QSet<QString> m_dirtyFolders;
+
+    QThread* m_thread;
+    std::atomic_bool m_cancelled;
+};
+
+#endif // FOLDERWATCHER_H
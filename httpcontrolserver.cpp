@@ -0,0 +1,458 @@
+#include "httpcontrolserver.h"
+#include "applog.h"
+#include "ipcprotocol.h"
+#include "diagnostics.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QJsonDocument>
+#include <QSet>
+#include <QDateTime>
+#include <QDebug>
+
+namespace {
+
+const int MaxHeaderSize = 64 * 1024;
+const int MaxBodySize = 4 * 1024 * 1024;   // enqueue 上万个路径也够用
+const int MaxClients = 256;
+const int MaxPollWait = 60000;             // 长轮询最多挂起 60 秒
+const int DefaultPollWait = 30000;
+const int HeartbeatInterval = 15000;
+const int IdleTimeout = 15000;             // 普通连接（包括还没发完请求头的）空闲这么久就断开
+const int IdleCheckInterval = 5000;
+
+// 逐字节比较全部内容，耗时只和长度有关
+bool constantTimeEquals(const QByteArray& a, const QByteArray& b)
+{
+    const int length = qMax(a.size(), b.size());
+    unsigned char diff = a.size() == b.size() ? 0 : 1;
+    for (int i = 0; i < length; ++i) {
+        diff |= (i < a.size() ? a[i] : 0) ^ (i < b.size() ? b[i] : 0);
+    }
+    return diff == 0;
+}
+
+// 只读命令可以用 GET，其余都必须用 POST
+const QSet<QString> ReadOnlyCommands = {"status", "queue", "search", "diagnostics"};
+
+} // namespace
+
+HttpControlServer::HttpControlServer(CommandHandler handler, QObject* parent)
+    : QObject(parent)
+    , m_handler(std::move(handler))
+{
+    m_server = new QTcpServer(this);
+    connect(m_server, &QTcpServer::newConnection, this, &HttpControlServer::onNewConnection);
+
+    m_notifyTimer = new QTimer(this);
+    m_notifyTimer->setSingleShot(true);
+    m_notifyTimer->setInterval(50);
+    connect(m_notifyTimer, &QTimer::timeout, this, &HttpControlServer::publishState);
+
+    m_heartbeatTimer = new QTimer(this);
+    m_heartbeatTimer->setInterval(HeartbeatInterval);
+    connect(m_heartbeatTimer, &QTimer::timeout, this, [this]() {
+        for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+            if (it->streaming) it.key()->write(": ping\n\n");
+        }
+    });
+
+    m_idleTimer = new QTimer(this);
+    m_idleTimer->setInterval(IdleCheckInterval);
+    connect(m_idleTimer, &QTimer::timeout, this, &HttpControlServer::closeIdleClients);
+}
+
+HttpControlServer::~HttpControlServer()
+{
+    stop();
+}
+
+bool HttpControlServer::start(const QHostAddress& address, quint16 port, const QString& token)
+{
+    stop();
+    m_token = token;
+    if (!m_server->listen(address, port)) {
+        m_errorString = m_server->errorString();
+        qCWarning(lcNet) << "HTTP 控制接口启动失败:" << m_errorString;
+        return false;
+    }
+    m_errorString.clear();
+    m_heartbeatTimer->start();
+    m_idleTimer->start();
+    qCDebug(lcNet) << "HTTP 控制接口已启动:" << address.toString() << port;
+    return true;
+}
+
+void HttpControlServer::stop()
+{
+    m_heartbeatTimer->stop();
+    m_idleTimer->stop();
+    m_notifyTimer->stop();
+    if (m_server->isListening()) {
+        m_server->close();
+    }
+    const QList<QTcpSocket*> sockets = m_clients.keys();
+    m_clients.clear();
+    for (QTcpSocket* socket : sockets) {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+}
+
+bool HttpControlServer::isListening() const
+{
+    return m_server->isListening();
+}
+
+void HttpControlServer::notifyStateChanged()
+{
+    if (m_server->isListening() && !m_notifyTimer->isActive()) {
+        m_notifyTimer->start();
+    }
+}
+
+void HttpControlServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        if (m_clients.size() >= MaxClients) {
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            sendResponse(socket, 503, "text/plain", "Too many clients", false);
+            continue;
+        }
+        Client client;
+        client.lastActivity = QDateTime::currentMSecsSinceEpoch();
+        m_clients.insert(socket, client);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { onDisconnected(socket); });
+    }
+}
+
+void HttpControlServer::onDisconnected(QTcpSocket* socket)
+{
+    m_clients.remove(socket);
+    socket->deleteLater();
+}
+
+// SSE 连接和挂起中的长轮询本来就会长时间没有请求，不算空闲
+void HttpControlServer::closeIdleClients()
+{
+    const qint64 deadline = QDateTime::currentMSecsSinceEpoch() - IdleTimeout;
+    QList<QTcpSocket*> idle;
+    for (auto it = m_clients.constBegin(); it != m_clients.constEnd(); ++it) {
+        if (!it->streaming && it->pollSince < 0 && it->lastActivity < deadline) {
+            idle.append(it.key());
+        }
+    }
+    for (QTcpSocket* socket : idle) {
+        m_clients.remove(socket);
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+}
+
+void HttpControlServer::onReadyRead(QTcpSocket* socket)
+{
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end()) return;
+    it->lastActivity = QDateTime::currentMSecsSinceEpoch();
+    it->buffer.append(socket->readAll());
+    if (it->buffer.size() > MaxHeaderSize + MaxBodySize) {
+        m_clients.erase(it);
+        socket->abort();
+        return;
+    }
+    processBuffer(socket);
+}
+
+void HttpControlServer::processBuffer(QTcpSocket* socket)
+{
+    while (true) {
+        auto it = m_clients.find(socket);
+        // SSE 连接和挂起中的长轮询不处理后续请求，数据先留在缓冲区里
+        if (it == m_clients.end() || it->streaming || it->pollSince >= 0) return;
+        if (socket->state() != QAbstractSocket::ConnectedState) return;
+
+        Request request;
+        int errorStatus = 0;
+        if (!parseRequest(it->buffer, &request, &errorStatus)) {
+            if (errorStatus != 0) {
+                m_clients.remove(socket);
+                sendJson(socket, errorStatus, IpcProtocol::makeError(QString::fromLatin1(statusText(errorStatus))), false);
+            }
+            return;
+        }
+        handleRequest(socket, request);
+    }
+}
+
+bool HttpControlServer::parseRequest(QByteArray& buffer, Request* request, int* errorStatus)
+{
+    int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (buffer.size() > MaxHeaderSize) *errorStatus = 431;
+        return false;
+    }
+
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() != 3 || !requestLine[2].startsWith("HTTP/1.")) {
+        *errorStatus = 400;
+        return false;
+    }
+
+    request->method = requestLine[0];
+    for (int i = 1; i < lines.size(); ++i) {
+        int colon = lines[i].indexOf(':');
+        if (colon <= 0) continue;
+        request->headers.insert(lines[i].left(colon).trimmed().toLower(), lines[i].mid(colon + 1).trimmed());
+    }
+
+    bool lengthOk = true;
+    qint64 contentLength = request->headers.value("content-length", "0").toLongLong(&lengthOk);
+    if (!lengthOk || contentLength < 0) {
+        *errorStatus = 400;
+        return false;
+    }
+    if (contentLength > MaxBodySize) {
+        *errorStatus = 413;
+        return false;
+    }
+    qint64 total = headerEnd + 4 + contentLength;
+    if (buffer.size() < total) {
+        return false;   // 请求体还没有收全
+    }
+    request->body = buffer.mid(headerEnd + 4, contentLength);
+    buffer.remove(0, total);
+
+    // 查询串按表单编码处理，"+" 表示空格
+    QUrl url(QString::fromUtf8(requestLine[1]));
+    request->path = url.path();
+    request->query = QUrlQuery(url.query(QUrl::FullyEncoded).replace('+', "%20"));
+
+    QByteArray connection = request->headers.value("connection").toLower();
+    if (requestLine[2] == "HTTP/1.0") {
+        request->keepAlive = connection == "keep-alive";
+    } else {
+        request->keepAlive = connection != "close";
+    }
+    return true;
+}
+
+bool HttpControlServer::isAuthorized(const Request& request, const QString& token)
+{
+    if (token.isEmpty()) return true;
+    const QByteArray expected = token.toUtf8();
+    // 两种方式都比较一遍，不因为第一种失败与否而提前返回
+    bool header = constantTimeEquals(request.headers.value("authorization"), "Bearer " + expected);
+    bool query = constantTimeEquals(request.query.queryItemValue("token", QUrl::FullyDecoded).toUtf8(), expected);
+    return header | query;
+}
+
+bool HttpControlServer::isLocalHost(const Request& request, quint16 port)
+{
+    const QByteArray host = request.headers.value("host").toLower();
+    const QByteArray suffix = ':' + QByteArray::number(port);
+    for (const char* name : {"localhost", "127.0.0.1", "[::1]"}) {
+        if (host == name + suffix || (port == 80 && host == name)) return true;
+    }
+    return false;
+}
+
+void HttpControlServer::handleRequest(QTcpSocket* socket, const Request& request)
+{
+    Diagnostics::ScopedTimer timer(Diagnostics::HttpRequest);
+
+    // 没有设置令牌时，拒绝一切来自浏览器网页的请求（包括只读查询和事件流），
+    // 否则用户打开的任何网页都能读到整个歌曲库；命令行工具和脚本不带 Origin，不受影响。
+    // DNS 重绑定的网页发出的是同源请求，没有 Origin 头，但 Host 是攻击者的域名
+    if (m_token.isEmpty()) {
+        if (!isLocalHost(request, m_server->serverPort())) {
+            sendJson(socket, 403, IpcProtocol::makeError("没有设置访问令牌时只能通过本机地址访问"), request.keepAlive);
+            return;
+        }
+        if (request.headers.contains("origin")) {
+            sendJson(socket, 403, IpcProtocol::makeError("跨站请求需要设置访问令牌"), request.keepAlive);
+            return;
+        }
+    }
+
+    // 浏览器的跨域预检请求不带令牌
+    if (request.method == "OPTIONS") {
+        sendResponse(socket, 204, QByteArray(), QByteArray(), request.keepAlive);
+        return;
+    }
+
+    if (!isAuthorized(request, m_token)) {
+        sendJson(socket, 401, IpcProtocol::makeError("需要访问令牌"), request.keepAlive);
+        return;
+    }
+
+    if (request.path == "/api/events" && request.method == "GET") {
+        Client& client = m_clients[socket];
+        client.streaming = true;
+        socket->write("HTTP/1.1 200 OK\r\n"
+                      "Content-Type: text/event-stream; charset=utf-8\r\n"
+                      "Cache-Control: no-cache\r\n"
+                      "Connection: keep-alive\r\n" + corsHeaders() + "\r\n");
+        // 连上后先推送一次当前状态，客户端不必再单独查询
+        QByteArray data = QJsonDocument(currentStatus()).toJson(QJsonDocument::Compact);
+        socket->write("id: " + QByteArray::number(m_stateVersion) + "\nevent: status\ndata: " + data + "\n\n");
+        return;
+    }
+
+    if (!request.path.startsWith("/api/")) {
+        sendJson(socket, 404, IpcProtocol::makeError("没有这个接口"), request.keepAlive);
+        return;
+    }
+
+    QString command = request.path.mid(5);
+    bool readOnly = ReadOnlyCommands.contains(command);
+    if (readOnly ? (request.method != "GET" && request.method != "POST") : request.method != "POST") {
+        sendJson(socket, 405, IpcProtocol::makeError("控制命令必须使用 POST"), request.keepAlive);
+        return;
+    }
+    // 参数：查询串中的数字按数字传递，JSON 请求体中的字段覆盖同名的查询参数
+    QJsonObject args;
+    const auto items = request.query.queryItems(QUrl::FullyDecoded);
+    for (const auto& item : items) {
+        if (item.first == "token") continue;
+        bool isNumber = false;
+        qlonglong number = item.second.toLongLong(&isNumber);
+        args.insert(item.first, isNumber ? QJsonValue(number) : QJsonValue(item.second));
+    }
+    if (!request.body.isEmpty()) {
+        QJsonDocument doc = QJsonDocument::fromJson(request.body);
+        if (!doc.isObject()) {
+            sendJson(socket, 400, IpcProtocol::makeError("请求体不是 JSON 对象"), request.keepAlive);
+            return;
+        }
+        const QJsonObject body = doc.object();
+        for (auto it = body.begin(); it != body.end(); ++it) {
+            args.insert(it.key(), it.value());
+        }
+    }
+
+    if (command == "status" && args.contains("since")) {
+        qint64 since = args.value("since").toVariant().toLongLong();
+        int waitMs = args.contains("wait") ? args.value("wait").toVariant().toInt() : DefaultPollWait;
+        beginLongPoll(socket, since, waitMs, request.keepAlive);
+        return;
+    }
+
+    QJsonObject reply = command == "status" ? currentStatus()
+                                            : m_handler(command, IpcProtocol::makeRequest(command, args));
+    sendJson(socket, reply.value("ok").toBool() ? 200 : 400, reply, request.keepAlive);
+}
+
+void HttpControlServer::beginLongPoll(QTcpSocket* socket, qint64 since, int waitMs, bool keepAlive)
+{
+    if (m_stateVersion > since || waitMs <= 0) {
+        sendJson(socket, 200, currentStatus(), keepAlive);
+        return;
+    }
+
+    Client& client = m_clients[socket];
+    client.pollSince = since;
+    client.pollKeepAlive = keepAlive;
+    int serial = ++client.pollSerial;
+
+    // 超时后返回当前状态（版本不变），客户端带着同一个 since 再次请求即可
+    QTimer::singleShot(qMin(waitMs, MaxPollWait), socket, [this, socket, serial]() {
+        auto it = m_clients.find(socket);
+        if (it == m_clients.end() || it->pollSerial != serial || it->pollSince < 0) return;
+        it->pollSince = -1;
+        bool keepAlive = it->pollKeepAlive;
+        sendJson(socket, 200, currentStatus(), keepAlive);
+        processBuffer(socket);
+    });
+}
+
+void HttpControlServer::publishState()
+{
+    ++m_stateVersion;
+    QJsonObject status = currentStatus();
+    QByteArray event = "id: " + QByteArray::number(m_stateVersion) + "\nevent: status\ndata: "
+                       + QJsonDocument(status).toJson(QJsonDocument::Compact) + "\n\n";
+
+    // 先收集要通知的连接，发送过程中可能有连接断开
+    QList<QTcpSocket*> polling;
+    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+        if (it->streaming) {
+            it.key()->write(event);
+        } else if (it->pollSince >= 0) {
+            polling.append(it.key());
+        }
+    }
+    for (QTcpSocket* socket : polling) {
+        auto it = m_clients.find(socket);
+        if (it == m_clients.end()) continue;
+        it->pollSince = -1;
+        sendJson(socket, 200, status, it->pollKeepAlive);
+        processBuffer(socket);
+    }
+}
+
+QJsonObject HttpControlServer::currentStatus() const
+{
+    QJsonObject reply = m_handler("status", IpcProtocol::makeRequest("status"));
+    reply.insert("stateVersion", m_stateVersion);
+    return reply;
+}
+
+void HttpControlServer::sendJson(QTcpSocket* socket, int status, const QJsonObject& body, bool keepAlive)
+{
+    sendResponse(socket, status, "application/json; charset=utf-8",
+                 QJsonDocument(body).toJson(QJsonDocument::Compact), keepAlive);
+}
+
+void HttpControlServer::sendResponse(QTcpSocket* socket, int status, const QByteArray& contentType,
+                                     const QByteArray& body, bool keepAlive)
+{
+    QByteArray header = "HTTP/1.1 " + QByteArray::number(status) + ' ' + statusText(status) + "\r\n";
+    if (!contentType.isEmpty()) {
+        header += "Content-Type: " + contentType + "\r\n";
+    }
+    header += "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+              "Cache-Control: no-store\r\n" + corsHeaders();
+    header += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+    auto it = m_clients.find(socket);
+    if (it != m_clients.end()) it->lastActivity = QDateTime::currentMSecsSinceEpoch();
+
+    socket->write(header);
+    socket->write(body);
+    if (!keepAlive) {
+        socket->disconnectFromHost();   // 数据发完后才真正断开
+    }
+}
+
+// 只有设置了令牌才允许网页跨域访问：请求仍然要带令牌，网页拿不到令牌就什么也读不到
+QByteArray HttpControlServer::corsHeaders() const
+{
+    if (m_token.isEmpty()) return QByteArray();
+    return "Access-Control-Allow-Origin: *\r\n"
+           "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
+           "Access-Control-Allow-Headers: Authorization, Content-Type\r\n";
+}
+
+QByteArray HttpControlServer::statusText(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 416: return "Range Not Satisfiable";
+    case 431: return "Request Header Fields Too Large";
+    case 503: return "Service Unavailable";
+    default:  return "Unknown";
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef HTTPCONTROLSERVER_H
+#define HTTPCONTROLSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QHostAddress>
+#include <QUrlQuery>
+#include <functional>
+
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+// 内嵌的 HTTP 控制接口（默认只监听 127.0.0.1，需要在设置中手动开启）
+// 命令与单实例通道相同（见 ipcprotocol.h），回复也是同样的 JSON：
+//   GET  /api/status[?since=N&wait=毫秒]   当前状态；带 since 时为长轮询，状态版本超过 N 或超时才返回
+//   GET  /api/queue?offset=&limit=         正在播放的列表
+//   GET  /api/search?q=&limit=             在歌曲库中按标题 / 艺术家 / 专辑搜索
+//   GET  /api/diagnostics                  各项操作的次数和耗时，用于集中监控
+//   GET  /api/events                       Server-Sent Events，状态变化时推送 status 事件
+//   POST /api/<命令>                        play pause toggle next previous seek volume enqueue，
+//                                          参数可以放在查询串中，也可以放在 JSON 请求体中
+// 设置了访问令牌时，每个请求都要带 "Authorization: Bearer <令牌>" 或 ?token=<令牌>；
+// 没有令牌时只接受 Host 为本机（localhost / 127.0.0.1 / [::1] 加监听端口）且不带 Origin 头的请求，
+// 防止网页通过跨站请求或 DNS 重绑定读取接口，也不返回跨域头（从局域网访问必须设置令牌）。
+// 普通连接超过 15 秒没有收发数据就断开，空闲连接不会占满连接数上限
+class HttpControlServer : public QObject
+{
+    Q_OBJECT
+public:
+    using CommandHandler = std::function<QJsonObject(const QString& command, const QJsonObject& request)>;
+
+    explicit HttpControlServer(CommandHandler handler, QObject* parent = nullptr);
+    ~HttpControlServer();
+
+    bool start(const QHostAddress& address, quint16 port, const QString& token = QString());
+    void stop();
+    bool isListening() const;
+    QString errorString() const { return m_errorString; }
+
+    // 请求解析，局域网串流（MediaStreamServer）共用
+    struct Request {
+        QByteArray method;
+        QString path;
+        QUrlQuery query;
+        QHash<QByteArray, QByteArray> headers;   // 键为小写
+        QByteArray body;
+        bool keepAlive = true;
+    };
+    // 从缓冲区头部取出一个完整的请求；数据不完整时返回 false 且 errorStatus 为 0，
+    // 请求有误时返回 false 并设置 errorStatus（HTTP 状态码）
+    static bool parseRequest(QByteArray& buffer, Request* request, int* errorStatus);
+    // 令牌按固定时间比较，响应时间不会泄露令牌的前缀
+    static bool isAuthorized(const Request& request, const QString& token);
+    // Host 头是否指向本机的 port 端口
+    static bool isLocalHost(const Request& request, quint16 port);
+    static QByteArray statusText(int status);
+
+public slots:
+    // 播放状态、歌曲或音量变化时调用：短时间内的多次变化合并为一次推送
+    void notifyStateChanged();
+
+private:
+    struct Client {
+        QByteArray buffer;
+        bool streaming = false;     // SSE 连接，不再解析后续请求
+        int pollSerial = 0;         // 用于识别过期的长轮询超时
+        qint64 pollSince = -1;      // 正在等待的长轮询，-1 表示没有
+        bool pollKeepAlive = true;
+        qint64 lastActivity = 0;    // 最近一次收发数据的时间，用于断开空闲连接
+    };
+
+    void onNewConnection();
+    void onReadyRead(QTcpSocket* socket);
+    void onDisconnected(QTcpSocket* socket);
+    void closeIdleClients();
+    void processBuffer(QTcpSocket* socket);   // 依次处理缓冲区中已经完整的请求
+    void handleRequest(QTcpSocket* socket, const Request& request);
+    void beginLongPoll(QTcpSocket* socket, qint64 since, int waitMs, bool keepAlive);
+    void publishState();
+    QJsonObject currentStatus() const;
+
+    QByteArray corsHeaders() const;
+    void sendJson(QTcpSocket* socket, int status, const QJsonObject& body, bool keepAlive);
+    void sendResponse(QTcpSocket* socket, int status, const QByteArray& contentType,
+                      const QByteArray& body, bool keepAlive);
+
+    CommandHandler m_handler;
+    QTcpServer* m_server;
+    QHash<QTcpSocket*, Client> m_clients;
+    QString m_token;
+    QString m_errorString;
+
+    qint64 m_stateVersion = 0;
+    QTimer* m_notifyTimer;       // 合并短时间内的多次状态变化
+    QTimer* m_heartbeatTimer;    // 定期给 SSE 客户端发注释行，防止被代理或防火墙断开
+    QTimer* m_idleTimer;         // 定期断开空闲的普通连接
+};
+
+#endif // HTTPCONTROLSERVER_H
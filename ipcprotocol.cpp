@@ -0,0 +1,104 @@
+#include "ipcprotocol.h"
+#include "applog.h"
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QDebug>
+
+QJsonObject IpcProtocol::makeRequest(const QString& command, const QJsonObject& args)
+{
+    QJsonObject request = args;
+    request.insert("v", Version);
+    request.insert("cmd", command);
+    return request;
+}
+
+QJsonObject IpcProtocol::makeReply(const QJsonObject& result)
+{
+    QJsonObject reply;
+    reply.insert("v", Version);
+    reply.insert("ok", true);
+    if (!result.isEmpty()) reply.insert("result", result);
+    return reply;
+}
+
+QJsonObject IpcProtocol::makeError(const QString& error)
+{
+    QJsonObject reply;
+    reply.insert("v", Version);
+    reply.insert("ok", false);
+    reply.insert("error", error);
+    return reply;
+}
+
+QByteArray IpcProtocol::encode(const QJsonObject& message)
+{
+    // Compact 格式中不会出现换行，可以直接按行分帧
+    QByteArray line = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    return line;
+}
+
+bool IpcProtocol::parseRequest(const QByteArray& line, QJsonObject* request, QString* errorString)
+{
+    QByteArray data = line.trimmed();
+
+    // 兼容旧版本的唤醒消息
+    if (data == "WAKE_UP") {
+        *request = makeRequest("wake");
+        return true;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        if (errorString) *errorString = "请求不是合法的 JSON 对象";
+        return false;
+    }
+
+    QJsonObject object = doc.object();
+    int version = object.value("v").toInt(1);
+    if (version > Version) {
+        if (errorString) *errorString = QString("不支持的协议版本 %1").arg(version);
+        return false;
+    }
+    if (object.value("cmd").toString().isEmpty()) {
+        if (errorString) *errorString = "缺少 cmd 字段";
+        return false;
+    }
+
+    *request = object;
+    return true;
+}
+
+bool IpcProtocol::sendRequest(const QString& serverName, const QJsonObject& request,
+                              QJsonObject* reply, int timeoutMs)
+{
+    QLocalSocket socket;
+    socket.connectToServer(serverName);
+    if (!socket.waitForConnected(timeoutMs)) {
+        return false;
+    }
+
+    socket.write(encode(request));
+    if (!socket.waitForBytesWritten(timeoutMs)) {
+        return false;
+    }
+
+    // 读到一整行为止
+    QByteArray buffer;
+    while (!buffer.contains('\n')) {
+        if (!socket.waitForReadyRead(timeoutMs)) {
+            qCWarning(lcIpc) << "等待回复超时:" << socket.errorString();
+            return false;
+        }
+        buffer.append(socket.readAll());
+    }
+    socket.disconnectFromServer();
+
+    if (reply) {
+        QJsonDocument doc = QJsonDocument::fromJson(buffer.left(buffer.indexOf('\n')));
+        *reply = doc.object();
+    }
+    return true;
+}
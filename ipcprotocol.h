@@ -0,0 +1,41 @@
+#ifndef IPCPROTOCOL_H
+#define IPCPROTOCOL_H
+
+#include <QString>
+#include <QByteArray>
+#include <QJsonObject>
+
+// 单实例之间的命令协议
+// 每条消息是一行 UTF-8 编码的 JSON 对象，以 '\n' 结尾：
+//   请求 {"v":1,"cmd":"seek","position":30000}
+//   回复 {"v":1,"ok":true,"result":{...}} 或 {"v":1,"ok":false,"error":"..."}
+// 命令：wake play pause toggle next previous seek(position 毫秒) volume(volume 0-100)
+//       enqueue(paths 数组，可选 playlist、play) status
+//       open(paths 数组)：与 enqueue 相同，但短时间内的多个请求合并为一批，
+//       追加到“打开方式”的目标列表并播放其中第一首，用于命令行和文件管理器的“打开方式”
+//       queue(offset、limit) search(q、limit) song(id)：查询正在播放的列表 / 歌曲库
+//       diagnostics：各项操作的次数和耗时（见 diagnostics.h）
+//       log(可选 category、level、rateLimit)：修改日志分类的级别，返回当前的日志设置（见 applog.h）
+// 旧版本发送的裸字符串 "WAKE_UP" 仍然按 wake 命令处理
+class IpcProtocol
+{
+public:
+    static const int Version = 1;
+
+    static QJsonObject makeRequest(const QString& command, const QJsonObject& args = QJsonObject());
+    static QJsonObject makeReply(const QJsonObject& result = QJsonObject());
+    static QJsonObject makeError(const QString& error);
+
+    // 编码为一行（带结尾的 '\n'）
+    static QByteArray encode(const QJsonObject& message);
+
+    // 解析一行请求；版本比自己新或格式不对时返回 false 并设置 errorString
+    static bool parseRequest(const QByteArray& line, QJsonObject* request, QString* errorString);
+
+    // 连接到正在运行的实例，发送一条请求并等待回复
+    // 会阻塞当前线程，只在命令行客户端（第二个进程）中使用
+    static bool sendRequest(const QString& serverName, const QJsonObject& request,
+                            QJsonObject* reply = nullptr, int timeoutMs = 1000);
+};
+
+#endif // IPCPROTOCOL_H
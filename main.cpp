@@ -1,118 +1,225 @@
-#include "singleapplication.h"
-#include <QFile>
-#include <QDir>
-#include <QSettings>
-#include "mainwindow.h"
-
-// 包含 Windows 头文件（仅在 Windows 平台）
-#ifdef Q_OS_WIN
-#include <Windows.h>
-#endif
-
-int main(int argc, char *argv[]) {
-    QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
-    QApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
-
-    // 定义一个全系统唯一的 Key，通常用包名或应用名
-    const QString APP_KEY = "OldPlayerMax_Unique_Instance_Key";
-
-    // 1. 使用 SingleApplication 替代 QApplication
-    SingleApplication app(argc, argv, APP_KEY);
-
-    // 2. 检查是否已经有实例在运行
-    if (app.isRunning()) {
-        // 如果正在运行，发送唤醒消息给旧实例
-        app.sendMessage("WAKE_UP");
-        // 然后直接退出当前新实例
-        return 0; 
-    }
-
-    QCoreApplication::setOrganizationName("OldCheung"); // 作者
-    QCoreApplication::setApplicationName("OldPlayer"); // 应用名
-    
-    // 设置配置文件保存到软件目录下的 config 文件夹
-    QString configPath = QCoreApplication::applicationDirPath() + "/config";
-    QDir configDir(configPath);
-    if (!configDir.exists()) {
-        configDir.mkpath(".");
-    }
-    QSettings::setDefaultFormat(QSettings::IniFormat);
-    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, configPath);
-    
-    #ifdef Q_OS_WIN
-    SetConsoleOutputCP(CP_UTF8);
-    #endif
-
-
-    //添加深色主题样式表
-    QString qss = R"(
-        QWidget {
-            background-color: #2E3440;
-            color: #D8DEE9;
-            font-family: "Microsoft YaHei";
-        }
-        QMainWindow {
-            background-color: #3B4252;
-        }
-        QGroupBox {
-            font-weight: bold;
-            border: 1px solid #4C566A;
-            border-radius: 5px;
-            margin-top: 1ex;
-        }
-        QGroupBox::title {
-            subcontrol-origin: margin;
-            subcontrol-position: top center;
-            padding: 0 3px;
-        }
-        QListWidget {
-            background-color: #2E3440;
-            border: 1px solid #4C566A;
-            padding: 5px;
-        }
-        QListWidget::item {
-            padding: 1px 5px;
-        }
-        QListWidget::item:selected {
-            background-color: #88C0D0;
-            color: #2E3440;
-        }
-        QPushButton {
-            background-color: #4C566A;
-            border: none;
-            padding: 8px 16px;
-            border-radius: 4px;
-        }
-        QPushButton:hover {
-            background-color: #5E81AC;
-        }
-        QPushButton:pressed {
-            background-color: #81A1C1;
-        }
-        QSlider::groove:horizontal {
-            border: 1px solid #4C566A;
-            height: 2px;
-            background: #434C5E;
-            margin: 2px 0;
-            border-radius: 1px;
-        }
-        QSlider::handle:horizontal {
-            background: #88C0D0;
-            border: 1px solid #88C0D0;
-            width: 10px;
-            margin: -5px 0;
-            border-radius: 5px;
-        }
-        QLabel {
-            color: #ECEFF4;
-        }
-    )";
-    app.setStyleSheet(qss);
-    
-    MainWindow window;
-    // 当第二个实例试图启动时，SingleApplication 会收到消息并发射 showUp
-    QObject::connect(&app, &SingleApplication::showUp, &window, &MainWindow::wakeUpWindow);
-    window.show();
-    
-    return app.exec();
+#include "singleapplication.h"
+#include "ipcprotocol.h"
+#include "startupprofiler.h"
+#include "tracerecorder.h"
+#include "applog.h"
+#include <QFile>
+#include <QDir>
+#include <QSettings>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <cstdio>
+#include "mainwindow.h"
+
+// 包含 Windows 头文件（仅在 Windows 平台）
+#ifdef Q_OS_WIN
+#include <Windows.h>
+#endif
+
+// 命令行遥控：OldPlayer --remote <命令> [参数...]
+// 把命令发给正在运行的实例并把回复（JSON）打印到标准输出，不创建任何窗口，例如
+//   OldPlayer --remote status
+//   OldPlayer --remote seek 30000
+//   OldPlayer --remote volume 50
+//   OldPlayer --remote enqueue [--play] a.flac b.mp3
+static int runRemoteCommand(const QStringList& args, const QString& serverName)
+{
+    if (args.isEmpty()) {
+        fputs("用法: OldPlayer --remote <play|pause|toggle|next|previous|seek 毫秒|volume 0-100|enqueue [--play] 文件...|status|diagnostics|log [分类 级别]|wake>\n", stderr);
+        return 1;
+    }
+
+    const QString command = args.first();
+    QJsonObject params;
+    if (command == "seek" && args.size() > 1) {
+        params.insert("position", args[1].toLongLong());
+    } else if (command == "volume" && args.size() > 1) {
+        params.insert("volume", args[1].toInt());
+    } else if (command == "log" && args.size() > 1) {
+        // 例如 --remote log oldplayer.import debug；省略级别表示恢复默认
+        params.insert("category", args[1]);
+        params.insert("level", args.value(2));
+    } else if (command == "enqueue") {
+        QJsonArray paths;
+        for (int i = 1; i < args.size(); ++i) {
+            if (args[i] == "--play") {
+                params.insert("play", true);
+            } else {
+                // 相对路径按本进程的工作目录解析，正在运行的实例的工作目录可能不同
+                paths.append(QFileInfo(args[i]).absoluteFilePath());
+            }
+        }
+        params.insert("paths", paths);
+    }
+
+    QJsonObject reply;
+    if (!IpcProtocol::sendRequest(serverName, IpcProtocol::makeRequest(command, params), &reply)) {
+        fputs("OldPlayer 没有在运行\n", stderr);
+        return 2;
+    }
+    fputs(QJsonDocument(reply).toJson(QJsonDocument::Compact).constData(), stdout);
+    fputs("\n", stdout);
+    fflush(stdout);
+    return reply.value("ok").toBool() ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+    StartupProfiler::start();
+    // 设置了 OLDPLAYER_TRACE 环境变量时从启动开始记录性能跟踪（之后可在设置菜单中导出）
+    if (qEnvironmentVariableIsSet("OLDPLAYER_TRACE")) {
+        TraceRecorder::setEnabled(true);
+    }
+    QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
+    QApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
+
+    // 定义一个全系统唯一的 Key，通常用包名或应用名
+    const QString APP_KEY = "OldPlayerMax_Unique_Instance_Key";
+
+    // 0. 遥控模式：只需要一个轻量的 QCoreApplication，发完命令立即退出
+    if (argc > 1 && qstrcmp(argv[1], "--remote") == 0) {
+        #ifdef Q_OS_WIN
+        // 这是 GUI 程序，默认没有控制台，借用启动它的命令行窗口输出结果
+        if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+            freopen("CONOUT$", "w", stdout);
+            freopen("CONOUT$", "w", stderr);
+        }
+        SetConsoleOutputCP(CP_UTF8);
+        #endif
+        QCoreApplication remote(argc, argv);
+        return runRemoteCommand(remote.arguments().mid(2), APP_KEY);
+    }
+
+    // 1. 使用 SingleApplication 替代 QApplication
+    SingleApplication app(argc, argv, APP_KEY);
+
+    // 命令行中的文件和文件夹（例如在文件管理器中选中多个文件后“打开方式”）
+    QStringList openPaths;
+    const QStringList arguments = app.arguments().mid(1);
+    for (const QString& argument : arguments) {
+        QFileInfo info(argument);
+        if (!argument.startsWith('-') && info.exists()) {
+            openPaths.append(info.absoluteFilePath());
+        }
+    }
+    QJsonObject openRequest = IpcProtocol::makeRequest("open", QJsonObject{
+        {"paths", QJsonArray::fromStringList(openPaths)}
+    });
+
+    // 2. 检查是否已经有实例在运行
+    if (app.isRunning()) {
+        // 有要打开的文件时一次性全部转交给旧实例；旧版本不认识 open，退回到只唤醒
+        if (openPaths.isEmpty() || !app.sendRequest(openRequest)) {
+            // 如果正在运行，发送唤醒消息给旧实例
+            app.sendMessage("WAKE_UP");
+        }
+        // 然后直接退出当前新实例
+        return 0; 
+    }
+    StartupProfiler::mark("ipc check");
+
+    QCoreApplication::setOrganizationName("OldCheung"); // 作者
+    QCoreApplication::setApplicationName("OldPlayer"); // 应用名
+    
+    // 设置配置文件保存到软件目录下的 config 文件夹
+    QString configPath = QCoreApplication::applicationDirPath() + "/config";
+    QDir configDir(configPath);
+    if (!configDir.exists()) {
+        configDir.mkpath(".");
+    }
+    QSettings::setDefaultFormat(QSettings::IniFormat);
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, configPath);
+
+    // 之后的日志写入 config/logs/oldplayer.log（级别见配置文件的 Logging 段）
+    AppLog::install(configPath + "/logs");
+    
+    #ifdef Q_OS_WIN
+    SetConsoleOutputCP(CP_UTF8);
+    #endif
+
+
+    //添加深色主题样式表
+    QString qss = R"(
+        QWidget {
+            background-color: #2E3440;
+            color: #D8DEE9;
+            font-family: "Microsoft YaHei";
+        }
+        QMainWindow {
+            background-color: #3B4252;
+        }
+        QGroupBox {
+            font-weight: bold;
+            border: 1px solid #4C566A;
+            border-radius: 5px;
+            margin-top: 1ex;
+        }
+        QGroupBox::title {
+            subcontrol-origin: margin;
+            subcontrol-position: top center;
+            padding: 0 3px;
+        }
+        QListWidget {
+            background-color: #2E3440;
+            border: 1px solid #4C566A;
+            padding: 5px;
+        }
+        QListWidget::item {
+            padding: 1px 5px;
+        }
+        QListWidget::item:selected {
+            background-color: #88C0D0;
+            color: #2E3440;
+        }
+        QPushButton {
+            background-color: #4C566A;
+            border: none;
+            padding: 8px 16px;
+            border-radius: 4px;
+        }
+        QPushButton:hover {
+            background-color: #5E81AC;
+        }
+        QPushButton:pressed {
+            background-color: #81A1C1;
+        }
+        QSlider::groove:horizontal {
+            border: 1px solid #4C566A;
+            height: 2px;
+            background: #434C5E;
+            margin: 2px 0;
+            border-radius: 1px;
+        }
+        QSlider::handle:horizontal {
+            background: #88C0D0;
+            border: 1px solid #88C0D0;
+            width: 10px;
+            margin: -5px 0;
+            border-radius: 5px;
+        }
+        QLabel {
+            color: #ECEFF4;
+        }
+    )";
+    app.setStyleSheet(qss);
+    StartupProfiler::mark("settings");
+    
+    MainWindow window;
+    // 当第二个实例试图启动时，SingleApplication 会收到消息并发射 showUp
+    QObject::connect(&app, &SingleApplication::showUp, &window, &MainWindow::wakeUpWindow);
+    // 其他命令（播放控制、添加歌曲、查询状态）交给主窗口处理
+    app.setCommandHandler([&window](const QString& command, const QJsonObject& request) {
+        return window.handleRemoteCommand(command, request);
+    });
+    window.show();
+    StartupProfiler::mark("show");
+
+    // 首次启动时带的文件同样追加到目标列表并开始播放
+    if (!openPaths.isEmpty()) {
+        window.handleRemoteCommand("open", openRequest);
+    }
+    
+    int exitCode = app.exec();
+    AppLog::shutdown();
+    return exitCode;
 }
\ No newline at end of file
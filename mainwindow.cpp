@@ -1,1779 +1,2897 @@
-﻿#include "mainwindow.h"
-#include <QVBoxLayout>
-#include <QFile>
-#include <QHBoxLayout>
-#include <QFileDialog>
-#include <QInputDialog>
-#include <QMessageBox>
-#include <QGroupBox>
-#include <QStyle>
-#include <QMediaMetaData>
-#include <QSplitter>
-#include <random>
-#include <algorithm>
-#include <QRandomGenerator> //Qt 6 的随机数生成器
-#include <QDirIterator>
-#include <QDebug>
-#include <QMenu>
-#include <QSettings>   //包含 QSettings 头文件
-#include <QSplitter>   //包含 QSplitter 的完整头文件
-#include <QAction>   //包含 QAction
-#include <QApplication> //调用 quit
-#include <QToolTip>
-#include <QFontDialog>
-#include <QFont>
-#include <QTimer>
-#include <QProcess>
-#include "customtimedialog.h"
-#include "fontsettingsdialog.h"
-#include <QMessageBox>
-
-// TagLib 头文件
-#include <taglib/fileref.h>
-#include <taglib/tag.h>
-
-MainWindow::MainWindow(QWidget* parent)
-    : QMainWindow(parent)
-    , m_currentPlaylistIndex(0)
-    , m_currentSongIndex(-1)
-    //, m_inListMode(InListMode::Sequential)
-    //, m_crossListMode(CrossListMode::ListLoop)
-    , m_shuffledPlaybackIndex(0)             // 初始化随机播放索引
-    , m_isFirstShow(true)
-    , m_playingPlaylistIndex(-1)
-{
-    m_player = new QMediaPlayer(this);
-    m_audioOutput = new QAudioOutput(this);
-    m_player->setAudioOutput(m_audioOutput);
-    
-    m_playlistManager = new PlaylistManager(this);
-
-    m_shutdownTimer = new QTimer(this);
-    m_shutdownTimer->setSingleShot(true); // 这是一个一次性的定时器
-    connect(m_shutdownTimer, &QTimer::timeout, this, &MainWindow::onShutdownTimerTimeout);
-
-    m_shutdownProcess = new QProcess(this);
-    
-    setupUI();
-
-    //安全地初始化字体
-    m_playingSongFont = m_songListWidget->font();
-    m_playingSongFont.setBold(true);
-    
-    // 连接播放器信号
-    connect(m_player, &QMediaPlayer::positionChanged, 
-            this, &MainWindow::onPositionChanged);
-    connect(m_player, &QMediaPlayer::durationChanged, 
-            this, &MainWindow::onDurationChanged);
-    connect(m_player, &QMediaPlayer::mediaStatusChanged,
-            this, &MainWindow::onMediaStatusChanged);
-    connect(m_player, &QMediaPlayer::metaDataChanged,
-            this, &MainWindow::onMetaDataChanged); // <--- 连接新信号
-    
-    updatePlaylistView();
-    updateSongListView();
-    updateInListModeButton();   // 在启动时更新按钮状态
-    updateCrossListModeButton(); // 在启动时更新按钮状态
-
-    //设置窗口图标（标题栏和任务栏）
-    //使用 Qt 资源系统中的路径
-    setWindowIcon(QIcon(":/icons/appicon.ico"));
-
-
-    QAction* fontAction = new QAction("字体...", this);
-    connect(fontAction, &QAction::triggered, this, &MainWindow::onShowFontSettings);
-
-    QMenu* settingsMenu = new QMenu("设置", this);
-    settingsMenu->addAction(fontAction);
-
-    QMenu* shutdownMenu = new QMenu("定时关机", this);
-
-    QAction* shutdown30MinsAction = shutdownMenu->addAction("30分钟后");
-    connect(shutdown30MinsAction, &QAction::triggered, this, &MainWindow::onSetShutdownAfter30Mins);
-    
-    QAction* shutdown60MinsAction = shutdownMenu->addAction("60分钟后");
-    connect(shutdown60MinsAction, &QAction::triggered, this, &MainWindow::onSetShutdownAfter60Mins);
-    
-    QAction* customShutdownAction = shutdownMenu->addAction("自定义时间...");
-    connect(customShutdownAction, &QAction::triggered, this, &MainWindow::onSetCustomShutdownTime);
-    
-    shutdownMenu->addSeparator();
-    
-    m_cancelShutdownAction = shutdownMenu->addAction("取消定时关机");
-    m_cancelShutdownAction->setEnabled(false); // 默认禁用
-    connect(m_cancelShutdownAction, &QAction::triggered, this, &MainWindow::onCancelShutdown);
-
-    settingsMenu->addMenu(shutdownMenu);
-    
-    m_quitAction = new QAction("退出", this);
-    connect(m_quitAction, &QAction::triggered, this, [this]() {
-        // 先保存设置再退出
-        QSettings settings;
-        settings.setValue("geometry", saveGeometry());
-        settings.setValue("splitterState", m_mainSplitter->saveState());
-        settings.setValue("volume", m_volumeSlider->value());
-        settings.setValue("lastPlaylistIndex", m_currentPlaylistIndex);
-        settings.setValue("lastSongIndex", m_currentSongIndex);
-        settings.setValue("inListMode", static_cast<int>(m_inListMode));
-        settings.setValue("crossListMode", static_cast<int>(m_crossListMode));
-        qApp->quit();
-    }); 
-
-    m_trayMenu = new QMenu(this);
-    
-    // === 托盘菜单播放控制区域 ===
-    // 1. 歌曲名标签
-    QWidget* songLabelWidget = new QWidget();
-    QHBoxLayout* songLabelLayout = new QHBoxLayout(songLabelWidget);
-    songLabelLayout->setContentsMargins(10, 5, 10, 5);
-    m_traySongLabel = new QLabel("未播放");
-    m_traySongLabel->setStyleSheet("font-weight: bold; font-size: 12px;");
-    m_traySongLabel->setAlignment(Qt::AlignCenter);
-    m_traySongLabel->setMinimumWidth(180);
-    songLabelLayout->addWidget(m_traySongLabel);
-    QWidgetAction* songLabelAction = new QWidgetAction(this);
-    songLabelAction->setDefaultWidget(songLabelWidget);
-    m_trayMenu->addAction(songLabelAction);
-    
-    // 2. 播放控制按钮（上一曲、播放/暂停、下一曲）
-    QWidget* controlWidget = new QWidget();
-    QHBoxLayout* controlLayout = new QHBoxLayout(controlWidget);
-    controlLayout->setContentsMargins(10, 5, 10, 5);
-    controlLayout->setSpacing(5);
-    
-    QPushButton* trayPrevBtn = new QPushButton();
-    trayPrevBtn->setIcon(style()->standardIcon(QStyle::SP_MediaSkipBackward));
-    trayPrevBtn->setFixedSize(32, 32);
-    trayPrevBtn->setFlat(true);
-    connect(trayPrevBtn, &QPushButton::clicked, this, &MainWindow::onPreviousClicked);
-    
-    QPushButton* trayPlayPauseBtn = new QPushButton();
-    trayPlayPauseBtn->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
-    trayPlayPauseBtn->setFixedSize(36, 36);
-    trayPlayPauseBtn->setFlat(true);
-    trayPlayPauseBtn->setObjectName("trayPlayPauseBtn");
-    connect(trayPlayPauseBtn, &QPushButton::clicked, this, &MainWindow::onPlayPauseClicked);
-    
-    QPushButton* trayNextBtn = new QPushButton();
-    trayNextBtn->setIcon(style()->standardIcon(QStyle::SP_MediaSkipForward));
-    trayNextBtn->setFixedSize(32, 32);
-    trayNextBtn->setFlat(true);
-    connect(trayNextBtn, &QPushButton::clicked, this, &MainWindow::onNextClicked);
-    
-    controlLayout->addStretch();
-    controlLayout->addWidget(trayPrevBtn);
-    controlLayout->addWidget(trayPlayPauseBtn);
-    controlLayout->addWidget(trayNextBtn);
-    controlLayout->addStretch();
-    
-    QWidgetAction* controlAction = new QWidgetAction(this);
-    controlAction->setDefaultWidget(controlWidget);
-    m_trayMenu->addAction(controlAction);
-    
-    // 3. 音量滑块
-    QWidget* volumeWidget = new QWidget();
-    QHBoxLayout* volumeLayout = new QHBoxLayout(volumeWidget);
-    volumeLayout->setContentsMargins(10, 5, 10, 5);
-    
-    QLabel* volumeIcon = new QLabel();
-    volumeIcon->setPixmap(style()->standardIcon(QStyle::SP_MediaVolume).pixmap(16, 16));
-    
-    m_trayVolumeSlider = new QSlider(Qt::Horizontal);
-    m_trayVolumeSlider->setRange(0, 100);
-    m_trayVolumeSlider->setValue(70);
-    m_trayVolumeSlider->setMinimumWidth(120);
-    connect(m_trayVolumeSlider, &QSlider::valueChanged, this, &MainWindow::onVolumeChanged);
-    
-    volumeLayout->addWidget(volumeIcon);
-    volumeLayout->addWidget(m_trayVolumeSlider);
-    
-    QWidgetAction* volumeAction = new QWidgetAction(this);
-    volumeAction->setDefaultWidget(volumeWidget);
-    m_trayMenu->addAction(volumeAction);
-    
-    m_trayMenu->addSeparator();
-    // === 播放控制区域结束 ===
-    
-    m_trayMenu->addMenu(settingsMenu); // <--- 将“设置”子菜单添加到主菜单
-    m_trayMenu->addSeparator();
-    m_trayMenu->addAction(m_quitAction);
-
-    //创建系统托盘图标对象
-    m_trayIcon = new QSystemTrayIcon(this);
-    m_trayIcon->setIcon(QIcon(":/icons/appicon.ico"));
-    m_trayIcon->setToolTip("OldPlayer");
-    m_trayIcon->setContextMenu(m_trayMenu); // <-- 将我们正确创建的菜单设置给托盘
-
-    //连接托盘图标的点击信号
-    connect(m_trayIcon, &QSystemTrayIcon::activated, this, &MainWindow::onTrayIconActivated);
-    
-    //显示托盘图标
-    m_trayIcon->show();
-
-    //加载设置
-    QSettings settings;
-    if (settings.contains("geometry")) {
-        restoreGeometry(settings.value("geometry").toByteArray());
-    }
-    if (settings.contains("splitterState")) {
-        m_mainSplitter->restoreState(settings.value("splitterState").toByteArray());
-    }
-
-    QFont defaultListFont = m_playlistListWidget->font();
-
-    //从设置中加载字体，如果不存在则使用默认值
-    QFont savedFont = settings.value("listFont", defaultListFont).value<QFont>();
-    
-    //将加载的字体分别设置给两个列表控件
-    m_playlistListWidget->setFont(savedFont);
-    m_songListWidget->setFont(savedFont);
-
-    int savedVolume = settings.value("volume", 70).toInt();
-    m_volumeSlider->setValue(savedVolume);
-    m_trayVolumeSlider->setValue(savedVolume);
-
-    //加载播放模式
-    //加载列表内模式 (顺序/随机)
-    //枚举转换为整数进行存储。如果设置不存在，默认为 Sequential (0)
-    m_inListMode = static_cast<InListMode>(settings.value("inListMode", 
-                                            static_cast<int>(InListMode::Sequential)).toInt());
-    
-    //加载列表间模式 (循环/前进等)
-    //默认为 ListLoop (1)
-    m_crossListMode = static_cast<CrossListMode>(settings.value("crossListMode",
-                                                    static_cast<int>(CrossListMode::ListLoop)).toInt());
-
-    //加载完模式后，立即更新按钮的UI状态
-    updateInListModeButton();
-    updateCrossListModeButton();
-
-    //现在再更新列表视图
-    updatePlaylistView();
-    updateSongListView();
-}
-
-MainWindow::~MainWindow() {}
-
-void MainWindow::setupUI() {
-    setWindowTitle("OldPlayer");
-    resize(360, 840);  // 默认窗口尺寸 9:21 比例（竖向）
-    
-    m_centralWidget = new QWidget(this);
-    setCentralWidget(m_centralWidget);
-    
-    QVBoxLayout* mainLayout = new QVBoxLayout(m_centralWidget);
-    
-    // 顶部：当前播放信息
-    QGroupBox* infoGroup = new QGroupBox("正在播放", this);
-    QVBoxLayout* infoLayout = new QVBoxLayout(infoGroup);
-    
-    m_songTitleLabel = new QLabel("未选择歌曲", this);
-    m_songTitleLabel->setStyleSheet("font-size: 18px; font-weight: bold;");
-    m_songTitleLabel->setAlignment(Qt::AlignCenter);
-    
-    m_songArtistLabel = new QLabel("", this);
-    m_songArtistLabel->setStyleSheet("font-size: 12px; color: gray;");
-    m_songArtistLabel->setAlignment(Qt::AlignCenter);
-    
-    infoLayout->addWidget(m_songTitleLabel);
-    infoLayout->addWidget(m_songArtistLabel);
-    mainLayout->addWidget(infoGroup);
-    
-    // 进度条区域
-    QHBoxLayout* progressLayout = new QHBoxLayout();
-    m_currentTimeLabel = new QLabel("00:00", this);
-    m_progressSlider = new ClickableSlider(Qt::Horizontal, this);
-    m_totalTimeLabel = new QLabel("00:00", this);
-    
-    connect(m_progressSlider, &ClickableSlider::sliderMoved,
-            this, &MainWindow::onProgressSliderMoved);
-    
-    progressLayout->addWidget(m_currentTimeLabel);
-    progressLayout->addWidget(m_progressSlider);
-    progressLayout->addWidget(m_totalTimeLabel);
-    mainLayout->addLayout(progressLayout);
-    
-    // 控制按钮区域
-    QHBoxLayout* controlLayout = new QHBoxLayout();
-    controlLayout->addStretch();
-    
-    m_previousBtn = new QPushButton(this);
-    m_previousBtn->setIcon(style()->standardIcon(QStyle::SP_MediaSkipBackward));
-    m_previousBtn->setIconSize(QSize(32, 32));
-    connect(m_previousBtn, &QPushButton::clicked, 
-            this, &MainWindow::onPreviousClicked);
-    
-    m_playPauseBtn = new QPushButton(this);
-    m_playPauseBtn->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
-    m_playPauseBtn->setIconSize(QSize(32, 32));
-    connect(m_playPauseBtn, &QPushButton::clicked, 
-            this, &MainWindow::onPlayPauseClicked);
-    
-    m_nextBtn = new QPushButton(this);
-    m_nextBtn->setIcon(style()->standardIcon(QStyle::SP_MediaSkipForward));
-    m_nextBtn->setIconSize(QSize(32, 32));
-    connect(m_nextBtn, &QPushButton::clicked, 
-            this, &MainWindow::onNextClicked);
-    
-    // 创建【列表内模式】按钮 (顺序/随机)
-    m_inListModeBtn = new QPushButton(this);
-    m_inListModeBtn->setIconSize(QSize(28, 28));
-    connect(m_inListModeBtn, &QPushButton::clicked,
-            this, &MainWindow::onInListModeClicked);
-
-    // 创建【列表间模式】按钮 (循环/前进等)
-    m_crossListModeBtn = new QPushButton(this);
-    m_crossListModeBtn->setIconSize(QSize(28, 28));
-    connect(m_crossListModeBtn, &QPushButton::clicked,
-            this, &MainWindow::onCrossListModeClicked);
-
-
-    controlLayout->addWidget(m_previousBtn);
-    controlLayout->addWidget(m_playPauseBtn);
-    controlLayout->addWidget(m_nextBtn);
-    controlLayout->addWidget(m_inListModeBtn);
-    controlLayout->addWidget(m_crossListModeBtn);
-    controlLayout->addStretch();
-    mainLayout->addLayout(controlLayout);
-    
-    // 音量控制
-    QHBoxLayout* volumeLayout = new QHBoxLayout();
-    volumeLayout->addStretch();
-    QLabel* volumeLabel = new QLabel("音量:", this);
-    m_volumeSlider = new ClickableSlider(Qt::Horizontal, this);
-    m_volumeSlider->setRange(0, 100);
-    m_volumeSlider->setValue(70);
-    connect(m_volumeSlider, &ClickableSlider::valueChanged,
-            this, &MainWindow::onVolumeChanged);
-    
-    volumeLayout->addWidget(volumeLabel);
-    volumeLayout->addWidget(m_volumeSlider);
-    volumeLayout->addStretch();
-    mainLayout->addLayout(volumeLayout);
-    
-
-    // 使用 QSplitter 来创建可拖动的左右两个面板
-    m_mainSplitter = new QSplitter(Qt::Horizontal, this);
-    m_mainSplitter->setChildrenCollapsible(false);
-
-    // --- 左侧面板：播放列表 ---
-    QWidget* leftPanel = new QWidget(m_mainSplitter); 
-    QVBoxLayout* leftLayout = new QVBoxLayout(leftPanel);
-    leftLayout->setContentsMargins(0, 0, 0, 0); // 无边距
-
-    QGroupBox* playlistGroup = new QGroupBox("播放列表", this);
-    QVBoxLayout* playlistGroupLayout = new QVBoxLayout(playlistGroup);
-    
-    m_playlistListWidget = new PlaylistListWidget(this);
-    //为播放列表启用多选功能
-    m_playlistListWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
-
-    m_playlistListWidget->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(m_playlistListWidget, &QListWidget::currentRowChanged,
-            this, &MainWindow::onPlaylistSelectionChanged);
-    connect(m_playlistListWidget, &PlaylistListWidget::foldersDropped,
-            this, &MainWindow::onFoldersDropped);
-    connect(m_playlistListWidget, &QWidget::customContextMenuRequested,
-            this, &MainWindow::onPlaylistContextMenuRequested);
-            
-    playlistGroupLayout->addWidget(m_playlistListWidget);
-
-    leftLayout->addWidget(playlistGroup);
-
-
-    // --- 右侧面板：歌曲列表 ---
-    QWidget* rightPanel = new QWidget(m_mainSplitter);
-    QVBoxLayout* rightLayout = new QVBoxLayout(rightPanel);
-    rightLayout->setContentsMargins(0, 0, 0, 0);
-
-    QGroupBox* songListGroup = new QGroupBox("歌曲列表", this);
-    QVBoxLayout* songListLayout = new QVBoxLayout(songListGroup);
-
-    m_songListWidget = new SongListWidget(this);
-    //为歌曲列表启用多选功能
-    m_songListWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
-    m_songListWidget->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(m_songListWidget, &QListWidget::itemDoubleClicked,
-            this, &MainWindow::onSongDoubleClicked);
-    connect(m_songListWidget, &SongListWidget::filesDropped,
-            this, &MainWindow::onFilesDroppedToSongList);
-    connect(m_songListWidget, &QWidget::customContextMenuRequested,
-            this, &MainWindow::onSongListContextMenuRequested);
-    
-    songListLayout->addWidget(m_songListWidget);
-    rightLayout->addWidget(songListGroup);
-    
-    // 现代滚动条样式
-    QString modernScrollBarStyle = R"(
-        QScrollBar:vertical {
-            background: transparent;
-            width: 8px;
-            margin: 0;
-            border-radius: 4px;
-        }
-        QScrollBar::handle:vertical {
-            background: #888888;
-            min-height: 30px;
-            border-radius: 4px;
-        }
-        QScrollBar::handle:vertical:hover {
-            background: #666666;
-        }
-        QScrollBar::add-line:vertical, QScrollBar::sub-line:vertical {
-            height: 0;
-            background: none;
-        }
-        QScrollBar::add-page:vertical, QScrollBar::sub-page:vertical {
-            background: none;
-        }
-        QScrollBar:horizontal {
-            background: transparent;
-            height: 8px;
-            margin: 0;
-            border-radius: 4px;
-        }
-        QScrollBar::handle:horizontal {
-            background: #888888;
-            min-width: 30px;
-            border-radius: 4px;
-        }
-        QScrollBar::handle:horizontal:hover {
-            background: #666666;
-        }
-        QScrollBar::add-line:horizontal, QScrollBar::sub-line:horizontal {
-            width: 0;
-            background: none;
-        }
-        QScrollBar::add-page:horizontal, QScrollBar::sub-page:horizontal {
-            background: none;
-        }
-    )";
-    
-    m_playlistListWidget->setStyleSheet(modernScrollBarStyle);
-    m_songListWidget->setStyleSheet(modernScrollBarStyle);
-
-    // 将左右面板添加到 Splitter
-    m_mainSplitter->addWidget(leftPanel);
-    m_mainSplitter->addWidget(rightPanel);
-    m_mainSplitter->setStretchFactor(0, 1); // 左侧面板拉伸因子
-    m_mainSplitter->setStretchFactor(1, 3); // 右侧面板拉伸因子 (使其更宽)
-
-    // 将 Splitter 添加到主布局
-    mainLayout->addWidget(m_mainSplitter);
-
-    mainLayout->setStretch(mainLayout->indexOf(m_mainSplitter), 1);
-
-    // 设置初始音量
-    m_audioOutput->setVolume(0.7);
-}
-
-void MainWindow::onInListModeClicked() {
-    if (m_inListMode == InListMode::Sequential) {
-        m_inListMode = InListMode::Random;
-        generateShuffledPlaylist(); // 切换到随机时生成列表
-    } else {
-        m_inListMode = InListMode::Sequential;
-        m_shuffledIndices.clear(); // 离开随机时清空列表
-    }
-    updateInListModeButton();
-}
-
-void MainWindow::onCrossListModeClicked() {
-    switch (m_crossListMode) {
-        case CrossListMode::ListLoop:
-            m_crossListMode = CrossListMode::SingleLoop;
-            break;
-        case CrossListMode::SingleLoop:
-            m_crossListMode = CrossListMode::Advance;
-            break;
-        case CrossListMode::Advance:
-            m_crossListMode = CrossListMode::ListLoop;
-            break;
-        // 'Stop' 模式不在此循环中，可以通过设置界面添加
-        case CrossListMode::Stop:
-            m_crossListMode = CrossListMode::ListLoop;
-            break;
-    }
-    updateCrossListModeButton();
-}
-
-
-// ↓↓↓ 实现新的函数，根据当前模式更新按钮的UI ↓↓↓
-void MainWindow::updateInListModeButton() {
-    if (m_inListMode == InListMode::Sequential) {
-    // 自定义图标
-        m_inListModeBtn->setIcon(QIcon(":/icons/sequential.png"));
-        m_inListModeBtn->setToolTip("顺序播放");
-    } else {
-    // 自定义图标
-        m_inListModeBtn->setIcon(QIcon(":/icons/random.png"));
-        m_inListModeBtn->setToolTip("随机播放");
-    }
-}
-
-// ↓↓↓ 修改 updateCrossListModeButton 函数 ↓↓↓
-void MainWindow::updateCrossListModeButton() {
-    switch (m_crossListMode) {
-        case CrossListMode::ListLoop:
-            m_crossListModeBtn->setIcon(QIcon(":/icons/listloop.png"));
-            m_crossListModeBtn->setToolTip("列表循环");
-            break;
-        case CrossListMode::SingleLoop:
-            m_crossListModeBtn->setIcon(QIcon(":/icons/singleloop.png"));
-            m_crossListModeBtn->setToolTip("单曲循环");
-            break;
-        case CrossListMode::Advance:
-            m_crossListModeBtn->setIcon(QIcon(":/icons/advance.png"));
-            m_crossListModeBtn->setToolTip("列表顺序");
-            break;
-        case CrossListMode::Stop:
-            // 如果您也为 Stop 模式准备了图标
-            // m_crossListModeBtn->setIcon(QIcon(":/icons/stop.png"));
-            m_crossListModeBtn->setIcon(style()->standardIcon(QStyle::SP_MediaStop));
-            m_crossListModeBtn->setToolTip("播完停止");
-            break;
-}
-}
-
-void MainWindow::closeEvent(QCloseEvent *event)
-{
-    if (this->isVisible() && m_trayIcon->isVisible()) {
-        // 隐藏主窗口到托盘，不保存设置（仅在真正退出时保存）
-        this->hide();
-        event->ignore();
-        return;  // 隐藏时直接返回，不保存geometry
-    }
-    
-    // 只有在真正退出时才保存设置
-    QSettings settings;
-    
-    // 保存窗口的几何信息（位置和大小）
-    settings.setValue("geometry", saveGeometry());
-    
-    // 保存 Splitter 的状态（两个面板的相对大小）
-    settings.setValue("splitterState", m_mainSplitter->saveState());
-
-    // 保存当前音量滑块的值
-    settings.setValue("volume", m_volumeSlider->value());
-
-    settings.setValue("lastPlaylistIndex", m_currentPlaylistIndex);
-    settings.setValue("lastSongIndex", m_currentSongIndex);
-
-    settings.setValue("inListMode", static_cast<int>(m_inListMode));
-    settings.setValue("crossListMode", static_cast<int>(m_crossListMode));
-
-    // 调用基类的 closeEvent，确保窗口能正常关闭
-    QMainWindow::closeEvent(event);
-}
-
-void MainWindow::onTrayIconActivated(QSystemTrayIcon::ActivationReason reason)
-{
-    // 我们只关心单击事件 (Trigger)，忽略双击、中键点击等
-    if (reason == QSystemTrayIcon::Trigger) {
-        
-        // 判断当前窗口是否可见（或者是否被最小化了）
-        // isMinimized() 对于隐藏的窗口返回 false，所以需要 isVisible() 一起判断
-        if (this->isVisible() && !this->isMinimized()) {
-            // --- 情况A: 窗口当前是可见且正常的 ---
-            //缩回托盘，隐藏窗口
-            this->hide();
-            
-        } else {
-            // --- 情况B: 窗口当前是隐藏的，或是最小化状态 ---
-            //跳到最前
-            
-            //确保窗口可见（如果是 hide() 状态，则显示）
-            this->show();
-            
-            //恢复窗口状态（如果是最小化，则恢复正常）
-            this->setWindowState(windowState() & ~Qt::WindowMinimized);
-            
-            //提升并激活窗口
-            this->raise();
-            this->activateWindow();
-        }
-    }
-}
-
-void MainWindow::updatePlaylistView() {
-    // 阻止信号触发，防止在更新UI时循环调用槽函数
-    m_playlistListWidget->blockSignals(true);
-    
-    m_playlistListWidget->clear();
-    for (const Playlist* pl : m_playlistManager->getPlaylists()) {
-        m_playlistListWidget->addItem(
-            QString("%1 (%2)").arg(pl->getName()).arg(pl->songCount())
-        );
-    }
-
-    // 恢复当前选择
-    if (m_currentPlaylistIndex >= 0 && m_currentPlaylistIndex < m_playlistListWidget->count()) {
-        m_playlistListWidget->setCurrentRow(m_currentPlaylistIndex);
-    }
-    
-    m_playlistListWidget->blockSignals(false);
-}
-
-void MainWindow::updateSongListView() {
-    m_songListWidget->clear();
-    
-    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    if (!playlist) return;
-
-    QListWidgetItem* itemToScrollTo = nullptr;
-
-    int index = 0;
-    for (const Song& song : playlist->getSongs()) {
-        // 显示格式: 歌手 - 歌曲名
-        QString itemText = QString("%1 - %2").arg(song.artist, song.title);
-        
-        // --- 2. 创建列表项 ---
-        QListWidgetItem* item = new QListWidgetItem(itemText);
-        item->setData(Qt::UserRole, index);
-        
-        // 检查当前UI选中的列表(m_currentPlaylistIndex)是否就是正在播放的列表(m_playingPlaylistIndex)
-        // 并且，当前歌曲的索引(index)是否就是正在播放的歌曲的索引(m_currentSongIndex)
-        if (m_currentPlaylistIndex == m_playingPlaylistIndex && index == m_currentSongIndex) {
-            item->setFont(m_playingSongFont);
-            item->setBackground(QColor("#5E81AC"));
-            item->setForeground(QColor("#ECEFF4"));
-            itemToScrollTo = item;
-        } else {
-            item->setBackground(Qt::NoBrush);
-        }
-        
-        m_songListWidget->addItem(item);
-        index++;
-    }
-    
-    // --- 5. 执行滚动 ---
-    if (itemToScrollTo) {
-        m_songListWidget->scrollToItem(itemToScrollTo, QAbstractItemView::PositionAtCenter);
-    }
-}
-
-// 读取播放列表内所有歌曲的元数据（仅读取未加载的歌曲以提高效率）
-void MainWindow::loadPlaylistMetaData(int playlistIndex) {
-    Playlist* playlist = m_playlistManager->getPlaylist(playlistIndex);
-    if (!playlist) return;
-    
-    const QList<Song>& songs = playlist->getSongs();
-    bool hasNewMetaData = false;  // 标记是否有新的元数据被加载
-    
-    for (int i = 0; i < songs.size(); ++i) {
-        const Song& song = songs[i];
-        
-        // 如果歌曲已有元数据（不是"未知艺术家"），跳过读取
-        if (song.artist != "未知艺术家") {
-            continue;
-        }
-        
-        // 使用 TagLib 读取文件元数据
-        TagLib::FileRef file(song.filePath.toStdWString().c_str());
-        
-        if (!file.isNull() && file.tag()) {
-            TagLib::Tag* tag = file.tag();
-            
-            QString title = QString::fromStdWString(tag->title().toWString());
-            QString artist = QString::fromStdWString(tag->artist().toWString());
-            QString album = QString::fromStdWString(tag->album().toWString());
-            
-            // 如果元数据为空，使用文件名作为标题
-            if (title.isEmpty()) {
-                title = song.title;  // 保持原来从文件名提取的标题
-            }
-            if (artist.isEmpty()) {
-                artist = "未知艺术家";
-            }
-            if (album.isEmpty()) {
-                album = "未知专辑";
-            }
-            
-            // 更新歌曲元数据
-            playlist->updateSongMetaData(i, title, artist, album);
-            hasNewMetaData = true;
-        }
-    }
-    
-    // 如果有新的元数据被加载，保存播放列表以便下次使用
-    if (hasNewMetaData) {
-        m_playlistManager->savePlaylists();
-    }
-}
-
-void MainWindow::playSong(int index) {
-    m_playingPlaylistIndex = m_currentPlaylistIndex; 
-    
-    Playlist* playlist = m_playlistManager->getPlaylist(m_playingPlaylistIndex); // 使用 m_playingPlaylistIndex 获取
-    if (!playlist || index < 0 || index >= playlist->songCount()) {
-        // 如果播放失败，重置状态
-        m_playingPlaylistIndex = -1; 
-        return;
-    }
-    
-    Song song = playlist->getSong(index);
-    m_currentSongIndex = index;
-    
-    m_player->setSource(QUrl::fromLocalFile(song.filePath));
-    m_player->play();
-    
-    m_songTitleLabel->setText(song.title);
-    m_songArtistLabel->setText(song.artist);
-    
-    // 更新托盘菜单的歌曲名
-    m_traySongLabel->setText(song.title);
-    
-    // 更新托盘图标悬浮提示
-    m_trayIcon->setToolTip(QString("%1 - %2").arg(song.artist, song.title));
-    
-    //直接调用 updateSongListView()
-    // 这个函数现在已经包含了高亮和滚动的所有逻辑，一举两得
-    updateSongListView();
-    
-    updatePlayPauseButton();
-}
-
-void MainWindow::updatePlayPauseButton() {
-    // 更新托盘菜单的播放/暂停按钮图标
-    QPushButton* trayPlayPauseBtn = m_trayMenu->findChild<QPushButton*>("trayPlayPauseBtn");
-    
-    if (m_player->playbackState() == QMediaPlayer::PlayingState) {
-        m_playPauseBtn->setIcon(style()->standardIcon(QStyle::SP_MediaPause));
-        if (trayPlayPauseBtn) {
-            trayPlayPauseBtn->setIcon(style()->standardIcon(QStyle::SP_MediaPause));
-        }
-    } else {
-        m_playPauseBtn->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
-        if (trayPlayPauseBtn) {
-            trayPlayPauseBtn->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
-        }
-    }
-}
-
-QString MainWindow::formatTime(qint64 milliseconds) {
-    int seconds = milliseconds / 1000;
-    int minutes = seconds / 60;
-    seconds = seconds % 60;
-    return QString("%1:%2")
-        .arg(minutes, 2, 10, QChar('0'))
-        .arg(seconds, 2, 10, QChar('0'));
-}
-
-void MainWindow::onPlayPauseClicked() {
-    if (m_currentSongIndex < 0) {
-        playSong(0);
-        return;
-    }
-    
-    if (m_player->playbackState() == QMediaPlayer::PlayingState) {
-        m_player->pause();
-    } else {
-        m_player->play();
-    }
-    updatePlayPauseButton();
-}
-
-void MainWindow::onPreviousClicked() {
-    if (m_currentSongIndex > 0) {
-        playSong(m_currentSongIndex - 1);
-    }
-}
-
-void MainWindow::onNextClicked() {
-    playNextSong();
-}
-
-
-// ↓↓↓ 新增辅助函数，封装“播放下一曲”的全部逻辑 ↓↓↓
-// ↓↓↓ 实现新的核心逻辑函数 playNextSong ↓↓↓
-void MainWindow::playNextSong() {
-    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    if (!playlist || playlist->songCount() == 0) {
-        return;
-    }
-
-    // --- 第 1 部分：决定列表内的下一首歌曲索引 ---
-    int nextIndexInList = -1;
-    bool isListFinished = false;
-
-    if (m_crossListMode == CrossListMode::SingleLoop) {
-        // 对于单曲循环，下一首永远是当前这首
-        nextIndexInList = m_currentSongIndex;
-    } else if (m_inListMode == InListMode::Random) {
-        // 随机模式
-        m_shuffledPlaybackIndex++;
-        if (m_shuffledPlaybackIndex < m_shuffledIndices.size()) {
-            nextIndexInList = m_shuffledIndices.at(m_shuffledPlaybackIndex);
-        } else {
-            isListFinished = true; // 随机列表已播完
-        }
-    } else { // 顺序模式
-        if (m_currentSongIndex + 1 < playlist->songCount()) {
-            nextIndexInList = m_currentSongIndex + 1;
-        } else {
-            isListFinished = true; // 顺序列表已播完
-        }
-    }
-
-    // --- 第 2 部分：根据列表是否播完，以及列表间过渡模式，决定最终动作 ---
-    if (!isListFinished) {
-        // 情况 A: 列表还没播完，直接播放下一首
-        playSong(nextIndexInList);
-    } else {
-        // 情况 B: 列表已经播完了
-        switch (m_crossListMode) {
-            case CrossListMode::ListLoop:
-                // 重新开始当前列表的第一首歌
-                if (m_inListMode == InListMode::Random) {
-                    generateShuffledPlaylist(); // 重新生成随机顺序
-                    playSong(m_shuffledIndices.at(0));
-                } else {
-                    playSong(0); // 播放顺序第一首
-                }
-                break;
-            
-            case CrossListMode::Advance:
-                // 切换到下一个播放列表
-                {
-                    int nextPlaylistIndex = (m_currentPlaylistIndex + 1) % m_playlistManager->playlistCount();
-                    m_playlistListWidget->setCurrentRow(nextPlaylistIndex);
-                    // setCurrentRow 会触发 onPlaylistSelectionChanged, 
-                    // 它会更新 m_currentPlaylistIndex 并刷新歌曲列表
-                    
-                    // 自动播放新列表的第一首歌
-                    // 需要稍作延迟，等待 onPlaylistSelectionChanged 完成
-                    QTimer::singleShot(50, this, [this]() {
-                        Playlist* newPlaylist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-                        if (newPlaylist && newPlaylist->songCount() > 0) {
-                             if (m_inListMode == InListMode::Random) {
-                                generateShuffledPlaylist();
-                                playSong(m_shuffledIndices.at(0));
-                             } else {
-                                playSong(0);
-                             }
-                        }
-                    });
-                }
-                break;
-
-            case CrossListMode::SingleLoop:
-                // 理论上 isListFinished 为 true 时不会进入这里，
-                // 但为保险起见，我们还是让它循环当前这首
-                playSong(m_currentSongIndex);
-                break;
-
-            case CrossListMode::Stop:
-                // 播完停止，什么都不做
-                break;
-        }
-    }
-}
-
-// ↓↓↓ 实现新增的辅助函数，用于生成随机播放顺序 ↓↓↓
-void MainWindow::generateShuffledPlaylist() {
-    m_shuffledIndices.clear();
-    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    if (!playlist || playlist->songCount() == 0) {
-        return;
-    }
-
-    // 创建一个从 0 到 n-1 的顺序列表
-    for (int i = 0; i < playlist->songCount(); ++i) {
-        m_shuffledIndices.append(i);
-    }
-    
-    // 使用 C++11 的标准方法来打乱列表，这比旧的 rand() 效果更好
-    std::shuffle(m_shuffledIndices.begin(), m_shuffledIndices.end(), *QRandomGenerator::global());
-
-    m_shuffledPlaybackIndex = 0; // 重置随机播放的起始位置
-    qDebug() << "生成新的随机播放顺序:" << m_shuffledIndices;
-}
-
-
-void MainWindow::onAddSongsClicked() {
-    QStringList files = QFileDialog::getOpenFileNames(
-        this,
-        "选择音乐文件",
-        QDir::homePath(),
-        "音频文件 (*.mp3 *.wav *.ogg *.flac *.m4a);;所有文件 (*.*)"
-    );
-    
-    if (files.isEmpty()) return;
-    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    if (!playlist) return;
-    for (const QString& file : files) {
-        playlist->addSong(Song(QDir::toNativeSeparators(file)));
-    }
-    
-    updatePlaylistView();
-    updateSongListView();
-    
-    // 如果当前是随机模式，则重新生成随机列表
-    if (m_inListMode == InListMode::Random) {
-        generateShuffledPlaylist();
-    }
-}
-
-void MainWindow::onCreatePlaylistClicked() {
-    bool ok;
-    QString name = QInputDialog::getText(
-        this,
-        "新建播放列表",
-        "请输入播放列表名称:",
-        QLineEdit::Normal,
-        "新建列表",
-        &ok
-    );
-    
-    if (ok && !name.isEmpty()) {
-        m_playlistManager->addPlaylist(name);
-        updatePlaylistView();
-        // 自动选中新创建的列表
-        m_playlistListWidget->setCurrentRow(m_playlistManager->playlistCount() - 1);
-    }
-}
-
-void MainWindow::onDeletePlaylistClicked() {
-    //获取所有被选中的项
-    QList<QListWidgetItem*> selectedItems = m_playlistListWidget->selectedItems();
-    if (selectedItems.isEmpty()) {
-        return; // 如果没有选中项，则不执行任何操作
-    }
-
-    //将项转换为行号索引
-    QList<int> indicesToDelete;
-    for (QListWidgetItem* item : selectedItems) {
-        indicesToDelete.append(m_playlistListWidget->row(item));
-    }
-    
-    //对索引进行降序排序
-    //必须从后往前删除，否则前面的索引会失效
-    std::sort(indicesToDelete.begin(), indicesToDelete.end(), std::greater<int>());
-
-    //执行删除
-    for (int index : indicesToDelete) {
-        // 确保不会删除最后一个播放列表
-        if (m_playlistManager->playlistCount() > 1) {
-            m_playlistManager->removePlaylist(index);
-        } else {
-            QMessageBox::warning(this, "警告", "至少需要保留一个播放列表！");
-            break; // 停止继续删除
-        }
-    }
-    
-    //更新状态和UI
-    m_currentPlaylistIndex = 0;
-    m_currentSongIndex = -1;
-    resetPlayerState(); // 批量删除后最好重置播放器
-    updatePlaylistView();
-    updateSongListView();
-
-    // 如果是随机模式，重新生成
-    if (m_inListMode == InListMode::Random) {
-        generateShuffledPlaylist();
-    }
-}
-
-void MainWindow::onPlaylistSelectionChanged() {
-    int index = m_playlistListWidget->currentRow();
-    // 当用户选择的行无效，或者没有真正改变时，直接返回
-    if (index < 0 || index == m_currentPlaylistIndex) {
-        return; 
-    }
-    
-    // 更新当前播放列表的索引
-    m_currentPlaylistIndex = index;
-    
-    // 读取该播放列表内所有歌曲的元数据
-    loadPlaylistMetaData(index);
-
-    // 根据新的 m_currentPlaylistIndex 更新右侧的歌曲列表视图
-    updateSongListView();
-}
-
-void MainWindow::onSongDoubleClicked(QListWidgetItem* item) {
-    int index = item->data(Qt::UserRole).toInt();
-    playSong(index);
-}
-
-void MainWindow::onPositionChanged(qint64 position) {
-    m_progressSlider->setValue(position);
-    m_currentTimeLabel->setText(formatTime(position));
-}
-
-void MainWindow::onDurationChanged(qint64 duration) {
-    m_progressSlider->setRange(0, duration);
-    m_totalTimeLabel->setText(formatTime(duration));
-}
-
-void MainWindow::onProgressSliderMoved(int position) {
-    m_player->setPosition(position);
-}
-
-void MainWindow::onVolumeChanged(int value) {
-    // a. 设置播放器的实际音量
-    m_audioOutput->setVolume(value / 100.0);
-
-    // b. 同步两个音量滑块的值（防止循环调用）
-    if (m_volumeSlider->value() != value) {
-        m_volumeSlider->blockSignals(true);
-        m_volumeSlider->setValue(value);
-        m_volumeSlider->blockSignals(false);
-    }
-    if (m_trayVolumeSlider && m_trayVolumeSlider->value() != value) {
-        m_trayVolumeSlider->blockSignals(true);
-        m_trayVolumeSlider->setValue(value);
-        m_trayVolumeSlider->blockSignals(false);
-    }
-
-    // c. 在当前鼠标光标位置显示一个临时的百分比提示
-    QString tooltipText = QString("音量: %1%").arg(value);
-    QToolTip::showText(QCursor::pos(), tooltipText, m_volumeSlider);
-}
-
-void MainWindow::onMediaStatusChanged(QMediaPlayer::MediaStatus status) {
-    if (status == QMediaPlayer::EndOfMedia) {
-        // 当一首歌自然播放结束时，调用播放下一首的逻辑
-        playNextSong();
-    }
-    updatePlayPauseButton();
-}
-
-void MainWindow::onMetaDataChanged() {
-    if (m_currentSongIndex < 0) return;
-
-    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    if (!playlist) return;
-
-    // 获取元数据
-    QMediaMetaData metaData = m_player->metaData();
-
-    QString title = metaData.value(QMediaMetaData::Title).toString();
-    QString artist = metaData.value(QMediaMetaData::AlbumArtist).toString();
-    if (artist.isEmpty()) {
-        artist = metaData.value(QMediaMetaData::ContributingArtist).toString();
-    }
-    QString album = metaData.value(QMediaMetaData::AlbumTitle).toString();
-
-    // 使用新函数来更新播放列表中的歌曲数据
-    playlist->updateSongMetaData(m_currentSongIndex, title, artist, album);
-
-    // 从播放列表重新获取更新后的歌曲信息
-    Song updatedSong = playlist->getSong(m_currentSongIndex);
-    
-    // 更新 UI 显示
-    m_songTitleLabel->setText(updatedSong.title);
-    m_songArtistLabel->setText(updatedSong.artist);
-
-    // 刷新歌曲列表视图，以显示更新后的信息
-    updateSongListView();
-}
-
-void MainWindow::onFilesDroppedToSongList(const QList<QUrl>& urls) {
-    Playlist* currentPlaylist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    if (!currentPlaylist) {
-        return;
-    }
-
-    for (const QUrl& url : urls) {
-        currentPlaylist->addSong(Song(url.toLocalFile()));
-    }
-
-    updatePlaylistView(); // 更新播放列表的歌曲计数
-    updateSongListView();
-
-    // 如果是随机模式，重新生成随机列表
-    if (m_inListMode == InListMode::Random) {
-        generateShuffledPlaylist();
-    }
-}
-
-void MainWindow::onFoldersDropped(const QList<QUrl>& urls) {
-    qDebug() << "--- Folders Dropped Event ---";
-    qDebug() << "接收到" << urls.size() << "个拖放项目。";
-    
-    // 定义我们支持的音频文件后缀名过滤器
-    QStringList supportedExtensions = {"*.mp3", "*.flac", "*.wav", "*.ogg", "*.m4a"};
-
-    for (const QUrl& url : urls) {
-        QString folderPath = url.toLocalFile();
-        QFileInfo folderInfo(folderPath);
-
-        // 安全检查：确保拖进来的是一个真实存在的目录
-        if (!folderInfo.isDir()) {
-            qDebug() << "跳过非目录项目:" << folderPath;
-            continue; // 继续处理下一个拖放项目
-        }
-
-        // 1. 使用文件夹名创建新的播放列表
-        QString playlistName = folderInfo.fileName();
-        qDebug() << "正在创建播放列表:" << playlistName;
-        m_playlistManager->addPlaylist(playlistName);
-        
-        // 2. 获取刚刚创建的播放列表的指针
-        int newPlaylistIndex = m_playlistManager->playlistCount() - 1;
-        Playlist* newPlaylist = m_playlistManager->getPlaylist(newPlaylistIndex);
-        if (!newPlaylist) {
-            qWarning() << "错误：无法获取新创建的播放列表！";
-            continue;
-        }
-
-        // 3. 核心步骤：使用 QDirIterator 递归扫描文件夹
-        qDebug() << "开始扫描文件夹:" << folderPath;
-        int songsFound = 0;
-        // 创建一个迭代器，它会查找指定目录（包括所有子目录）中所有符合后缀名过滤器的文件
-        QDirIterator it(folderPath, supportedExtensions, QDir::Files, QDirIterator::Subdirectories);
-        
-        // 循环直到迭代器找不到更多文件
-        while (it.hasNext()) {
-            // 获取下一个文件的完整路径
-            QString filePath = it.next();
-            // 添加到播放列表中
-            newPlaylist->addSong(Song(filePath));
-            songsFound++;
-            qDebug() << "  (+) 已添加:" << filePath; // 打印出每个找到的文件
-        }
-        qDebug() << "扫描完成。在" << playlistName << "中总共找到并添加了" << songsFound << "首歌曲。";
-    }
-    
-    // 4. 所有文件夹都处理完毕后，一次性更新UI
-    updatePlaylistView();
-    // 自动选中我们最后创建的那个播放列表
-    if (m_playlistManager->playlistCount() > 0) {
-        m_playlistListWidget->setCurrentRow(m_playlistManager->playlistCount() - 1);
-    }
-    qDebug() << "UI更新完成。";
-    qDebug() << "--------------------------";
-}
-
-void MainWindow::onPlaylistContextMenuRequested(const QPoint& pos) {
-    QMenu contextMenu(this);
-
-    // 创建动作
-    QAction* createAction = contextMenu.addAction("新建播放列表");
-    QAction* deleteAction = contextMenu.addAction("删除选中列表");
-
-    // 左侧菜单：排序播放列表
-    contextMenu.addSeparator();
-    QAction* sortAction = contextMenu.addAction("列表按名称排序");
-
-    // 逻辑判断：只有当选中了一个列表，并且总列表数大于1时，才允许删除
-    if (m_playlistListWidget->currentRow() < 0 || m_playlistManager->playlistCount() <= 1) {
-        deleteAction->setEnabled(false);
-    }
-
-    // 如果列表总数少于2个，也没必要排序
-    if (m_playlistManager->playlistCount() < 2) {
-        sortAction->setEnabled(false);
-    }
-
-    // 将动作的 triggered 信号连接到已有的槽函数
-    connect(createAction, &QAction::triggered, this, &MainWindow::onCreatePlaylistClicked);
-    connect(deleteAction, &QAction::triggered, this, &MainWindow::onDeletePlaylistClicked);
-    // 连接到“排序播放列表”的槽函数
-    connect(sortAction, &QAction::triggered, this, &MainWindow::onSortPlaylistsAction);
-
-    // 在鼠标光标位置显示菜单
-    // mapToGlobal 将控件的局部坐标转换为屏幕的全局坐标
-    contextMenu.exec(m_playlistListWidget->mapToGlobal(pos));
-}
-
-// 当在歌曲列表上右键点击时调用
-void MainWindow::onSongListContextMenuRequested(const QPoint& pos) {
-    QMenu contextMenu(this);
-
-    QAction* addAction = contextMenu.addAction("添加歌曲...");
-
-    // 右侧菜单：排序歌曲
-    contextMenu.addSeparator();
-    QAction* sortAction = contextMenu.addAction("歌曲按名称排序");
-
-    // 获取当前列表
-    Playlist* currentPlaylist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    if (!currentPlaylist || currentPlaylist->songCount() < 2) {
-        sortAction->setEnabled(false);
-    }
-    
-    // 只有当用户确实选中了一首歌曲时，才显示删除相关的选项
-    if (m_songListWidget->currentItem() != nullptr) {
-        contextMenu.addSeparator(); // 添加一条分割线，让UI更清晰
-        
-        // 编辑歌曲信息选项
-        QAction* editInfoAction = contextMenu.addAction("编辑歌曲信息...");
-        connect(editInfoAction, &QAction::triggered, this, &MainWindow::onEditSongInfoClicked);
-        
-        // 音频转码选项
-        QAction* transcodeAction = contextMenu.addAction("音频转码...");
-        connect(transcodeAction, &QAction::triggered, this, &MainWindow::onTranscodeAudioClicked);
-        
-        contextMenu.addSeparator();
-        QAction* deleteAction = contextMenu.addAction("删除列表中的歌曲");
-        QAction* deleteFromDiskAction = contextMenu.addAction("删除磁盘中的歌曲");
-        connect(deleteAction, &QAction::triggered, this, &MainWindow::onDeleteSongClicked);
-        connect(deleteFromDiskAction, &QAction::triggered, this, &MainWindow::onDeleteSongFromDiskClicked);
-    }
-    
-    connect(addAction, &QAction::triggered, this, &MainWindow::onAddSongsClicked);
-    // 连接到“排序歌曲”的槽函数
-    connect(sortAction, &QAction::triggered, this, &MainWindow::onSortSongsAction);
-    
-    contextMenu.exec(m_songListWidget->mapToGlobal(pos));
-}
-
-// ↓↓↓ 在文件末尾添加两个新函数的实现 ↓↓↓
-
-// 实现重置播放器状态的辅助函数
-void MainWindow::resetPlayerState() {
-    m_player->stop();
-    m_songTitleLabel->setText("未选择歌曲");
-    m_songArtistLabel->setText("");
-    m_currentTimeLabel->setText("00:00");
-    m_totalTimeLabel->setText("00:00");
-    m_progressSlider->setValue(0);
-    
-    // ↓↓↓ ★★★ 核心修改：重置播放器时，必须同时重置所有相关状态 ★★★ ↓↓↓
-    int oldPlayingPlaylistIndex = m_playingPlaylistIndex;
-    m_currentSongIndex = -1;
-    m_playingPlaylistIndex = -1;
-    
-    updatePlayPauseButton();
-
-    // 如果之前有高亮的列表，现在需要刷新它以移除高亮
-    if (oldPlayingPlaylistIndex == m_currentPlaylistIndex) {
-        updateSongListView();
-    }
-}
-
-// 实现删除歌曲的槽函数
-void MainWindow::onDeleteSongClicked() {
-    //获取所有被选中的项
-    QList<QListWidgetItem*> selectedItems = m_songListWidget->selectedItems();
-    if (selectedItems.isEmpty()) {
-        return;
-    }
-    
-    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    if (!playlist) {
-        return;
-    }
-
-    //将项转换为行号索引
-    QList<int> indicesToDelete;
-    for (QListWidgetItem* item : selectedItems) {
-        // 将索引存在 UserRole 数据中，这样更可靠
-        indicesToDelete.append(item->data(Qt::UserRole).toInt());
-    }
-    
-    //对索引进行降序排序
-    std::sort(indicesToDelete.begin(), indicesToDelete.end(), std::greater<int>());
-
-    bool currentPlayerSongRemoved = false;
-
-    //执行删除
-    for (int index : indicesToDelete) {
-        // 检查是否删除了正在播放的歌曲
-        if (index == m_currentSongIndex) {
-            currentPlayerSongRemoved = true;
-        } else if (index < m_currentSongIndex) {
-            // 如果删除的歌曲在当前播放歌曲的前面，索引要-1
-            m_currentSongIndex--;
-        }
-        playlist->removeSong(index);
-    }
-    
-    //如果当前播放的歌曲被删了，自动播放下一首
-    if (currentPlayerSongRemoved) {
-        // 先保存要播放的下一首索引（在重置之前）
-        int nextIndex = m_currentSongIndex;
-        if (nextIndex >= playlist->songCount()) {
-            nextIndex = playlist->songCount() - 1;
-        }
-        
-        resetPlayerState();
-        
-        // 如果列表还有歌曲，自动播放下一首
-        if (playlist->songCount() > 0 && nextIndex >= 0) {
-            QTimer::singleShot(50, this, [this, nextIndex]() {
-                playSong(nextIndex);
-            });
-        }
-    }
-    
-    //更新UI
-    updateSongListView();
-    updatePlaylistView();
-    
-    //更新随机列表
-    if (m_inListMode == InListMode::Random) {
-        generateShuffledPlaylist();
-    }
-}
-
-// 从磁盘删除歌曲的槽函数
-void MainWindow::onDeleteSongFromDiskClicked() {
-    // 获取所有被选中的项
-    QList<QListWidgetItem*> selectedItems = m_songListWidget->selectedItems();
-    if (selectedItems.isEmpty()) {
-        return;
-    }
-    
-    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    if (!playlist) {
-        return;
-    }
-
-    // 构建要删除的歌曲列表信息
-    QStringList songNames;
-    QList<int> indicesToDelete;
-    for (QListWidgetItem* item : selectedItems) {
-        int index = item->data(Qt::UserRole).toInt();
-        indicesToDelete.append(index);
-        songNames.append(playlist->getSong(index).title);
-    }
-
-    // 显示确认警告对话框
-    QString message = QString("确定要从磁盘永久删除以下 %1 首歌曲吗？\n\n%2\n\n此操作无法撤销！")
-                          .arg(indicesToDelete.size())
-                          .arg(songNames.join("\n"));
-    
-    QMessageBox::StandardButton reply = QMessageBox::warning(
-        this,
-        "确认删除",
-        message,
-        QMessageBox::Yes | QMessageBox::No,
-        QMessageBox::No  // 默认选择"否"，更安全
-    );
-
-    if (reply != QMessageBox::Yes) {
-        return; // 用户取消操作
-    }
-
-    // ★ 关键改进：在删除前，检查是否正在播放要删除的歌曲
-    // 如果是，先停止播放器以释放文件句柄
-    bool isPlayingInDeleteList = false;
-    bool isSamePlaylist = (m_currentPlaylistIndex == m_playingPlaylistIndex);
-    
-    if (isSamePlaylist && m_currentSongIndex >= 0) {
-        for (int index : indicesToDelete) {
-            if (index == m_currentSongIndex) {
-                isPlayingInDeleteList = true;
-                break;
-            }
-        }
-    }
-
-    // 如果正在播放的歌曲在删除列表中，先停止播放器
-    if (isPlayingInDeleteList) {
-        m_player->stop();
-        m_player->setSource(QUrl()); // 清除媒体源，彻底释放文件句柄
-    }
-
-    // 对索引进行降序排序，必须从后往前删除
-    std::sort(indicesToDelete.begin(), indicesToDelete.end(), std::greater<int>());
-
-    bool currentPlayerSongRemoved = false;
-    QStringList failedFiles; // 记录删除失败的文件
-
-    // 执行删除
-    for (int index : indicesToDelete) {
-        Song song = playlist->getSong(index);
-        QString filePath = song.filePath;
-
-        // 尝试从磁盘删除文件
-        QFile file(filePath);
-        if (file.exists()) {
-            if (!file.remove()) {
-                // 删除失败，记录下来
-                failedFiles.append(song.title);
-                continue; // 跳过这个文件，不从播放列表移除
-            }
-        }
-
-        // 文件删除成功（或文件已不存在），从播放列表移除
-        // 检查是否删除了正在播放的歌曲
-        if (isSamePlaylist && index == m_currentSongIndex) {
-            currentPlayerSongRemoved = true;
-        } else if (isSamePlaylist && index < m_currentSongIndex) {
-            // 如果删除的歌曲在当前播放歌曲的前面，索引要-1
-            m_currentSongIndex--;
-        }
-        playlist->removeSong(index);
-    }
-
-    // 如果有删除失败的文件，提示用户
-    if (!failedFiles.isEmpty()) {
-        QMessageBox::warning(this, "部分删除失败",
-            QString("以下文件无法删除（可能正在被占用或没有权限）：\n\n%1")
-                .arg(failedFiles.join("\n")));
-    }
-
-    // 如果当前播放的歌曲被删了，自动播放下一首
-    if (currentPlayerSongRemoved) {
-        // 先保存要播放的下一首索引（在重置之前）
-        int nextIndex = m_currentSongIndex;
-        if (nextIndex >= playlist->songCount()) {
-            nextIndex = playlist->songCount() - 1;
-        }
-        
-        resetPlayerState();
-        
-        // 如果列表还有歌曲，自动播放下一首
-        if (playlist->songCount() > 0 && nextIndex >= 0) {
-            // 延迟一小段时间后播放，确保文件句柄完全释放
-            QTimer::singleShot(100, this, [this, nextIndex]() {
-                playSong(nextIndex);
-            });
-        }
-    }
-    
-    // 更新UI
-    updateSongListView();
-    updatePlaylistView();
-    
-    // 更新随机列表
-    if (m_inListMode == InListMode::Random) {
-        generateShuffledPlaylist();
-    }
-}
-
-void MainWindow::showEvent(QShowEvent *event)
-{
-    // 首先，必须调用基类的实现
-    QMainWindow::showEvent(event);
-
-    // 使用标志位确保这个加载逻辑只在程序启动时执行一次
-    // 而不是每次从托盘恢复窗口时都执行
-    if (m_isFirstShow) {
-        m_isFirstShow = false; // 立刻将标志位设为 false
-
-        QSettings settings;
-        int lastPlaylistIndex = settings.value("lastPlaylistIndex", 0).toInt();
-        int lastSongIndex = settings.value("lastSongIndex", -1).toInt();
-
-        // 验证加载的播放列表索引是否有效
-        if (lastPlaylistIndex >= 0 && lastPlaylistIndex < m_playlistManager->playlistCount()) {
-            
-            // 切换到上次的播放列表
-            m_playlistListWidget->setCurrentRow(lastPlaylistIndex);
-            // onPlaylistSelectionChanged 会被自动触发，更新 m_currentPlaylistIndex 和歌曲列表视图
-
-            Playlist* playlist = m_playlistManager->getPlaylist(lastPlaylistIndex);
-            // 验证加载的歌曲索引是否有效
-            if (playlist && lastSongIndex >= 0 && lastSongIndex < playlist->songCount()) {
-                
-                // 播放上次的歌曲
-                playSong(lastSongIndex);
-            }
-        }
-    }
-}
-
-
-void MainWindow::onShowFontSettings()
-{
-    // 获取当前列表控件的字体作为对话框的默认选项
-    QFont currentFont = m_playlistListWidget->font();
-
-    // 使用自定义的中文字体选择对话框
-    FontSettingsDialog dialog(currentFont, this);
-    
-    if (dialog.exec() == QDialog::Accepted) {
-        QFont selectedFont = dialog.selectedFont();
-
-        // 将新字体分别应用到两个列表控件
-        m_playlistListWidget->setFont(selectedFont);
-        m_songListWidget->setFont(selectedFont);
-
-        // 使用 QSettings 立即保存用户的选择
-        QSettings settings;
-        settings.setValue("listFont", selectedFont);
-    }
-}
-
-void MainWindow::startShutdownTimer(int msecs)
-{
-    if (msecs <= 0) return;
-
-    m_shutdownTimer->start(msecs);
-    m_shutdownDateTime = QDateTime::currentDateTime().addMSecs(msecs);
-    
-    // 更新托盘提示信息，告诉用户关机时间
-    m_trayIcon->setToolTip(QString("MusicPlayer\n将于 %1 定时关机")
-                           .arg(m_shutdownDateTime.toString("HH:mm:ss")));
-    
-    m_cancelShutdownAction->setEnabled(true); // 启用“取消”按钮
-    QMessageBox::information(this, "定时关机", 
-        QString("已设定在 %1 执行关机。")
-        .arg(m_shutdownDateTime.toString("yyyy-MM-dd HH:mm:ss")));
-}
-
-// “30分钟后”的槽函数
-void MainWindow::onSetShutdownAfter30Mins()
-{
-    startShutdownTimer(30 * 60 * 1000);
-}
-
-// “60分钟后”的槽函数
-void MainWindow::onSetShutdownAfter60Mins()
-{
-    startShutdownTimer(60 * 60 * 1000);
-}
-
-// “自定义时间”的槽函数
-void MainWindow::onSetCustomShutdownTime()
-{
-    // a. 创建我们的自定义对话框实例
-    CustomTimeDialog dialog(this);
-    dialog.setCurrentTime(QTime::currentTime().addSecs(60 * 10)); // 默认显示10分钟后的时间
-
-    // b. 以模态方式执行对话框，并检查返回值
-    if (dialog.exec() == QDialog::Accepted) {
-        // c. 如果用户点击了 "OK"，获取选择的时间
-        QTime time = dialog.selectedTime();
-
-        QDateTime now = QDateTime::currentDateTime();
-        QDateTime targetDateTime(now.date(), time);
-
-        if (targetDateTime < now) {
-            targetDateTime = targetDateTime.addDays(1);
-        }
-
-        qint64 msecs = now.msecsTo(targetDateTime);
-        startShutdownTimer(msecs);
-    }
-    // 如果用户点击 "Cancel"，dialog.exec() 返回 Rejected，我们什么都不做
-}
-
-// “取消定时”的槽函数
-void MainWindow::onCancelShutdown()
-{
-    m_shutdownTimer->stop();
-    m_shutdownDateTime = QDateTime(); // 重置为无效时间
-    m_trayIcon->setToolTip("MusicPlayer"); // 恢复默认提示
-    m_cancelShutdownAction->setEnabled(false); // 禁用“取消”按钮
-    QMessageBox::information(this, "提示", "定时关机已取消。");
-}
-
-// 定时器触发时，执行真正的关机命令
-void MainWindow::onShutdownTimerTimeout()
-{
-    QString command;
-    QStringList args;
-
-#if defined(Q_OS_WIN)
-    command = "shutdown";
-    args << "/s" << "/t" << "0"; // /s: 关机, /t 0: 立即
-#elif defined(Q_OS_MAC)
-    command = "shutdown";
-    args << "-h" << "now"; // -h: 关机, now: 立即
-#elif defined(Q_OS_LINUX)
-    command = "shutdown";
-    args << "-h" << "now";
-#endif
-
-    if (!command.isEmpty()) {
-        // 使用 startDetached 启动命令，这样即使我们的播放器被关闭，
-        // 关机命令也能继续执行。
-        m_shutdownProcess->startDetached(command, args);
-    }
-}
-
-// 重写 nativeEvent 以捕获 Windows 原生事件
-bool MainWindow::nativeEvent(const QByteArray &eventType, void *message, qintptr *result)
-{
-    // 只处理 Windows 平台的消息
-#ifdef Q_OS_WIN
-    // 将通用的 message 指针转换为 Windows 消息结构体指针
-    MSG* msg = static_cast<MSG*>(message);
-
-    // 只关心 WM_POWERBROADCAST 消息
-    if (msg->message == WM_POWERBROADCAST)
-    {
-        // PBT_APMRESUMEAUTOMATIC 事件表示系统已从睡眠或休眠中唤醒
-        if (msg->wParam == PBT_APMRESUMEAUTOMATIC)
-        {
-            qDebug() << "检测到系统已从睡眠状态唤醒。";
-
-            // 核心缓解策略
-            // 检查播放器是否正在播放
-            if (m_player->playbackState() == QMediaPlayer::PlayingState)
-            {
-                qDebug() << "播放器正在播放，尝试重置以避免卡顿。";
-                
-                //获取当前播放位置
-                qint64 currentPosition = m_player->position();
-                
-                //暂停播放器
-                m_player->pause();
-
-                //使用 QTimer 做一个非常短暂的延迟
-                //    这给了声卡和驱动一点点时间来完全初始化
-                QTimer::singleShot(250, this, [this, currentPosition]() {
-                    //在延迟后，重新设置播放位置并继续播放
-                    m_player->setPosition(currentPosition);
-                    m_player->play();
-                    qDebug() << "播放器状态已重置。";
-                });
-            }
-        }
-    }
-#endif
-
-    // 调用基类的实现，确保其他事件能被正常处理
-    return QMainWindow::nativeEvent(eventType, message, result);
-}
-
-// --- 左侧：排序播放列表本身 ---
-void MainWindow::onSortPlaylistsAction() {
-    // 1. 保存当前状态
-    // 我们需要记录下“当前正在看的列表”和“当前正在播放的列表”的指针
-    // 因为排序后，它们的索引(int)会发生变化
-    Playlist* viewingPlaylist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    
-    // m_playingPlaylistIndex 是我们之前为了高亮引入的变量
-    Playlist* playingPlaylist = nullptr;
-    if (m_playingPlaylistIndex >= 0) {
-        playingPlaylist = m_playlistManager->getPlaylist(m_playingPlaylistIndex);
-    }
-
-    // 2. 执行排序 (PlaylistManager 中新加的函数)
-    m_playlistManager->sortPlaylistsByName();
-
-    // 3. 恢复索引
-    // 找到刚才那个列表现在跑到哪里去了
-    if (viewingPlaylist) {
-        m_currentPlaylistIndex = m_playlistManager->getPlaylistIndex(viewingPlaylist);
-    }
-    if (playingPlaylist) {
-        m_playingPlaylistIndex = m_playlistManager->getPlaylistIndex(playingPlaylist);
-    }
-
-    // 4. 彻底刷新左侧列表UI
-    updatePlaylistView();
-    
-    // 恢复选中状态
-    if (m_currentPlaylistIndex >= 0) {
-        m_playlistListWidget->setCurrentRow(m_currentPlaylistIndex);
-    }
-}
-
-// --- 右侧：排序当前列表里的歌曲 ---
-void MainWindow::onSortSongsAction() {
-    // 1. 获取当前正在查看的列表
-    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    if (!playlist || playlist->songCount() == 0) return;
-
-    // 2. 保存播放状态
-    // 只有当“正在查看的列表”就是“正在播放的列表”时，才需要处理歌曲索引
-    QString currentPlayingFilePath;
-    bool isSortingPlayingList = (m_currentPlaylistIndex == m_playingPlaylistIndex);
-    
-    if (isSortingPlayingList && m_currentSongIndex >= 0) {
-        // 记住正在播放的那首歌的路径
-        currentPlayingFilePath = playlist->getSong(m_currentSongIndex).filePath;
-    }
-
-    // 3. 执行排序 (Playlist 类中已有的函数)
-    playlist->sortByName();
-
-    // 4. 恢复播放索引
-    if (isSortingPlayingList && !currentPlayingFilePath.isEmpty()) {
-        const QList<Song>& songs = playlist->getSongs();
-        for (int i = 0; i < songs.size(); ++i) {
-            if (songs[i].filePath == currentPlayingFilePath) {
-                m_currentSongIndex = i; // 找到它在新列表中的位置
-                break;
-            }
-        }
-    }
-
-    // 5. 刷新右侧歌曲列表UI
-    updateSongListView();
-    
-    // 6. 如果是随机模式，列表变了，随机种子也要重置
-    if (m_inListMode == InListMode::Random && isSortingPlayingList) {
-        generateShuffledPlaylist();
-    }
-}
-
-// 单实例实现
-void MainWindow::wakeUpWindow()
-{
-    // 确保窗口可见
-    if (!this->isVisible()) {
-        this->show();
-    }
-    
-    // 恢复窗口状态（如果是最小化，则恢复正常）
-    if (this->isMinimized()) {
-        this->setWindowState((windowState() & ~Qt::WindowMinimized) | Qt::WindowActive);
-    }
-    
-    // 提升并激活窗口
-    this->raise();
-    this->activateWindow();
-}
-
-// 音频转码槽函数
-void MainWindow::onTranscodeAudioClicked() {
-    // 获取所有选中的歌曲
-    QList<QListWidgetItem*> selectedItems = m_songListWidget->selectedItems();
-    if (selectedItems.isEmpty()) {
-        return;
-    }
-    
-    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    if (!playlist) {
-        return;
-    }
-    
-    // 收集所有选中歌曲的文件路径
-    QStringList filePaths;
-    for (QListWidgetItem* item : selectedItems) {
-        int index = item->data(Qt::UserRole).toInt();
-        Song song = playlist->getSong(index);
-        filePaths.append(song.filePath);
-    }
-    
-    // 创建并显示转码对话框
-    TranscodeDialog dialog(filePaths, this);
-    dialog.exec();
-}
-
-// 编辑歌曲信息槽函数
-void MainWindow::onEditSongInfoClicked() {
-    // 获取当前选中的歌曲
-    QListWidgetItem* currentItem = m_songListWidget->currentItem();
-    if (!currentItem) {
-        return;
-    }
-    
-    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
-    if (!playlist) {
-        return;
-    }
-    
-    int songIndex = currentItem->data(Qt::UserRole).toInt();
-    Song song = playlist->getSong(songIndex);
-    
-    // 创建并显示歌曲信息编辑对话框
-    SongInfoDialog dialog(song.filePath, this);
-    
-    if (dialog.exec() == QDialog::Accepted) {
-        // 如果用户点击了保存，更新播放列表中的歌曲信息
-        playlist->updateSongMetaData(songIndex, 
-                                     dialog.title(), 
-                                     dialog.artist(), 
-                                     dialog.album());
-        
-        // 刷新歌曲列表视图
-        updateSongListView();
-        
-        // 如果正在播放的歌曲被修改了，更新当前显示的信息
-        if (m_currentPlaylistIndex == m_playingPlaylistIndex && 
-            songIndex == m_currentSongIndex) {
-            m_songTitleLabel->setText(dialog.title());
-            m_songArtistLabel->setText(dialog.artist());
-        }
-    }
-}
\ No newline at end of file
+﻿#include "mainwindow.h"
+#include <QVBoxLayout>
+#include <QFile>
+#include <QHBoxLayout>
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QMessageBox>
+#include <QGroupBox>
+#include <QStyle>
+#include <QMediaMetaData>
+#include <QSplitter>
+#include <random>
+#include <algorithm>
+#include <QRandomGenerator> //Qt 6 的随机数生成器
+#include <QDirIterator>
+#include <QDebug>
+#include <QMenu>
+#include <QSettings>   //包含 QSettings 头文件
+#include <QSet>
+#include <QSplitter>   //包含 QSplitter 的完整头文件
+#include <QAction>   //包含 QAction
+#include <QApplication> //调用 quit
+#include <QToolTip>
+#include <QFontDialog>
+#include <QFont>
+#include <QTimer>
+#include <QProcess>
+#include <QFileInfo>
+#include <QScrollBar>
+#include <QJsonArray>
+#include <QSignalBlocker>
+#include <QNetworkInterface>
+#include "customtimedialog.h"
+#include "fontsettingsdialog.h"
+#include "ipcprotocol.h"
+#include "startupprofiler.h"
+#include "diagnostics.h"
+#include "diagnosticsdialog.h"
+#include "tracerecorder.h"
+#include "applog.h"
+#include <QMessageBox>
+
+// TagLib 头文件
+#include <taglib/fileref.h>
+#include <taglib/tag.h>
+
+namespace {
+
+const int NowPlayingCoverSize = 160;   // 正在播放的封面边长
+const int ListCoverSize = 24;          // 歌曲列表缩略图边长
+
+// 扫描文件夹时收录的文件
+const QStringList AudioFileFilters = {"*.mp3", "*.flac", "*.wav", "*.ogg", "*.m4a", "*.cue"};
+
+// HTTP 控制接口和局域网串流的默认端口
+const int DefaultHttpApiPort = 8765;
+const int DefaultStreamingPort = 8766;
+
+// 远程 queue / search 命令中的一首歌
+QJsonObject songToJson(const SongLibrary* library, int id)
+{
+    QJsonObject song;
+    song.insert("id", id);
+    song.insert("title", library->title(id));
+    song.insert("artist", library->artist(id));
+    song.insert("album", library->album(id));
+    song.insert("duration", library->duration(id));
+    song.insert("filePath", library->filePath(id));
+    return song;
+}
+
+} // namespace
+
+MainWindow::MainWindow(QWidget* parent)
+    : QMainWindow(parent)
+    , m_currentPlaylistIndex(0)
+    , m_currentSongIndex(-1)
+    //, m_inListMode(InListMode::Sequential)
+    //, m_crossListMode(CrossListMode::ListLoop)
+    , m_shuffledPlaybackIndex(0)             // 初始化随机播放索引
+    , m_isFirstShow(true)
+    , m_playingPlaylistIndex(-1)
+{
+    m_player = new QMediaPlayer(this);
+    m_audioOutput = new QAudioOutput(this);
+    m_player->setAudioOutput(m_audioOutput);
+    
+    m_playlistManager = new PlaylistManager(this);
+    StartupProfiler::mark("playlist load");
+
+    m_shutdownTimer = new QTimer(this);
+    m_shutdownTimer->setSingleShot(true); // 这是一个一次性的定时器
+    connect(m_shutdownTimer, &QTimer::timeout, this, &MainWindow::onShutdownTimerTimeout);
+
+    m_shutdownProcess = new QProcess(this);
+
+    // 后台丢失文件检测
+    m_missingFileChecker = new MissingFileChecker(this);
+    connect(m_missingFileChecker, &MissingFileChecker::batchVerified,
+            this, &MainWindow::onMissingFilesBatchVerified);
+    connect(m_missingFileChecker, &MissingFileChecker::relocateFinished,
+            this, &MainWindow::onMissingFilesRelocated);
+
+    m_songListRefreshTimer = new QTimer(this);
+    m_songListRefreshTimer->setSingleShot(true);
+    m_songListRefreshTimer->setInterval(300);
+    connect(m_songListRefreshTimer, &QTimer::timeout, this, &MainWindow::updateSongListView);
+
+    // 监视文件夹：启动完成后对所有监视的文件夹做一次增量同步（见 finishStartup）
+    m_folderWatcher = new FolderWatcher(this);
+    connect(m_folderWatcher, &FolderWatcher::folderScanned,
+            this, &MainWindow::onWatchedFolderScanned);
+
+    // 专辑封面缩略图在后台解码，结果缓存在内存和磁盘中
+    m_coverArtCache = new CoverArtCache(this);
+    connect(m_coverArtCache, &CoverArtCache::coverReady, this, &MainWindow::onCoverReady);
+
+    m_coverRequestTimer = new QTimer(this);
+    m_coverRequestTimer->setSingleShot(true);
+    m_coverRequestTimer->setInterval(50);
+    connect(m_coverRequestTimer, &QTimer::timeout, this, &MainWindow::requestVisibleCovers);
+
+    // 文件管理器可能为每个选中的文件各启动一个进程，短时间内到达的 open 请求合并成一批导入
+    m_openFilesTimer = new QTimer(this);
+    m_openFilesTimer->setSingleShot(true);
+    m_openFilesTimer->setInterval(100);
+    connect(m_openFilesTimer, &QTimer::timeout, this, [this]() {
+        QStringList paths;
+        paths.swap(m_pendingOpenPaths);
+        enqueueFiles(paths, QString(), true);
+        wakeUpWindow();
+    });
+    
+    setupUI();
+
+    //安全地初始化字体
+    m_playingSongFont = m_songListWidget->font();
+    m_playingSongFont.setBold(true);
+    
+    // 连接播放器信号
+    connect(m_player, &QMediaPlayer::positionChanged, 
+            this, &MainWindow::onPositionChanged);
+    connect(m_player, &QMediaPlayer::durationChanged, 
+            this, &MainWindow::onDurationChanged);
+    connect(m_player, &QMediaPlayer::mediaStatusChanged,
+            this, &MainWindow::onMediaStatusChanged);
+    connect(m_player, &QMediaPlayer::metaDataChanged,
+            this, &MainWindow::onMetaDataChanged); // <--- 连接新信号
+
+    // 状态变化推送给 HTTP 控制接口的长轮询和 SSE 客户端
+    connect(m_player, &QMediaPlayer::playbackStateChanged, this, &MainWindow::notifyRemoteStateChanged);
+    connect(m_audioOutput, &QAudioOutput::volumeChanged, this, &MainWindow::notifyRemoteStateChanged);
+
+    //设置窗口图标（标题栏和任务栏）
+    //使用 Qt 资源系统中的路径
+    setWindowIcon(QIcon(":/icons/appicon.ico"));
+
+
+    // 快速启动（默认开启）时托盘图标和菜单推迟到窗口第一次绘制之后再创建
+    m_fastStart = QSettings().value("Startup/fastStart", true).toBool();
+    if (!m_fastStart) {
+        setupTrayIcon();
+    }
+
+    //加载设置
+    QSettings settings;
+    if (settings.contains("geometry")) {
+        restoreGeometry(settings.value("geometry").toByteArray());
+    }
+    if (settings.contains("splitterState")) {
+        m_mainSplitter->restoreState(settings.value("splitterState").toByteArray());
+    }
+
+    QFont defaultListFont = m_playlistListWidget->font();
+
+    //从设置中加载字体，如果不存在则使用默认值
+    QFont savedFont = settings.value("listFont", defaultListFont).value<QFont>();
+    
+    //将加载的字体分别设置给两个列表控件
+    m_playlistListWidget->setFont(savedFont);
+    m_songListWidget->setFont(savedFont);
+
+    int savedVolume = settings.value("volume", 70).toInt();
+    m_volumeSlider->setValue(savedVolume);
+    if (m_trayVolumeSlider) {
+        m_trayVolumeSlider->setValue(savedVolume);
+    }
+
+    // 直接定位到上次的列表：歌曲列表只构建一次，不必先构建第一个列表再在 showEvent 中重建
+    int lastPlaylistIndex = settings.value("lastPlaylistIndex", 0).toInt();
+    if (lastPlaylistIndex >= 0 && lastPlaylistIndex < m_playlistManager->playlistCount()) {
+        m_currentPlaylistIndex = lastPlaylistIndex;
+    }
+
+    //加载播放模式
+    //加载列表内模式 (顺序/随机)
+    //枚举转换为整数进行存储。如果设置不存在，默认为 Sequential (0)
+    m_inListMode = static_cast<InListMode>(settings.value("inListMode", 
+                                            static_cast<int>(InListMode::Sequential)).toInt());
+    
+    //加载列表间模式 (循环/前进等)
+    //默认为 ListLoop (1)
+    m_crossListMode = static_cast<CrossListMode>(settings.value("crossListMode",
+                                                    static_cast<int>(CrossListMode::ListLoop)).toInt());
+
+    //加载完模式后，立即更新按钮的UI状态
+    updateInListModeButton();
+    updateCrossListModeButton();
+
+    //现在再更新列表视图
+    updatePlaylistView();
+    updateSongListView();
+    StartupProfiler::mark("ui build");
+}
+
+// 托盘图标和它的菜单（包括“设置”子菜单）
+void MainWindow::setupTrayIcon() {
+    QAction* fontAction = new QAction("字体...", this);
+    connect(fontAction, &QAction::triggered, this, &MainWindow::onShowFontSettings);
+
+    QMenu* settingsMenu = new QMenu("设置", this);
+    settingsMenu->addAction(fontAction);
+
+    QMenu* shutdownMenu = new QMenu("定时关机", this);
+
+    QAction* shutdown30MinsAction = shutdownMenu->addAction("30分钟后");
+    connect(shutdown30MinsAction, &QAction::triggered, this, &MainWindow::onSetShutdownAfter30Mins);
+    
+    QAction* shutdown60MinsAction = shutdownMenu->addAction("60分钟后");
+    connect(shutdown60MinsAction, &QAction::triggered, this, &MainWindow::onSetShutdownAfter60Mins);
+    
+    QAction* customShutdownAction = shutdownMenu->addAction("自定义时间...");
+    connect(customShutdownAction, &QAction::triggered, this, &MainWindow::onSetCustomShutdownTime);
+    
+    shutdownMenu->addSeparator();
+    
+    m_cancelShutdownAction = shutdownMenu->addAction("取消定时关机");
+    m_cancelShutdownAction->setEnabled(false); // 默认禁用
+    connect(m_cancelShutdownAction, &QAction::triggered, this, &MainWindow::onCancelShutdown);
+
+    settingsMenu->addMenu(shutdownMenu);
+
+    // HTTP 控制接口：默认关闭，开启后只监听本机（地址、端口和令牌见配置文件的 HttpApi 段）
+    QAction* httpApiAction = settingsMenu->addAction(
+        QString("HTTP 控制接口 (端口 %1)").arg(QSettings().value("HttpApi/port", DefaultHttpApiPort).toInt()));
+    httpApiAction->setCheckable(true);
+    httpApiAction->setChecked(m_httpServer && m_httpServer->isListening());
+    connect(httpApiAction, &QAction::toggled, this, [this, httpApiAction](bool checked) {
+        QSettings().setValue("HttpApi/enabled", checked);
+        setHttpApiEnabled(checked);
+        if (checked && !m_httpServer->isListening()) {
+            httpApiAction->setChecked(false);
+            QMessageBox::warning(this, "HTTP 控制接口", "无法启动: " + m_httpServer->errorString());
+        }
+    });
+
+    // 局域网串流：其他设备可以通过 http://本机地址:端口/stream/playlist.m3u 收听（设置见配置文件的 Streaming 段）
+    QAction* streamingAction = settingsMenu->addAction(
+        QString("局域网串流 (端口 %1)").arg(QSettings().value("Streaming/port", DefaultStreamingPort).toInt()));
+    streamingAction->setCheckable(true);
+    streamingAction->setChecked(m_streamServer && m_streamServer->isListening());
+    connect(streamingAction, &QAction::toggled, this, [this, streamingAction](bool checked) {
+        QSettings().setValue("Streaming/enabled", checked);
+        setStreamingEnabled(checked);
+        if (checked && !m_streamServer->isListening()) {
+            streamingAction->setChecked(false);
+            QMessageBox::warning(this, "局域网串流", "无法启动: " + m_streamServer->errorString());
+        } else if (checked) {
+            // 地址中带有访问令牌，其他设备直接打开即可
+            QMessageBox::information(this, "局域网串流", "其他设备可以用播放器打开:\n" + streamingPlaylistUrl());
+        }
+    });
+
+    // 诊断信息：各项操作的次数和耗时，可导出为 JSON
+    QAction* diagnosticsAction = settingsMenu->addAction("诊断信息...");
+    connect(diagnosticsAction, &QAction::triggered, this, [this]() {
+        DiagnosticsDialog* dialog = new DiagnosticsDialog([this]() { return diagnosticsSnapshot(); }, this);
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+        dialog->show();
+    });
+
+    // 性能跟踪：开启后记录播放、保存、导入、转码等操作的时间线，导出后用 Perfetto 或 chrome://tracing 查看
+    QMenu* traceMenu = settingsMenu->addMenu("性能跟踪");
+    QAction* traceAction = traceMenu->addAction("记录");
+    traceAction->setCheckable(true);
+    traceAction->setChecked(TraceRecorder::isEnabled());
+    connect(traceAction, &QAction::toggled, this, [](bool checked) {
+        TraceRecorder::setEnabled(checked);
+    });
+    QAction* exportTraceAction = traceMenu->addAction("导出...");
+    connect(exportTraceAction, &QAction::triggered, this, [this]() {
+        if (TraceRecorder::eventCount() == 0) {
+            QMessageBox::information(this, "性能跟踪", "还没有记录到任何事件，请先开启记录。");
+            return;
+        }
+        QString filePath = QFileDialog::getSaveFileName(
+            this,
+            "导出性能跟踪",
+            QDir::homePath() + "/OldPlayer-trace-" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".json",
+            "Chrome 跟踪文件 (*.json)"
+        );
+        if (filePath.isEmpty()) return;
+
+        QString error;
+        if (!TraceRecorder::exportJson(filePath, &error)) {
+            QMessageBox::warning(this, "导出失败", QString("无法写入 %1：\n%2").arg(filePath, error));
+        }
+    });
+
+    // 快速启动：托盘、文件夹同步等推迟到窗口显示之后，下次启动时生效（各阶段耗时见 config/startup.log）
+    QAction* fastStartAction = settingsMenu->addAction("快速启动");
+    fastStartAction->setCheckable(true);
+    fastStartAction->setChecked(m_fastStart);
+    connect(fastStartAction, &QAction::toggled, this, [](bool checked) {
+        QSettings().setValue("Startup/fastStart", checked);
+    });
+    
+    m_quitAction = new QAction("退出", this);
+    connect(m_quitAction, &QAction::triggered, this, [this]() {
+        // 先保存设置再退出
+        QSettings settings;
+        settings.setValue("geometry", saveGeometry());
+        settings.setValue("splitterState", m_mainSplitter->saveState());
+        settings.setValue("volume", m_volumeSlider->value());
+        settings.setValue("lastPlaylistIndex", m_currentPlaylistIndex);
+        settings.setValue("lastSongIndex", m_currentSongIndex);
+        settings.setValue("inListMode", static_cast<int>(m_inListMode));
+        settings.setValue("crossListMode", static_cast<int>(m_crossListMode));
+        qApp->quit();
+    }); 
+
+    m_trayMenu = new QMenu(this);
+    
+    // === 托盘菜单播放控制区域 ===
+    // 1. 歌曲名标签
+    QWidget* songLabelWidget = new QWidget();
+    QHBoxLayout* songLabelLayout = new QHBoxLayout(songLabelWidget);
+    songLabelLayout->setContentsMargins(10, 5, 10, 5);
+    m_traySongLabel = new QLabel("未播放");
+    m_traySongLabel->setStyleSheet("font-weight: bold; font-size: 12px;");
+    m_traySongLabel->setAlignment(Qt::AlignCenter);
+    m_traySongLabel->setMinimumWidth(180);
+    songLabelLayout->addWidget(m_traySongLabel);
+    QWidgetAction* songLabelAction = new QWidgetAction(this);
+    songLabelAction->setDefaultWidget(songLabelWidget);
+    m_trayMenu->addAction(songLabelAction);
+    
+    // 2. 播放控制按钮（上一曲、播放/暂停、下一曲）
+    QWidget* controlWidget = new QWidget();
+    QHBoxLayout* controlLayout = new QHBoxLayout(controlWidget);
+    controlLayout->setContentsMargins(10, 5, 10, 5);
+    controlLayout->setSpacing(5);
+    
+    QPushButton* trayPrevBtn = new QPushButton();
+    trayPrevBtn->setIcon(style()->standardIcon(QStyle::SP_MediaSkipBackward));
+    trayPrevBtn->setFixedSize(32, 32);
+    trayPrevBtn->setFlat(true);
+    connect(trayPrevBtn, &QPushButton::clicked, this, &MainWindow::onPreviousClicked);
+    
+    QPushButton* trayPlayPauseBtn = new QPushButton();
+    trayPlayPauseBtn->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
+    trayPlayPauseBtn->setFixedSize(36, 36);
+    trayPlayPauseBtn->setFlat(true);
+    trayPlayPauseBtn->setObjectName("trayPlayPauseBtn");
+    connect(trayPlayPauseBtn, &QPushButton::clicked, this, &MainWindow::onPlayPauseClicked);
+    
+    QPushButton* trayNextBtn = new QPushButton();
+    trayNextBtn->setIcon(style()->standardIcon(QStyle::SP_MediaSkipForward));
+    trayNextBtn->setFixedSize(32, 32);
+    trayNextBtn->setFlat(true);
+    connect(trayNextBtn, &QPushButton::clicked, this, &MainWindow::onNextClicked);
+    
+    controlLayout->addStretch();
+    controlLayout->addWidget(trayPrevBtn);
+    controlLayout->addWidget(trayPlayPauseBtn);
+    controlLayout->addWidget(trayNextBtn);
+    controlLayout->addStretch();
+    
+    QWidgetAction* controlAction = new QWidgetAction(this);
+    controlAction->setDefaultWidget(controlWidget);
+    m_trayMenu->addAction(controlAction);
+    
+    // 3. 音量滑块
+    QWidget* volumeWidget = new QWidget();
+    QHBoxLayout* volumeLayout = new QHBoxLayout(volumeWidget);
+    volumeLayout->setContentsMargins(10, 5, 10, 5);
+    
+    QLabel* volumeIcon = new QLabel();
+    volumeIcon->setPixmap(style()->standardIcon(QStyle::SP_MediaVolume).pixmap(16, 16));
+    
+    m_trayVolumeSlider = new QSlider(Qt::Horizontal);
+    m_trayVolumeSlider->setRange(0, 100);
+    m_trayVolumeSlider->setValue(70);
+    m_trayVolumeSlider->setMinimumWidth(120);
+    connect(m_trayVolumeSlider, &QSlider::valueChanged, this, &MainWindow::onVolumeChanged);
+    
+    volumeLayout->addWidget(volumeIcon);
+    volumeLayout->addWidget(m_trayVolumeSlider);
+    
+    QWidgetAction* volumeAction = new QWidgetAction(this);
+    volumeAction->setDefaultWidget(volumeWidget);
+    m_trayMenu->addAction(volumeAction);
+    
+    m_trayMenu->addSeparator();
+    // === 播放控制区域结束 ===
+    
+    m_trayMenu->addMenu(settingsMenu); // <--- 将“设置”子菜单添加到主菜单
+    m_trayMenu->addSeparator();
+    m_trayMenu->addAction(m_quitAction);
+
+    //创建系统托盘图标对象
+    m_trayIcon = new QSystemTrayIcon(this);
+    m_trayIcon->setIcon(QIcon(":/icons/appicon.ico"));
+    m_trayIcon->setToolTip("OldPlayer");
+    m_trayIcon->setContextMenu(m_trayMenu); // <-- 将我们正确创建的菜单设置给托盘
+
+    //连接托盘图标的点击信号
+    connect(m_trayIcon, &QSystemTrayIcon::activated, this, &MainWindow::onTrayIconActivated);
+    
+    //显示托盘图标
+    m_trayIcon->show();
+
+    // 推迟创建时，播放可能已经开始，同步一次当前状态
+    m_trayVolumeSlider->blockSignals(true);
+    m_trayVolumeSlider->setValue(m_volumeSlider->value());
+    m_trayVolumeSlider->blockSignals(false);
+    Playlist* playingPlaylist = m_playlistManager->getPlaylist(m_playingPlaylistIndex);
+    if (playingPlaylist && m_currentSongIndex >= 0 && m_currentSongIndex < playingPlaylist->songCount()) {
+        QString title = playingPlaylist->songTitle(m_currentSongIndex);
+        m_traySongLabel->setText(title);
+        m_trayIcon->setToolTip(QString("%1 - %2").arg(playingPlaylist->songArtist(m_currentSongIndex), title));
+    }
+    updatePlayPauseButton();
+}
+
+// 启动后才需要的部分：网络接口、托盘、监视文件夹同步和丢失文件检查
+// 快速启动时在窗口第一次绘制之后执行，否则在第一次 showEvent 中执行
+void MainWindow::finishStartup() {
+    // 先启动网络接口，托盘菜单中的开关状态才正确
+    QSettings settings;
+    if (settings.value("HttpApi/enabled", false).toBool()) {
+        setHttpApiEnabled(true);
+    }
+    if (settings.value("Streaming/enabled", false).toBool()) {
+        setStreamingEnabled(true);
+    }
+    if (!m_trayIcon) {
+        setupTrayIcon();
+    }
+
+    m_folderWatcher->setFolders(m_playlistManager->watchedFolders());
+
+    // 上次的列表中还没读过标签的歌曲（以前由切换列表触发）
+    if (loadPlaylistMetaData(m_currentPlaylistIndex)) {
+        updateSongListView();
+    }
+
+    // 界面显示出来之后，再在后台检查歌曲库中的文件是否还存在
+    startMissingFileCheck();
+}
+
+MainWindow::~MainWindow() {}
+
+void MainWindow::setupUI() {
+    setWindowTitle("OldPlayer");
+    resize(360, 840);  // 默认窗口尺寸 9:21 比例（竖向）
+    
+    m_centralWidget = new QWidget(this);
+    setCentralWidget(m_centralWidget);
+    
+    QVBoxLayout* mainLayout = new QVBoxLayout(m_centralWidget);
+    
+    // 顶部：当前播放信息
+    QGroupBox* infoGroup = new QGroupBox("正在播放", this);
+    QVBoxLayout* infoLayout = new QVBoxLayout(infoGroup);
+
+    // 封面：没有封面时隐藏
+    m_coverLabel = new QLabel(this);
+    m_coverLabel->setFixedSize(NowPlayingCoverSize, NowPlayingCoverSize);
+    m_coverLabel->setAlignment(Qt::AlignCenter);
+    m_coverLabel->hide();
+    infoLayout->addWidget(m_coverLabel, 0, Qt::AlignHCenter);
+    
+    m_songTitleLabel = new QLabel("未选择歌曲", this);
+    m_songTitleLabel->setStyleSheet("font-size: 18px; font-weight: bold;");
+    m_songTitleLabel->setAlignment(Qt::AlignCenter);
+    
+    m_songArtistLabel = new QLabel("", this);
+    m_songArtistLabel->setStyleSheet("font-size: 12px; color: gray;");
+    m_songArtistLabel->setAlignment(Qt::AlignCenter);
+    
+    infoLayout->addWidget(m_songTitleLabel);
+    infoLayout->addWidget(m_songArtistLabel);
+    mainLayout->addWidget(infoGroup);
+    
+    // 进度条区域
+    QHBoxLayout* progressLayout = new QHBoxLayout();
+    m_currentTimeLabel = new QLabel("00:00", this);
+    m_progressSlider = new ClickableSlider(Qt::Horizontal, this);
+    m_totalTimeLabel = new QLabel("00:00", this);
+    
+    connect(m_progressSlider, &ClickableSlider::sliderMoved,
+            this, &MainWindow::onProgressSliderMoved);
+    
+    progressLayout->addWidget(m_currentTimeLabel);
+    progressLayout->addWidget(m_progressSlider);
+    progressLayout->addWidget(m_totalTimeLabel);
+    mainLayout->addLayout(progressLayout);
+    
+    // 控制按钮区域
+    QHBoxLayout* controlLayout = new QHBoxLayout();
+    controlLayout->addStretch();
+    
+    m_previousBtn = new QPushButton(this);
+    m_previousBtn->setIcon(style()->standardIcon(QStyle::SP_MediaSkipBackward));
+    m_previousBtn->setIconSize(QSize(32, 32));
+    connect(m_previousBtn, &QPushButton::clicked, 
+            this, &MainWindow::onPreviousClicked);
+    
+    m_playPauseBtn = new QPushButton(this);
+    m_playPauseBtn->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
+    m_playPauseBtn->setIconSize(QSize(32, 32));
+    connect(m_playPauseBtn, &QPushButton::clicked, 
+            this, &MainWindow::onPlayPauseClicked);
+    
+    m_nextBtn = new QPushButton(this);
+    m_nextBtn->setIcon(style()->standardIcon(QStyle::SP_MediaSkipForward));
+    m_nextBtn->setIconSize(QSize(32, 32));
+    connect(m_nextBtn, &QPushButton::clicked, 
+            this, &MainWindow::onNextClicked);
+    
+    // 创建【列表内模式】按钮 (顺序/随机)
+    m_inListModeBtn = new QPushButton(this);
+    m_inListModeBtn->setIconSize(QSize(28, 28));
+    connect(m_inListModeBtn, &QPushButton::clicked,
+            this, &MainWindow::onInListModeClicked);
+
+    // 创建【列表间模式】按钮 (循环/前进等)
+    m_crossListModeBtn = new QPushButton(this);
+    m_crossListModeBtn->setIconSize(QSize(28, 28));
+    connect(m_crossListModeBtn, &QPushButton::clicked,
+            this, &MainWindow::onCrossListModeClicked);
+
+
+    controlLayout->addWidget(m_previousBtn);
+    controlLayout->addWidget(m_playPauseBtn);
+    controlLayout->addWidget(m_nextBtn);
+    controlLayout->addWidget(m_inListModeBtn);
+    controlLayout->addWidget(m_crossListModeBtn);
+    controlLayout->addStretch();
+    mainLayout->addLayout(controlLayout);
+    
+    // 音量控制
+    QHBoxLayout* volumeLayout = new QHBoxLayout();
+    volumeLayout->addStretch();
+    QLabel* volumeLabel = new QLabel("音量:", this);
+    m_volumeSlider = new ClickableSlider(Qt::Horizontal, this);
+    m_volumeSlider->setRange(0, 100);
+    m_volumeSlider->setValue(70);
+    connect(m_volumeSlider, &ClickableSlider::valueChanged,
+            this, &MainWindow::onVolumeChanged);
+    
+    volumeLayout->addWidget(volumeLabel);
+    volumeLayout->addWidget(m_volumeSlider);
+    volumeLayout->addStretch();
+    mainLayout->addLayout(volumeLayout);
+    
+
+    // 使用 QSplitter 来创建可拖动的左右两个面板
+    m_mainSplitter = new QSplitter(Qt::Horizontal, this);
+    m_mainSplitter->setChildrenCollapsible(false);
+
+    // --- 左侧面板：播放列表 ---
+    QWidget* leftPanel = new QWidget(m_mainSplitter); 
+    QVBoxLayout* leftLayout = new QVBoxLayout(leftPanel);
+    leftLayout->setContentsMargins(0, 0, 0, 0); // 无边距
+
+    QGroupBox* playlistGroup = new QGroupBox("播放列表", this);
+    QVBoxLayout* playlistGroupLayout = new QVBoxLayout(playlistGroup);
+    
+    m_playlistListWidget = new PlaylistListWidget(this);
+    //为播放列表启用多选功能
+    m_playlistListWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+    m_playlistListWidget->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(m_playlistListWidget, &QListWidget::currentRowChanged,
+            this, &MainWindow::onPlaylistSelectionChanged);
+    connect(m_playlistListWidget, &PlaylistListWidget::foldersDropped,
+            this, &MainWindow::onFoldersDropped);
+    connect(m_playlistListWidget, &QWidget::customContextMenuRequested,
+            this, &MainWindow::onPlaylistContextMenuRequested);
+            
+    playlistGroupLayout->addWidget(m_playlistListWidget);
+
+    leftLayout->addWidget(playlistGroup);
+
+
+    // --- 右侧面板：歌曲列表 ---
+    QWidget* rightPanel = new QWidget(m_mainSplitter);
+    QVBoxLayout* rightLayout = new QVBoxLayout(rightPanel);
+    rightLayout->setContentsMargins(0, 0, 0, 0);
+
+    QGroupBox* songListGroup = new QGroupBox("歌曲列表", this);
+    QVBoxLayout* songListLayout = new QVBoxLayout(songListGroup);
+
+    m_songListWidget = new SongListWidget(this);
+    //为歌曲列表启用多选功能
+    m_songListWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_songListWidget->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(m_songListWidget, &QListWidget::itemDoubleClicked,
+            this, &MainWindow::onSongDoubleClicked);
+    connect(m_songListWidget, &SongListWidget::filesDropped,
+            this, &MainWindow::onFilesDroppedToSongList);
+    connect(m_songListWidget, &QWidget::customContextMenuRequested,
+            this, &MainWindow::onSongListContextMenuRequested);
+
+    // 列表缩略图：只为可见的行加载
+    m_songListWidget->setIconSize(QSize(ListCoverSize, ListCoverSize));
+    QPixmap blankCover(ListCoverSize, ListCoverSize);
+    blankCover.fill(Qt::transparent);
+    m_blankCoverIcon = QIcon(blankCover);
+    connect(m_songListWidget->verticalScrollBar(), &QScrollBar::valueChanged,
+            m_coverRequestTimer, qOverload<>(&QTimer::start));
+    
+    songListLayout->addWidget(m_songListWidget);
+    rightLayout->addWidget(songListGroup);
+    
+    // 现代滚动条样式
+    QString modernScrollBarStyle = R"(
+        QScrollBar:vertical {
+            background: transparent;
+            width: 8px;
+            margin: 0;
+            border-radius: 4px;
+        }
+        QScrollBar::handle:vertical {
+            background: #888888;
+            min-height: 30px;
+            border-radius: 4px;
+        }
+        QScrollBar::handle:vertical:hover {
+            background: #666666;
+        }
+        QScrollBar::add-line:vertical, QScrollBar::sub-line:vertical {
+            height: 0;
+            background: none;
+        }
+        QScrollBar::add-page:vertical, QScrollBar::sub-page:vertical {
+            background: none;
+        }
+        QScrollBar:horizontal {
+            background: transparent;
+            height: 8px;
+            margin: 0;
+            border-radius: 4px;
+        }
+        QScrollBar::handle:horizontal {
+            background: #888888;
+            min-width: 30px;
+            border-radius: 4px;
+        }
+        QScrollBar::handle:horizontal:hover {
+            background: #666666;
+        }
+        QScrollBar::add-line:horizontal, QScrollBar::sub-line:horizontal {
+            width: 0;
+            background: none;
+        }
+        QScrollBar::add-page:horizontal, QScrollBar::sub-page:horizontal {
+            background: none;
+        }
+    )";
+    
+    m_playlistListWidget->setStyleSheet(modernScrollBarStyle);
+    m_songListWidget->setStyleSheet(modernScrollBarStyle);
+
+    // 将左右面板添加到 Splitter
+    m_mainSplitter->addWidget(leftPanel);
+    m_mainSplitter->addWidget(rightPanel);
+    m_mainSplitter->setStretchFactor(0, 1); // 左侧面板拉伸因子
+    m_mainSplitter->setStretchFactor(1, 3); // 右侧面板拉伸因子 (使其更宽)
+
+    // 将 Splitter 添加到主布局
+    mainLayout->addWidget(m_mainSplitter);
+
+    mainLayout->setStretch(mainLayout->indexOf(m_mainSplitter), 1);
+
+    // 设置初始音量
+    m_audioOutput->setVolume(0.7);
+}
+
+void MainWindow::onInListModeClicked() {
+    if (m_inListMode == InListMode::Sequential) {
+        m_inListMode = InListMode::Random;
+        generateShuffledPlaylist(); // 切换到随机时生成列表
+    } else {
+        m_inListMode = InListMode::Sequential;
+        m_shuffledIndices.clear(); // 离开随机时清空列表
+    }
+    updateInListModeButton();
+}
+
+void MainWindow::onCrossListModeClicked() {
+    switch (m_crossListMode) {
+        case CrossListMode::ListLoop:
+            m_crossListMode = CrossListMode::SingleLoop;
+            break;
+        case CrossListMode::SingleLoop:
+            m_crossListMode = CrossListMode::Advance;
+            break;
+        case CrossListMode::Advance:
+            m_crossListMode = CrossListMode::ListLoop;
+            break;
+        // 'Stop' 模式不在此循环中，可以通过设置界面添加
+        case CrossListMode::Stop:
+            m_crossListMode = CrossListMode::ListLoop;
+            break;
+    }
+    updateCrossListModeButton();
+}
+
+
+// ↓↓↓ 实现新的函数，根据当前模式更新按钮的UI ↓↓↓
+void MainWindow::updateInListModeButton() {
+    if (m_inListMode == InListMode::Sequential) {
+    // 自定义图标
+        m_inListModeBtn->setIcon(QIcon(":/icons/sequential.png"));
+        m_inListModeBtn->setToolTip("顺序播放");
+    } else {
+    // 自定义图标
+        m_inListModeBtn->setIcon(QIcon(":/icons/random.png"));
+        m_inListModeBtn->setToolTip("随机播放");
+    }
+}
+
+// ↓↓↓ 修改 updateCrossListModeButton 函数 ↓↓↓
+void MainWindow::updateCrossListModeButton() {
+    switch (m_crossListMode) {
+        case CrossListMode::ListLoop:
+            m_crossListModeBtn->setIcon(QIcon(":/icons/listloop.png"));
+            m_crossListModeBtn->setToolTip("列表循环");
+            break;
+        case CrossListMode::SingleLoop:
+            m_crossListModeBtn->setIcon(QIcon(":/icons/singleloop.png"));
+            m_crossListModeBtn->setToolTip("单曲循环");
+            break;
+        case CrossListMode::Advance:
+            m_crossListModeBtn->setIcon(QIcon(":/icons/advance.png"));
+            m_crossListModeBtn->setToolTip("列表顺序");
+            break;
+        case CrossListMode::Stop:
+            // 如果您也为 Stop 模式准备了图标
+            // m_crossListModeBtn->setIcon(QIcon(":/icons/stop.png"));
+            m_crossListModeBtn->setIcon(style()->standardIcon(QStyle::SP_MediaStop));
+            m_crossListModeBtn->setToolTip("播完停止");
+            break;
+}
+}
+
+void MainWindow::closeEvent(QCloseEvent *event)
+{
+    if (this->isVisible() && m_trayIcon && m_trayIcon->isVisible()) {
+        // 隐藏主窗口到托盘，不保存设置（仅在真正退出时保存）
+        this->hide();
+        event->ignore();
+        return;  // 隐藏时直接返回，不保存geometry
+    }
+    
+    // 只有在真正退出时才保存设置
+    QSettings settings;
+    
+    // 保存窗口的几何信息（位置和大小）
+    settings.setValue("geometry", saveGeometry());
+    
+    // 保存 Splitter 的状态（两个面板的相对大小）
+    settings.setValue("splitterState", m_mainSplitter->saveState());
+
+    // 保存当前音量滑块的值
+    settings.setValue("volume", m_volumeSlider->value());
+
+    settings.setValue("lastPlaylistIndex", m_currentPlaylistIndex);
+    settings.setValue("lastSongIndex", m_currentSongIndex);
+
+    settings.setValue("inListMode", static_cast<int>(m_inListMode));
+    settings.setValue("crossListMode", static_cast<int>(m_crossListMode));
+
+    // 调用基类的 closeEvent，确保窗口能正常关闭
+    QMainWindow::closeEvent(event);
+}
+
+void MainWindow::onTrayIconActivated(QSystemTrayIcon::ActivationReason reason)
+{
+    // 我们只关心单击事件 (Trigger)，忽略双击、中键点击等
+    if (reason == QSystemTrayIcon::Trigger) {
+        
+        // 判断当前窗口是否可见（或者是否被最小化了）
+        // isMinimized() 对于隐藏的窗口返回 false，所以需要 isVisible() 一起判断
+        if (this->isVisible() && !this->isMinimized()) {
+            // --- 情况A: 窗口当前是可见且正常的 ---
+            //缩回托盘，隐藏窗口
+            this->hide();
+            
+        } else {
+            // --- 情况B: 窗口当前是隐藏的，或是最小化状态 ---
+            //跳到最前
+            
+            //确保窗口可见（如果是 hide() 状态，则显示）
+            this->show();
+            
+            //恢复窗口状态（如果是最小化，则恢复正常）
+            this->setWindowState(windowState() & ~Qt::WindowMinimized);
+            
+            //提升并激活窗口
+            this->raise();
+            this->activateWindow();
+        }
+    }
+}
+
+void MainWindow::updatePlaylistView() {
+    // 阻止信号触发，防止在更新UI时循环调用槽函数
+    m_playlistListWidget->blockSignals(true);
+    
+    m_playlistListWidget->clear();
+    for (const Playlist* pl : m_playlistManager->getPlaylists()) {
+        m_playlistListWidget->addItem(
+            QString("%1 (%2)").arg(pl->getName()).arg(pl->songCount())
+        );
+    }
+
+    // 恢复当前选择
+    if (m_currentPlaylistIndex >= 0 && m_currentPlaylistIndex < m_playlistListWidget->count()) {
+        m_playlistListWidget->setCurrentRow(m_currentPlaylistIndex);
+    }
+    
+    m_playlistListWidget->blockSignals(false);
+}
+
+void MainWindow::updateSongListView() {
+    Diagnostics::ScopedTimer timer(Diagnostics::ListRebuild);
+    TraceRecorder::Span span("updateSongListView", "ui");
+    m_songListWidget->clear();
+    
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist) return;
+
+    const SongLibrary* library = m_playlistManager->library();
+    QListWidgetItem* itemToScrollTo = nullptr;
+
+    const int songCount = playlist->songCount();
+    for (int index = 0; index < songCount; ++index) {
+        // 显示格式: 歌手 - 歌曲名
+        QString itemText = QString("%1 - %2").arg(playlist->songArtist(index), playlist->songTitle(index));
+        
+        // --- 2. 创建列表项 ---
+        QListWidgetItem* item = new QListWidgetItem(itemText);
+        item->setData(Qt::UserRole, index);
+        item->setIcon(m_blankCoverIcon);
+        
+        // 检查当前UI选中的列表(m_currentPlaylistIndex)是否就是正在播放的列表(m_playingPlaylistIndex)
+        // 并且，当前歌曲的索引(index)是否就是正在播放的歌曲的索引(m_currentSongIndex)
+        if (m_currentPlaylistIndex == m_playingPlaylistIndex && index == m_currentSongIndex) {
+            item->setFont(m_playingSongFont);
+            item->setBackground(QColor("#5E81AC"));
+            item->setForeground(QColor("#ECEFF4"));
+            itemToScrollTo = item;
+        } else {
+            item->setBackground(Qt::NoBrush);
+        }
+
+        // 后台检测发现文件已丢失，用灰色标出
+        if (library->isMissing(playlist->songId(index))) {
+            item->setForeground(QColor("#7B8394"));
+            item->setToolTip("文件不存在：" + playlist->songFilePath(index));
+        }
+        
+        m_songListWidget->addItem(item);
+    }
+    
+    // --- 5. 执行滚动 ---
+    if (itemToScrollTo) {
+        m_songListWidget->scrollToItem(itemToScrollTo, QAbstractItemView::PositionAtCenter);
+    }
+
+    // 等布局完成后再确定哪些行可见
+    m_coverRequestTimer->start();
+}
+
+// 读取播放列表内所有歌曲的元数据（仅读取未加载的歌曲以提高效率）
+// 元数据保存在全局歌曲表中，同一首歌即使出现在多个列表里也只扫描一次
+bool MainWindow::loadPlaylistMetaData(int playlistIndex) {
+    TraceRecorder::Span span("loadPlaylistMetaData", "tags");
+    Playlist* playlist = m_playlistManager->getPlaylist(playlistIndex);
+    if (!playlist) return false;
+    
+    SongLibrary* library = m_playlistManager->library();
+    bool hasNewMetaData = false;  // 标记是否有新的元数据被加载
+    
+    for (int id : playlist->getSongIds()) {
+        // 如果歌曲已经扫描过，跳过读取（CUE 音轨的信息来自 CUE 文件，也不读取）
+        if (library->isMetaDataLoaded(id) || library->isVirtualTrack(id)) {
+            continue;
+        }
+        library->setMetaDataLoaded(id);
+        
+        // 使用 TagLib 读取文件元数据
+        Diagnostics::ScopedTimer timer(Diagnostics::TagRead);
+        TagLib::FileRef file(library->filePath(id).toStdWString().c_str());
+        
+        if (!file.isNull() && file.tag()) {
+            TagLib::Tag* tag = file.tag();
+            
+            QString title = QString::fromStdWString(tag->title().toWString());
+            QString artist = QString::fromStdWString(tag->artist().toWString());
+            QString album = QString::fromStdWString(tag->album().toWString());
+            
+            // 如果元数据为空，使用文件名作为标题
+            if (title.isEmpty()) {
+                title = library->title(id);  // 保持原来从文件名提取的标题
+            }
+            if (artist.isEmpty()) {
+                artist = "未知艺术家";
+            }
+            if (album.isEmpty()) {
+                album = "未知专辑";
+            }
+            
+            // 更新歌曲元数据
+            library->updateMetaData(id, title, artist, album);
+            hasNewMetaData = true;
+        }
+    }
+    
+    // 如果有新的元数据被加载，保存播放列表以便下次使用
+    if (hasNewMetaData) {
+        m_playlistManager->savePlaylists();
+    }
+    return hasNewMetaData;
+}
+
+void MainWindow::playSong(int index) {
+    TraceRecorder::Span span("playSong", "playback");
+    m_playingPlaylistIndex = m_currentPlaylistIndex; 
+    
+    Playlist* playlist = m_playlistManager->getPlaylist(m_playingPlaylistIndex); // 使用 m_playingPlaylistIndex 获取
+    if (!playlist || index < 0 || index >= playlist->songCount()) {
+        // 如果播放失败，重置状态
+        m_playingPlaylistIndex = -1; 
+        return;
+    }
+    
+    // 拷贝一份（隐式共享，几乎无开销），setSource 可能同步触发元数据更新
+    QString title = playlist->songTitle(index);
+    QString artist = playlist->songArtist(index);
+    QString filePath = playlist->songFilePath(index);
+    m_currentSongIndex = index;
+
+    // 已被标记为丢失的文件：再确认一次，确实不存在就不交给播放器去报错
+    SongLibrary* library = m_playlistManager->library();
+    int songId = playlist->songId(index);
+    if (library->isMissing(songId)) {
+        if (QFileInfo::exists(filePath)) {
+            library->setMissing(songId, false);
+        } else {
+            m_player->stop();
+            m_songTitleLabel->setText(title);
+            m_songArtistLabel->setText("文件已丢失，可在右键菜单中重新定位");
+            updateSongListView();
+            updatePlayPauseButton();
+            return;
+        }
+    }
+    
+    // CUE 音轨与正在播放的是同一个文件时不重新打开文件，直接跳转；
+    // 下一首紧接着上一首开始时连跳转都不需要，切歌没有停顿
+    qint64 trackStart = library->trackStart(songId);
+    bool sameSource = library->isVirtualTrack(songId)
+                      && m_player->source() == QUrl::fromLocalFile(filePath)
+                      && m_player->mediaStatus() != QMediaPlayer::NoMedia
+                      && m_player->mediaStatus() != QMediaPlayer::InvalidMedia;
+    m_trackStart = trackStart;
+    m_trackEnd = library->trackEnd(songId);
+
+    if (sameSource) {
+        if (m_pendingSeek >= 0) {
+            m_pendingSeek = trackStart;   // 文件还没加载完，等加载完再跳
+        } else if (qAbs(m_player->position() - trackStart) > 300) {
+            m_player->setPosition(trackStart);
+        }
+        m_player->play();
+        updateTrackRange();
+    } else {
+        m_pendingSeek = trackStart > 0 ? trackStart : -1;
+        m_fileOpenTimer.start();   // 加载完成时记录打开文件的耗时
+        m_player->setSource(QUrl::fromLocalFile(filePath));
+        m_player->play();
+    }
+    
+    m_songTitleLabel->setText(title);
+    m_songArtistLabel->setText(artist);
+    updateNowPlayingCover();
+    
+    // 更新托盘菜单的歌曲名和托盘图标悬浮提示（快速启动时托盘可能还没创建）
+    if (m_trayIcon) {
+        m_traySongLabel->setText(title);
+        m_trayIcon->setToolTip(QString("%1 - %2").arg(artist, title));
+    }
+    
+    //直接调用 updateSongListView()
+    // 这个函数现在已经包含了高亮和滚动的所有逻辑，一举两得
+    updateSongListView();
+    
+    updatePlayPauseButton();
+    notifyRemoteStateChanged();   // 同一文件中的 CUE 音轨切换时播放状态不变，需要单独通知
+}
+
+void MainWindow::updatePlayPauseButton() {
+    // 更新托盘菜单的播放/暂停按钮图标
+    QPushButton* trayPlayPauseBtn = m_trayMenu ? m_trayMenu->findChild<QPushButton*>("trayPlayPauseBtn") : nullptr;
+    
+    if (m_player->playbackState() == QMediaPlayer::PlayingState) {
+        m_playPauseBtn->setIcon(style()->standardIcon(QStyle::SP_MediaPause));
+        if (trayPlayPauseBtn) {
+            trayPlayPauseBtn->setIcon(style()->standardIcon(QStyle::SP_MediaPause));
+        }
+    } else {
+        m_playPauseBtn->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
+        if (trayPlayPauseBtn) {
+            trayPlayPauseBtn->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
+        }
+    }
+}
+
+QString MainWindow::formatTime(qint64 milliseconds) {
+    int seconds = milliseconds / 1000;
+    int minutes = seconds / 60;
+    seconds = seconds % 60;
+    return QString("%1:%2")
+        .arg(minutes, 2, 10, QChar('0'))
+        .arg(seconds, 2, 10, QChar('0'));
+}
+
+void MainWindow::onPlayPauseClicked() {
+    if (m_currentSongIndex < 0) {
+        playSong(0);
+        return;
+    }
+    
+    if (m_player->playbackState() == QMediaPlayer::PlayingState) {
+        m_player->pause();
+    } else {
+        m_player->play();
+    }
+    updatePlayPauseButton();
+}
+
+void MainWindow::onPreviousClicked() {
+    if (m_currentSongIndex > 0) {
+        playSong(m_currentSongIndex - 1);
+    }
+}
+
+void MainWindow::onNextClicked() {
+    playNextSong();
+}
+
+
+// ↓↓↓ 新增辅助函数，封装“播放下一曲”的全部逻辑 ↓↓↓
+// ↓↓↓ 实现新的核心逻辑函数 playNextSong ↓↓↓
+void MainWindow::playNextSong() {
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist || playlist->songCount() == 0) {
+        return;
+    }
+
+    // --- 第 1 部分：决定列表内的下一首歌曲索引 ---
+    int nextIndexInList = -1;
+    bool isListFinished = false;
+
+    if (m_crossListMode == CrossListMode::SingleLoop) {
+        // 对于单曲循环，下一首永远是当前这首
+        nextIndexInList = m_currentSongIndex;
+    } else if (m_inListMode == InListMode::Random) {
+        // 随机模式
+        m_shuffledPlaybackIndex++;
+        if (m_shuffledPlaybackIndex < m_shuffledIndices.size()) {
+            nextIndexInList = m_shuffledIndices.at(m_shuffledPlaybackIndex);
+        } else {
+            isListFinished = true; // 随机列表已播完
+        }
+    } else { // 顺序模式
+        if (m_currentSongIndex + 1 < playlist->songCount()) {
+            nextIndexInList = m_currentSongIndex + 1;
+        } else {
+            isListFinished = true; // 顺序列表已播完
+        }
+    }
+
+    // --- 第 2 部分：根据列表是否播完，以及列表间过渡模式，决定最终动作 ---
+    if (!isListFinished) {
+        // 情况 A: 列表还没播完，直接播放下一首
+        playSong(nextIndexInList);
+    } else {
+        // 情况 B: 列表已经播完了
+        switch (m_crossListMode) {
+            case CrossListMode::ListLoop:
+                // 重新开始当前列表的第一首歌
+                if (m_inListMode == InListMode::Random) {
+                    generateShuffledPlaylist(); // 重新生成随机顺序
+                    playSong(m_shuffledIndices.at(0));
+                } else {
+                    playSong(0); // 播放顺序第一首
+                }
+                break;
+            
+            case CrossListMode::Advance:
+                // 切换到下一个播放列表
+                {
+                    int nextPlaylistIndex = (m_currentPlaylistIndex + 1) % m_playlistManager->playlistCount();
+                    m_playlistListWidget->setCurrentRow(nextPlaylistIndex);
+                    // setCurrentRow 会触发 onPlaylistSelectionChanged, 
+                    // 它会更新 m_currentPlaylistIndex 并刷新歌曲列表
+                    
+                    // 自动播放新列表的第一首歌
+                    // 需要稍作延迟，等待 onPlaylistSelectionChanged 完成
+                    QTimer::singleShot(50, this, [this]() {
+                        Playlist* newPlaylist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+                        if (newPlaylist && newPlaylist->songCount() > 0) {
+                             if (m_inListMode == InListMode::Random) {
+                                generateShuffledPlaylist();
+                                playSong(m_shuffledIndices.at(0));
+                             } else {
+                                playSong(0);
+                             }
+                        }
+                    });
+                }
+                break;
+
+            case CrossListMode::SingleLoop:
+                // 理论上 isListFinished 为 true 时不会进入这里，
+                // 但为保险起见，我们还是让它循环当前这首
+                playSong(m_currentSongIndex);
+                break;
+
+            case CrossListMode::Stop:
+                // 播完停止，什么都不做
+                break;
+        }
+    }
+}
+
+// ↓↓↓ 实现新增的辅助函数，用于生成随机播放顺序 ↓↓↓
+void MainWindow::generateShuffledPlaylist() {
+    m_shuffledIndices.clear();
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist || playlist->songCount() == 0) {
+        return;
+    }
+
+    // 创建一个从 0 到 n-1 的顺序列表
+    for (int i = 0; i < playlist->songCount(); ++i) {
+        m_shuffledIndices.append(i);
+    }
+    
+    // 使用 C++11 的标准方法来打乱列表，这比旧的 rand() 效果更好
+    std::shuffle(m_shuffledIndices.begin(), m_shuffledIndices.end(), *QRandomGenerator::global());
+
+    m_shuffledPlaybackIndex = 0; // 重置随机播放的起始位置
+    // 不输出完整的顺序：上万首歌时格式化列表比打乱本身还慢
+    qCDebug(lcPlayback) << "生成新的随机播放顺序，共" << m_shuffledIndices.size() << "首";
+}
+
+
+void MainWindow::onAddSongsClicked() {
+    QStringList files = QFileDialog::getOpenFileNames(
+        this,
+        "选择音乐文件",
+        QDir::homePath(),
+        "音频文件 (*.mp3 *.wav *.ogg *.flac *.m4a *.cue);;所有文件 (*.*)"
+    );
+    
+    if (files.isEmpty()) return;
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist) return;
+    for (QString& file : files) {
+        file = QDir::toNativeSeparators(file);
+    }
+    // CUE 文件展开为多条音轨，它引用的整轨文件不再单独添加
+    playlist->addSongs(CueSheet::expandFiles(files));
+    
+    updatePlaylistView();
+    updateSongListView();
+    
+    // 如果当前是随机模式，则重新生成随机列表
+    if (m_inListMode == InListMode::Random) {
+        generateShuffledPlaylist();
+    }
+}
+
+void MainWindow::onCreatePlaylistClicked() {
+    bool ok;
+    QString name = QInputDialog::getText(
+        this,
+        "新建播放列表",
+        "请输入播放列表名称:",
+        QLineEdit::Normal,
+        "新建列表",
+        &ok
+    );
+    
+    if (ok && !name.isEmpty()) {
+        m_playlistManager->addPlaylist(name);
+        updatePlaylistView();
+        // 自动选中新创建的列表
+        m_playlistListWidget->setCurrentRow(m_playlistManager->playlistCount() - 1);
+    }
+}
+
+// 导入 M3U / M3U8 / PLS：每个文件创建一个同名的新列表
+void MainWindow::onImportPlaylistClicked() {
+    QStringList files = QFileDialog::getOpenFileNames(
+        this,
+        "导入播放列表",
+        QDir::homePath(),
+        "播放列表 (*.m3u *.m3u8 *.pls);;所有文件 (*.*)"
+    );
+    if (files.isEmpty()) return;
+
+    QStringList failed;
+    for (const QString& file : files) {
+        QString error;
+        QList<Song> songs = PlaylistFile::read(file, &error);
+        if (songs.isEmpty()) {
+            failed.append(QString("%1：%2").arg(QFileInfo(file).fileName(), error));
+            continue;
+        }
+
+        m_playlistManager->addPlaylist(QFileInfo(file).completeBaseName());
+        Playlist* playlist = m_playlistManager->getPlaylist(m_playlistManager->playlistCount() - 1);
+        if (playlist) {
+            playlist->addSongs(songs);   // 一次性批量加入
+        }
+    }
+
+    m_playlistManager->savePlaylists();
+    updatePlaylistView();
+    m_playlistListWidget->setCurrentRow(m_playlistManager->playlistCount() - 1);
+
+    if (!failed.isEmpty()) {
+        QMessageBox::warning(this, "导入失败", failed.join("\n"));
+    }
+}
+
+void MainWindow::onExportPlaylistClicked() {
+    Playlist* playlist = m_playlistManager->getPlaylist(m_playlistListWidget->currentRow());
+    if (!playlist) return;
+
+    QString filePath = QFileDialog::getSaveFileName(
+        this,
+        "导出播放列表",
+        QDir::homePath() + "/" + playlist->getName() + ".m3u8",
+        "M3U8 播放列表 (*.m3u8);;M3U 播放列表 (*.m3u);;PLS 播放列表 (*.pls)"
+    );
+    if (filePath.isEmpty()) return;
+
+    QString error;
+    if (!PlaylistFile::write(filePath, playlist, &error)) {
+        QMessageBox::warning(this, "导出失败", QString("无法写入 %1：\n%2").arg(filePath, error));
+    }
+}
+
+void MainWindow::onDeletePlaylistClicked() {
+    //获取所有被选中的项
+    QList<QListWidgetItem*> selectedItems = m_playlistListWidget->selectedItems();
+    if (selectedItems.isEmpty()) {
+        return; // 如果没有选中项，则不执行任何操作
+    }
+
+    //将项转换为行号索引
+    QList<int> indicesToDelete;
+    for (QListWidgetItem* item : selectedItems) {
+        indicesToDelete.append(m_playlistListWidget->row(item));
+    }
+    
+    //对索引进行降序排序
+    //必须从后往前删除，否则前面的索引会失效
+    std::sort(indicesToDelete.begin(), indicesToDelete.end(), std::greater<int>());
+
+    //执行删除
+    for (int index : indicesToDelete) {
+        // 确保不会删除最后一个播放列表
+        if (m_playlistManager->playlistCount() > 1) {
+            m_playlistManager->removePlaylist(index);
+        } else {
+            QMessageBox::warning(this, "警告", "至少需要保留一个播放列表！");
+            break; // 停止继续删除
+        }
+    }
+    
+    //更新状态和UI
+    m_folderWatcher->setFolders(m_playlistManager->watchedFolders());
+    m_currentPlaylistIndex = 0;
+    m_currentSongIndex = -1;
+    resetPlayerState(); // 批量删除后最好重置播放器
+    updatePlaylistView();
+    updateSongListView();
+
+    // 如果是随机模式，重新生成
+    if (m_inListMode == InListMode::Random) {
+        generateShuffledPlaylist();
+    }
+}
+
+void MainWindow::onPlaylistSelectionChanged() {
+    int index = m_playlistListWidget->currentRow();
+    // 当用户选择的行无效，或者没有真正改变时，直接返回
+    if (index < 0 || index == m_currentPlaylistIndex) {
+        return; 
+    }
+    
+    // 更新当前播放列表的索引
+    m_currentPlaylistIndex = index;
+    
+    // 读取该播放列表内所有歌曲的元数据
+    loadPlaylistMetaData(index);
+
+    // 根据新的 m_currentPlaylistIndex 更新右侧的歌曲列表视图
+    updateSongListView();
+}
+
+void MainWindow::onSongDoubleClicked(QListWidgetItem* item) {
+    int index = item->data(Qt::UserRole).toInt();
+    playSong(index);
+}
+
+void MainWindow::onPositionChanged(qint64 position) {
+    // CUE 音轨播到了结束位置就切到下一首；文件中的最后一首仍由 EndOfMedia 处理，避免切两次
+    if (m_trackEnd > 0 && m_pendingSeek < 0 && position >= m_trackEnd
+        && m_trackEnd < m_player->duration() - 500) {
+        // 先清掉结束位置，没有开始新歌曲时（例如 "播完停止"）不会反复触发
+        m_trackEnd = 0;
+        int endedIndex = m_currentSongIndex;
+        playNextSong();
+        if (m_crossListMode == CrossListMode::Stop && m_trackEnd == 0 && m_currentSongIndex == endedIndex) {
+            m_player->stop();
+            updatePlayPauseButton();
+        }
+        return;
+    }
+
+    // 进度条和时间显示的都是相对于音轨开头的位置
+    qint64 relative = qMax<qint64>(0, position - m_trackStart);
+    m_progressSlider->setValue(relative);
+    m_currentTimeLabel->setText(formatTime(relative));
+}
+
+void MainWindow::onDurationChanged(qint64 duration) {
+    Q_UNUSED(duration);
+    updateTrackRange();
+}
+
+void MainWindow::updateTrackRange() {
+    qint64 end = m_trackEnd > 0 ? m_trackEnd : m_player->duration();
+    qint64 length = qMax<qint64>(0, end - m_trackStart);
+    m_progressSlider->setRange(0, length);
+    m_totalTimeLabel->setText(formatTime(length));
+}
+
+void MainWindow::onProgressSliderMoved(int position) {
+    m_player->setPosition(m_trackStart + position);
+}
+
+void MainWindow::onVolumeChanged(int value) {
+    // a. 设置播放器的实际音量
+    m_audioOutput->setVolume(value / 100.0);
+
+    // b. 同步两个音量滑块的值（防止循环调用）
+    if (m_volumeSlider->value() != value) {
+        m_volumeSlider->blockSignals(true);
+        m_volumeSlider->setValue(value);
+        m_volumeSlider->blockSignals(false);
+    }
+    if (m_trayVolumeSlider && m_trayVolumeSlider->value() != value) {
+        m_trayVolumeSlider->blockSignals(true);
+        m_trayVolumeSlider->setValue(value);
+        m_trayVolumeSlider->blockSignals(false);
+    }
+
+    // c. 在当前鼠标光标位置显示一个临时的百分比提示
+    QString tooltipText = QString("音量: %1%").arg(value);
+    QToolTip::showText(QCursor::pos(), tooltipText, m_volumeSlider);
+}
+
+void MainWindow::onMediaStatusChanged(QMediaPlayer::MediaStatus status) {
+    if (m_fileOpenTimer.isValid()) {
+        if (status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::BufferedMedia) {
+            Diagnostics::record(Diagnostics::FileOpen, m_fileOpenTimer.nsecsElapsed() / 1000);
+            m_fileOpenTimer.invalidate();
+        } else if (status == QMediaPlayer::InvalidMedia || status == QMediaPlayer::NoMedia) {
+            m_fileOpenTimer.invalidate();
+        }
+    }
+    // 播放过程中数据跟不上（网络盘、磁盘繁忙等）
+    if (status == QMediaPlayer::StalledMedia) {
+        Diagnostics::count(Diagnostics::DecoderUnderrun);
+    }
+
+    // 文件加载完成后才能跳转到 CUE 音轨的开始位置
+    if (m_pendingSeek >= 0 && (status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::BufferedMedia)) {
+        m_player->setPosition(m_pendingSeek);
+        m_pendingSeek = -1;
+    } else if (status == QMediaPlayer::InvalidMedia || status == QMediaPlayer::NoMedia) {
+        m_pendingSeek = -1;
+    }
+
+    if (status == QMediaPlayer::EndOfMedia) {
+        // 当一首歌自然播放结束时，调用播放下一首的逻辑
+        playNextSong();
+    }
+    updatePlayPauseButton();
+}
+
+void MainWindow::onMetaDataChanged() {
+    if (m_currentSongIndex < 0) return;
+
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist) return;
+
+    // CUE 音轨的信息以 CUE 文件为准，文件自带的标签描述的是整张专辑
+    if (m_playlistManager->library()->isVirtualTrack(playlist->songId(m_currentSongIndex))) return;
+
+    // 获取元数据
+    QMediaMetaData metaData = m_player->metaData();
+
+    QString title = metaData.value(QMediaMetaData::Title).toString();
+    QString artist = metaData.value(QMediaMetaData::AlbumArtist).toString();
+    if (artist.isEmpty()) {
+        artist = metaData.value(QMediaMetaData::ContributingArtist).toString();
+    }
+    QString album = metaData.value(QMediaMetaData::AlbumTitle).toString();
+
+    // 使用新函数来更新播放列表中的歌曲数据
+    playlist->updateSongMetaData(m_currentSongIndex, title, artist, album);
+
+    // 从播放列表重新获取更新后的歌曲信息，更新 UI 显示
+    m_songTitleLabel->setText(playlist->songTitle(m_currentSongIndex));
+    m_songArtistLabel->setText(playlist->songArtist(m_currentSongIndex));
+
+    // 刷新歌曲列表视图，以显示更新后的信息
+    updateSongListView();
+}
+
+void MainWindow::onFilesDroppedToSongList(const QList<QUrl>& urls) {
+    Playlist* currentPlaylist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!currentPlaylist) {
+        return;
+    }
+
+    QStringList files;
+    for (const QUrl& url : urls) {
+        files.append(url.toLocalFile());
+    }
+    currentPlaylist->addSongs(CueSheet::expandFiles(files));
+
+    updatePlaylistView(); // 更新播放列表的歌曲计数
+    updateSongListView();
+
+    // 如果是随机模式，重新生成随机列表
+    if (m_inListMode == InListMode::Random) {
+        generateShuffledPlaylist();
+    }
+}
+
+void MainWindow::onFoldersDropped(const QList<QUrl>& urls) {
+    TraceRecorder::Span span("onFoldersDropped", "import");
+    qCDebug(lcImport) << "接收到" << urls.size() << "个拖放项目";
+
+    for (const QUrl& url : urls) {
+        QString folderPath = QDir::cleanPath(url.toLocalFile());
+        QFileInfo folderInfo(folderPath);
+
+        // 安全检查：确保拖进来的是一个真实存在的目录
+        if (!folderInfo.isDir()) {
+            qCDebug(lcImport) << "跳过非目录项目:" << folderPath;
+            continue; // 继续处理下一个拖放项目
+        }
+
+        // 1. 使用文件夹名创建新的播放列表
+        QString playlistName = folderInfo.fileName();
+        m_playlistManager->addPlaylist(playlistName);
+        
+        // 2. 获取刚刚创建的播放列表的指针
+        int newPlaylistIndex = m_playlistManager->playlistCount() - 1;
+        Playlist* newPlaylist = m_playlistManager->getPlaylist(newPlaylistIndex);
+        if (!newPlaylist) {
+            qCWarning(lcImport) << "无法获取新创建的播放列表";
+            continue;
+        }
+        // 该列表之后会随文件夹内容的变化自动同步
+        newPlaylist->setWatchedFolder(folderPath);
+
+        // 3. 核心步骤：使用 QDirIterator 递归扫描文件夹
+        // 创建一个迭代器，它会查找指定目录（包括所有子目录）中所有符合后缀名过滤器的文件
+        QDirIterator it(folderPath, AudioFileFilters, QDir::Files, QDirIterator::Subdirectories);
+        
+        // 先收集所有文件，CUE 需要知道同目录下有哪些整轨文件
+        QStringList filePaths;
+        {
+            TraceRecorder::Span scanSpan("scanFolder", "import");
+            while (it.hasNext()) {
+                filePaths.append(it.next());
+            }
+        }
+        QList<Song> songs;
+        {
+            TraceRecorder::Span addSpan("addSongs", "import");
+            songs = CueSheet::expandFiles(filePaths);
+            newPlaylist->addSongs(songs);
+        }
+        int songsFound = songs.size();
+        qCInfo(lcImport) << "导入文件夹" << folderPath << "：添加了" << songsFound << "首歌曲";
+    }
+    
+    // 4. 所有文件夹都处理完毕后，一次性更新UI，并开始监视新文件夹
+    m_folderWatcher->setFolders(m_playlistManager->watchedFolders());
+    updatePlaylistView();
+    // 自动选中我们最后创建的那个播放列表
+    if (m_playlistManager->playlistCount() > 0) {
+        m_playlistListWidget->setCurrentRow(m_playlistManager->playlistCount() - 1);
+    }
+}
+
+void MainWindow::onPlaylistContextMenuRequested(const QPoint& pos) {
+    QMenu contextMenu(this);
+
+    // 创建动作
+    QAction* createAction = contextMenu.addAction("新建播放列表");
+    QAction* deleteAction = contextMenu.addAction("删除选中列表");
+
+    // 左侧菜单：排序播放列表
+    contextMenu.addSeparator();
+    QAction* sortAction = contextMenu.addAction("列表按名称排序");
+
+    // 与其他播放器交换列表
+    contextMenu.addSeparator();
+    QAction* importAction = contextMenu.addAction("导入播放列表...");
+    QAction* exportAction = contextMenu.addAction("导出播放列表...");
+    connect(importAction, &QAction::triggered, this, &MainWindow::onImportPlaylistClicked);
+    connect(exportAction, &QAction::triggered, this, &MainWindow::onExportPlaylistClicked);
+
+    // 监视文件夹的列表可以取消监视，变回普通列表
+    Playlist* selectedPlaylist = m_playlistManager->getPlaylist(m_playlistListWidget->currentRow());
+    if (!selectedPlaylist || selectedPlaylist->songCount() == 0) {
+        exportAction->setEnabled(false);
+    }
+    // 从文件管理器“打开方式”或命令行传进来的文件添加到哪个列表（未设置时为当前列表）
+    if (selectedPlaylist) {
+        QAction* openWithAction = contextMenu.addAction("作为“打开方式”的目标列表");
+        openWithAction->setCheckable(true);
+        openWithAction->setChecked(QSettings().value("OpenWith/playlist").toString() == selectedPlaylist->getName());
+        QString playlistName = selectedPlaylist->getName();
+        connect(openWithAction, &QAction::toggled, this, [playlistName](bool checked) {
+            QSettings settings;
+            if (checked) {
+                settings.setValue("OpenWith/playlist", playlistName);
+            } else {
+                settings.remove("OpenWith/playlist");
+            }
+        });
+    }
+    if (selectedPlaylist && selectedPlaylist->isWatched()) {
+        contextMenu.addSeparator();
+        QAction* stopWatchingAction = contextMenu.addAction("停止监视文件夹");
+        stopWatchingAction->setToolTip(selectedPlaylist->watchedFolder());
+        connect(stopWatchingAction, &QAction::triggered, this, &MainWindow::onStopWatchingFolderClicked);
+    }
+
+    // 逻辑判断：只有当选中了一个列表，并且总列表数大于1时，才允许删除
+    if (m_playlistListWidget->currentRow() < 0 || m_playlistManager->playlistCount() <= 1) {
+        deleteAction->setEnabled(false);
+    }
+
+    // 如果列表总数少于2个，也没必要排序
+    if (m_playlistManager->playlistCount() < 2) {
+        sortAction->setEnabled(false);
+    }
+
+    // 将动作的 triggered 信号连接到已有的槽函数
+    connect(createAction, &QAction::triggered, this, &MainWindow::onCreatePlaylistClicked);
+    connect(deleteAction, &QAction::triggered, this, &MainWindow::onDeletePlaylistClicked);
+    // 连接到“排序播放列表”的槽函数
+    connect(sortAction, &QAction::triggered, this, &MainWindow::onSortPlaylistsAction);
+
+    // 在鼠标光标位置显示菜单
+    // mapToGlobal 将控件的局部坐标转换为屏幕的全局坐标
+    contextMenu.exec(m_playlistListWidget->mapToGlobal(pos));
+}
+
+// 当在歌曲列表上右键点击时调用
+void MainWindow::onSongListContextMenuRequested(const QPoint& pos) {
+    QMenu contextMenu(this);
+
+    QAction* addAction = contextMenu.addAction("添加歌曲...");
+
+    // 右侧菜单：排序歌曲
+    contextMenu.addSeparator();
+    QAction* sortAction = contextMenu.addAction("歌曲按名称排序");
+
+    // 获取当前列表
+    Playlist* currentPlaylist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!currentPlaylist || currentPlaylist->songCount() < 2) {
+        sortAction->setEnabled(false);
+    }
+    
+    // 只有当用户确实选中了一首歌曲时，才显示删除相关的选项
+    if (m_songListWidget->currentItem() != nullptr) {
+        contextMenu.addSeparator(); // 添加一条分割线，让UI更清晰
+        
+        // 编辑歌曲信息选项
+        QAction* editInfoAction = contextMenu.addAction(
+            m_songListWidget->selectedItems().size() > 1 ? "批量编辑歌曲信息..." : "编辑歌曲信息...");
+        connect(editInfoAction, &QAction::triggered, this, &MainWindow::onEditSongInfoClicked);
+        QAction* guessTagsAction = contextMenu.addAction("从文件名猜测标签...");
+        connect(guessTagsAction, &QAction::triggered, this, &MainWindow::onGuessTagsClicked);
+        
+        // 音频转码选项
+        QAction* transcodeAction = contextMenu.addAction("音频转码...");
+        connect(transcodeAction, &QAction::triggered, this, &MainWindow::onTranscodeAudioClicked);
+        
+        contextMenu.addSeparator();
+        QAction* deleteAction = contextMenu.addAction("删除列表中的歌曲");
+        QAction* deleteFromDiskAction = contextMenu.addAction("删除磁盘中的歌曲");
+        connect(deleteAction, &QAction::triggered, this, &MainWindow::onDeleteSongClicked);
+        connect(deleteFromDiskAction, &QAction::triggered, this, &MainWindow::onDeleteSongFromDiskClicked);
+    }
+
+    // 歌曲库中有丢失的文件时，提供批量重新定位
+    int missingCount = m_playlistManager->library()->missingCount();
+    if (missingCount > 0) {
+        contextMenu.addSeparator();
+        QAction* relocateAction = contextMenu.addAction(QString("重新定位丢失的文件 (%1)...").arg(missingCount));
+        connect(relocateAction, &QAction::triggered, this, &MainWindow::onRelocateMissingFilesClicked);
+    }
+
+    contextMenu.addSeparator();
+    QAction* duplicatesAction = contextMenu.addAction("查找重复歌曲...");
+    connect(duplicatesAction, &QAction::triggered, this, &MainWindow::onFindDuplicatesClicked);
+    
+    connect(addAction, &QAction::triggered, this, &MainWindow::onAddSongsClicked);
+    // 连接到“排序歌曲”的槽函数
+    connect(sortAction, &QAction::triggered, this, &MainWindow::onSortSongsAction);
+    
+    contextMenu.exec(m_songListWidget->mapToGlobal(pos));
+}
+
+// ↓↓↓ 在文件末尾添加两个新函数的实现 ↓↓↓
+
+// 实现重置播放器状态的辅助函数
+void MainWindow::resetPlayerState() {
+    m_player->stop();
+    m_trackStart = 0;
+    m_trackEnd = 0;
+    m_pendingSeek = -1;
+    m_songTitleLabel->setText("未选择歌曲");
+    m_songArtistLabel->setText("");
+    m_coverLabel->clear();
+    m_coverLabel->hide();
+    m_currentTimeLabel->setText("00:00");
+    m_totalTimeLabel->setText("00:00");
+    m_progressSlider->setValue(0);
+    
+    // ↓↓↓ ★★★ 核心修改：重置播放器时，必须同时重置所有相关状态 ★★★ ↓↓↓
+    int oldPlayingPlaylistIndex = m_playingPlaylistIndex;
+    m_currentSongIndex = -1;
+    m_playingPlaylistIndex = -1;
+    
+    updatePlayPauseButton();
+
+    // 如果之前有高亮的列表，现在需要刷新它以移除高亮
+    if (oldPlayingPlaylistIndex == m_currentPlaylistIndex) {
+        updateSongListView();
+    }
+}
+
+// 实现删除歌曲的槽函数
+void MainWindow::onDeleteSongClicked() {
+    //获取所有被选中的项
+    QList<QListWidgetItem*> selectedItems = m_songListWidget->selectedItems();
+    if (selectedItems.isEmpty()) {
+        return;
+    }
+    
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist) {
+        return;
+    }
+
+    //将项转换为行号索引
+    QList<int> indicesToDelete;
+    for (QListWidgetItem* item : selectedItems) {
+        // 将索引存在 UserRole 数据中，这样更可靠
+        indicesToDelete.append(item->data(Qt::UserRole).toInt());
+    }
+    
+    //对索引进行降序排序
+    std::sort(indicesToDelete.begin(), indicesToDelete.end(), std::greater<int>());
+
+    bool currentPlayerSongRemoved = false;
+
+    //执行删除
+    for (int index : indicesToDelete) {
+        // 检查是否删除了正在播放的歌曲
+        if (index == m_currentSongIndex) {
+            currentPlayerSongRemoved = true;
+        } else if (index < m_currentSongIndex) {
+            // 如果删除的歌曲在当前播放歌曲的前面，索引要-1
+            m_currentSongIndex--;
+        }
+        playlist->removeSong(index);
+    }
+    
+    //如果当前播放的歌曲被删了，自动播放下一首
+    if (currentPlayerSongRemoved) {
+        // 先保存要播放的下一首索引（在重置之前）
+        int nextIndex = m_currentSongIndex;
+        if (nextIndex >= playlist->songCount()) {
+            nextIndex = playlist->songCount() - 1;
+        }
+        
+        resetPlayerState();
+        
+        // 如果列表还有歌曲，自动播放下一首
+        if (playlist->songCount() > 0 && nextIndex >= 0) {
+            QTimer::singleShot(50, this, [this, nextIndex]() {
+                playSong(nextIndex);
+            });
+        }
+    }
+    
+    //更新UI
+    updateSongListView();
+    updatePlaylistView();
+    
+    //更新随机列表
+    if (m_inListMode == InListMode::Random) {
+        generateShuffledPlaylist();
+    }
+}
+
+// 从磁盘删除歌曲的槽函数
+void MainWindow::onDeleteSongFromDiskClicked() {
+    // 获取所有被选中的项
+    QList<QListWidgetItem*> selectedItems = m_songListWidget->selectedItems();
+    if (selectedItems.isEmpty()) {
+        return;
+    }
+    
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist) {
+        return;
+    }
+
+    // 构建要删除的歌曲列表信息
+    QStringList songNames;
+    QList<int> indicesToDelete;
+    for (QListWidgetItem* item : selectedItems) {
+        int index = item->data(Qt::UserRole).toInt();
+        indicesToDelete.append(index);
+        songNames.append(playlist->songTitle(index));
+    }
+
+    // 显示确认警告对话框
+    QString message = QString("确定要从磁盘永久删除以下 %1 首歌曲吗？\n\n%2\n\n此操作无法撤销！")
+                          .arg(indicesToDelete.size())
+                          .arg(songNames.join("\n"));
+    
+    QMessageBox::StandardButton reply = QMessageBox::warning(
+        this,
+        "确认删除",
+        message,
+        QMessageBox::Yes | QMessageBox::No,
+        QMessageBox::No  // 默认选择"否"，更安全
+    );
+
+    if (reply != QMessageBox::Yes) {
+        return; // 用户取消操作
+    }
+
+    // ★ 关键改进：在删除前，检查是否正在播放要删除的歌曲
+    // 如果是，先停止播放器以释放文件句柄
+    bool isPlayingInDeleteList = false;
+    bool isSamePlaylist = (m_currentPlaylistIndex == m_playingPlaylistIndex);
+    
+    if (isSamePlaylist && m_currentSongIndex >= 0) {
+        for (int index : indicesToDelete) {
+            if (index == m_currentSongIndex) {
+                isPlayingInDeleteList = true;
+                break;
+            }
+        }
+    }
+
+    // 如果正在播放的歌曲在删除列表中，先停止播放器
+    if (isPlayingInDeleteList) {
+        m_player->stop();
+        m_player->setSource(QUrl()); // 清除媒体源，彻底释放文件句柄
+    }
+
+    // 对索引进行降序排序，必须从后往前删除
+    std::sort(indicesToDelete.begin(), indicesToDelete.end(), std::greater<int>());
+
+    bool currentPlayerSongRemoved = false;
+    QStringList failedFiles; // 记录删除失败的文件
+
+    // 执行删除
+    for (int index : indicesToDelete) {
+        QString filePath = playlist->songFilePath(index);
+
+        // 尝试从磁盘删除文件
+        QFile file(filePath);
+        if (file.exists()) {
+            if (!file.remove()) {
+                // 删除失败，记录下来
+                failedFiles.append(playlist->songTitle(index));
+                continue; // 跳过这个文件，不从播放列表移除
+            }
+        }
+
+        // 文件删除成功（或文件已不存在），从播放列表移除
+        // 检查是否删除了正在播放的歌曲
+        if (isSamePlaylist && index == m_currentSongIndex) {
+            currentPlayerSongRemoved = true;
+        } else if (isSamePlaylist && index < m_currentSongIndex) {
+            // 如果删除的歌曲在当前播放歌曲的前面，索引要-1
+            m_currentSongIndex--;
+        }
+        playlist->removeSong(index);
+    }
+
+    // 如果有删除失败的文件，提示用户
+    if (!failedFiles.isEmpty()) {
+        QMessageBox::warning(this, "部分删除失败",
+            QString("以下文件无法删除（可能正在被占用或没有权限）：\n\n%1")
+                .arg(failedFiles.join("\n")));
+    }
+
+    // 如果当前播放的歌曲被删了，自动播放下一首
+    if (currentPlayerSongRemoved) {
+        // 先保存要播放的下一首索引（在重置之前）
+        int nextIndex = m_currentSongIndex;
+        if (nextIndex >= playlist->songCount()) {
+            nextIndex = playlist->songCount() - 1;
+        }
+        
+        resetPlayerState();
+        
+        // 如果列表还有歌曲，自动播放下一首
+        if (playlist->songCount() > 0 && nextIndex >= 0) {
+            // 延迟一小段时间后播放，确保文件句柄完全释放
+            QTimer::singleShot(100, this, [this, nextIndex]() {
+                playSong(nextIndex);
+            });
+        }
+    }
+    
+    // 更新UI
+    updateSongListView();
+    updatePlaylistView();
+    
+    // 更新随机列表
+    if (m_inListMode == InListMode::Random) {
+        generateShuffledPlaylist();
+    }
+}
+
+void MainWindow::showEvent(QShowEvent *event)
+{
+    // 首先，必须调用基类的实现
+    QMainWindow::showEvent(event);
+
+    // 使用标志位确保这个加载逻辑只在程序启动时执行一次
+    // 而不是每次从托盘恢复窗口时都执行
+    if (m_isFirstShow) {
+        m_isFirstShow = false; // 立刻将标志位设为 false
+
+        QSettings settings;
+        int lastPlaylistIndex = settings.value("lastPlaylistIndex", 0).toInt();
+        int lastSongIndex = settings.value("lastSongIndex", -1).toInt();
+
+        // 验证加载的播放列表索引是否有效
+        if (lastPlaylistIndex >= 0 && lastPlaylistIndex < m_playlistManager->playlistCount()) {
+            
+            // 切换到上次的播放列表
+            m_playlistListWidget->setCurrentRow(lastPlaylistIndex);
+            // onPlaylistSelectionChanged 会被自动触发，更新 m_currentPlaylistIndex 和歌曲列表视图
+
+            Playlist* playlist = m_playlistManager->getPlaylist(lastPlaylistIndex);
+            // 验证加载的歌曲索引是否有效
+            if (playlist && lastSongIndex >= 0 && lastSongIndex < playlist->songCount()) {
+                
+                // 播放上次的歌曲
+                playSong(lastSongIndex);
+            }
+        }
+
+        if (m_fastStart) {
+            StartupProfiler::watchFirstPaint(this, [this]() {
+                finishStartup();
+                StartupProfiler::mark("deferred init");
+                StartupProfiler::report();
+            });
+        } else {
+            finishStartup();
+            StartupProfiler::watchFirstPaint(this, []() { StartupProfiler::report(); });
+        }
+    }
+}
+
+
+void MainWindow::onShowFontSettings()
+{
+    // 获取当前列表控件的字体作为对话框的默认选项
+    QFont currentFont = m_playlistListWidget->font();
+
+    // 使用自定义的中文字体选择对话框
+    FontSettingsDialog dialog(currentFont, this);
+    
+    if (dialog.exec() == QDialog::Accepted) {
+        QFont selectedFont = dialog.selectedFont();
+
+        // 将新字体分别应用到两个列表控件
+        m_playlistListWidget->setFont(selectedFont);
+        m_songListWidget->setFont(selectedFont);
+
+        // 使用 QSettings 立即保存用户的选择
+        QSettings settings;
+        settings.setValue("listFont", selectedFont);
+    }
+}
+
+void MainWindow::startShutdownTimer(int msecs)
+{
+    if (msecs <= 0) return;
+
+    m_shutdownTimer->start(msecs);
+    m_shutdownDateTime = QDateTime::currentDateTime().addMSecs(msecs);
+    
+    // 更新托盘提示信息，告诉用户关机时间
+    m_trayIcon->setToolTip(QString("MusicPlayer\n将于 %1 定时关机")
+                           .arg(m_shutdownDateTime.toString("HH:mm:ss")));
+    
+    m_cancelShutdownAction->setEnabled(true); // 启用“取消”按钮
+    QMessageBox::information(this, "定时关机", 
+        QString("已设定在 %1 执行关机。")
+        .arg(m_shutdownDateTime.toString("yyyy-MM-dd HH:mm:ss")));
+}
+
+// “30分钟后”的槽函数
+void MainWindow::onSetShutdownAfter30Mins()
+{
+    startShutdownTimer(30 * 60 * 1000);
+}
+
+// “60分钟后”的槽函数
+void MainWindow::onSetShutdownAfter60Mins()
+{
+    startShutdownTimer(60 * 60 * 1000);
+}
+
+// “自定义时间”的槽函数
+void MainWindow::onSetCustomShutdownTime()
+{
+    // a. 创建我们的自定义对话框实例
+    CustomTimeDialog dialog(this);
+    dialog.setCurrentTime(QTime::currentTime().addSecs(60 * 10)); // 默认显示10分钟后的时间
+
+    // b. 以模态方式执行对话框，并检查返回值
+    if (dialog.exec() == QDialog::Accepted) {
+        // c. 如果用户点击了 "OK"，获取选择的时间
+        QTime time = dialog.selectedTime();
+
+        QDateTime now = QDateTime::currentDateTime();
+        QDateTime targetDateTime(now.date(), time);
+
+        if (targetDateTime < now) {
+            targetDateTime = targetDateTime.addDays(1);
+        }
+
+        qint64 msecs = now.msecsTo(targetDateTime);
+        startShutdownTimer(msecs);
+    }
+    // 如果用户点击 "Cancel"，dialog.exec() 返回 Rejected，我们什么都不做
+}
+
+// “取消定时”的槽函数
+void MainWindow::onCancelShutdown()
+{
+    m_shutdownTimer->stop();
+    m_shutdownDateTime = QDateTime(); // 重置为无效时间
+    m_trayIcon->setToolTip("MusicPlayer"); // 恢复默认提示
+    m_cancelShutdownAction->setEnabled(false); // 禁用“取消”按钮
+    QMessageBox::information(this, "提示", "定时关机已取消。");
+}
+
+// 定时器触发时，执行真正的关机命令
+void MainWindow::onShutdownTimerTimeout()
+{
+    QString command;
+    QStringList args;
+
+#if defined(Q_OS_WIN)
+    command = "shutdown";
+    args << "/s" << "/t" << "0"; // /s: 关机, /t 0: 立即
+#elif defined(Q_OS_MAC)
+    command = "shutdown";
+    args << "-h" << "now"; // -h: 关机, now: 立即
+#elif defined(Q_OS_LINUX)
+    command = "shutdown";
+    args << "-h" << "now";
+#endif
+
+    if (!command.isEmpty()) {
+        // 使用 startDetached 启动命令，这样即使我们的播放器被关闭，
+        // 关机命令也能继续执行。
+        m_shutdownProcess->startDetached(command, args);
+    }
+}
+
+// 重写 nativeEvent 以捕获 Windows 原生事件
+bool MainWindow::nativeEvent(const QByteArray &eventType, void *message, qintptr *result)
+{
+    // 只处理 Windows 平台的消息
+#ifdef Q_OS_WIN
+    // 将通用的 message 指针转换为 Windows 消息结构体指针
+    MSG* msg = static_cast<MSG*>(message);
+
+    // 只关心 WM_POWERBROADCAST 消息
+    if (msg->message == WM_POWERBROADCAST)
+    {
+        // PBT_APMRESUMEAUTOMATIC 事件表示系统已从睡眠或休眠中唤醒
+        if (msg->wParam == PBT_APMRESUMEAUTOMATIC)
+        {
+            qDebug() << "检测到系统已从睡眠状态唤醒。";
+
+            // 核心缓解策略
+            // 检查播放器是否正在播放
+            if (m_player->playbackState() == QMediaPlayer::PlayingState)
+            {
+                qDebug() << "播放器正在播放，尝试重置以避免卡顿。";
+                
+                //获取当前播放位置
+                qint64 currentPosition = m_player->position();
+                
+                //暂停播放器
+                m_player->pause();
+
+                //使用 QTimer 做一个非常短暂的延迟
+                //    这给了声卡和驱动一点点时间来完全初始化
+                QTimer::singleShot(250, this, [this, currentPosition]() {
+                    //在延迟后，重新设置播放位置并继续播放
+                    m_player->setPosition(currentPosition);
+                    m_player->play();
+                    qDebug() << "播放器状态已重置。";
+                });
+            }
+        }
+    }
+#endif
+
+    // 调用基类的实现，确保其他事件能被正常处理
+    return QMainWindow::nativeEvent(eventType, message, result);
+}
+
+// --- 左侧：排序播放列表本身 ---
+void MainWindow::onSortPlaylistsAction() {
+    // 1. 保存当前状态
+    // 我们需要记录下“当前正在看的列表”和“当前正在播放的列表”的指针
+    // 因为排序后，它们的索引(int)会发生变化
+    Playlist* viewingPlaylist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    
+    // m_playingPlaylistIndex 是我们之前为了高亮引入的变量
+    Playlist* playingPlaylist = nullptr;
+    if (m_playingPlaylistIndex >= 0) {
+        playingPlaylist = m_playlistManager->getPlaylist(m_playingPlaylistIndex);
+    }
+
+    // 2. 执行排序 (PlaylistManager 中新加的函数)
+    m_playlistManager->sortPlaylistsByName();
+
+    // 3. 恢复索引
+    // 找到刚才那个列表现在跑到哪里去了
+    if (viewingPlaylist) {
+        m_currentPlaylistIndex = m_playlistManager->getPlaylistIndex(viewingPlaylist);
+    }
+    if (playingPlaylist) {
+        m_playingPlaylistIndex = m_playlistManager->getPlaylistIndex(playingPlaylist);
+    }
+
+    // 4. 彻底刷新左侧列表UI
+    updatePlaylistView();
+    
+    // 恢复选中状态
+    if (m_currentPlaylistIndex >= 0) {
+        m_playlistListWidget->setCurrentRow(m_currentPlaylistIndex);
+    }
+}
+
+// --- 右侧：排序当前列表里的歌曲 ---
+void MainWindow::onSortSongsAction() {
+    // 1. 获取当前正在查看的列表
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist || playlist->songCount() == 0) return;
+
+    // 2. 保存播放状态
+    // 只有当“正在查看的列表”就是“正在播放的列表”时，才需要处理歌曲索引
+    int currentPlayingSongId = SongLibrary::InvalidId;
+    bool isSortingPlayingList = (m_currentPlaylistIndex == m_playingPlaylistIndex);
+    
+    if (isSortingPlayingList && m_currentSongIndex >= 0) {
+        // 记住正在播放的那首歌在歌曲表中的 ID
+        currentPlayingSongId = playlist->songId(m_currentSongIndex);
+    }
+
+    // 3. 执行排序 (Playlist 类中已有的函数)
+    playlist->sortByName();
+
+    // 4. 恢复播放索引
+    if (isSortingPlayingList && currentPlayingSongId != SongLibrary::InvalidId) {
+        // 找到它在新列表中的位置
+        m_currentSongIndex = playlist->indexOfSong(currentPlayingSongId);
+    }
+
+    // 5. 刷新右侧歌曲列表UI
+    updateSongListView();
+    
+    // 6. 如果是随机模式，列表变了，随机种子也要重置
+    if (m_inListMode == InListMode::Random && isSortingPlayingList) {
+        generateShuffledPlaylist();
+    }
+}
+
+// 单实例实现
+void MainWindow::wakeUpWindow()
+{
+    // 确保窗口可见
+    if (!this->isVisible()) {
+        this->show();
+    }
+    
+    // 恢复窗口状态（如果是最小化，则恢复正常）
+    if (this->isMinimized()) {
+        this->setWindowState((windowState() & ~Qt::WindowMinimized) | Qt::WindowActive);
+    }
+    
+    // 提升并激活窗口
+    this->raise();
+    this->activateWindow();
+}
+
+QJsonObject MainWindow::handleRemoteCommand(const QString& command, const QJsonObject& request)
+{
+    qCDebug(lcIpc) << "收到远程命令:" << command;
+
+    if (command == "play") {
+        if (m_currentSongIndex < 0) {
+            playSong(0);
+        } else {
+            m_player->play();
+            updatePlayPauseButton();
+        }
+    } else if (command == "pause") {
+        m_player->pause();
+        updatePlayPauseButton();
+    } else if (command == "toggle") {
+        onPlayPauseClicked();
+    } else if (command == "next") {
+        onNextClicked();
+    } else if (command == "previous") {
+        onPreviousClicked();
+    } else if (command == "seek") {
+        if (!request.contains("position")) {
+            return IpcProtocol::makeError("seek 需要 position 参数（毫秒）");
+        }
+        // 位置相对于当前音轨（CUE 音轨从 0 开始）
+        qint64 position = qMax<qint64>(0, request.value("position").toVariant().toLongLong());
+        if (m_trackEnd > 0) {
+            position = qMin(position, m_trackEnd - m_trackStart);
+        }
+        m_player->setPosition(m_trackStart + position);
+    } else if (command == "volume") {
+        if (!request.contains("volume")) {
+            return IpcProtocol::makeError("volume 需要 volume 参数（0-100）");
+        }
+        int volume = qBound(0, request.value("volume").toVariant().toInt(), 100);
+        m_audioOutput->setVolume(volume / 100.0);
+        // 只同步滑块，不弹出 onVolumeChanged 中跟随鼠标的提示
+        QSignalBlocker volumeBlocker(m_volumeSlider);
+        QSignalBlocker trayVolumeBlocker(m_trayVolumeSlider);
+        m_volumeSlider->setValue(volume);
+        if (m_trayVolumeSlider) m_trayVolumeSlider->setValue(volume);
+    } else if (command == "enqueue" || command == "open") {
+        QStringList paths;
+        for (const QJsonValue& value : request.value("paths").toArray()) {
+            if (!value.toString().isEmpty()) paths.append(value.toString());
+        }
+        if (paths.isEmpty()) {
+            return IpcProtocol::makeError(QString("%1 需要 paths 参数").arg(command));
+        }
+        if (command == "open") {
+            // 命令行 / “打开方式”传来的文件：稍后与同一时间到达的其他请求一起导入
+            m_pendingOpenPaths.append(paths);
+            m_openFilesTimer->start();
+            QJsonObject result;
+            result.insert("queued", paths.size());
+            return IpcProtocol::makeReply(result);
+        }
+        int added = enqueueFiles(paths, request.value("playlist").toString(),
+                                 request.value("play").toBool());
+        QJsonObject result;
+        result.insert("added", added);
+        return IpcProtocol::makeReply(result);
+    } else if (command == "queue") {
+        // 正在播放的列表（还没有播放过时为当前列表），分页返回
+        int index = m_playingPlaylistIndex >= 0 ? m_playingPlaylistIndex : m_currentPlaylistIndex;
+        const Playlist* playlist = m_playlistManager->getPlaylist(index);
+        if (!playlist) {
+            return IpcProtocol::makeError("没有播放列表");
+        }
+        int offset = qMax(0, request.value("offset").toVariant().toInt());
+        int limit = request.contains("limit") ? qBound(1, request.value("limit").toVariant().toInt(), 100000) : 500;
+        int end = qMin(playlist->songCount(), offset + limit);
+
+        QJsonArray songs;
+        for (int i = offset; i < end; ++i) {
+            QJsonObject song = songToJson(playlist->library(), playlist->songId(i));
+            song.insert("index", i);
+            songs.append(song);
+        }
+        QJsonObject result;
+        result.insert("playlist", playlist->getName());
+        result.insert("total", playlist->songCount());
+        result.insert("offset", offset);
+        result.insert("current", index == m_playingPlaylistIndex ? m_currentSongIndex : -1);
+        result.insert("songs", songs);
+        return IpcProtocol::makeReply(result);
+    } else if (command == "song") {
+        const SongLibrary* library = m_playlistManager->library();
+        int id = request.contains("id") ? request.value("id").toVariant().toInt() : SongLibrary::InvalidId;
+        if (id < 0 || id >= library->songCount()) {
+            return IpcProtocol::makeError("没有这首歌");
+        }
+        return IpcProtocol::makeReply(songToJson(library, id));
+    } else if (command == "search") {
+        QString keyword = request.value("q").toVariant().toString().trimmed();
+        if (keyword.isEmpty()) {
+            return IpcProtocol::makeError("search 需要 q 参数");
+        }
+        int limit = request.contains("limit") ? qBound(1, request.value("limit").toVariant().toInt(), 1000) : 100;
+
+        // 直接扫描歌曲库的列存储，十万首也只需几毫秒
+        const SongLibrary* library = m_playlistManager->library();
+        QJsonArray songs;
+        int matched = 0;
+        for (int id = 0; id < library->songCount(); ++id) {
+            if (library->titleView(id).contains(keyword, Qt::CaseInsensitive)
+                || library->artist(id).contains(keyword, Qt::CaseInsensitive)
+                || library->album(id).contains(keyword, Qt::CaseInsensitive)) {
+                if (matched++ < limit) songs.append(songToJson(library, id));
+            }
+        }
+        QJsonObject result;
+        result.insert("total", matched);
+        result.insert("songs", songs);
+        return IpcProtocol::makeReply(result);
+    } else if (command == "diagnostics") {
+        return IpcProtocol::makeReply(diagnosticsSnapshot());
+    } else if (command == "log") {
+        // 修改分类的日志级别；不带参数时只返回当前设置
+        if (request.contains("rateLimit")) {
+            AppLog::setRateLimit(request.value("rateLimit").toVariant().toInt());
+        }
+        if (request.contains("category")
+            && !AppLog::setLevel(request.value("category").toString(), request.value("level").toString())) {
+            return IpcProtocol::makeError("无效的日志级别，可用 debug info warning critical off");
+        }
+        return IpcProtocol::makeReply(AppLog::status());
+    } else if (command != "status") {
+        return IpcProtocol::makeError(QString("未知命令 %1").arg(command));
+    }
+
+    // 所有命令都带回执行后的状态，脚本不必再单独查询
+    return IpcProtocol::makeReply(playerStatus());
+}
+
+void MainWindow::setHttpApiEnabled(bool enabled)
+{
+    if (!enabled) {
+        if (m_httpServer) m_httpServer->stop();
+        return;
+    }
+    if (!m_httpServer) {
+        m_httpServer = new HttpControlServer([this](const QString& command, const QJsonObject& request) {
+            return handleRemoteCommand(command, request);
+        }, this);
+    }
+
+    QSettings settings;
+    QHostAddress address(settings.value("HttpApi/address", "127.0.0.1").toString());
+    if (address.isNull()) address = QHostAddress::LocalHost;
+    quint16 port = static_cast<quint16>(settings.value("HttpApi/port", DefaultHttpApiPort).toUInt());
+    m_httpServer->start(address, port, settings.value("HttpApi/token").toString());
+}
+
+void MainWindow::setStreamingEnabled(bool enabled)
+{
+    if (!enabled) {
+        if (m_streamServer) m_streamServer->stop();
+        return;
+    }
+    if (!m_streamServer) {
+        m_streamServer = new MediaStreamServer([this](const QString& command, const QJsonObject& request) {
+            return handleRemoteCommand(command, request);
+        }, this);
+    }
+
+    // 串流是给局域网中其他设备用的，默认监听所有网卡
+    QSettings settings;
+    QHostAddress address(settings.value("Streaming/address", "0.0.0.0").toString());
+    if (address.isNull()) address = QHostAddress::AnyIPv4;
+    quint16 port = static_cast<quint16>(settings.value("Streaming/port", DefaultStreamingPort).toUInt());
+
+    // 监听局域网地址时必须有令牌，否则同一网络中的任何人都能按编号下载整个歌曲库
+    QString token = settings.value("Streaming/token").toString();
+    if (token.isEmpty() && !address.isLoopback()) {
+        token = QString::number(QRandomGenerator::system()->generate64(), 16)
+                + QString::number(QRandomGenerator::system()->generate64(), 16);
+        settings.setValue("Streaming/token", token);
+        qCInfo(lcIpc) << "已为局域网串流生成访问令牌（配置文件的 Streaming/token）";
+    }
+    m_streamServer->start(address, port, token);
+}
+
+QString MainWindow::streamingPlaylistUrl() const
+{
+    QSettings settings;
+    QString host = "127.0.0.1";
+    QHostAddress address(settings.value("Streaming/address", "0.0.0.0").toString());
+    if (!address.isNull() && address != QHostAddress::AnyIPv4 && address != QHostAddress::Any) {
+        host = address.toString();
+    } else {
+        // 监听所有网卡时取第一个局域网 IPv4 地址
+        for (const QHostAddress& candidate : QNetworkInterface::allAddresses()) {
+            if (candidate.protocol() == QAbstractSocket::IPv4Protocol && !candidate.isLoopback()) {
+                host = candidate.toString();
+                break;
+            }
+        }
+    }
+    quint16 port = static_cast<quint16>(settings.value("Streaming/port", DefaultStreamingPort).toUInt());
+    QString url = QString("http://%1:%2/stream/playlist.m3u").arg(host).arg(port);
+    QString token = settings.value("Streaming/token").toString();
+    if (!token.isEmpty()) {
+        url += "?token=" + QString::fromUtf8(QUrl::toPercentEncoding(token));
+    }
+    return url;
+}
+
+void MainWindow::notifyRemoteStateChanged()
+{
+    if (m_httpServer) m_httpServer->notifyStateChanged();
+}
+
+QJsonObject MainWindow::playerStatus() const
+{
+    QJsonObject status;
+    switch (m_player->playbackState()) {
+    case QMediaPlayer::PlayingState: status.insert("state", "playing"); break;
+    case QMediaPlayer::PausedState:  status.insert("state", "paused"); break;
+    default:                         status.insert("state", "stopped"); break;
+    }
+    status.insert("volume", m_volumeSlider->value());
+
+    const Playlist* playlist = m_playlistManager->getPlaylist(m_playingPlaylistIndex);
+    if (playlist && m_currentSongIndex >= 0 && m_currentSongIndex < playlist->songCount()) {
+        status.insert("playlist", playlist->getName());
+        status.insert("index", m_currentSongIndex);
+        status.insert("title", playlist->songTitle(m_currentSongIndex));
+        status.insert("artist", playlist->songArtist(m_currentSongIndex));
+        status.insert("album", playlist->songAlbum(m_currentSongIndex));
+        status.insert("filePath", playlist->songFilePath(m_currentSongIndex));
+
+        qint64 duration = m_trackEnd > 0 ? m_trackEnd - m_trackStart : m_player->duration() - m_trackStart;
+        status.insert("position", qMax<qint64>(0, m_player->position() - m_trackStart));
+        status.insert("duration", qMax<qint64>(0, duration));
+    }
+    return status;
+}
+
+QJsonObject MainWindow::diagnosticsSnapshot() const
+{
+    QJsonObject snapshot = Diagnostics::toJson();
+
+    // 补充当前状态，便于和计数对照
+    const SongLibrary* library = m_playlistManager->library();
+    QJsonObject gauges;
+    gauges.insert("songs", library->songCount());
+    gauges.insert("playlists", m_playlistManager->getPlaylists().size());
+    gauges.insert("libraryMemoryBytes", library->memoryUsage());
+    gauges.insert("streamConnections", m_streamServer ? m_streamServer->connectionCount() : 0);
+    snapshot.insert("gauges", gauges);
+    return snapshot;
+}
+
+int MainWindow::enqueueFiles(const QStringList& paths, const QString& playlistName, bool playFirst)
+{
+    // 目标列表：请求中指定的 > 设置为“打开方式”目标的 > 当前列表
+    QString targetName = playlistName;
+    if (targetName.isEmpty()) {
+        targetName = QSettings().value("OpenWith/playlist").toString();
+    }
+    int targetIndex = m_currentPlaylistIndex;
+    if (!targetName.isEmpty()) {
+        targetIndex = -1;
+        for (int i = 0; i < m_playlistManager->playlistCount(); ++i) {
+            if (m_playlistManager->getPlaylist(i)->getName() == targetName) {
+                targetIndex = i;
+                break;
+            }
+        }
+        if (targetIndex < 0) {
+            m_playlistManager->addPlaylist(targetName);
+            targetIndex = m_playlistManager->playlistCount() - 1;
+        }
+    }
+    Playlist* playlist = m_playlistManager->getPlaylist(targetIndex);
+    if (!playlist) return 0;
+
+    // 文件夹展开为其中的音频文件（按路径排序），和文件一起作为一批导入
+    QStringList files;
+    files.reserve(paths.size());
+    for (const QString& path : paths) {
+        QFileInfo info(path);
+        if (info.isDir()) {
+            QStringList folderFiles;
+            QDirIterator it(info.absoluteFilePath(), AudioFileFilters, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                folderFiles.append(it.next());
+            }
+            folderFiles.sort(Qt::CaseInsensitive);
+            files.append(folderFiles);
+        } else if (info.isFile()) {
+            files.append(info.absoluteFilePath());
+        }
+    }
+
+    int firstNewIndex = playlist->songCount();
+    playlist->addSongs(CueSheet::expandFiles(files));
+    int added = playlist->songCount() - firstNewIndex;
+    qCInfo(lcImport) << "向" << playlist->getName() << "添加了" << added << "首歌曲";
+    if (added == 0) return 0;
+
+    // 整批只刷新一次界面
+    updatePlaylistView();
+    if (playFirst && targetIndex != m_currentPlaylistIndex) {
+        m_playlistListWidget->setCurrentRow(targetIndex);   // 切换当前列表，playSong 播放的是当前列表
+    } else if (targetIndex == m_currentPlaylistIndex) {
+        updateSongListView();
+    }
+    if (m_inListMode == InListMode::Random && targetIndex == m_currentPlaylistIndex) {
+        generateShuffledPlaylist();
+    }
+    if (playFirst && targetIndex == m_currentPlaylistIndex) {
+        playSong(firstNewIndex);
+    }
+    return added;
+}
+
+// 音频转码槽函数
+void MainWindow::onTranscodeAudioClicked() {
+    // 获取所有选中的歌曲
+    QList<QListWidgetItem*> selectedItems = m_songListWidget->selectedItems();
+    if (selectedItems.isEmpty()) {
+        return;
+    }
+    
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist) {
+        return;
+    }
+    
+    // 收集所有选中歌曲的文件路径（同一个 CUE 的多条音轨指向同一个文件，只转码一次）
+    QStringList filePaths;
+    QSet<QString> seenPaths;
+    for (QListWidgetItem* item : selectedItems) {
+        int index = item->data(Qt::UserRole).toInt();
+        QString filePath = playlist->songFilePath(index);
+        if (!seenPaths.contains(filePath)) {
+            seenPaths.insert(filePath);
+            filePaths.append(filePath);
+        }
+    }
+    
+    // 记住正在播放的歌曲，替换后按 ID 找回它的位置
+    Playlist* playingPlaylist = m_playlistManager->getPlaylist(m_playingPlaylistIndex);
+    int playingSongId = playingPlaylist ? playingPlaylist->songId(m_currentSongIndex) : SongLibrary::InvalidId;
+    
+    // 创建并显示转码对话框
+    TranscodeDialog dialog(filePaths, this);
+    dialog.exec();
+    
+    // 无论是全部完成还是中途取消，已经转好的文件都可以替换
+    if (!dialog.replaceInPlaylists() || dialog.completedFiles().isEmpty()) {
+        return;
+    }
+    
+    // 所有播放列表一次性更新，只保存一次、刷新一次
+    int replaced = m_playlistManager->replaceSongFiles(dialog.completedFiles());
+    if (replaced == 0) {
+        return;
+    }
+    
+    if (playingPlaylist && playingSongId != SongLibrary::InvalidId) {
+        int newIndex = playingPlaylist->indexOfSong(playingSongId);
+        m_currentSongIndex = (newIndex >= 0) ? newIndex
+                                             : qMin(m_currentSongIndex, playingPlaylist->songCount() - 1);
+    }
+    
+    m_playlistManager->savePlaylists();
+    updateSongListView();
+    if (m_inListMode == InListMode::Random) {
+        generateShuffledPlaylist();
+    }
+    qCDebug(lcTranscode) << "转码后替换了" << replaced << "首歌曲";
+}
+
+// 从文件名猜测选中歌曲的标签
+void MainWindow::onGuessTagsClicked() {
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist) {
+        return;
+    }
+
+    QList<QListWidgetItem*> selectedItems = m_songListWidget->selectedItems();
+    QVector<int> songIds;
+    songIds.reserve(selectedItems.size());
+    for (QListWidgetItem* item : selectedItems) {
+        int id = playlist->songId(item->data(Qt::UserRole).toInt());
+        if (id != SongLibrary::InvalidId) {
+            songIds.append(id);
+        }
+    }
+    if (songIds.isEmpty()) {
+        return;
+    }
+
+    TagGuessDialog dialog(m_playlistManager, songIds, this);
+    dialog.exec();
+    if (!dialog.hasUpdatedSongs()) {
+        return;
+    }
+
+    // 所有修改一次性保存、一次性刷新
+    m_playlistManager->savePlaylists();
+    updateSongListView();
+
+    Playlist* playingPlaylist = m_playlistManager->getPlaylist(m_playingPlaylistIndex);
+    if (playingPlaylist && songIds.contains(playingPlaylist->songId(m_currentSongIndex))) {
+        m_songTitleLabel->setText(playingPlaylist->songTitle(m_currentSongIndex));
+        m_songArtistLabel->setText(playingPlaylist->songArtist(m_currentSongIndex));
+    }
+}
+
+// 显示正在播放的歌曲的封面：内存中有就立即显示，否则等 onCoverReady
+void MainWindow::updateNowPlayingCover() {
+    Playlist* playlist = m_playlistManager->getPlaylist(m_playingPlaylistIndex);
+    if (!playlist || m_currentSongIndex < 0 || m_currentSongIndex >= playlist->songCount()) {
+        m_coverLabel->hide();
+        return;
+    }
+
+    QPixmap pixmap = m_coverArtCache->cover(playlist->songFilePath(m_currentSongIndex), NowPlayingCoverSize);
+    if (pixmap.isNull()) {
+        m_coverLabel->hide();
+    } else {
+        m_coverLabel->setPixmap(pixmap);
+        m_coverLabel->show();
+    }
+}
+
+// indexAt 落在行间距或最后半行上时取不到行，这时按行高估算，不能退回到整个列表
+void MainWindow::visibleSongRows(int* first, int* last) const {
+    const int count = m_songListWidget->count();
+    QRect viewport = m_songListWidget->viewport()->rect();
+    *first = qMax(0, m_songListWidget->indexAt(viewport.topLeft()).row());
+    *last = m_songListWidget->indexAt(viewport.bottomLeft()).row();
+    if (*last < 0) {
+        int rowHeight = qMax(1, m_songListWidget->sizeHintForRow(*first));
+        *last = *first + viewport.height() / rowHeight + 1;
+    }
+    *last = qMin(*last, count - 1);
+}
+
+void MainWindow::requestVisibleCovers() {
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist || m_songListWidget->count() == 0) return;
+
+    // 滚出视野的行还没开始加载的请求直接撤回
+    m_coverArtCache->cancelPending(ListCoverSize);
+
+    int first = 0;
+    int last = -1;
+    visibleSongRows(&first, &last);
+    for (int row = first; row <= last; ++row) {
+        QListWidgetItem* item = m_songListWidget->item(row);
+        if (!item) continue;
+        int index = item->data(Qt::UserRole).toInt();
+        QPixmap pixmap = m_coverArtCache->cover(playlist->songFilePath(index), ListCoverSize);
+        if (!pixmap.isNull()) {
+            item->setIcon(QIcon(pixmap));
+        }
+    }
+}
+
+void MainWindow::onCoverReady(const QString& filePath, int size, const QPixmap& pixmap) {
+    if (size == NowPlayingCoverSize) {
+        Playlist* playingPlaylist = m_playlistManager->getPlaylist(m_playingPlaylistIndex);
+        if (playingPlaylist && playingPlaylist->songFilePath(m_currentSongIndex) == filePath) {
+            m_coverLabel->setPixmap(pixmap);
+            m_coverLabel->setVisible(!pixmap.isNull());
+        }
+        return;
+    }
+
+    if (size != ListCoverSize || pixmap.isNull()) return;
+
+    // 只需要更新可见的行，其余的行滚动到时会从内存缓存中取
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist) return;
+    int first = 0;
+    int last = -1;
+    visibleSongRows(&first, &last);
+    for (int row = first; row <= last; ++row) {
+        QListWidgetItem* item = m_songListWidget->item(row);
+        if (item && playlist->songFilePath(item->data(Qt::UserRole).toInt()) == filePath) {
+            item->setIcon(QIcon(pixmap));
+        }
+    }
+}
+
+// 编辑歌曲信息槽函数
+void MainWindow::onEditSongInfoClicked() {
+    // 获取当前选中的歌曲
+    QListWidgetItem* currentItem = m_songListWidget->currentItem();
+    if (!currentItem) {
+        return;
+    }
+    
+    Playlist* playlist = m_playlistManager->getPlaylist(m_currentPlaylistIndex);
+    if (!playlist) {
+        return;
+    }
+    
+    // 选中了多首歌曲时使用批量编辑
+    QList<QListWidgetItem*> selectedItems = m_songListWidget->selectedItems();
+    if (selectedItems.size() > 1) {
+        QVector<int> songIds;
+        songIds.reserve(selectedItems.size());
+        for (QListWidgetItem* item : selectedItems) {
+            int id = playlist->songId(item->data(Qt::UserRole).toInt());
+            if (id != SongLibrary::InvalidId) {
+                songIds.append(id);
+            }
+        }
+
+        BatchTagDialog dialog(m_playlistManager, songIds, this);
+        dialog.exec();
+        if (!dialog.hasUpdatedSongs()) {
+            return;
+        }
+
+        // 所有修改一次性保存、一次性刷新
+        m_playlistManager->savePlaylists();
+        updateSongListView();
+
+        Playlist* playingPlaylist = m_playlistManager->getPlaylist(m_playingPlaylistIndex);
+        if (playingPlaylist) {
+            int playingSongId = playingPlaylist->songId(m_currentSongIndex);
+            if (songIds.contains(playingSongId)) {
+                m_songArtistLabel->setText(m_playlistManager->library()->artist(playingSongId));
+            }
+        }
+        return;
+    }
+
+    int songIndex = currentItem->data(Qt::UserRole).toInt();
+    // 创建并显示歌曲信息编辑对话框
+    SongInfoDialog dialog(playlist->songFilePath(songIndex), this);
+    
+    if (dialog.exec() == QDialog::Accepted) {
+        // 如果用户点击了保存，更新全局歌曲表中的歌曲信息
+        // 所有包含这首歌的播放列表都会同步看到修改
+        playlist->updateSongMetaData(songIndex, 
+                                     dialog.title(), 
+                                     dialog.artist(), 
+                                     dialog.album());
+        
+        // 刷新歌曲列表视图
+        updateSongListView();
+        
+        // 如果正在播放的歌曲被修改了（可能是在另一个列表中编辑的同一首歌），更新当前显示的信息
+        Playlist* playingPlaylist = m_playlistManager->getPlaylist(m_playingPlaylistIndex);
+        if (playingPlaylist &&
+            playingPlaylist->songId(m_currentSongIndex) == playlist->songId(songIndex)) {
+            m_songTitleLabel->setText(dialog.title());
+            m_songArtistLabel->setText(dialog.artist());
+        }
+    }
+}
+
+// 在后台检查歌曲库中所有文件是否还存在
+void MainWindow::startMissingFileCheck() {
+    const SongLibrary* library = m_playlistManager->library();
+
+    QVector<MissingFileChecker::Entry> entries;
+    entries.reserve(library->songCount());
+    for (int id = 0; id < library->songCount(); ++id) {
+        entries.append({id, library->filePath(id), library->fileSize(id)});
+    }
+
+    m_missingFileChecker->startVerify(entries);
+}
+
+// 每检查完一批文件就更新一次丢失标记
+void MainWindow::onMissingFilesBatchVerified(const QVector<int>& missingIds,
+                                             const QVector<int>& presentIds,
+                                             const QVector<qint64>& presentSizes) {
+    SongLibrary* library = m_playlistManager->library();
+    bool changed = false;
+
+    for (int id : missingIds) {
+        if (!library->isMissing(id)) {
+            library->setMissing(id);
+            changed = true;
+        }
+    }
+    for (int i = 0; i < presentIds.size(); ++i) {
+        int id = presentIds[i];
+        if (library->isMissing(id)) {
+            library->setMissing(id, false);
+            changed = true;
+        }
+        // 记住文件大小，文件被移动后用 "文件名 + 大小" 重新定位
+        library->setFileSize(id, presentSizes[i]);
+    }
+
+    // 多批结果合并成一次刷新
+    if (changed && !m_songListRefreshTimer->isActive()) {
+        m_songListRefreshTimer->start();
+    }
+}
+
+// 选择新的根目录，为所有丢失的文件批量寻找新位置
+void MainWindow::onRelocateMissingFilesClicked() {
+    QString rootPath = QFileDialog::getExistingDirectory(this, "选择音乐文件的新位置", QDir::homePath());
+    if (rootPath.isEmpty()) {
+        return;
+    }
+
+    const SongLibrary* library = m_playlistManager->library();
+    QVector<MissingFileChecker::Entry> missingEntries;
+    for (int id = 0; id < library->songCount(); ++id) {
+        if (library->isMissing(id)) {
+            missingEntries.append({id, library->filePath(id), library->fileSize(id)});
+        }
+    }
+    if (missingEntries.isEmpty()) {
+        return;
+    }
+
+    // 扫描在后台进行，完成后由 onMissingFilesRelocated 处理结果
+    m_missingFileChecker->startRelocate(rootPath, missingEntries);
+}
+
+void MainWindow::onMissingFilesRelocated(const QVector<int>& songIds, const QStringList& newPaths) {
+    SongLibrary* library = m_playlistManager->library();
+    for (int i = 0; i < songIds.size(); ++i) {
+        library->relocate(songIds[i], newPaths[i]);
+    }
+
+    if (!songIds.isEmpty()) {
+        m_playlistManager->savePlaylists();
+        updateSongListView();
+    }
+
+    QMessageBox::information(this, "重新定位",
+        QString("已为 %1 首丢失的歌曲找到新位置，仍有 %2 首未找到。")
+            .arg(songIds.size())
+            .arg(library->missingCount()));
+
+    // 重新定位可能打断了正在进行的检测，这里重新检查一遍
+    startMissingFileCheck();
+}
+
+// 监视文件夹扫描完成：把变化一次性合并到对应的播放列表
+void MainWindow::onWatchedFolderScanned(const QString& folder, const QVector<WatchedFile>& files) {
+    bool anyChanged = false;
+    bool currentChanged = false;
+    bool playingChanged = false;
+
+    for (int i = 0; i < m_playlistManager->playlistCount(); ++i) {
+        Playlist* playlist = m_playlistManager->getPlaylist(i);
+        if (!playlist || playlist->watchedFolder() != folder) {
+            continue;
+        }
+
+        // 记住正在播放的歌曲，同步后按 ID 找回它的新位置
+        int playingSongId = SongLibrary::InvalidId;
+        if (i == m_playingPlaylistIndex) {
+            playingSongId = playlist->songId(m_currentSongIndex);
+        }
+
+        PlaylistManager::FolderSyncResult result = m_playlistManager->syncWatchedFolder(playlist, files);
+        if (result.isEmpty()) {
+            continue;
+        }
+        qCInfo(lcImport) << "监视文件夹同步:" << folder << "新增" << result.added
+                 << "删除" << result.removed << "变更" << result.changed;
+
+        anyChanged = true;
+        if (i == m_currentPlaylistIndex) currentChanged = true;
+        if (i == m_playingPlaylistIndex) {
+            playingChanged = true;
+            if (playingSongId != SongLibrary::InvalidId) {
+                int newIndex = playlist->indexOfSong(playingSongId);
+                // 正在播放的文件被删了：让它播完，之后从原来的位置继续
+                m_currentSongIndex = (newIndex >= 0) ? newIndex
+                                                     : qMin(m_currentSongIndex, playlist->songCount() - 1);
+            }
+        }
+    }
+
+    if (!anyChanged) {
+        return;
+    }
+
+    // 所有变化只触发一次保存和一次界面刷新
+    m_playlistManager->savePlaylists();
+    updatePlaylistView();
+    if (currentChanged) {
+        loadPlaylistMetaData(m_currentPlaylistIndex);  // 新文件和被修改的文件重新读取标签
+        updateSongListView();
+    }
+    if (playingChanged && m_inListMode == InListMode::Random) {
+        generateShuffledPlaylist();
+    }
+}
+
+// 取消监视，列表内容保持不变
+void MainWindow::onStopWatchingFolderClicked() {
+    Playlist* playlist = m_playlistManager->getPlaylist(m_playlistListWidget->currentRow());
+    if (!playlist) {
+        return;
+    }
+
+    playlist->setWatchedFolder(QString());
+    m_folderWatcher->setFolders(m_playlistManager->watchedFolders());
+    m_playlistManager->savePlaylists();
+}
+
+// 查找重复歌曲，移除勾选的副本后统一保存和刷新一次
+void MainWindow::onFindDuplicatesClicked() {
+    // 记住正在播放的歌曲，移除后按 ID 找回它的新位置
+    Playlist* playingPlaylist = m_playlistManager->getPlaylist(m_playingPlaylistIndex);
+    int playingSongId = playingPlaylist ? playingPlaylist->songId(m_currentSongIndex) : SongLibrary::InvalidId;
+
+    DuplicateDialog dialog(m_playlistManager, m_currentPlaylistIndex, this);
+    dialog.exec();
+
+    if (!dialog.hasRemovedSongs()) {
+        return;
+    }
+
+    if (playingPlaylist && playingSongId != SongLibrary::InvalidId) {
+        int newIndex = playingPlaylist->indexOfSong(playingSongId);
+        // 正在播放的歌曲被移除了：让它播完，之后从原来的位置继续
+        m_currentSongIndex = (newIndex >= 0) ? newIndex
+                                             : qMin(m_currentSongIndex, playingPlaylist->songCount() - 1);
+    }
+
+    m_playlistManager->savePlaylists();
+    updatePlaylistView();
+    updateSongListView();
+    if (m_inListMode == InListMode::Random) {
+        generateShuffledPlaylist();
+    }
+}
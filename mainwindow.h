@@ -1,202 +1,279 @@
-#ifndef MAINWINDOW_H
-#define MAINWINDOW_H
-
-#include <QMainWindow>
-#include <QMediaPlayer>
-#include <QAudioOutput>
-#include <QPushButton>
-#include <QSlider>
-#include <QLabel>
-#include <QListWidget>
-#include <QComboBox>
-#include <QMouseEvent>
-#include <QListWidgetItem>
-#include <QCloseEvent>
-#include <QSystemTrayIcon>
-#include <QWidgetAction>
-#include <QShowEvent>
-#include <QDateTime>
-#include "playlistmanager.h"
-#include "playlistlistwidget.h"
-#include "songlistwidget.h"
-#include "transcodedialog.h"
-#include "songinfodialog.h"
-
-#ifdef Q_OS_WIN
-#include <windows.h>
-#endif
-
-
-// 自定义 Slider 类，支持点击跳转
-class ClickableSlider : public QSlider {
-    Q_OBJECT
-public:
-    explicit ClickableSlider(Qt::Orientation orientation, QWidget* parent = nullptr)
-        : QSlider(orientation, parent) {}
-
-protected:
-    void mousePressEvent(QMouseEvent* event) override {
-        if (event->button() == Qt::LeftButton) {
-            int value;
-            if (orientation() == Qt::Horizontal) {
-                double pos = event->position().x() / (double)width();
-                value = pos * (maximum() - minimum()) + minimum();
-            } else {
-                double pos = event->position().y() / (double)height();
-                value = pos * (maximum() - minimum()) + minimum();
-            }
-            setValue(value);
-            emit sliderMoved(value);
-            emit sliderPressed();
-        }
-        QSlider::mousePressEvent(event);
-    }
-};
-
-enum class InListMode {
-    Sequential,     // 顺序播放
-    Random          // 随机播放
-};
-
-enum class CrossListMode {
-    Stop,           // 播完当前列表后停止
-    ListLoop,       // 循环当前列表
-    SingleLoop,     // 循环当前单曲
-    Advance         // 前进到下一个列表
-};
-
-class QSplitter;
-
-class QProcess;
-class QTimer;
-
-class MainWindow : public QMainWindow {
-    Q_OBJECT
-    
-public:
-    explicit MainWindow(QWidget* parent = nullptr);
-    ~MainWindow();
-    void wakeUpWindow(); 
-
-protected:
-    //closeEvent 函数声明
-    void closeEvent(QCloseEvent *event) override;
-    void showEvent(QShowEvent *event) override;
-
-    bool nativeEvent(const QByteArray &eventType, void *message, qintptr *result) override;
-    
-private slots:
-    void onPlayPauseClicked();
-    void onPreviousClicked();
-    void onNextClicked();
-    void onPlaylistContextMenuRequested(const QPoint& pos);
-    void onSongListContextMenuRequested(const QPoint& pos);
-    void onAddSongsClicked();
-    void onCreatePlaylistClicked();
-    void onDeletePlaylistClicked();
-    void onDeleteSongClicked();
-    void onDeleteSongFromDiskClicked(); // 从磁盘删除歌曲
-    void onPlaylistSelectionChanged();
-    void onSongDoubleClicked(QListWidgetItem* item);
-    void onFoldersDropped(const QList<QUrl>& urls);
-    void onFilesDroppedToSongList(const QList<QUrl>& urls);
-    void onTrayIconActivated(QSystemTrayIcon::ActivationReason reason);
-    void onShowFontSettings();
-    void onPositionChanged(qint64 position);
-    void onDurationChanged(qint64 duration);
-    void onProgressSliderMoved(int position);
-    void onVolumeChanged(int value);
-    void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
-    void onMetaDataChanged();
-    void onInListModeClicked();
-    void onCrossListModeClicked();
-    //定时关机功能
-    void onShutdownTimerTimeout();       // 定时器触发时调用
-    void onSetShutdownAfter30Mins();     // "30分钟后" 菜单项
-    void onSetShutdownAfter60Mins();     // "60分钟后" 菜单项
-    void onSetCustomShutdownTime();      // "自定义时间" 菜单项
-    void onCancelShutdown();             // "取消定时" 菜单项
-
-    void onSortPlaylistsAction(); // 左侧：排序播放列表
-    void onSortSongsAction();     // 右侧：排序歌曲
-    void onTranscodeAudioClicked(); // 音频转码
-    void onEditSongInfoClicked();   // 编辑歌曲信息
-    
-private:
-    void setupUI();
-    void updatePlaylistView();
-    void updateSongListView();
-    void loadPlaylistMetaData(int playlistIndex);  // 读取播放列表内歌曲元数据
-    void playSong(int index);
-    void updatePlayPauseButton();
-    void resetPlayerState();
-    void playNextSong();             //处理“下一曲”逻辑的辅助函数
-    void generateShuffledPlaylist();
-    void updateInListModeButton();
-    void updateCrossListModeButton();
-    bool m_isFirstShow;
-    void startShutdownTimer(int msecs); 
-    QString formatTime(qint64 milliseconds);
-    
-    // UI 组件
-    QWidget* m_centralWidget;
-    QPushButton* m_inListModeBtn;   // 用于 顺序/随机
-    QPushButton* m_playPauseBtn;
-    QPushButton* m_previousBtn;
-    QPushButton* m_nextBtn;
-    QPushButton* m_crossListModeBtn;  // 用于 列表循环/单曲循环/列表前进
-    
-    ClickableSlider* m_progressSlider;
-    ClickableSlider* m_volumeSlider;
-    QLabel* m_currentTimeLabel;
-    QLabel* m_totalTimeLabel;
-    QLabel* m_songTitleLabel;
-    QLabel* m_songArtistLabel;
-
-    QSystemTrayIcon* m_trayIcon;
-    QMenu* m_trayMenu;
-    QAction* m_quitAction;
-    
-    // 托盘菜单播放控制
-    QLabel* m_traySongLabel;
-    QAction* m_trayPreviousAction;
-    QAction* m_trayPlayPauseAction;
-    QAction* m_trayNextAction;
-    QSlider* m_trayVolumeSlider;
-    void updateTrayMenu();  // 更新托盘菜单状态
-    
-    //成员变量存储高亮字体
-    QFont m_playingSongFont;
-    
-    // 播放器
-    QMediaPlayer* m_player;
-    QAudioOutput* m_audioOutput;
-    QSplitter* m_mainSplitter; // <--- 4. 将 Splitter 声明为成员变量
-    PlaylistManager* m_playlistManager;
-
-
-    //定时关机相关的成员变量
-    QTimer* m_shutdownTimer;
-    QProcess* m_shutdownProcess;
-    QDateTime m_shutdownDateTime;      // 用于存储关机时间，方便UI显示
-    QAction* m_cancelShutdownAction;   // 用于方便地启用/禁用“取消”菜单项
-
-    
-
-    PlaylistListWidget* m_playlistListWidget;
-    SongListWidget* m_songListWidget;
-    
-    int m_currentPlaylistIndex;
-    int m_currentSongIndex;
-
-    int m_playingPlaylistIndex; 
-
-    InListMode m_inListMode;     // <-- 新的模式变量
-    CrossListMode m_crossListMode; // <-- 新的模式变量
-
-
-    QList<int> m_shuffledIndices;      //用于存储打乱后的歌曲索引
-    int m_shuffledPlaybackIndex;       //当前在随机列表中的播放位置
-};
-
-#endif // MAINWINDOW_H
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include <QMainWindow>
+#include <QMediaPlayer>
+#include <QAudioOutput>
+#include <QPushButton>
+#include <QSlider>
+#include <QLabel>
+#include <QListWidget>
+#include <QComboBox>
+#include <QMouseEvent>
+#include <QListWidgetItem>
+#include <QCloseEvent>
+#include <QSystemTrayIcon>
+#include <QWidgetAction>
+#include <QShowEvent>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include "playlistmanager.h"
+#include "playlistlistwidget.h"
+#include "songlistwidget.h"
+#include "transcodedialog.h"
+#include "songinfodialog.h"
+#include "missingfilechecker.h"
+#include "folderwatcher.h"
+#include "duplicatedialog.h"
+#include "batchtagdialog.h"
+#include "tagguessdialog.h"
+#include "coverartcache.h"
+#include "cuesheet.h"
+#include "playlistfile.h"
+#include "httpcontrolserver.h"
+#include "mediastreamserver.h"
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+
+// 自定义 Slider 类，支持点击跳转
+class ClickableSlider : public QSlider {
+    Q_OBJECT
+public:
+    explicit ClickableSlider(Qt::Orientation orientation, QWidget* parent = nullptr)
+        : QSlider(orientation, parent) {}
+
+protected:
+    void mousePressEvent(QMouseEvent* event) override {
+        if (event->button() == Qt::LeftButton) {
+            int value;
+            if (orientation() == Qt::Horizontal) {
+                double pos = event->position().x() / (double)width();
+                value = pos * (maximum() - minimum()) + minimum();
+            } else {
+                double pos = event->position().y() / (double)height();
+                value = pos * (maximum() - minimum()) + minimum();
+            }
+            setValue(value);
+            emit sliderMoved(value);
+            emit sliderPressed();
+        }
+        QSlider::mousePressEvent(event);
+    }
+};
+
+enum class InListMode {
+    Sequential,     // 顺序播放
+    Random          // 随机播放
+};
+
+enum class CrossListMode {
+    Stop,           // 播完当前列表后停止
+    ListLoop,       // 循环当前列表
+    SingleLoop,     // 循环当前单曲
+    Advance         // 前进到下一个列表
+};
+
+class QSplitter;
+
+class QProcess;
+class QTimer;
+
+class MainWindow : public QMainWindow {
+    Q_OBJECT
+    // 基准测试直接调用内部的刷新函数（见 benchmarks/librarybenchmark.cpp）
+    friend class LibraryBenchmark;
+    
+public:
+    explicit MainWindow(QWidget* parent = nullptr);
+    ~MainWindow();
+    void wakeUpWindow(); 
+    // 处理其他进程通过单实例通道发来的命令（协议见 ipcprotocol.h）
+    QJsonObject handleRemoteCommand(const QString& command, const QJsonObject& request);
+
+protected:
+    //closeEvent 函数声明
+    void closeEvent(QCloseEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+
+    bool nativeEvent(const QByteArray &eventType, void *message, qintptr *result) override;
+    
+private slots:
+    void onPlayPauseClicked();
+    void onPreviousClicked();
+    void onNextClicked();
+    void onPlaylistContextMenuRequested(const QPoint& pos);
+    void onSongListContextMenuRequested(const QPoint& pos);
+    void onAddSongsClicked();
+    void onCreatePlaylistClicked();
+    void onDeletePlaylistClicked();
+    void onDeleteSongClicked();
+    void onDeleteSongFromDiskClicked(); // 从磁盘删除歌曲
+    void onPlaylistSelectionChanged();
+    void onSongDoubleClicked(QListWidgetItem* item);
+    void onFoldersDropped(const QList<QUrl>& urls);
+    void onFilesDroppedToSongList(const QList<QUrl>& urls);
+    void onTrayIconActivated(QSystemTrayIcon::ActivationReason reason);
+    void onShowFontSettings();
+    void onPositionChanged(qint64 position);
+    void onDurationChanged(qint64 duration);
+    void onProgressSliderMoved(int position);
+    void onVolumeChanged(int value);
+    void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
+    void onMetaDataChanged();
+    void onInListModeClicked();
+    void onCrossListModeClicked();
+    //定时关机功能
+    void onShutdownTimerTimeout();       // 定时器触发时调用
+    void onSetShutdownAfter30Mins();     // "30分钟后" 菜单项
+    void onSetShutdownAfter60Mins();     // "60分钟后" 菜单项
+    void onSetCustomShutdownTime();      // "自定义时间" 菜单项
+    void onCancelShutdown();             // "取消定时" 菜单项
+
+    void onSortPlaylistsAction(); // 左侧：排序播放列表
+    void onSortSongsAction();     // 右侧：排序歌曲
+    void onTranscodeAudioClicked(); // 音频转码
+    void onEditSongInfoClicked();   // 编辑歌曲信息
+    void onGuessTagsClicked();      // 从文件名猜测标签
+
+    // 丢失文件检测与重新定位
+    void onMissingFilesBatchVerified(const QVector<int>& missingIds,
+                                     const QVector<int>& presentIds,
+                                     const QVector<qint64>& presentSizes);
+    void onRelocateMissingFilesClicked();
+    void onMissingFilesRelocated(const QVector<int>& songIds, const QStringList& newPaths);
+
+    // 监视文件夹
+    void onWatchedFolderScanned(const QString& folder, const QVector<WatchedFile>& files);
+    void onStopWatchingFolderClicked();
+
+    void onFindDuplicatesClicked();   // 查找重复歌曲
+    void onImportPlaylistClicked();   // 导入 M3U / PLS
+    void onExportPlaylistClicked();   // 导出 M3U / PLS
+
+    // 专辑封面
+    void onCoverReady(const QString& filePath, int size, const QPixmap& pixmap);
+    void requestVisibleCovers();      // 为歌曲列表中可见的行加载缩略图
+    void visibleSongRows(int* first, int* last) const;   // 歌曲列表中可见的行（列表为空时 last < first）
+    
+private:
+    void setupUI();
+    void updatePlaylistView();
+    void updateSongListView();
+    bool loadPlaylistMetaData(int playlistIndex);  // 读取播放列表内歌曲元数据，有新读取的返回 true
+    void playSong(int index);
+    void updatePlayPauseButton();
+    void resetPlayerState();
+    void playNextSong();             //处理“下一曲”逻辑的辅助函数
+    void generateShuffledPlaylist();
+    void updateInListModeButton();
+    void updateCrossListModeButton();
+    bool m_isFirstShow;
+    void startShutdownTimer(int msecs); 
+    QString formatTime(qint64 milliseconds);
+    void startMissingFileCheck();    // 在后台检查歌曲库中的文件是否还存在
+    QJsonObject playerStatus() const; // 远程 status 命令的返回内容
+    QJsonObject diagnosticsSnapshot() const; // 诊断面板和 diagnostics 命令的内容
+    // 把文件和文件夹作为一批追加到目标列表，返回添加的歌曲数
+    int enqueueFiles(const QStringList& paths, const QString& playlistName, bool playFirst);
+    QTimer* m_openFilesTimer;          // 合并短时间内的多个 open 请求
+    QStringList m_pendingOpenPaths;
+
+    // 可选的 HTTP 控制接口，未开启时为空
+    HttpControlServer* m_httpServer = nullptr;
+    void setHttpApiEnabled(bool enabled);
+    // 可选的局域网串流，未开启时为空
+    MediaStreamServer* m_streamServer = nullptr;
+    void setStreamingEnabled(bool enabled);
+    QString streamingPlaylistUrl() const;   // 其他设备打开的列表地址（含令牌）
+    void notifyRemoteStateChanged();
+    
+    // UI 组件
+    QWidget* m_centralWidget;
+    QPushButton* m_inListModeBtn;   // 用于 顺序/随机
+    QPushButton* m_playPauseBtn;
+    QPushButton* m_previousBtn;
+    QPushButton* m_nextBtn;
+    QPushButton* m_crossListModeBtn;  // 用于 列表循环/单曲循环/列表前进
+    
+    ClickableSlider* m_progressSlider;
+    ClickableSlider* m_volumeSlider;
+    QLabel* m_currentTimeLabel;
+    QLabel* m_totalTimeLabel;
+    QLabel* m_songTitleLabel;
+    QLabel* m_songArtistLabel;
+
+    // 托盘图标和菜单：快速启动时在第一次绘制之后才创建，之前为空
+    QSystemTrayIcon* m_trayIcon = nullptr;
+    QMenu* m_trayMenu = nullptr;
+    QAction* m_quitAction = nullptr;
+    
+    // 托盘菜单播放控制
+    QLabel* m_traySongLabel = nullptr;
+    QAction* m_trayPreviousAction;
+    QAction* m_trayPlayPauseAction;
+    QAction* m_trayNextAction;
+    QSlider* m_trayVolumeSlider = nullptr;
+    void updateTrayMenu();  // 更新托盘菜单状态
+    void setupTrayIcon();
+    void finishStartup();   // 窗口显示后才需要的初始化
+    bool m_fastStart = true;
+    
+    //成员变量存储高亮字体
+    QFont m_playingSongFont;
+    
+    // 播放器
+    QMediaPlayer* m_player;
+    QAudioOutput* m_audioOutput;
+    QSplitter* m_mainSplitter; // <--- 4. 将 Splitter 声明为成员变量
+    PlaylistManager* m_playlistManager;
+
+
+    //定时关机相关的成员变量
+    QTimer* m_shutdownTimer;
+    QProcess* m_shutdownProcess;
+    QDateTime m_shutdownDateTime;      // 用于存储关机时间，方便UI显示
+    QAction* m_cancelShutdownAction = nullptr;   // 用于方便地启用/禁用“取消”菜单项
+
+    // 丢失文件检测
+    MissingFileChecker* m_missingFileChecker;
+    QTimer* m_songListRefreshTimer;    // 合并多批检测结果，只刷新一次歌曲列表
+
+    FolderWatcher* m_folderWatcher;    // 监视文件夹播放列表的增量同步
+
+    // 专辑封面
+    CoverArtCache* m_coverArtCache;
+    QLabel* m_coverLabel;              // 正在播放的封面
+    QTimer* m_coverRequestTimer;       // 滚动时合并多次请求
+    QIcon m_blankCoverIcon;            // 没有封面的歌曲用透明图标占位，保持文字对齐
+    void updateNowPlayingCover();
+
+    
+
+    PlaylistListWidget* m_playlistListWidget;
+    SongListWidget* m_songListWidget;
+    
+    int m_currentPlaylistIndex;
+    int m_currentSongIndex;
+
+    int m_playingPlaylistIndex; 
+
+    InListMode m_inListMode;     // <-- 新的模式变量
+    CrossListMode m_crossListMode; // <-- 新的模式变量
+
+
+    QList<int> m_shuffledIndices;      //用于存储打乱后的歌曲索引
+    int m_shuffledPlaybackIndex;       //当前在随机列表中的播放位置
+
+    // CUE 虚拟音轨：正在播放的一段在文件中的位置（毫秒），普通歌曲为 0 / 0
+    qint64 m_trackStart = 0;
+    qint64 m_trackEnd = 0;             // 0 表示播放到文件末尾
+    qint64 m_pendingSeek = -1;         // 新文件加载完成后要跳转到的位置
+    QElapsedTimer m_fileOpenTimer;     // 从 setSource 到加载完成，用于诊断统计
+    void updateTrackRange();           // 按当前音轨更新进度条范围和总时长
+};
+
+#endif // MAINWINDOW_H
@@ -0,0 +1,673 @@
+#include "mediastreamserver.h"
+#include "applog.h"
+#include "ipcprotocol.h"
+#include <QThread>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QSocketNotifier>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QUrl>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <sys/sendfile.h>
+#include <cerrno>
+#endif
+#ifdef Q_OS_WIN
+#include <QDir>
+#include <QWinEventNotifier>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <mswsock.h>
+#include <windows.h>
+#endif
+
+namespace {
+
+const qint64 ChunkSize = 256 * 1024;
+const qint64 MaxBuffered = 1024 * 1024;   // Qt 写缓冲区中最多积压的数据，多了就等对方收走
+const int MaxRequestSize = 64 * 1024;
+const int MaxConnections = 128;
+// 播放列表（queue 命令的结果）在这段时间内直接复用，许多客户端同时刷新时界面线程只生成一次
+const int PlaylistCacheMsecs = 5000;
+
+QByteArray contentType(const QString& filePath)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "mp3") return "audio/mpeg";
+    if (suffix == "flac") return "audio/flac";
+    if (suffix == "wav") return "audio/wav";
+    if (suffix == "ogg" || suffix == "oga" || suffix == "opus") return "audio/ogg";
+    if (suffix == "m4a" || suffix == "aac") return "audio/mp4";
+    if (suffix == "ape") return "audio/x-ape";
+    if (suffix == "wv") return "audio/x-wavpack";
+    return "application/octet-stream";
+}
+
+// 解析 "bytes=start-end" / "bytes=start-" / "bytes=-N"
+// 返回 1 表示得到一个区间，0 表示忽略（格式不对或多个区间，按整个文件返回），-1 表示区间无法满足
+int parseRange(const QByteArray& header, qint64 size, qint64* start, qint64* end)
+{
+    if (!header.startsWith("bytes=")) return 0;
+    QByteArray spec = header.mid(6).trimmed();
+    if (spec.contains(',')) return 0;
+    int dash = spec.indexOf('-');
+    if (dash < 0) return 0;
+
+    QByteArray first = spec.left(dash).trimmed();
+    QByteArray last = spec.mid(dash + 1).trimmed();
+    bool firstOk = true, lastOk = true;
+    if (first.isEmpty()) {
+        // 最后 N 个字节
+        qint64 suffix = last.toLongLong(&lastOk);
+        if (!lastOk) return 0;
+        if (suffix <= 0 || size == 0) return -1;
+        *start = qMax<qint64>(0, size - suffix);
+        *end = size - 1;
+        return 1;
+    }
+
+    *start = first.toLongLong(&firstOk);
+    *end = last.isEmpty() ? size - 1 : last.toLongLong(&lastOk);
+    if (!firstOk || !lastOk || *start < 0 || *end < *start) return 0;
+    if (*start >= size) return -1;
+    *end = qMin(*end, size - 1);
+    return 1;
+}
+
+} // namespace
+
+// 一个客户端连接：解析请求，向界面线程查询文件路径，然后分块（或 sendfile / TransmitFile）发送文件
+// 连接上可以连续发送多个请求（keep-alive）
+class StreamConnection : public QObject
+{
+public:
+    StreamConnection(StreamWorker* worker, QTcpSocket* socket, quint64 id, const QString& token);
+    ~StreamConnection();
+
+    void onResolved(const QJsonObject& reply);
+
+private:
+    enum class State { Reading, Resolving, Sending };
+
+    void onReadyRead();
+    void processBuffer();
+    void handleRequest();
+    void sendSimple(int status, const QByteArray& body,
+                    const QByteArray& type = "text/plain; charset=utf-8",
+                    const QByteArray& extraHeaders = QByteArray());
+    void sendFile(const QString& filePath);
+    void sendPlaylist(const QJsonObject& result);
+    void pump();
+    void finishResponse();
+#ifdef Q_OS_WIN
+    bool openTransmitFile(const QString& filePath);
+    bool startTransmit();
+    void onTransmitDone();
+    void closeTransmitFile();
+#endif
+
+    StreamWorker* m_worker;
+    QTcpSocket* m_socket;
+    quint64 m_id;
+    QString m_token;
+
+    State m_state = State::Reading;
+    QByteArray m_buffer;
+    HttpControlServer::Request m_request;
+    QString m_pendingCommand;          // 等待界面线程返回结果的命令
+
+    QFile m_file;
+    qint64 m_offset = 0;
+    qint64 m_remaining = 0;
+    bool m_zeroCopy = false;           // 由内核直接发送文件内容（Linux 的 sendfile，Windows 的 TransmitFile）
+    QSocketNotifier* m_writeNotifier = nullptr;
+#ifdef Q_OS_WIN
+    HANDLE m_fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE m_transmitEvent = nullptr;
+    OVERLAPPED m_overlapped = {};
+    SOCKET m_transmitSocket = INVALID_SOCKET;
+    QWinEventNotifier* m_transmitNotifier = nullptr;
+    bool m_transmitPending = false;
+#endif
+};
+
+// 串流线程中的服务器，连接都由它创建和销毁
+class StreamWorker : public QObject
+{
+public:
+    StreamWorker(MediaStreamServer* facade, const QString& token)
+        : m_facade(facade), m_token(token) {}
+
+    bool listen(const QHostAddress& address, quint16 port, QString* errorString)
+    {
+        m_server = new QTcpServer(this);
+        connect(m_server, &QTcpServer::newConnection, this, [this]() { onNewConnection(); });
+        if (!m_server->listen(address, port)) {
+            *errorString = m_server->errorString();
+            return false;
+        }
+        return true;
+    }
+
+    // 在串流线程中关闭所有连接，之后线程才能安全退出
+    void shutdown()
+    {
+        if (m_server) m_server->close();
+        const QList<StreamConnection*> connections = m_connections.values();
+        m_connections.clear();
+        qDeleteAll(connections);
+        m_facade->m_connectionCount.store(0, std::memory_order_relaxed);
+    }
+
+    void requestCommand(quint64 id, const QString& command, const QJsonObject& args)
+    {
+        m_facade->resolve(this, id, command, args);
+    }
+
+    void deliver(quint64 id, const QJsonObject& reply)
+    {
+        // 连接可能在等待期间已经断开
+        if (StreamConnection* connection = m_connections.value(id)) {
+            connection->onResolved(reply);
+        }
+    }
+
+    void removeConnection(quint64 id)
+    {
+        if (StreamConnection* connection = m_connections.take(id)) {
+            connection->deleteLater();
+            m_facade->m_connectionCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    void onNewConnection()
+    {
+        while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+            if (m_connections.size() >= MaxConnections) {
+                connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+                socket->write("HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+                socket->disconnectFromHost();
+                continue;
+            }
+            quint64 id = m_nextId++;
+            m_connections.insert(id, new StreamConnection(this, socket, id, m_token));
+            m_facade->m_connectionCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    MediaStreamServer* m_facade;
+    QString m_token;
+    QTcpServer* m_server = nullptr;
+    QHash<quint64, StreamConnection*> m_connections;
+    quint64 m_nextId = 1;
+};
+
+StreamConnection::StreamConnection(StreamWorker* worker, QTcpSocket* socket, quint64 id, const QString& token)
+    : QObject(worker), m_worker(worker), m_socket(socket), m_id(id), m_token(token)
+{
+    m_socket->setParent(this);
+    connect(m_socket, &QTcpSocket::readyRead, this, [this]() { onReadyRead(); });
+    connect(m_socket, &QTcpSocket::bytesWritten, this, [this]() { pump(); });
+    connect(m_socket, &QTcpSocket::disconnected, this, [this]() { m_worker->removeConnection(m_id); });
+}
+
+StreamConnection::~StreamConnection()
+{
+    // 通知器要在套接字关闭之前销毁
+    delete m_writeNotifier;
+#ifdef Q_OS_WIN
+    closeTransmitFile();
+    delete m_transmitNotifier;
+    if (m_transmitEvent) CloseHandle(m_transmitEvent);
+#endif
+    m_socket->abort();
+}
+
+void StreamConnection::onReadyRead()
+{
+    m_buffer.append(m_socket->readAll());
+    if (m_buffer.size() > MaxRequestSize) {
+        m_socket->abort();
+        return;
+    }
+    processBuffer();
+}
+
+void StreamConnection::processBuffer()
+{
+    while (m_state == State::Reading && m_socket->state() == QAbstractSocket::ConnectedState) {
+        int errorStatus = 0;
+        HttpControlServer::Request request;
+        if (!HttpControlServer::parseRequest(m_buffer, &request, &errorStatus)) {
+            if (errorStatus != 0) {
+                m_request.keepAlive = false;
+                sendSimple(errorStatus, HttpControlServer::statusText(errorStatus));
+            }
+            return;
+        }
+        m_request = request;
+        handleRequest();
+    }
+}
+
+void StreamConnection::handleRequest()
+{
+    if (!HttpControlServer::isAuthorized(m_request, m_token)) {
+        sendSimple(401, "Unauthorized");
+        return;
+    }
+    if (m_request.method != "GET" && m_request.method != "HEAD") {
+        sendSimple(405, "Method Not Allowed", "text/plain; charset=utf-8", "Allow: GET, HEAD\r\n");
+        return;
+    }
+
+    QJsonObject args;
+    const QString path = m_request.path;
+    if (path == "/stream/now") {
+        m_pendingCommand = "status";
+    } else if (path == "/stream/playlist.m3u") {
+        m_pendingCommand = "queue";
+        args.insert("limit", 100000);
+    } else if (path.startsWith("/stream/")) {
+        bool ok = false;
+        int songId = path.mid(8).toInt(&ok);
+        if (!ok) {
+            sendSimple(404, "Not Found");
+            return;
+        }
+        m_pendingCommand = "song";
+        args.insert("id", songId);
+    } else {
+        sendSimple(404, "Not Found");
+        return;
+    }
+
+    // 歌曲表只能在界面线程访问，结果由 StreamWorker::deliver 送回
+    m_state = State::Resolving;
+    m_worker->requestCommand(m_id, m_pendingCommand, args);
+}
+
+void StreamConnection::onResolved(const QJsonObject& reply)
+{
+    if (m_state != State::Resolving) return;
+    m_state = State::Reading;
+
+    if (!reply.value("ok").toBool()) {
+        sendSimple(404, reply.value("error").toString().toUtf8());
+        return;
+    }
+    QJsonObject result = reply.value("result").toObject();
+    if (m_pendingCommand == "queue") {
+        sendPlaylist(result);
+        return;
+    }
+
+    QString filePath = result.value("filePath").toString();
+    if (filePath.isEmpty()) {
+        sendSimple(404, "当前没有在播放");
+        return;
+    }
+    sendFile(filePath);
+}
+
+void StreamConnection::sendSimple(int status, const QByteArray& body, const QByteArray& type,
+                                  const QByteArray& extraHeaders)
+{
+    const bool head = m_request.method == "HEAD";
+    QByteArray header = "HTTP/1.1 " + QByteArray::number(status) + ' '
+                        + HttpControlServer::statusText(status) + "\r\n"
+                        "Content-Type: " + type + "\r\n"
+                        "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                        + extraHeaders
+                        + (m_request.keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+    m_socket->write(header);
+    if (!head) m_socket->write(body);
+    finishResponse();
+}
+
+void StreamConnection::sendFile(const QString& filePath)
+{
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        sendSimple(404, "文件不存在");
+        return;
+    }
+
+    const qint64 size = m_file.size();
+    qint64 start = 0;
+    qint64 end = size - 1;
+    int status = 200;
+    QByteArray rangeHeader = m_request.headers.value("range");
+    if (!rangeHeader.isEmpty()) {
+        int range = parseRange(rangeHeader, size, &start, &end);
+        if (range < 0) {
+            m_file.close();
+            sendSimple(416, QByteArray(), "text/plain; charset=utf-8",
+                       "Content-Range: bytes */" + QByteArray::number(size) + "\r\n");
+            return;
+        }
+        if (range > 0) status = 206;
+    }
+    const qint64 length = size > 0 ? end - start + 1 : 0;
+
+    QByteArray header = "HTTP/1.1 " + QByteArray::number(status) + ' '
+                        + HttpControlServer::statusText(status) + "\r\n"
+                        "Content-Type: " + contentType(filePath) + "\r\n"
+                        "Content-Length: " + QByteArray::number(length) + "\r\n"
+                        "Accept-Ranges: bytes\r\n";
+    if (status == 206) {
+        header += "Content-Range: bytes " + QByteArray::number(start) + '-' + QByteArray::number(end)
+                  + '/' + QByteArray::number(size) + "\r\n";
+    }
+    header += m_request.keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    m_socket->write(header);
+
+    if (m_request.method == "HEAD" || length == 0) {
+        m_file.close();
+        finishResponse();
+        return;
+    }
+
+    m_offset = start;
+    m_remaining = length;
+#if defined(Q_OS_LINUX)
+    m_zeroCopy = true;
+#elif defined(Q_OS_WIN)
+    m_zeroCopy = openTransmitFile(filePath);
+    if (!m_zeroCopy) m_file.seek(start);
+#else
+    m_zeroCopy = false;
+    m_file.seek(start);
+#endif
+    m_state = State::Sending;
+    pump();
+}
+
+void StreamConnection::sendPlaylist(const QJsonObject& result)
+{
+    // 条目地址用客户端访问本机时使用的地址，令牌也一并带上
+    QByteArray host = m_request.headers.value("host");
+    if (host.isEmpty()) {
+        host = m_socket->localAddress().toString().toUtf8() + ':' + QByteArray::number(m_socket->localPort());
+    }
+    QByteArray query = m_token.isEmpty() ? QByteArray() : "?token=" + QUrl::toPercentEncoding(m_token);
+
+    // 同一个 CUE 文件的连续多条音轨只列一次，串流发送的总是整个文件
+    QByteArray body = "#EXTM3U\n";
+    QString lastPath;
+    const QJsonArray songs = result.value("songs").toArray();
+    for (const QJsonValue& value : songs) {
+        QJsonObject song = value.toObject();
+        QString path = song.value("filePath").toString();
+        if (path == lastPath) continue;
+        lastPath = path;
+
+        QString artist = song.value("artist").toString();
+        QString title = song.value("title").toString();
+        QString name = artist.isEmpty() ? title : artist + " - " + title;
+        qint64 duration = song.value("duration").toVariant().toLongLong();
+        body += "#EXTINF:" + QByteArray::number(duration > 0 ? duration / 1000 : -1) + ',' + name.toUtf8() + '\n'
+                + "http://" + host + "/stream/" + QByteArray::number(song.value("id").toInt()) + query + '\n';
+    }
+    sendSimple(200, body, "audio/x-mpegurl; charset=utf-8");
+}
+
+void StreamConnection::pump()
+{
+    if (m_state != State::Sending) return;
+
+#ifdef Q_OS_LINUX
+    if (m_zeroCopy) {
+        // 响应头还在 Qt 的写缓冲区里时先等它发完，文件内容再由内核直接发送
+        if (m_socket->bytesToWrite() > 0) return;
+
+        const int fd = static_cast<int>(m_socket->socketDescriptor());
+        while (m_remaining > 0) {
+            off_t offset = m_offset;
+            ssize_t sent = ::sendfile(fd, m_file.handle(), &offset, static_cast<size_t>(qMin(m_remaining, 4 * ChunkSize)));
+            if (sent > 0) {
+                m_offset += sent;
+                m_remaining -= sent;
+                continue;
+            }
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // 发送缓冲区满了，等套接字可写时再继续
+                if (!m_writeNotifier) {
+                    m_writeNotifier = new QSocketNotifier(fd, QSocketNotifier::Write, this);
+                    connect(m_writeNotifier, &QSocketNotifier::activated, this, [this]() {
+                        m_writeNotifier->setEnabled(false);
+                        pump();
+                    });
+                }
+                m_writeNotifier->setEnabled(true);
+                return;
+            }
+            if (sent < 0 && (errno == EINVAL || errno == ENOSYS)) {
+                // 文件系统不支持 sendfile，改用普通读写
+                m_zeroCopy = false;
+                m_file.seek(m_offset);
+                break;
+            }
+            // 对方断开，或者文件在发送过程中被截短
+            m_socket->abort();
+            return;
+        }
+        if (m_zeroCopy) {
+            m_file.close();
+            finishResponse();
+            return;
+        }
+    }
+#endif
+
+#ifdef Q_OS_WIN
+    if (m_zeroCopy) {
+        // 上一段还在发送，或者响应头还在 Qt 的写缓冲区里
+        if (m_transmitPending || m_socket->bytesToWrite() > 0) return;
+        if (m_remaining == 0) {
+            closeTransmitFile();
+            m_file.close();
+            finishResponse();
+            return;
+        }
+        if (startTransmit()) return;
+        // 套接字或文件不支持 TransmitFile，改用普通读写
+        closeTransmitFile();
+        m_zeroCopy = false;
+        m_file.seek(m_offset);
+    }
+#endif
+
+    while (m_remaining > 0 && m_socket->bytesToWrite() < MaxBuffered) {
+        QByteArray chunk = m_file.read(qMin(m_remaining, ChunkSize));
+        if (chunk.isEmpty()) {
+            m_socket->abort();
+            return;
+        }
+        m_remaining -= chunk.size();
+        m_socket->write(chunk);
+    }
+    if (m_remaining == 0) {
+        m_file.close();
+        finishResponse();
+    }
+}
+
+#ifdef Q_OS_WIN
+// TransmitFile 需要系统的文件句柄，QFile 只用来取大小和在失败时退回普通读写
+bool StreamConnection::openTransmitFile(const QString& filePath)
+{
+    const QString nativePath = QDir::toNativeSeparators(filePath);
+    m_fileHandle = CreateFileW(reinterpret_cast<LPCWSTR>(nativePath.utf16()), GENERIC_READ,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                               OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_fileHandle == INVALID_HANDLE_VALUE) return false;
+
+    if (!m_transmitEvent) {
+        // 手动复位的事件，每一段发送前重置
+        m_transmitEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!m_transmitEvent) {
+            closeTransmitFile();
+            return false;
+        }
+        m_transmitNotifier = new QWinEventNotifier(m_transmitEvent, this);
+        m_transmitNotifier->setEnabled(false);
+        connect(m_transmitNotifier, &QWinEventNotifier::activated, this, [this]() { onTransmitDone(); });
+    }
+    return true;
+}
+
+// 异步发送下一段，完成后由 m_transmitNotifier 通知
+// 每段最多 1MB：客户端版本的 Windows 同时只允许两个 TransmitFile 在进行，长时间占着会拖慢其他连接
+bool StreamConnection::startTransmit()
+{
+    m_transmitSocket = static_cast<SOCKET>(m_socket->socketDescriptor());
+    ResetEvent(m_transmitEvent);
+    m_overlapped = {};
+    m_overlapped.Offset = static_cast<DWORD>(m_offset & 0xFFFFFFFF);
+    m_overlapped.OffsetHigh = static_cast<DWORD>(m_offset >> 32);
+    m_overlapped.hEvent = m_transmitEvent;
+
+    const DWORD bytes = static_cast<DWORD>(qMin(m_remaining, 4 * ChunkSize));
+    if (!TransmitFile(m_transmitSocket, m_fileHandle, bytes, 0, &m_overlapped, nullptr, 0)
+        && WSAGetLastError() != WSA_IO_PENDING) {
+        return false;
+    }
+    m_transmitPending = true;
+    m_transmitNotifier->setEnabled(true);
+    return true;
+}
+
+void StreamConnection::onTransmitDone()
+{
+    // 事件是手动复位的，不关掉通知器会一直触发
+    m_transmitNotifier->setEnabled(false);
+    if (!m_transmitPending) return;
+    m_transmitPending = false;
+
+    DWORD sent = 0;
+    DWORD flags = 0;
+    if (!WSAGetOverlappedResult(m_transmitSocket, &m_overlapped, &sent, FALSE, &flags) || sent == 0) {
+        // 对方断开，或者文件在发送过程中被截短
+        m_socket->abort();
+        return;
+    }
+    m_offset += sent;
+    m_remaining -= sent;
+    pump();
+}
+
+void StreamConnection::closeTransmitFile()
+{
+    if (m_transmitPending) {
+        // 取消进行中的发送，等它真正结束后才能释放 OVERLAPPED 和文件句柄
+        CancelIoEx(reinterpret_cast<HANDLE>(m_transmitSocket), &m_overlapped);
+        WaitForSingleObject(m_transmitEvent, INFINITE);
+        m_transmitPending = false;
+    }
+    if (m_fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_fileHandle);
+        m_fileHandle = INVALID_HANDLE_VALUE;
+    }
+}
+#endif
+
+void StreamConnection::finishResponse()
+{
+    m_state = State::Reading;
+    if (!m_request.keepAlive) {
+        m_socket->disconnectFromHost();   // 写缓冲区发完后才真正断开
+        return;
+    }
+    // 下一个请求放到事件循环中处理，避免在发送回调里层层递归
+    if (!m_buffer.isEmpty()) {
+        QMetaObject::invokeMethod(this, [this]() { processBuffer(); }, Qt::QueuedConnection);
+    }
+}
+
+MediaStreamServer::MediaStreamServer(CommandHandler handler, QObject* parent)
+    : QObject(parent)
+    , m_handler(std::move(handler))
+{
+}
+
+MediaStreamServer::~MediaStreamServer()
+{
+    stop();
+}
+
+bool MediaStreamServer::start(const QHostAddress& address, quint16 port, const QString& token)
+{
+    stop();
+
+    m_thread = new QThread(this);
+    m_thread->setObjectName("MediaStream");
+    m_worker = new StreamWorker(this, token);
+    m_worker->moveToThread(m_thread);
+    m_thread->start();
+
+    // 服务器要在串流线程中创建和监听
+    bool ok = false;
+    StreamWorker* worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, address, port, &ok, this]() {
+        ok = worker->listen(address, port, &m_errorString);
+    }, Qt::BlockingQueuedConnection);
+
+    if (!ok) {
+        qCWarning(lcNet) << "局域网串流启动失败:" << m_errorString;
+        QString error = m_errorString;
+        stop();
+        m_errorString = error;
+        return false;
+    }
+    m_errorString.clear();
+    qCDebug(lcNet) << "局域网串流已启动:" << address.toString() << port;
+    return true;
+}
+
+void MediaStreamServer::stop()
+{
+    if (!m_thread) return;
+
+    StreamWorker* worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker]() { worker->shutdown(); }, Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
+
+    m_playlistCache = QJsonObject();
+    m_playlistCacheTimer.invalidate();
+
+    // 线程已经退出，可以在这里直接销毁它的对象
+    delete m_worker;
+    m_worker = nullptr;
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+void MediaStreamServer::resolve(StreamWorker* worker, quint64 connectionId, const QString& command, const QJsonObject& args)
+{
+    QMetaObject::invokeMethod(this, [this, worker, connectionId, command, args]() {
+        if (worker != m_worker) return;   // 服务器已经停止
+        QJsonObject reply;
+        if (command == "queue") {
+            if (!m_playlistCacheTimer.isValid() || m_playlistCacheTimer.elapsed() >= PlaylistCacheMsecs) {
+                m_playlistCache = m_handler(command, IpcProtocol::makeRequest(command, args));
+                m_playlistCacheTimer.start();
+            }
+            reply = m_playlistCache;   // 隐式共享，不复制整个列表
+        } else {
+            reply = m_handler(command, IpcProtocol::makeRequest(command, args));
+        }
+        QMetaObject::invokeMethod(worker, [worker, connectionId, reply]() {
+            worker->deliver(connectionId, reply);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
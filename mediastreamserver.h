@@ -0,0 +1,56 @@
+#ifndef MEDIASTREAMSERVER_H
+#define MEDIASTREAMSERVER_H
+
+#include <QObject>
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <atomic>
+#include "httpcontrolserver.h"
+
+class QThread;
+class StreamWorker;
+
+// 局域网音频串流（默认关闭，开启后监听所有网卡；监听非本机地址时必须带访问令牌）
+//   GET /stream/now            正在播放的歌曲文件
+//   GET /stream/<歌曲 ID>       歌曲库中的任一文件
+//   GET /stream/playlist.m3u   正在播放的列表，条目指向上面的地址，可以直接用其他设备上的播放器打开
+// 支持 HEAD 和单个区间的 Range 请求，其他设备拖动进度条时只传需要的部分。
+// 所有连接都在独立的线程中异步处理，不占用界面线程；Linux 上用 sendfile、Windows 上用 TransmitFile 直接从页缓存发送。
+// 只有查找歌曲路径时才回到界面线程执行命令（见 ipcprotocol.h 的 song / status / queue）。
+// playlist.m3u 的内容缓存几秒，列表的改动最多延迟这么久才反映出来
+// CUE 虚拟音轨发送的是整个文件
+class MediaStreamServer : public QObject
+{
+    Q_OBJECT
+public:
+    using CommandHandler = HttpControlServer::CommandHandler;
+
+    explicit MediaStreamServer(CommandHandler handler, QObject* parent = nullptr);
+    ~MediaStreamServer();
+
+    bool start(const QHostAddress& address, quint16 port, const QString& token = QString());
+    void stop();
+    bool isListening() const { return m_worker != nullptr; }
+    QString errorString() const { return m_errorString; }
+
+    // 当前的串流连接数（可以在任意线程读取）
+    int connectionCount() const { return m_connectionCount.load(std::memory_order_relaxed); }
+
+private:
+    friend class StreamWorker;
+    // 由串流线程调用：在界面线程执行命令，结果再投递回串流线程
+    void resolve(StreamWorker* worker, quint64 connectionId, const QString& command, const QJsonObject& args);
+
+    CommandHandler m_handler;
+    QThread* m_thread = nullptr;
+    StreamWorker* m_worker = nullptr;
+    QString m_errorString;
+    std::atomic<int> m_connectionCount{0};
+
+    // 只在界面线程中访问
+    QJsonObject m_playlistCache;
+    QElapsedTimer m_playlistCacheTimer;
+};
+
+#endif // MEDIASTREAMSERVER_H
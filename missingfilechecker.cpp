@@ -0,0 +1,171 @@
+#include "missingfilechecker.h"
+#include "tracerecorder.h"
+#include <QThread>
+#include <QFileInfo>
+#include <QDirIterator>
+#include <QHash>
+#include <QSet>
+
+namespace {
+
+// 每批检查的文件数：足够大以减少跨线程通信，又足够小以便及时响应取消
+const int kVerifyBatchSize = 256;
+
+QString fileNameKey(const QString& filePath) {
+    int pos = qMax(filePath.lastIndexOf('/'), filePath.lastIndexOf('\\')) + 1;
+    return filePath.mid(pos).toLower();
+}
+
+} // namespace
+
+MissingFileChecker::MissingFileChecker(QObject* parent)
+    : QObject(parent)
+    , m_thread(nullptr)
+    , m_cancelled(false)
+{
+}
+
+MissingFileChecker::~MissingFileChecker()
+{
+    cancel();
+    if (m_thread) {
+        m_thread->disconnect(this);
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void MissingFileChecker::startVerify(const QVector<Entry>& entries)
+{
+    startJob([this, entries]() { runVerify(entries); });
+}
+
+void MissingFileChecker::startRelocate(const QString& rootPath, const QVector<Entry>& missingEntries)
+{
+    startJob([this, rootPath, missingEntries]() { runRelocate(rootPath, missingEntries); });
+}
+
+void MissingFileChecker::cancel()
+{
+    m_cancelled = true;
+    m_pendingJob = nullptr;
+}
+
+void MissingFileChecker::startJob(std::function<void()> job)
+{
+    if (m_thread) {
+        // 先让正在运行的任务尽快退出，等它结束后再启动新任务（不在 GUI 线程中等待）
+        m_cancelled = true;
+        m_pendingJob = std::move(job);
+        return;
+    }
+
+    m_cancelled = false;
+    m_thread = QThread::create(std::move(job));
+    m_thread->setObjectName("MissingFileCheck");   // 调试器和性能跟踪中显示的线程名
+    connect(m_thread, &QThread::finished, this, [this]() {
+        m_thread->deleteLater();
+        m_thread = nullptr;
+
+        if (m_pendingJob) {
+            std::function<void()> next = std::move(m_pendingJob);
+            m_pendingJob = nullptr;
+            startJob(std::move(next));
+        }
+    });
+    m_thread->start(QThread::LowestPriority);
+}
+
+// 以下两个函数运行在工作线程中，只通过排队调用把结果交回 GUI 线程
+void MissingFileChecker::runVerify(const QVector<Entry>& entries)
+{
+    TraceRecorder::Span span("verifyFiles", "scan");
+    for (int start = 0; start < entries.size(); start += kVerifyBatchSize) {
+        if (m_cancelled) return;
+
+        QVector<int> missingIds;
+        QVector<int> presentIds;
+        QVector<qint64> presentSizes;
+
+        int end = qMin(start + kVerifyBatchSize, entries.size());
+        for (int i = start; i < end; ++i) {
+            QFileInfo fileInfo(entries[i].filePath);
+            if (fileInfo.exists()) {
+                presentIds.append(entries[i].songId);
+                presentSizes.append(fileInfo.size());
+            } else {
+                missingIds.append(entries[i].songId);
+            }
+        }
+
+        QMetaObject::invokeMethod(this, [this, missingIds, presentIds, presentSizes]() {
+            emit batchVerified(missingIds, presentIds, presentSizes);
+        }, Qt::QueuedConnection);
+
+        // 让出时间片，避免和播放线程争抢
+        QThread::yieldCurrentThread();
+    }
+
+    QMetaObject::invokeMethod(this, [this]() {
+        emit verifyFinished();
+    }, Qt::QueuedConnection);
+}
+
+void MissingFileChecker::runRelocate(const QString& rootPath, const QVector<Entry>& missingEntries)
+{
+    TraceRecorder::Span span("relocateFiles", "scan");
+    // 1. 丢失文件的文件名（小写）集合，扫描时只关心这些名字
+    QHash<QString, QVector<int>> wanted;
+    for (int i = 0; i < missingEntries.size(); ++i) {
+        wanted[fileNameKey(missingEntries[i].filePath)].append(i);
+    }
+
+    // 2. 扫描新的根目录，为同名文件建立 文件名 -> 候选文件 的哈希索引
+    //    只有文件名命中时才去读取文件大小
+    struct Candidate {
+        QString filePath;
+        qint64 size;
+    };
+    QHash<QString, QVector<Candidate>> index;
+
+    QDirIterator it(rootPath, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        if (m_cancelled) return;
+
+        it.next();
+        QString key = it.fileName().toLower();
+        if (!wanted.contains(key)) continue;
+        index[key].append({it.filePath(), it.fileInfo().size()});
+    }
+
+    // 3. 匹配：已知大小时要求大小一致；未知大小时只接受唯一的同名文件
+    QVector<int> songIds;
+    QStringList newPaths;
+    QSet<QString> usedPaths;
+
+    for (const Entry& entry : missingEntries) {
+        const QVector<Candidate> candidates = index.value(fileNameKey(entry.filePath));
+
+        QString match;
+        if (entry.fileSize > 0) {
+            for (const Candidate& candidate : candidates) {
+                if (candidate.size == entry.fileSize && !usedPaths.contains(candidate.filePath)) {
+                    match = candidate.filePath;
+                    break;
+                }
+            }
+        } else if (candidates.size() == 1 && !usedPaths.contains(candidates.first().filePath)) {
+            match = candidates.first().filePath;
+        }
+
+        if (!match.isEmpty()) {
+            usedPaths.insert(match);
+            songIds.append(entry.songId);
+            newPaths.append(match);
+        }
+    }
+
+    QMetaObject::invokeMethod(this, [this, songIds, newPaths]() {
+        emit relocateFinished(songIds, newPaths);
+    }, Qt::QueuedConnection);
+}
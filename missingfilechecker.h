@@ -0,0 +1,57 @@
+#ifndef MISSINGFILECHECKER_H
+#define MISSINGFILECHECKER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+class QThread;
+
+// 后台丢失文件检测与重新定位
+// 所有磁盘访问都在一个低优先级的工作线程中完成，结果通过信号回到 GUI 线程，
+// 因此即使歌曲库有几十万首歌、或者文件位于很慢的网络盘上，界面也不会卡住
+class MissingFileChecker : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry {
+        int songId;
+        QString filePath;
+        qint64 fileSize;    // 上次见到时的大小，0 表示未知
+    };
+
+    explicit MissingFileChecker(QObject* parent = nullptr);
+    ~MissingFileChecker();
+
+    bool isBusy() const { return m_thread != nullptr; }
+
+    // 分批检查给定的文件是否还存在
+    void startVerify(const QVector<Entry>& entries);
+    // 在新的根目录下，按 "文件名 + 文件大小" 为丢失的歌曲寻找新位置
+    void startRelocate(const QString& rootPath, const QVector<Entry>& missingEntries);
+    void cancel();
+
+signals:
+    // 每检查完一批发射一次
+    void batchVerified(const QVector<int>& missingIds,
+                       const QVector<int>& presentIds,
+                       const QVector<qint64>& presentSizes);
+    void verifyFinished();
+    // songIds[i] 的新路径为 newPaths[i]
+    void relocateFinished(const QVector<int>& songIds, const QStringList& newPaths);
+
+private:
+    void startJob(std::function<void()> job);
+    void runVerify(const QVector<Entry>& entries);
+    void runRelocate(const QString& rootPath, const QVector<Entry>& missingEntries);
+
+    QThread* m_thread;
+    std::function<void()> m_pendingJob;   // 当前任务结束后再启动的任务
+    std::atomic_bool m_cancelled;
+};
+
+#endif // MISSINGFILECHECKER_H
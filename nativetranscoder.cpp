@@ -0,0 +1,265 @@
+#include "nativetranscoder.h"
+#include "applog.h"
+#include "audioencoder.h"
+#include "tracerecorder.h"
+#include <QThread>
+#include <QEventLoop>
+#include <QAudioDecoder>
+#include <QAudioBuffer>
+#include <QAudioFormat>
+#include <QVector>
+#include <QUrl>
+#include <QElapsedTimer>
+#include <QDebug>
+
+// TagLib 头文件
+#include <taglib/fileref.h>
+#include <taglib/audioproperties.h>
+#include <taglib/flacproperties.h>
+#include <taglib/wavproperties.h>
+#include <taglib/aiffproperties.h>
+#include <taglib/mp4properties.h>
+
+namespace {
+
+// 无损格式的位深；有损格式没有位深的概念，返回 0
+int sourceBitsPerSample(const TagLib::AudioProperties* properties)
+{
+    if (auto flac = dynamic_cast<const TagLib::FLAC::Properties*>(properties)) return flac->bitsPerSample();
+    if (auto wav = dynamic_cast<const TagLib::RIFF::WAV::Properties*>(properties)) return wav->bitsPerSample();
+    if (auto aiff = dynamic_cast<const TagLib::RIFF::AIFF::Properties*>(properties)) return aiff->bitsPerSample();
+    if (auto mp4 = dynamic_cast<const TagLib::MP4::Properties*>(properties)) return mp4->bitsPerSample();
+    return 0;
+}
+
+// 把解码得到的任意样本格式统一转换为 bits 位的整数
+bool convertSamples(const QAudioBuffer& buffer, int bits, QVector<qint32>& out)
+{
+    const int count = buffer.sampleCount();
+    out.resize(count);
+    qint32* dst = out.data();
+
+    switch (buffer.format().sampleFormat()) {
+        case QAudioFormat::UInt8: {
+            const quint8* src = buffer.constData<quint8>();
+            for (int i = 0; i < count; ++i) dst[i] = (qint32(src[i]) - 128) * (1 << (bits - 8));
+            return true;
+        }
+        case QAudioFormat::Int16: {
+            const qint16* src = buffer.constData<qint16>();
+            for (int i = 0; i < count; ++i) dst[i] = qint32(src[i]) * (1 << (bits - 16));
+            return true;
+        }
+        case QAudioFormat::Int32: {
+            const qint32* src = buffer.constData<qint32>();
+            for (int i = 0; i < count; ++i) dst[i] = src[i] >> (32 - bits);
+            return true;
+        }
+        case QAudioFormat::Float: {
+            const float scale = float((1 << (bits - 1)) - 1);
+            const float* src = buffer.constData<float>();
+            for (int i = 0; i < count; ++i) {
+                dst[i] = qint32(qRound(qBound(-1.0f, src[i], 1.0f) * scale));
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+NativeTranscoder::NativeTranscoder(const QString& inputPath, const QString& outputPath,
+                                   const QString& codecName, QObject* parent)
+    : QObject(parent)
+    , m_inputPath(inputPath)
+    , m_outputPath(outputPath)
+    , m_codecName(codecName)
+    , m_thread(nullptr)
+    , m_cancelled(false)
+{
+}
+
+NativeTranscoder::~NativeTranscoder()
+{
+    m_cancelled = true;
+    if (m_thread) {
+        m_thread->disconnect(this);
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void NativeTranscoder::start()
+{
+    if (m_thread) return;
+
+    m_cancelled = false;
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("Transcode");   // 调试器和性能跟踪中显示的线程名
+    connect(m_thread, &QThread::finished, this, [this]() {
+        m_thread->deleteLater();
+        m_thread = nullptr;
+    });
+    m_thread->start(QThread::LowPriority);
+}
+
+void NativeTranscoder::cancel()
+{
+    m_cancelled = true;
+}
+
+bool NativeTranscoder::canTranscode(const QString& inputPath)
+{
+    TagLib::FileRef ref(inputPath.toStdWString().c_str(), true, TagLib::AudioProperties::Fast);
+    if (ref.isNull() || !ref.audioProperties()) return true;   // 读不出属性时交给解码器判断
+    return sourceBitsPerSample(ref.audioProperties()) <= AudioEncoder::MaxBitsPerSample;
+}
+
+void NativeTranscoder::run()
+{
+    TraceRecorder::Span span("nativeTranscode", "transcode");
+    auto reportFinished = [this](bool success) {
+        QMetaObject::invokeMethod(this, [this, success]() {
+            emit finished(success);
+        }, Qt::QueuedConnection);
+    };
+
+    std::unique_ptr<AudioEncoder> encoder = AudioEncoder::create(m_codecName);
+    if (!encoder) {
+        reportFinished(false);
+        return;
+    }
+
+    // 总时长用于把已处理的样本数换算为进度；位深决定输出 16 位还是 24 位
+    qint64 durationMs = 0;
+    int sourceBits = 0;
+    int sourceRate = 0;
+    int sourceChannels = 0;
+    {
+        TagLib::FileRef ref(m_inputPath.toStdWString().c_str(), true, TagLib::AudioProperties::Fast);
+        if (!ref.isNull() && ref.audioProperties()) {
+            durationMs = ref.audioProperties()->lengthInMilliseconds();
+            sourceBits = sourceBitsPerSample(ref.audioProperties());
+            sourceRate = ref.audioProperties()->sampleRate();
+            sourceChannels = ref.audioProperties()->channels();
+        }
+    }
+    if (sourceBits > AudioEncoder::MaxBitsPerSample) {
+        qCWarning(lcTranscode) << "位深超出内置引擎的支持范围:" << m_inputPath << sourceBits;
+        reportFinished(false);
+        return;
+    }
+    // 有损格式和 16 位以下的源文件输出 16 位，与 FFmpeg 的默认行为一致
+    const int outputBits = sourceBits > 16 ? AudioEncoder::MaxBitsPerSample : 16;
+
+    // QAudioDecoder 需要事件循环，这里在工作线程中运行一个局部事件循环
+    QAudioDecoder decoder;
+    decoder.setSource(QUrl::fromLocalFile(m_inputPath));
+    if (outputBits > 16 && sourceRate > 0 && sourceChannels > 0) {
+        // 高位深的源文件要求解码器输出 32 位整数，避免先被降为 16 位
+        QAudioFormat format;
+        format.setSampleRate(sourceRate);
+        format.setChannelCount(sourceChannels);
+        format.setSampleFormat(QAudioFormat::Int32);
+        decoder.setAudioFormat(format);
+    }
+
+    QEventLoop loop;
+    bool done = false;
+    bool ok = true;
+    bool opened = false;
+    int sampleRate = 0;
+    int channelCount = 0;
+    qint64 totalFrames = 0;
+    qint64 framesDone = 0;
+    int lastPercent = -1;
+    QVector<qint32> samples;
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    auto stop = [&](bool success) {
+        ok = ok && success;
+        done = true;
+        loop.quit();
+    };
+
+    connect(&decoder, &QAudioDecoder::bufferReady, &loop, [&]() {
+        if (done) return;
+        if (m_cancelled) {
+            decoder.stop();
+            stop(false);
+            return;
+        }
+
+        QAudioBuffer buffer = decoder.read();
+        if (!buffer.isValid()) return;
+
+        QAudioFormat format = buffer.format();
+        if (!opened) {
+            sampleRate = format.sampleRate();
+            channelCount = format.channelCount();
+            totalFrames = durationMs * sampleRate / 1000;
+            if (outputBits > 16 && (format.sampleFormat() == QAudioFormat::UInt8
+                                    || format.sampleFormat() == QAudioFormat::Int16)) {
+                // 解码器已经降成了 16 位，继续下去会悄悄丢掉精度
+                qCWarning(lcTranscode) << "解码器无法输出高位深样本:" << m_inputPath;
+                decoder.stop();
+                stop(false);
+                return;
+            }
+            if (!encoder->open(m_outputPath, sampleRate, channelCount, outputBits)) {
+                qCWarning(lcTranscode) << "无法创建输出文件:" << m_outputPath;
+                decoder.stop();
+                stop(false);
+                return;
+            }
+            opened = true;
+        } else if (format.sampleRate() != sampleRate || format.channelCount() != channelCount) {
+            // 中途格式变化的文件交给 FFmpeg 处理
+            qCWarning(lcTranscode) << "解码格式发生变化，无法继续:" << m_inputPath;
+            decoder.stop();
+            stop(false);
+            return;
+        }
+
+        if (!convertSamples(buffer, outputBits, samples) || !encoder->write(samples.constData(), buffer.frameCount())) {
+            decoder.stop();
+            stop(false);
+            return;
+        }
+
+        framesDone += buffer.frameCount();
+        if (totalFrames > 0) {
+            int percent = static_cast<int>(qMin<qint64>(99, framesDone * 100 / totalFrames));
+            if (percent != lastPercent) {
+                lastPercent = percent;
+                double speed = elapsed.elapsed() > 0
+                    ? (framesDone * 1000.0 / sampleRate) / elapsed.elapsed() : 0;
+                QMetaObject::invokeMethod(this, [this, percent, speed]() {
+                    emit progressChanged(percent, speed);
+                }, Qt::QueuedConnection);
+            }
+        }
+    });
+    connect(&decoder, &QAudioDecoder::finished, &loop, [&]() {
+        stop(true);
+    });
+    connect(&decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), &loop,
+            [&](QAudioDecoder::Error) {
+        qCWarning(lcTranscode) << "解码失败:" << m_inputPath << decoder.errorString();
+        stop(false);
+    });
+
+    decoder.start();
+    // 解码器可能在 start() 中就同步报错
+    if (!done) {
+        loop.exec();
+    }
+
+    if (opened) {
+        ok = encoder->close() && ok;
+    }
+    reportFinished(ok && opened);
+}
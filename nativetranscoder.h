@@ -0,0 +1,45 @@
+#ifndef NATIVETRANSCODER_H
+#define NATIVETRANSCODER_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+
+class QThread;
+
+// 进程内转码：在工作线程中用 QAudioDecoder 解码，转换为整数 PCM，
+// 再交给内置的 AudioEncoder 写成 WAV 或 FLAC。不需要启动 FFmpeg 进程，
+// 进度直接由已处理的样本数计算，而不是解析文本输出
+// 采样率、声道数和位深（16 / 24 位）保持与源文件一致
+class NativeTranscoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    NativeTranscoder(const QString& inputPath, const QString& outputPath,
+                     const QString& codecName, QObject* parent = nullptr);
+    ~NativeTranscoder();
+
+    void start();
+    void cancel();
+
+    // 源文件的位深超出内置编码器的能力（例如 32 位整数 WAV）时返回 false，调用者应改用 FFmpeg
+    static bool canTranscode(const QString& inputPath);
+
+signals:
+    // speed 为相对实时的倍数
+    void progressChanged(int percent, double speed);
+    void finished(bool success);
+
+private:
+    void run();    // 运行在工作线程中
+
+    QString m_inputPath;
+    QString m_outputPath;
+    QString m_codecName;
+
+    QThread* m_thread;
+    std::atomic_bool m_cancelled;
+};
+
+#endif // NATIVETRANSCODER_H
@@ -1,53 +1,86 @@
-#ifndef PLAYLIST_H
-#define PLAYLIST_H
-
-#include <QString>
-#include <QList>
-#include <QUrl>
-#include <QRegularExpression>
-
-struct Song {
-    QString title;
-    QString artist;
-    QString album;      // <--- 在这里添加 album 字段
-    QString filePath;
-    qint64 duration;  // 毫秒
-    
-    Song(const QString& path = "") 
-        : filePath(path), duration(0), artist("未知艺术家"), album("未知专辑") { // <--- 初始化新增字段
-        // 从文件路径提取歌曲名（使用正确的分隔符）
-        QStringList parts = path.split(QRegularExpression("[/\\\\]"));
-        if (!parts.isEmpty()) {
-            title = parts.last();
-            title.replace(QRegularExpression("\\.(mp3|wav|ogg|flac|m4a)$", 
-                         QRegularExpression::CaseInsensitiveOption), "");
-        }
-    }
-};
-
-class Playlist {
-public:
-    explicit Playlist(const QString& name = "新建列表");
-    
-    QString getName() const { return m_name; }
-    void setName(const QString& name) { m_name = name; }
-    
-    int songCount() const { return m_songs.size(); }
-    const QList<Song>& getSongs() const { return m_songs; }
-    Song getSong(int index) const;
-    
-    void addSong(const Song& song);
-    void addSongs(const QList<Song>& songs);
-    void removeSong(int index);
-    void clear();
-
-    void updateSongMetaData(int index, const QString& title, const QString& artist, const QString& album);
-    void sortByName();
-
-
-private:
-    QString m_name;
-    QList<Song> m_songs;
-};
-
-#endif // PLAYLIST_H
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <QString>
+#include <QList>
+#include <QUrl>
+#include "songlibrary.h"
+
+// 单首歌曲的完整记录，用于在模块之间传递数据
+// 播放列表内部不再直接保存 Song，而是保存在全局歌曲表（SongLibrary）中
+struct Song {
+    QString title;
+    QString artist;
+    QString album;      // <--- 在这里添加 album 字段
+    QString filePath;
+    qint64 duration;  // 毫秒
+    // CUE 虚拟音轨在音频文件中的起止位置（毫秒），普通歌曲均为 0
+    // endOffset 为 0 表示一直播放到文件末尾
+    qint64 startOffset;
+    qint64 endOffset;
+
+    Song(const QString& path = "")
+        : filePath(path), duration(0), startOffset(0), endOffset(0), artist("未知艺术家"), album("未知专辑") { // <--- 初始化新增字段
+        // 从文件路径提取歌曲名（同时兼容 / 和 \ 分隔符），再去掉音频后缀
+        // 这里不用正则，批量导入上万首歌时构造正则的开销非常明显
+        int start = qMax(path.lastIndexOf('/'), path.lastIndexOf('\\')) + 1;
+        title = path.mid(start);
+        int dot = title.lastIndexOf('.');
+        if (dot > 0) {
+            static const QStringList audioSuffixes = {"mp3", "wav", "ogg", "flac", "m4a"};
+            if (audioSuffixes.contains(title.mid(dot + 1), Qt::CaseInsensitive)) {
+                title.truncate(dot);
+            }
+        }
+    }
+
+    bool isVirtualTrack() const { return startOffset > 0 || endOffset > 0; }
+};
+
+class Playlist {
+public:
+    // 播放列表只保存歌曲 ID，歌曲本身登记在由 PlaylistManager 持有的全局歌曲表中
+    explicit Playlist(SongLibrary* library, const QString& name = "新建列表");
+
+    QString getName() const { return m_name; }
+    void setName(const QString& name) { m_name = name; }
+
+    // 监视文件夹：非空时，该列表会随文件夹内容的变化自动增删歌曲
+    QString watchedFolder() const { return m_watchedFolder; }
+    void setWatchedFolder(const QString& folder) { m_watchedFolder = folder; }
+    bool isWatched() const { return !m_watchedFolder.isEmpty(); }
+
+    int songCount() const { return m_songIds.size(); }
+    const QVector<int>& getSongIds() const { return m_songIds; }
+    int songId(int index) const { return m_songIds.value(index, SongLibrary::InvalidId); }
+    int indexOfSong(int songId) const { return m_songIds.indexOf(songId); }
+    SongLibrary* library() const { return m_library; }
+    Song getSong(int index) const { return m_library->song(songId(index)); }  // 需要拷贝，热路径请用下面的访问器
+
+    // 越界时返回空字符串；艺术家和专辑返回池中字符串的引用，标题从文本区拷贝
+    QString songTitle(int index) const { return m_library->title(songId(index)); }
+    const QString& songArtist(int index) const { return m_library->artist(songId(index)); }
+    const QString& songAlbum(int index) const { return m_library->album(songId(index)); }
+    QString songFilePath(int index) const { return m_library->filePath(songId(index)); }
+
+    void reserve(int count) { m_songIds.reserve(count); }
+    void addSong(const Song& song);
+    void addSongs(const QList<Song>& songs);
+    void addSongId(int songId);
+    void setSongIds(const QVector<int>& songIds) { m_songIds = songIds; }
+    void removeSong(int index);
+    void clear();
+
+    // 修改的是全局歌曲表中的记录，所有包含该歌曲的播放列表都会同步
+    void updateSongMetaData(int index, const QString& title, const QString& artist, const QString& album);
+    void sortByName();
+
+
+private:
+    QString m_name;
+    QString m_watchedFolder;
+    SongLibrary* m_library;
+    QVector<int> m_songIds;
+};
+
+#endif // PLAYLIST_H
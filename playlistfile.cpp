@@ -0,0 +1,250 @@
+#include "playlistfile.h"
+#include "applog.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QUrl>
+#include <QMap>
+#include <QTextStream>
+#include <QStringDecoder>
+#include <QDebug>
+
+namespace {
+
+// .m3u 没有规定编码：开头一段是合法的 UTF-8 就按 UTF-8 读，否则按本地编码（中文系统上为 GBK）
+QStringConverter::Encoding detectM3uEncoding(QFile& file)
+{
+    QByteArray head = file.peek(64 * 1024);
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    QString decoded = decoder(head);
+    Q_UNUSED(decoded);
+    return decoder.hasError() ? QStringConverter::System : QStringConverter::Utf8;
+}
+
+// "Artist - Title" 拆成艺术家和标题
+void applyDisplayName(Song& song, const QString& name)
+{
+    QString trimmed = name.trimmed();
+    if (trimmed.isEmpty()) return;
+
+    int separator = trimmed.indexOf(" - ");
+    if (separator > 0) {
+        song.artist = trimmed.left(separator).trimmed();
+        song.title = trimmed.mid(separator + 3).trimmed();
+    } else {
+        song.title = trimmed;
+    }
+}
+
+} // namespace
+
+bool PlaylistFile::isPlaylistFile(const QString& filePath)
+{
+    return filePath.endsWith(".m3u", Qt::CaseInsensitive)
+        || filePath.endsWith(".m3u8", Qt::CaseInsensitive)
+        || filePath.endsWith(".pls", Qt::CaseInsensitive);
+}
+
+QString PlaylistFile::resolvePath(const QString& entry, const QString& baseDir)
+{
+    QString path = entry.trimmed();
+    if (path.isEmpty()) return QString();
+
+    if (path.contains("://")) {
+        // 只接受本地文件地址，网络流跳过
+        QUrl url(path);
+        if (!url.isLocalFile()) return QString();
+        path = url.toLocalFile();
+    }
+
+    // 其他系统上生成的列表可能用 \ 分隔
+    path.replace('\\', '/');
+    if (QDir::isRelativePath(path)) {
+        path = baseDir + '/' + path;
+    }
+    return QDir::toNativeSeparators(QDir::cleanPath(path));
+}
+
+void PlaylistFile::readM3u(QTextStream& stream, const QString& baseDir, QList<Song>& songs)
+{
+    QString pendingName;
+    qint64 pendingDuration = 0;
+
+    QString line;
+    while (stream.readLineInto(&line)) {
+        line = line.trimmed();
+        if (line.isEmpty()) continue;
+
+        if (line.startsWith('#')) {
+            // #EXTINF:秒数,艺术家 - 标题
+            if (line.startsWith("#EXTINF:", Qt::CaseInsensitive)) {
+                int comma = line.indexOf(',');
+                if (comma > 0) {
+                    pendingDuration = line.mid(8, comma - 8).trimmed().toLongLong() * 1000;
+                    pendingName = line.mid(comma + 1);
+                }
+            }
+            continue;
+        }
+
+        QString path = resolvePath(line, baseDir);
+        if (!path.isEmpty()) {
+            Song song(path);
+            applyDisplayName(song, pendingName);
+            if (pendingDuration > 0) song.duration = pendingDuration;
+            songs.append(song);
+        }
+        pendingName.clear();
+        pendingDuration = 0;
+    }
+}
+
+void PlaylistFile::readPls(QTextStream& stream, const QString& baseDir, QList<Song>& songs)
+{
+    // FileN / TitleN / LengthN 可以按任意顺序出现，按编号收集后再排序输出
+    struct Entry {
+        QString path;
+        QString title;
+        qint64 duration = 0;
+    };
+    QMap<int, Entry> entries;
+
+    QString line;
+    while (stream.readLineInto(&line)) {
+        int equals = line.indexOf('=');
+        if (equals <= 0) continue;
+
+        QString key = line.left(equals).trimmed();
+        QString value = line.mid(equals + 1).trimmed();
+
+        int digits = key.size();
+        while (digits > 0 && key.at(digits - 1).isDigit()) --digits;
+        if (digits == key.size()) continue;   // NumberOfEntries、Version 等
+        int number = key.mid(digits).toInt();
+        QString name = key.left(digits).toLower();
+
+        if (name == "file") {
+            entries[number].path = resolvePath(value, baseDir);
+        } else if (name == "title") {
+            entries[number].title = value;
+        } else if (name == "length") {
+            entries[number].duration = qMax<qint64>(0, value.toLongLong()) * 1000;
+        }
+    }
+
+    songs.reserve(songs.size() + entries.size());
+    for (const Entry& entry : entries) {
+        if (entry.path.isEmpty()) continue;
+        Song song(entry.path);
+        applyDisplayName(song, entry.title);
+        if (entry.duration > 0) song.duration = entry.duration;
+        songs.append(song);
+    }
+}
+
+QList<Song> PlaylistFile::read(const QString& filePath, QString* errorString)
+{
+    QList<Song> songs;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (errorString) *errorString = file.errorString();
+        return songs;
+    }
+
+    QString baseDir = QFileInfo(filePath).absolutePath();
+    QTextStream stream(&file);
+    if (filePath.endsWith(".m3u", Qt::CaseInsensitive)) {
+        stream.setEncoding(detectM3uEncoding(file));
+    } else {
+        stream.setEncoding(QStringConverter::Utf8);   // .m3u8 / .pls
+    }
+
+    if (filePath.endsWith(".pls", Qt::CaseInsensitive)) {
+        readPls(stream, baseDir, songs);
+    } else {
+        readM3u(stream, baseDir, songs);
+    }
+
+    qCDebug(lcPlaylist) << "从" << filePath << "读取了" << songs.size() << "首歌曲";
+    if (songs.isEmpty() && errorString) {
+        *errorString = "文件中没有可用的歌曲";
+    }
+    return songs;
+}
+
+bool PlaylistFile::write(const QString& filePath, const Playlist* playlist, QString* errorString)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (errorString) *errorString = file.errorString();
+        return false;
+    }
+
+    const bool isPls = filePath.endsWith(".pls", Qt::CaseInsensitive);
+    QTextStream stream(&file);
+    // .m3u 也写 UTF-8：本地编码（GBK 等）表示不了的字符会被静默写成 '?'，
+    // 读取时会先按 UTF-8 识别，自己导出的文件总能原样读回
+    stream.setEncoding(QStringConverter::Utf8);
+
+    // 列表文件所在目录下的歌曲写相对路径，整个目录拷走后列表仍然可用
+    QDir baseDir = QFileInfo(filePath).absoluteDir();
+    const SongLibrary* library = playlist->library();
+
+    // 这些格式无法表示文件中的一段，同一个 CUE 文件的连续多条音轨只写一次
+    QVector<int> ids;
+    ids.reserve(playlist->songCount());
+    QString lastVirtualPath;
+    for (int id : playlist->getSongIds()) {
+        if (library->isVirtualTrack(id)) {
+            QString path = library->filePath(id);
+            if (path == lastVirtualPath) continue;
+            lastVirtualPath = path;
+        } else {
+            lastVirtualPath.clear();
+        }
+        ids.append(id);
+    }
+
+    if (isPls) {
+        stream << "[playlist]\n";
+    } else {
+        stream << "#EXTM3U\n";
+    }
+
+    for (int i = 0; i < ids.size(); ++i) {
+        int id = ids[i];
+        QString path = library->filePath(id);
+        QString relative = baseDir.relativeFilePath(path);
+        if (!relative.startsWith("..") && !QDir::isAbsolutePath(relative)) {
+            path = relative;
+        }
+        path = QDir::toNativeSeparators(path);
+
+        QString name = library->store().isUnknownArtist(id)
+                       ? library->title(id)
+                       : library->artist(id) + " - " + library->title(id);
+        qint64 seconds = library->duration(id) > 0 ? library->duration(id) / 1000 : -1;
+
+        if (isPls) {
+            int number = i + 1;
+            stream << "File" << number << '=' << path << '\n'
+                   << "Title" << number << '=' << name << '\n'
+                   << "Length" << number << '=' << seconds << '\n';
+        } else {
+            stream << "#EXTINF:" << seconds << ',' << name << '\n' << path << '\n';
+        }
+    }
+
+    if (isPls) {
+        stream << "NumberOfEntries=" << ids.size() << '\n' << "Version=2\n";
+    }
+
+    stream.flush();
+    if (stream.status() != QTextStream::Ok || !file.commit()) {
+        if (errorString) *errorString = file.errorString();
+        return false;
+    }
+    qCDebug(lcPlaylist) << "播放列表已导出到" << filePath << "，共" << ids.size() << "首歌曲";
+    return true;
+}
@@ -0,0 +1,31 @@
+#ifndef PLAYLISTFILE_H
+#define PLAYLISTFILE_H
+
+#include <QString>
+#include <QList>
+#include "playlist.h"
+
+class QTextStream;
+
+// M3U / M3U8 / PLS 播放列表文件的导入和导出
+// 读取时逐行解析，十万行的列表也不会整个读进内存；相对路径按列表文件所在目录解析。
+// 写入时逐首直接写到磁盘（QSaveFile，写完才替换目标文件）
+class PlaylistFile
+{
+public:
+    // 读取播放列表文件，返回其中的歌曲（#EXTINF / TitleN 中的信息会填入标题和艺术家）
+    // 网络地址会被跳过；失败时返回空列表并设置 errorString
+    static QList<Song> read(const QString& filePath, QString* errorString = nullptr);
+
+    // 按扩展名（.m3u / .m3u8 / .pls）写出播放列表
+    static bool write(const QString& filePath, const Playlist* playlist, QString* errorString = nullptr);
+
+    static bool isPlaylistFile(const QString& filePath);
+
+private:
+    static void readM3u(QTextStream& stream, const QString& baseDir, QList<Song>& songs);
+    static void readPls(QTextStream& stream, const QString& baseDir, QList<Song>& songs);
+    static QString resolvePath(const QString& entry, const QString& baseDir);
+};
+
+#endif // PLAYLISTFILE_H
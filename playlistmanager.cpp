@@ -1,142 +1,455 @@
-#include "playlistmanager.h"
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QFile>
-#include <QStandardPaths>
-#include <QDir>
-#include <QDebug> // 用于调试输出
-#include <QCoreApplication>
-#include <algorithm>
-
-PlaylistManager::PlaylistManager(QObject* parent) : QObject(parent) {
-    // 1. 确定配置文件的存储路径（软件目录下的 config 文件夹）
-    QString dataPath = QCoreApplication::applicationDirPath() + "/config";
-    QDir dir(dataPath);
-    if (!dir.exists()) {
-        dir.mkpath(".");
-    }
-    m_configFilePath = dataPath + "/playlists.json";
-    qDebug() << "配置文件路径：" << m_configFilePath;
-
-    // 2. 加载播放列表
-    loadPlaylists();
-
-    // 3. 如果加载后没有任何播放列表，则创建一个默认的
-    if (m_playlists.isEmpty()) {
-        m_playlists.append(new Playlist("我喜欢"));
-    }
-}
-
-// 实现析构函数，在对象销毁时自动保存
-PlaylistManager::~PlaylistManager() {
-    savePlaylists();
-
-    // 释放内存
-    qDeleteAll(m_playlists);
-    m_playlists.clear();
-}
-
-void PlaylistManager::loadPlaylists() {
-    QFile configFile(m_configFilePath);
-    if (!configFile.exists() || !configFile.open(QIODevice::ReadOnly)) {
-        qWarning("无法打开播放列表文件，将创建新的列表。");
-        return;
-    }
-
-    QByteArray saveData = configFile.readAll();
-    QJsonDocument loadDoc(QJsonDocument::fromJson(saveData));
-    
-    // 确保顶层是一个 JSON 数组
-    if (!loadDoc.isArray()) {
-        qWarning("播放列表文件格式错误。");
-        return;
-    }
-    
-    QJsonArray playlistsArray = loadDoc.array();
-
-    for (const QJsonValue& playlistValue : playlistsArray) {
-        QJsonObject playlistObject = playlistValue.toObject();
-        
-        QString playlistName = playlistObject["name"].toString();
-        Playlist* newPlaylist = new Playlist(playlistName);
-        
-        QJsonArray songsArray = playlistObject["songs"].toArray();
-        for (const QJsonValue& songValue : songsArray) {
-            QJsonObject songObject = songValue.toObject();
-            
-            // 创建 Song 对象并填充数据
-            Song newSong(songObject["filePath"].toString());
-            newSong.title = songObject["title"].toString();
-            newSong.artist = songObject["artist"].toString();
-            
-            newPlaylist->addSong(newSong);
-        }
-        m_playlists.append(newPlaylist);
-    }
-    
-    qDebug() << "成功加载" << m_playlists.size() << "个播放列表。";
-}
-
-void PlaylistManager::savePlaylists() const {
-    QJsonArray playlistsArray;
-    
-    for (const Playlist* playlist : m_playlists) {
-        QJsonObject playlistObject;
-        playlistObject["name"] = playlist->getName();
-        
-        QJsonArray songsArray;
-        for (const Song& song : playlist->getSongs()) {
-            QJsonObject songObject;
-            songObject["filePath"] = song.filePath;
-            songObject["title"] = song.title; // 保存标题
-            songObject["artist"] = song.artist; // 保存艺术家
-            songsArray.append(songObject);
-        }
-        
-        playlistObject["songs"] = songsArray;
-        playlistsArray.append(playlistObject);
-    }
-    
-    QJsonDocument saveDoc(playlistsArray);
-    
-    QFile configFile(m_configFilePath);
-    if (!configFile.open(QIODevice::WriteOnly)) {
-        qWarning("无法写入播放列表文件！");
-        return;
-    }
-    
-    configFile.write(saveDoc.toJson());
-    qDebug() << "播放列表已成功保存到" << m_configFilePath;
-}
-
-Playlist* PlaylistManager::getPlaylist(int index) {
-    if (index >= 0 && index < m_playlists.size()) {
-        return m_playlists[index];
-    }
-    return nullptr;
-}
-
-void PlaylistManager::addPlaylist(const QString& name) {
-    m_playlists.append(new Playlist(name));
-    emit playlistAdded(m_playlists.size() - 1);
-}
-
-void PlaylistManager::removePlaylist(int index) {
-    if (index >= 0 && index < m_playlists.size() && m_playlists.size() > 1) {
-        delete m_playlists[index];
-        m_playlists.removeAt(index);
-        emit playlistRemoved(index);
-    }
-}
-// 实现排序
-void PlaylistManager::sortPlaylistsByName() {
-    std::sort(m_playlists.begin(), m_playlists.end(), [](Playlist* a, Playlist* b) {
-        return QString::localeAwareCompare(a->getName(), b->getName()) < 0;
-    });
-}
-
-// 实现查找索引
-int PlaylistManager::getPlaylistIndex(Playlist* playlist) {
-    return m_playlists.indexOf(playlist);
-}
\ No newline at end of file
+#include "playlistmanager.h"
+#include "diagnostics.h"
+#include "tracerecorder.h"
+#include "applog.h"
+#include "cuesheet.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QFile>
+#include <QStandardPaths>
+#include <QDir>
+#include <QDebug> // 用于调试输出
+#include <QCoreApplication>
+#include <QHash>
+#include <QSet>
+#include <QFileInfo>
+#include <QDateTime>
+#include <algorithm>
+
+PlaylistManager::PlaylistManager(QObject* parent) : QObject(parent) {
+    // 1. 确定配置文件的存储路径（软件目录下的 config 文件夹）
+    QString dataPath = QCoreApplication::applicationDirPath() + "/config";
+    QDir dir(dataPath);
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+    m_configFilePath = dataPath + "/playlists.json";
+    qCDebug(lcPlaylist) << "配置文件路径:" << m_configFilePath;
+
+    // 2. 加载播放列表
+    loadPlaylists();
+
+    // 3. 如果加载后没有任何播放列表，则创建一个默认的
+    if (m_playlists.isEmpty()) {
+        m_playlists.append(new Playlist(&m_library, "我喜欢"));
+    }
+}
+
+// 实现析构函数，在对象销毁时自动保存
+PlaylistManager::~PlaylistManager() {
+    savePlaylists();
+
+    // 释放内存
+    qDeleteAll(m_playlists);
+    m_playlists.clear();
+}
+
+void PlaylistManager::loadPlaylists() {
+    QFile configFile(m_configFilePath);
+    if (!configFile.exists() || !configFile.open(QIODevice::ReadOnly)) {
+        qCWarning(lcPlaylist, "无法打开播放列表文件，将创建新的列表。");
+        return;
+    }
+
+    QByteArray saveData = configFile.readAll();
+    QJsonDocument loadDoc(QJsonDocument::fromJson(saveData));
+    
+    // 旧版本的顶层是一个 JSON 数组，每个播放列表各自保存完整的歌曲信息
+    if (loadDoc.isArray()) {
+        loadLegacyPlaylists(loadDoc.array());
+        qCInfo(lcPlaylist) << "成功加载" << m_playlists.size() << "个播放列表（旧格式）。";
+        return;
+    }
+
+    // 新版本的顶层是一个对象：songs 为全局歌曲表，playlists 中只保存歌曲在表中的序号
+    if (!loadDoc.isObject()) {
+        qCWarning(lcPlaylist, "播放列表文件格式错误。");
+        return;
+    }
+
+    QJsonObject rootObject = loadDoc.object();
+    QJsonArray songsArray = rootObject["songs"].toArray();
+
+    // 文件中的序号 -> 歌曲表中的 ID
+    QVector<int> songIds;
+    songIds.reserve(songsArray.size());
+    m_library.reserve(songsArray.size());
+
+    for (const QJsonValue& songValue : songsArray) {
+        QJsonObject songObject = songValue.toObject();
+
+        // 创建 Song 对象并填充数据
+        Song newSong(songObject["filePath"].toString());
+        newSong.title = songObject["title"].toString();
+        newSong.artist = songObject["artist"].toString();
+        newSong.album = songObject["album"].toString();
+        newSong.duration = songObject["duration"].toInteger();
+        newSong.startOffset = songObject["start"].toInteger();
+        newSong.endOffset = songObject["end"].toInteger();
+
+        int id = m_library.addSong(newSong);
+        m_library.setFileSize(id, songObject["size"].toInteger());
+        m_library.setModifiedTime(id, songObject["mtime"].toInteger());
+        // 保存过已知艺术家的歌曲说明标签已经读过，不必再次扫描；CUE 音轨的信息来自 CUE 文件
+        m_library.setMetaDataLoaded(id, m_library.isVirtualTrack(id) || !m_library.store().isUnknownArtist(id));
+        songIds.append(id);
+    }
+
+    QJsonArray playlistsArray = rootObject["playlists"].toArray();
+    for (const QJsonValue& playlistValue : playlistsArray) {
+        QJsonObject playlistObject = playlistValue.toObject();
+
+        Playlist* newPlaylist = new Playlist(&m_library, playlistObject["name"].toString());
+        newPlaylist->setWatchedFolder(playlistObject["watchedFolder"].toString());
+
+        QJsonArray indicesArray = playlistObject["songs"].toArray();
+        newPlaylist->reserve(indicesArray.size());
+        for (const QJsonValue& indexValue : indicesArray) {
+            int fileIndex = indexValue.toInt(-1);
+            if (fileIndex >= 0 && fileIndex < songIds.size()) {
+                newPlaylist->addSongId(songIds.at(fileIndex));
+            }
+        }
+        m_playlists.append(newPlaylist);
+    }
+    
+    qCInfo(lcPlaylist) << "成功加载" << m_playlists.size() << "个播放列表，共" << m_library.songCount() << "首歌曲。";
+}
+
+void PlaylistManager::loadLegacyPlaylists(const QJsonArray& playlistsArray) {
+    for (const QJsonValue& playlistValue : playlistsArray) {
+        QJsonObject playlistObject = playlistValue.toObject();
+        
+        QString playlistName = playlistObject["name"].toString();
+        Playlist* newPlaylist = new Playlist(&m_library, playlistName);
+        
+        QJsonArray songsArray = playlistObject["songs"].toArray();
+        newPlaylist->reserve(songsArray.size());
+        for (const QJsonValue& songValue : songsArray) {
+            QJsonObject songObject = songValue.toObject();
+            
+            // 创建 Song 对象并填充数据
+            Song newSong(songObject["filePath"].toString());
+            newSong.title = songObject["title"].toString();
+            newSong.artist = songObject["artist"].toString();
+
+            // 同一文件出现在多个列表中时只登记一次
+            int id = m_library.addSong(newSong);
+            m_library.setMetaDataLoaded(id, !m_library.store().isUnknownArtist(id));
+            newPlaylist->addSongId(id);
+        }
+        m_playlists.append(newPlaylist);
+    }
+}
+
+void PlaylistManager::savePlaylists() const {
+    Diagnostics::ScopedTimer timer(Diagnostics::PlaylistSave);
+    TraceRecorder::Span span("savePlaylists", "io");
+
+    // 只保存仍被某个播放列表引用的歌曲，并按出现顺序重新编号
+    QVector<int> fileIndexOfId(m_library.songCount(), -1);
+    QJsonArray songsArray;
+    QJsonArray playlistsArray;
+
+    for (const Playlist* playlist : m_playlists) {
+        QJsonObject playlistObject;
+        playlistObject["name"] = playlist->getName();
+        
+        QJsonArray indicesArray;
+        for (int id : playlist->getSongIds()) {
+            if (fileIndexOfId[id] < 0) {
+                fileIndexOfId[id] = songsArray.size();
+
+                QJsonObject songObject;
+                songObject["filePath"] = m_library.filePath(id);
+                songObject["title"] = m_library.title(id); // 保存标题
+                songObject["artist"] = m_library.artist(id); // 保存艺术家
+                songObject["album"] = m_library.album(id); // 保存专辑
+                if (m_library.duration(id) > 0) {
+                    songObject["duration"] = m_library.duration(id);
+                }
+                if (m_library.fileSize(id) > 0) {
+                    songObject["size"] = m_library.fileSize(id); // 用于文件移动后重新定位
+                }
+                if (m_library.modifiedTime(id) > 0) {
+                    songObject["mtime"] = m_library.modifiedTime(id); // 用于监视文件夹发现被修改的文件
+                }
+                if (m_library.isVirtualTrack(id)) {
+                    songObject["start"] = m_library.trackStart(id); // CUE 音轨在文件中的位置
+                    if (m_library.trackEnd(id) > 0) {
+                        songObject["end"] = m_library.trackEnd(id);
+                    }
+                }
+                songsArray.append(songObject);
+            }
+            indicesArray.append(fileIndexOfId[id]);
+        }
+        
+        playlistObject["songs"] = indicesArray;
+        if (playlist->isWatched()) {
+            playlistObject["watchedFolder"] = playlist->watchedFolder();
+        }
+        playlistsArray.append(playlistObject);
+    }
+
+    QJsonObject rootObject;
+    rootObject["version"] = 2;
+    rootObject["songs"] = songsArray;
+    rootObject["playlists"] = playlistsArray;
+    
+    QJsonDocument saveDoc(rootObject);
+    
+    QFile configFile(m_configFilePath);
+    if (!configFile.open(QIODevice::WriteOnly)) {
+        qCWarning(lcPlaylist, "无法写入播放列表文件！");
+        return;
+    }
+    
+    configFile.write(saveDoc.toJson());
+    // 每次编辑都会保存，只在调试级别记录
+    qCDebug(lcPlaylist) << "播放列表已保存:" << m_configFilePath;
+}
+
+Playlist* PlaylistManager::getPlaylist(int index) {
+    if (index >= 0 && index < m_playlists.size()) {
+        return m_playlists[index];
+    }
+    return nullptr;
+}
+
+void PlaylistManager::addPlaylist(const QString& name) {
+    m_playlists.append(new Playlist(&m_library, name));
+    emit playlistAdded(m_playlists.size() - 1);
+}
+
+void PlaylistManager::removePlaylist(int index) {
+    if (index >= 0 && index < m_playlists.size() && m_playlists.size() > 1) {
+        delete m_playlists[index];
+        m_playlists.removeAt(index);
+        emit playlistRemoved(index);
+    }
+}
+// 实现排序
+void PlaylistManager::sortPlaylistsByName() {
+    std::sort(m_playlists.begin(), m_playlists.end(), [](Playlist* a, Playlist* b) {
+        return QString::localeAwareCompare(a->getName(), b->getName()) < 0;
+    });
+}
+
+// 实现查找索引
+int PlaylistManager::getPlaylistIndex(Playlist* playlist) {
+    return m_playlists.indexOf(playlist);
+}
+
+QStringList PlaylistManager::watchedFolders() const {
+    QStringList folders;
+    for (const Playlist* playlist : m_playlists) {
+        if (playlist->isWatched() && !folders.contains(playlist->watchedFolder())) {
+            folders.append(playlist->watchedFolder());
+        }
+    }
+    return folders;
+}
+
+PlaylistManager::FolderSyncResult PlaylistManager::syncWatchedFolder(Playlist* playlist, const QVector<WatchedFile>& files) {
+    FolderSyncResult result;
+    if (!playlist) return result;
+
+    // 磁盘上当前存在的文件：路径 -> 修改时间，CUE 文件单独放
+    // 扫描结果用 / 分隔，换成歌曲库中的规范形式再比较，否则 Windows 上所有歌曲都会被当作新文件
+    QHash<QString, qint64> onDisk;
+    QHash<QString, qint64> cueFiles;
+    onDisk.reserve(files.size());
+    for (const WatchedFile& file : files) {
+        QString path = SongLibrary::normalizePath(file.filePath);
+        if (CueSheet::isCueFile(path)) {
+            cueFiles.insert(path, file.modified);
+        } else {
+            onDisk.insert(path, file.modified);
+        }
+    }
+
+    // 0. CUE：新的、改动过的，或者在本列表中还没有音轨的 CUE 重新解析
+    // 被 CUE 引用的整轨文件只以虚拟音轨的形式出现在列表中
+    QSet<QString> listedImages;
+    for (int id : playlist->getSongIds()) {
+        if (m_library.isVirtualTrack(id)) listedImages.insert(m_library.filePath(id));
+    }
+    QSet<QString> covered;
+    QSet<QString> reparsedImages;           // 这些文件上原有的条目以新解析的结果为准
+    QSet<int> cueTrackIds;
+    QHash<QString, QVector<int>> tracksByCue;
+    for (auto it = cueFiles.constBegin(); it != cueFiles.constEnd(); ++it) {
+        auto cached = m_cueCache.constFind(it.key());
+        bool needParse = cached == m_cueCache.constEnd() || cached->modified != it.value();
+        if (!needParse && !cached->audioFiles.isEmpty()) {
+            needParse = std::none_of(cached->audioFiles.begin(), cached->audioFiles.end(),
+                                     [&](const QString& image) { return listedImages.contains(image); });
+        }
+
+        if (needParse) {
+            CueInfo info;
+            info.modified = it.value();
+            CueSheet sheet;
+            if (sheet.load(it.key())) {
+                for (const QString& image : sheet.audioFiles()) {
+                    info.audioFiles.append(SongLibrary::normalizePath(image));
+                }
+                QVector<int>& ids = tracksByCue[it.key()];
+                for (const Song& track : sheet.tracks()) {
+                    int id = m_library.addSong(track);
+                    ids.append(id);
+                    cueTrackIds.insert(id);
+                }
+                for (const QString& image : info.audioFiles) reparsedImages.insert(image);
+            }
+            m_cueCache.insert(it.key(), info);
+        }
+        for (const QString& image : m_cueCache.value(it.key()).audioFiles) covered.insert(image);
+    }
+
+    // 整轨文件可能是扫描不列出的格式（.ape 等），这时直接确认它是否存在
+    QHash<QString, bool> imageExists;
+    auto isOnDisk = [&](const QString& path, bool virtualTrack) {
+        if (onDisk.contains(path)) return true;
+        if (!virtualTrack || !covered.contains(path)) return false;
+        auto found = imageExists.constFind(path);
+        if (found == imageExists.constEnd()) found = imageExists.insert(path, QFileInfo::exists(path));
+        return found.value();
+    };
+
+    // 1. 保留仍然存在的歌曲，顺便检查修改时间
+    // 一个 CUE 文件的多条虚拟音轨指向同一个文件，所以只记下已出现的路径，不从 onDisk 中删除
+    QVector<int> keptIds;
+    keptIds.reserve(playlist->songCount());
+    QSet<int> keptSet;
+    QSet<QString> knownPaths;
+    for (int id : playlist->getSongIds()) {
+        QString path = m_library.filePath(id);
+        bool virtualTrack = m_library.isVirtualTrack(id);
+        if (!isOnDisk(path, virtualTrack)) {
+            result.removed++;
+            continue;
+        }
+        // 被 CUE 引用的整轨文件不再作为普通歌曲保留；CUE 改动后旧的音轨也一并去掉
+        if (covered.contains(path)
+            && (!virtualTrack || (reparsedImages.contains(path) && !cueTrackIds.contains(id)))) {
+            result.removed++;
+            continue;
+        }
+
+        auto it = onDisk.constFind(path);
+        if (it != onDisk.constEnd()) {
+            qint64 known = m_library.modifiedTime(id);
+            // 文件内容变了（例如标签被其他软件修改），下次显示时重新读取标签
+            // 虚拟音轨的信息来自 CUE 文件，不从音频文件中重新读取
+            if (known != 0 && known != it.value() && !virtualTrack) {
+                m_library.setMetaDataLoaded(id, false);
+                result.changed++;
+            }
+            m_library.setModifiedTime(id, it.value());
+            knownPaths.insert(path);
+        }
+        keptIds.append(id);
+        keptSet.insert(id);
+    }
+
+    // 2. 其余的都是新文件，和重新解析的 CUE 一起按路径排序后一次性追加
+    QStringList newPaths;
+    for (auto it = onDisk.constBegin(); it != onDisk.constEnd(); ++it) {
+        if (!knownPaths.contains(it.key()) && !covered.contains(it.key())) newPaths.append(it.key());
+    }
+    newPaths.append(tracksByCue.keys());
+    std::sort(newPaths.begin(), newPaths.end());
+    for (const QString& path : newPaths) {
+        auto cue = tracksByCue.constFind(path);
+        if (cue != tracksByCue.constEnd()) {
+            for (int id : cue.value()) {
+                if (keptSet.contains(id)) continue;
+                m_library.setModifiedTime(id, onDisk.value(m_library.filePath(id)));
+                keptIds.append(id);
+                keptSet.insert(id);
+                result.added++;
+            }
+            continue;
+        }
+        int id = m_library.addSong(Song(path));
+        m_library.setModifiedTime(id, onDisk.value(path));
+        keptIds.append(id);
+        keptSet.insert(id);
+        result.added++;
+    }
+
+    if (!result.isEmpty()) {
+        playlist->setSongIds(keptIds);
+    }
+    return result;
+}
+
+int PlaylistManager::replaceSongFiles(const QVector<QPair<QString, QString>>& replacements) {
+    int replaced = 0;
+    QHash<int, int> remap;   // 新文件已在歌曲库中时：旧 ID -> 已有 ID
+
+    for (const auto& pair : replacements) {
+        const QString& newPath = pair.second;
+        QFileInfo newFileInfo(pair.second);
+
+        // CUE 音轨只是文件中的一段，转码不改变时间轴，直接指向新文件即可
+        for (int trackId : m_library.findVirtualTracks(pair.first)) {
+            m_library.relocate(trackId, newPath);
+            m_library.setFileSize(trackId, newFileInfo.size());
+            m_library.setModifiedTime(trackId, newFileInfo.lastModified().toMSecsSinceEpoch());
+            replaced++;
+        }
+
+        int id = m_library.findSong(pair.first);
+        if (id == SongLibrary::InvalidId) continue;
+
+        int existingId = m_library.findSong(newPath);
+        if (existingId == id) continue;
+
+        if (existingId == SongLibrary::InvalidId) {
+            // 歌曲记录由所有列表共享，改一次路径，所有包含它的列表就都指向了新文件
+            // 标签已从原文件复制过去，标题等元数据保持不变
+            m_library.relocate(id, newPath);
+            m_library.setFileSize(id, newFileInfo.size());
+            m_library.setModifiedTime(id, newFileInfo.lastModified().toMSecsSinceEpoch());
+        } else {
+            remap.insert(id, existingId);
+        }
+        replaced++;
+    }
+
+    // 新文件本来就在歌曲库中：各列表中的旧 ID 换成已有 ID，每个列表只重建一次
+    if (!remap.isEmpty()) {
+        for (Playlist* playlist : m_playlists) {
+            const QVector<int>& songIds = playlist->getSongIds();
+            bool changed = false;
+            for (int id : songIds) {
+                if (remap.contains(id)) {
+                    changed = true;
+                    break;
+                }
+            }
+            if (!changed) continue;
+
+            QSet<int> present(songIds.begin(), songIds.end());
+            QVector<int> newIds;
+            newIds.reserve(songIds.size());
+            for (int id : songIds) {
+                auto it = remap.constFind(id);
+                if (it == remap.constEnd()) {
+                    newIds.append(id);
+                } else if (!present.contains(it.value())) {
+                    // 同一列表中已有新文件时不重复添加
+                    newIds.append(it.value());
+                    present.insert(it.value());
+                }
+            }
+            playlist->setSongIds(newIds);
+        }
+    }
+
+    return replaced;
+}
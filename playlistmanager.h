@@ -1,38 +1,73 @@
-#ifndef PLAYLISTMANAGER_H
-#define PLAYLISTMANAGER_H
-
-#include <QObject>
-#include <QList>
-#include "playlist.h"
-
-class PlaylistManager : public QObject {
-    Q_OBJECT
-    
-public:
-    explicit PlaylistManager(QObject* parent = nullptr);
-    ~PlaylistManager(); // <--- 添加析构函数声明
-    
-    int playlistCount() const { return m_playlists.size(); }
-    Playlist* getPlaylist(int index);
-    const QList<Playlist*>& getPlaylists() const { return m_playlists; }
-    
-    void addPlaylist(const QString& name);
-    void removePlaylist(int index);
-    // 对播放列表本身进行排序
-    void sortPlaylistsByName();
-    // 根据指针查找索引（用于排序后恢复状态）
-    int getPlaylistIndex(Playlist* playlist);
-    void savePlaylists() const;  // 保存播放列表到配置文件
-    
-signals:
-    void playlistAdded(int index);
-    void playlistRemoved(int index);
-    
-private:
-    void loadPlaylists();       // <--- 添加加载函数声明
-
-    QList<Playlist*> m_playlists;
-    QString m_configFilePath;   // <--- 用于保存配置文件的路径
-};
-
-#endif // PLAYLISTMANAGER_H
+#ifndef PLAYLISTMANAGER_H
+#define PLAYLISTMANAGER_H
+
+#include <QObject>
+#include <QList>
+#include <QPair>
+#include <QHash>
+#include "playlist.h"
+#include "folderwatcher.h"
+
+class QJsonArray;
+
+class PlaylistManager : public QObject {
+    Q_OBJECT
+    
+public:
+    explicit PlaylistManager(QObject* parent = nullptr);
+    ~PlaylistManager(); // <--- 添加析构函数声明
+    
+    int playlistCount() const { return m_playlists.size(); }
+    Playlist* getPlaylist(int index);
+    const QList<Playlist*>& getPlaylists() const { return m_playlists; }
+    
+    void addPlaylist(const QString& name);
+    void removePlaylist(int index);
+    // 对播放列表本身进行排序
+    void sortPlaylistsByName();
+    // 根据指针查找索引（用于排序后恢复状态）
+    int getPlaylistIndex(Playlist* playlist);
+    void savePlaylists() const;  // 保存播放列表到配置文件
+
+    // 所有被监视的文件夹（去重）
+    QStringList watchedFolders() const;
+
+    // 监视文件夹同步的结果统计
+    struct FolderSyncResult {
+        int added = 0;
+        int removed = 0;
+        int changed = 0;     // 文件被修改，已标记为需要重新读取标签
+        bool isEmpty() const { return added == 0 && removed == 0 && changed == 0; }
+    };
+    // 用文件夹的最新扫描结果更新播放列表：一次性完成新增、删除和变更标记
+    FolderSyncResult syncWatchedFolder(Playlist* playlist, const QVector<WatchedFile>& files);
+
+    // 把歌曲换成转码后的新文件：每对为 (原路径, 新路径)
+    // 所有包含原文件的播放列表一次性更新，返回替换的歌曲数（调用者负责保存）
+    int replaceSongFiles(const QVector<QPair<QString, QString>>& replacements);
+
+    // 所有播放列表共用的全局歌曲表
+    SongLibrary* library() { return &m_library; }
+    const SongLibrary* library() const { return &m_library; }
+    
+signals:
+    void playlistAdded(int index);
+    void playlistRemoved(int index);
+    
+private:
+    void loadPlaylists();       // <--- 添加加载函数声明
+    void loadLegacyPlaylists(const QJsonArray& playlistsArray);  // 旧格式：每个列表各存一份歌曲
+
+    // 监视文件夹中解析过的 CUE 文件：没有变化时不必每次同步都重新解析
+    struct CueInfo {
+        qint64 modified = 0;
+        QStringList audioFiles;   // 引用的整轨文件（规范路径）
+    };
+    QHash<QString, CueInfo> m_cueCache;
+
+    SongLibrary m_library;      // 必须先于 m_playlists 构造、后于其析构
+    QList<Playlist*> m_playlists;
+    QString m_configFilePath;   // <--- 用于保存配置文件的路径
+};
+
+#endif // PLAYLISTMANAGER_H
@@ -1,73 +1,184 @@
-#include "singleapplication.h"
-#include <QDebug>
-
-SingleApplication::SingleApplication(int &argc, char *argv[], const QString uniqueKey)
-    : QApplication(argc, argv), _uniqueKey(uniqueKey), _isRunning(false)
-{
-    _localServer = new QLocalServer(this);
-
-    // 1. 尝试连接已存在的服务器
-    QLocalSocket socket;
-    socket.connectToServer(_uniqueKey);
-
-    if (socket.waitForConnected(500)) {
-        // 连接成功，说明已经有一个实例在运行
-        _isRunning = true;
-        // 关闭连接，我们稍后通过 sendMessage 发送指令
-        socket.disconnectFromServer(); 
-    } else {
-        // 连接失败，说明我们是第一个实例
-        _isRunning = false;
-        
-        // 2. 清理可能遗留的旧连接（防止上次崩溃导致的问题）
-        QLocalServer::removeServer(_uniqueKey);
-
-        // 3. 启动监听
-        connect(_localServer, &QLocalServer::newConnection, this, &SingleApplication::receiveMessage);
-        if (!_localServer->listen(_uniqueKey)) {
-            // 如果监听失败（极少情况，例如权限问题），至少让程序能跑
-            qWarning() << "Local server listen failed:" << _localServer->errorString();
-        }
-    }
-}
-
-bool SingleApplication::isRunning()
-{
-    return _isRunning;
-}
-
-bool SingleApplication::sendMessage(const QString &message)
-{
-    if (!_isRunning) return false;
-
-    QLocalSocket socket;
-    socket.connectToServer(_uniqueKey);
-    if (socket.waitForConnected(1000)) {
-        // 发送消息（例如 "WAKE_UP"）
-        socket.write(message.toUtf8());
-        socket.flush();
-        socket.waitForBytesWritten(1000);
-        return true;
-    }
-    return false;
-}
-
-void SingleApplication::receiveMessage()
-{
-    // 获取连接进来的 Socket
-    QLocalSocket *socket = _localServer->nextPendingConnection();
-    if (!socket) return;
-
-    // 等待读取数据
-    if (socket->waitForReadyRead(1000)) {
-        QByteArray data = socket->readAll();
-        QString message = QString::fromUtf8(data);
-
-        // 如果收到唤醒指令
-        if (message == "WAKE_UP") {
-            qDebug() << "Received WAKE_UP signal.";
-            emit showUp(); // 发射信号通知主窗口
-        }
-    }
-    socket->deleteLater();
-}
\ No newline at end of file
+#include "singleapplication.h"
+#include "ipcprotocol.h"
+#include "diagnostics.h"
+#include "applog.h"
+#include <QDir>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QDebug>
+
+namespace {
+
+// 单条消息的上限：一次 enqueue 上万个路径也远小于这个值，超过的客户端直接断开
+const int MaxMessageSize = 16 * 1024 * 1024;
+
+} // namespace
+
+SingleApplication::SingleApplication(int &argc, char *argv[], const QString uniqueKey)
+    : QApplication(argc, argv), _isRunning(false), _uniqueKey(uniqueKey)
+{
+    _localServer = new QLocalServer(this);
+
+    // 1. 用锁文件判断是否已有实例：不需要连接和等待，首次启动不会有任何延迟
+    //    持有锁的进程崩溃后，QLockFile 会根据进程号识别出过期的锁并接管
+    _lockFile = new QLockFile(QDir::temp().filePath(_uniqueKey + ".lock"));
+    if (!_lockFile->tryLock(0) && _lockFile->error() == QLockFile::LockFailedError) {
+        // 锁被另一个活着的进程持有，说明已经有一个实例在运行
+        _isRunning = true;
+        return;
+    }
+    // 其他错误（例如临时目录不可写）时按第一个实例继续，至少让程序能跑
+
+    // 2. 清理可能遗留的旧连接（防止上次崩溃导致的问题）
+    QLocalServer::removeServer(_uniqueKey);
+
+    // 3. 启动监听
+    connect(_localServer, &QLocalServer::newConnection, this, &SingleApplication::onNewConnection);
+    if (!_localServer->listen(_uniqueKey)) {
+        // 如果监听失败（极少情况，例如权限问题），至少让程序能跑
+        qWarning() << "Local server listen failed:" << _localServer->errorString();
+    }
+}
+
+SingleApplication::~SingleApplication()
+{
+    delete _lockFile;   // 析构时释放锁
+}
+
+bool SingleApplication::isRunning()
+{
+    return _isRunning;
+}
+
+// 主实例刚启动时可能已经拿到锁但还没开始监听，短暂重试
+bool SingleApplication::connectToPrimary(QLocalSocket &socket)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (true) {
+        socket.connectToServer(_uniqueKey);
+        if (socket.waitForConnected(1000)) {
+            return true;
+        }
+        if (timer.elapsed() > 2000) {
+            return false;
+        }
+        QThread::msleep(50);
+    }
+}
+
+bool SingleApplication::sendMessage(const QString &message)
+{
+    if (!_isRunning) return false;
+
+    QLocalSocket socket;
+    if (connectToPrimary(socket)) {
+        // 发送消息（例如 "WAKE_UP"）
+        socket.write(message.toUtf8());
+        socket.flush();
+        socket.waitForBytesWritten(1000);
+        return true;
+    }
+    return false;
+}
+
+bool SingleApplication::sendRequest(const QJsonObject &request, QJsonObject *reply)
+{
+    if (!_isRunning) return false;
+
+    // 先确认主实例已在监听，再交给协议层收发
+    QLocalSocket probe;
+    if (!connectToPrimary(probe)) return false;
+    probe.disconnectFromServer();
+    return IpcProtocol::sendRequest(_uniqueKey, request, reply);
+}
+
+void SingleApplication::setCommandHandler(CommandHandler handler)
+{
+    _commandHandler = std::move(handler);
+}
+
+void SingleApplication::onNewConnection()
+{
+    // 一次 newConnection 可能对应多个连接
+    while (QLocalSocket *socket = _localServer->nextPendingConnection()) {
+        _buffers.insert(socket, QByteArray());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+            onClientReadyRead(socket);
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            onClientDisconnected(socket);
+        });
+        // 连接前已经到达的数据不会再触发 readyRead
+        if (socket->bytesAvailable() > 0) {
+            onClientReadyRead(socket);
+        }
+    }
+}
+
+void SingleApplication::onClientReadyRead(QLocalSocket *socket)
+{
+    if (!_buffers.contains(socket)) return;
+
+    QByteArray &buffer = _buffers[socket];
+    buffer.append(socket->readAll());
+    if (buffer.size() > MaxMessageSize) {
+        qCWarning(lcIpc) << "客户端消息过长，断开连接";
+        _buffers.remove(socket);
+        socket->abort();   // 之后的清理在 onClientDisconnected 中完成
+        return;
+    }
+
+    // 逐行处理；一个连接可以连续发送多条请求，每条都按顺序回复
+    QPointer<QLocalSocket> guard(socket);
+    while (true) {
+        auto it = _buffers.find(socket);
+        if (it == _buffers.end()) return;
+        int end = it->indexOf('\n');
+        if (end < 0) return;
+
+        QByteArray line = it->left(end);
+        it->remove(0, end + 1);
+        if (line.trimmed().isEmpty()) continue;
+
+        // 处理命令时可能间接处理事件，客户端在此期间断开的话不再回复
+        QJsonObject reply = handleRequest(line);
+        if (!guard || guard->state() != QLocalSocket::ConnectedState) return;
+        socket->write(IpcProtocol::encode(reply));
+    }
+}
+
+void SingleApplication::onClientDisconnected(QLocalSocket *socket)
+{
+    // 旧版本发送不带换行的 "WAKE_UP" 后立即断开，剩下的数据按一条请求处理
+    QByteArray rest = _buffers.take(socket);
+    rest.append(socket->readAll());
+    if (!rest.trimmed().isEmpty()) {
+        handleRequest(rest);
+    }
+    socket->deleteLater();
+}
+
+QJsonObject SingleApplication::handleRequest(const QByteArray &line)
+{
+    Diagnostics::ScopedTimer timer(Diagnostics::IpcMessage);
+
+    QJsonObject request;
+    QString error;
+    if (!IpcProtocol::parseRequest(line, &request, &error)) {
+        qCWarning(lcIpc) << "收到无效的请求:" << error;
+        return IpcProtocol::makeError(error);
+    }
+
+    QString command = request.value("cmd").toString();
+    if (command == "wake") {
+        qCDebug(lcIpc) << "Received WAKE_UP signal.";
+        emit showUp(); // 发射信号通知主窗口
+        return IpcProtocol::makeReply();
+    }
+    if (!_commandHandler) {
+        return IpcProtocol::makeError("主窗口尚未就绪");
+    }
+    return _commandHandler(command, request);
+}
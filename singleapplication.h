@@ -1,34 +1,56 @@
-#ifndef SINGLEAPPLICATION_H
-#define SINGLEAPPLICATION_H
-
-#include <QApplication>
-#include <QLocalServer>
-#include <QLocalSocket>
-
-class SingleApplication : public QApplication
-{
-    Q_OBJECT
-public:
-    SingleApplication(int &argc, char *argv[], const QString uniqueKey);
-
-    // 检查是否已经有实例在运行
-    bool isRunning();
-    
-    // 如果已经运行，发送消息给主实例
-    bool sendMessage(const QString &message);
-
-public slots:
-    // 处理新连接的槽函数
-    void receiveMessage();
-
-signals:
-    // 当收到唤醒消息时，发射此信号
-    void showUp();
-
-private:
-    bool _isRunning;
-    QString _uniqueKey;
-    QLocalServer *_localServer;
-};
-
-#endif // SINGLEAPPLICATION_H
\ No newline at end of file
+#ifndef SINGLEAPPLICATION_H
+#define SINGLEAPPLICATION_H
+
+#include <QApplication>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QLockFile>
+#include <QHash>
+#include <QJsonObject>
+#include <functional>
+
+class SingleApplication : public QApplication
+{
+    Q_OBJECT
+public:
+    // 处理一条命令（协议见 ipcprotocol.h），返回要发回给客户端的回复
+    using CommandHandler = std::function<QJsonObject(const QString& command, const QJsonObject& request)>;
+
+    SingleApplication(int &argc, char *argv[], const QString uniqueKey);
+    ~SingleApplication();
+
+    // 检查是否已经有实例在运行
+    bool isRunning();
+    
+    // 如果已经运行，发送消息给主实例
+    bool sendMessage(const QString &message);
+
+    // 向主实例发送一条命令请求，reply 不为空时带回主实例的回复
+    bool sendRequest(const QJsonObject &request, QJsonObject *reply = nullptr);
+
+    // 除 wake 以外的命令都交给 handler 处理（由主窗口设置）
+    void setCommandHandler(CommandHandler handler);
+
+signals:
+    // 当收到唤醒消息时，发射此信号
+    void showUp();
+
+private slots:
+    // 接受所有等待中的连接，之后完全由 readyRead 驱动，不在界面线程上等待
+    void onNewConnection();
+
+private:
+    void onClientReadyRead(QLocalSocket *socket);
+    void onClientDisconnected(QLocalSocket *socket);
+    QJsonObject handleRequest(const QByteArray &line);
+    bool connectToPrimary(QLocalSocket &socket);
+
+    bool _isRunning;
+    QString _uniqueKey;
+    QLocalServer *_localServer;
+    QLockFile *_lockFile;
+    QHash<QLocalSocket*, QByteArray> _buffers;   // 每个客户端尚未凑成一行的数据
+    CommandHandler _commandHandler;
+};
+
+#endif // SINGLEAPPLICATION_H
@@ -0,0 +1,226 @@
+#include "songlibrary.h"
+#include "playlist.h"
+#include <QDir>
+#include <algorithm>
+
+namespace {
+
+// 路径索引的装载率上限为 3/4，超过时容量翻倍
+int indexCapacity(int count) {
+    int capacity = 64;
+    while (qint64(capacity) * 3 < qint64(count) * 4) capacity *= 2;
+    return capacity;
+}
+
+int indexSlot(QStringView fileName, int capacity) {
+    return int(qHash(fileName) & size_t(capacity - 1));
+}
+
+} // namespace
+
+void SongLibrary::reserve(int count) {
+    m_store.reserve(count);
+    m_flags.reserve(count);
+    if (indexCapacity(count) > m_indexSlots.size()) {
+        rehashIndex(indexCapacity(count));
+    }
+}
+
+QString SongLibrary::normalizePath(const QString& filePath) {
+    QString path = QDir::fromNativeSeparators(filePath);
+    // 大多数路径本来就是干净的，只有可能含 "."、".." 或重复分隔符时才调用 cleanPath
+    if (path.contains(QLatin1String("/.")) || path.indexOf(QLatin1String("//"), 1) >= 0) {
+        path = QDir::cleanPath(path);
+    }
+    return QDir::toNativeSeparators(path);
+}
+
+int SongLibrary::addSong(const Song& song) {
+    Song normalized = song;
+    normalized.filePath = normalizePath(song.filePath);
+    int existing = findNormalized(normalized.filePath, song.startOffset, song.endOffset);
+    if (existing != InvalidId) {
+        return existing;
+    }
+
+    int id = m_store.append(normalized);
+    m_flags.append(0);
+    addToIndex(id);
+
+    // 虚拟音轨的标题等信息来自 CUE 文件，不再用 TagLib 读取整个文件的标签
+    if (song.isVirtualTrack()) {
+        m_trackRanges.insert(id, qMakePair(song.startOffset, song.endOffset));
+        setFlag(id, VirtualTrack, true);
+        setFlag(id, MetaDataLoaded, true);
+    }
+    return id;
+}
+
+int SongLibrary::findSong(const QString& filePath, qint64 startOffset, qint64 endOffset) const {
+    return findNormalized(normalizePath(filePath), startOffset, endOffset);
+}
+
+int SongLibrary::findNormalized(const QString& filePath, qint64 startOffset, qint64 endOffset) const {
+    int pos = qMax(filePath.lastIndexOf('/'), filePath.lastIndexOf('\\')) + 1;
+    QStringView dir = QStringView(filePath).left(pos);
+    QStringView fileName = QStringView(filePath).mid(pos);
+    if (m_indexSlots.isEmpty()) return InvalidId;
+
+    const int mask = m_indexSlots.size() - 1;
+    for (int slot = indexSlot(fileName, m_indexSlots.size()); m_indexSlots.at(slot) != InvalidId;
+         slot = (slot + 1) & mask) {
+        int id = m_indexSlots.at(slot);
+        if (m_store.fileName(id) == fileName && m_store.directory(id) == dir
+            && trackStart(id) == startOffset && trackEnd(id) == endOffset) {
+            return id;
+        }
+    }
+    return InvalidId;
+}
+
+QVector<int> SongLibrary::findVirtualTracks(const QString& path) const {
+    const QString filePath = normalizePath(path);
+    int pos = qMax(filePath.lastIndexOf('/'), filePath.lastIndexOf('\\')) + 1;
+    QStringView dir = QStringView(filePath).left(pos);
+    QStringView fileName = QStringView(filePath).mid(pos);
+
+    QVector<int> ids;
+    if (m_indexSlots.isEmpty()) return ids;
+
+    const int mask = m_indexSlots.size() - 1;
+    for (int slot = indexSlot(fileName, m_indexSlots.size()); m_indexSlots.at(slot) != InvalidId;
+         slot = (slot + 1) & mask) {
+        int id = m_indexSlots.at(slot);
+        if (isVirtualTrack(id) && m_store.fileName(id) == fileName && m_store.directory(id) == dir) {
+            ids.append(id);
+        }
+    }
+    // 槽的顺序与登记顺序无关，按 ID（即登记顺序）返回
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+qint64 SongLibrary::trackStart(int id) const {
+    auto it = m_trackRanges.constFind(id);
+    return it != m_trackRanges.constEnd() ? it.value().first : 0;
+}
+
+qint64 SongLibrary::trackEnd(int id) const {
+    auto it = m_trackRanges.constFind(id);
+    return it != m_trackRanges.constEnd() ? it.value().second : 0;
+}
+
+Song SongLibrary::song(int id) const {
+    Song result = m_store.song(id);
+    result.startOffset = trackStart(id);
+    result.endOffset = trackEnd(id);
+    return result;
+}
+
+bool SongLibrary::testFlag(int id, Flag flag) const {
+    return id >= 0 && id < m_flags.size() && (m_flags.at(id) & flag);
+}
+
+void SongLibrary::setFlag(int id, Flag flag, bool on) {
+    if (id < 0 || id >= m_flags.size()) return;
+    if (on) {
+        m_flags[id] |= flag;
+    } else {
+        m_flags[id] &= ~flag;
+    }
+}
+
+int SongLibrary::missingCount() const {
+    int count = 0;
+    for (quint8 flags : m_flags) {
+        if (flags & Missing) ++count;
+    }
+    return count;
+}
+
+void SongLibrary::addToIndex(int id) {
+    if (indexCapacity(m_store.size()) > m_indexSlots.size()) {
+        rehashIndex(indexCapacity(m_store.size()));
+        return;   // 重建时已经放入
+    }
+    const int mask = m_indexSlots.size() - 1;
+    int slot = indexSlot(m_store.fileName(id), m_indexSlots.size());
+    while (m_indexSlots.at(slot) != InvalidId) {
+        slot = (slot + 1) & mask;
+    }
+    m_indexSlots[slot] = id;
+}
+
+// 线性探测表不能直接清空一个槽：把后面本应排在这个位置之前的 ID 依次前移
+void SongLibrary::removeFromIndex(int id) {
+    if (m_indexSlots.isEmpty()) return;
+    const int mask = m_indexSlots.size() - 1;
+    int slot = indexSlot(m_store.fileName(id), m_indexSlots.size());
+    while (m_indexSlots.at(slot) != id) {
+        if (m_indexSlots.at(slot) == InvalidId) return;
+        slot = (slot + 1) & mask;
+    }
+
+    int next = slot;
+    for (;;) {
+        next = (next + 1) & mask;
+        int other = m_indexSlots.at(next);
+        if (other == InvalidId) break;
+        int home = indexSlot(m_store.fileName(other), m_indexSlots.size());
+        // home 在 (slot, next] 区间内（考虑回绕）时，这个 ID 不需要移动
+        bool stays = slot <= next ? (slot < home && home <= next) : (slot < home || home <= next);
+        if (stays) continue;
+        m_indexSlots[slot] = other;
+        slot = next;
+    }
+    m_indexSlots[slot] = InvalidId;
+}
+
+void SongLibrary::rehashIndex(int capacity) {
+    m_indexSlots.fill(InvalidId, capacity);
+    const int mask = capacity - 1;
+    for (int id = 0; id < m_store.size(); ++id) {
+        int slot = indexSlot(m_store.fileName(id), capacity);
+        while (m_indexSlots.at(slot) != InvalidId) {
+            slot = (slot + 1) & mask;
+        }
+        m_indexSlots[slot] = id;
+    }
+}
+
+void SongLibrary::relocate(int id, const QString& newFilePath) {
+    if (id < 0 || id >= m_store.size()) return;
+
+    removeFromIndex(id);
+    m_store.setFilePath(id, normalizePath(newFilePath));
+    addToIndex(id);
+    setMissing(id, false);
+}
+
+void SongLibrary::updateMetaData(int id, const QString& title, const QString& artist, const QString& album) {
+    if (id < 0 || id >= m_store.size()) return;
+
+    if (!title.isEmpty()) {
+        m_store.setTitle(id, title);
+    }
+    if (!artist.isEmpty()) {
+        m_store.setArtist(id, artist);
+    }
+    if (!album.isEmpty()) {
+        m_store.setAlbum(id, album);
+    }
+}
+
+void SongLibrary::clear() {
+    m_store.clear();
+    m_flags.clear();
+    m_indexSlots.clear();
+    m_trackRanges.clear();
+}
+
+qint64 SongLibrary::memoryUsage() const {
+    // 虚拟音轨的起止位置表按每个节点约 32 字节估算
+    return m_store.memoryUsage()
+         + m_flags.capacity() + qint64(m_indexSlots.capacity()) * qint64(sizeof(int))
+         + m_trackRanges.size() * 32;
+}
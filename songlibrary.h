@@ -0,0 +1,97 @@
+#ifndef SONGLIBRARY_H
+#define SONGLIBRARY_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include "songstore.h"
+
+// 全局歌曲表：同一个文件无论出现在多少个播放列表中，都只登记一次
+// 播放列表只保存歌曲 ID（即本表中的行号），元数据的读取和修改都在这里进行，
+// 因此在任一列表中编辑歌曲信息，所有包含它的列表都会立刻看到
+class SongLibrary {
+public:
+    static constexpr int InvalidId = -1;
+
+    SongLibrary() = default;
+
+    int songCount() const { return m_store.size(); }
+    void reserve(int count);
+
+    // 路径的规范形式：本机分隔符、去掉多余的 "." 和 ".."
+    // 歌曲库只保存规范形式，调用者传入哪种分隔符都可以
+    static QString normalizePath(const QString& filePath);
+
+    // 同一路径只登记一次，已存在时直接返回已有 ID（不覆盖已有的元数据）
+    // CUE 虚拟音轨按 "路径 + 起止位置" 区分，同一个文件可以登记多条
+    int addSong(const Song& song);
+    int findSong(const QString& filePath, qint64 startOffset = 0, qint64 endOffset = 0) const;
+    // 指向该文件的所有虚拟音轨
+    QVector<int> findVirtualTracks(const QString& filePath) const;
+
+    const SongStore& store() const { return m_store; }
+    Song song(int id) const;
+
+    // 估算歌曲表和路径索引占用的堆内存（字节）
+    qint64 memoryUsage() const;
+
+    // ID 无效时返回空字符串；titleView 不拷贝，只在下一次修改歌曲库之前有效
+    QString title(int id) const { return m_store.title(id); }
+    QStringView titleView(int id) const { return m_store.titleView(id); }
+    const QString& artist(int id) const { return m_store.artist(id); }
+    const QString& album(int id) const { return m_store.album(id); }
+    QString filePath(int id) const { return m_store.filePath(id); }
+    qint64 duration(int id) const { return m_store.duration(id); }
+    qint64 fileSize(int id) const { return m_store.fileSize(id); }
+    qint64 modifiedTime(int id) const { return m_store.modifiedTime(id); }
+
+    // 元数据是否已经用 TagLib 扫描过，扫描过的歌曲不会再重复读取标签
+    bool isMetaDataLoaded(int id) const { return testFlag(id, MetaDataLoaded); }
+    void setMetaDataLoaded(int id, bool loaded = true) { setFlag(id, MetaDataLoaded, loaded); }
+
+    // CUE 虚拟音轨：元数据来自 CUE 文件，播放时只播放文件中的一段
+    bool isVirtualTrack(int id) const { return testFlag(id, VirtualTrack); }
+    qint64 trackStart(int id) const;   // 毫秒，普通歌曲为 0
+    qint64 trackEnd(int id) const;     // 毫秒，0 表示播放到文件末尾
+
+    // 后台校验发现文件已不在原位置
+    bool isMissing(int id) const { return testFlag(id, Missing); }
+    void setMissing(int id, bool missing = true) { setFlag(id, Missing, missing); }
+    int missingCount() const;
+
+    // 空字符串表示保持原值不变
+    void updateMetaData(int id, const QString& title, const QString& artist, const QString& album);
+    void setDuration(int id, qint64 duration) { m_store.setDuration(id, duration); }
+    void setFileSize(int id, qint64 size) { m_store.setFileSize(id, size); }
+    void setModifiedTime(int id, qint64 modified) { m_store.setModifiedTime(id, modified); }
+
+    // 文件被移动后更新路径（同时维护路径索引并清除丢失标记）
+    void relocate(int id, const QString& newFilePath);
+
+    void clear();
+
+private:
+    enum Flag : quint8 {
+        MetaDataLoaded = 0x01,
+        Missing        = 0x02,
+        VirtualTrack   = 0x04
+    };
+    bool testFlag(int id, Flag flag) const;
+    void setFlag(int id, Flag flag, bool on);
+    void addToIndex(int id);
+    void removeFromIndex(int id);
+    void rehashIndex(int capacity);
+    // filePath 已经是规范形式
+    int findNormalized(const QString& filePath, qint64 startOffset, qint64 endOffset) const;
+
+    SongStore m_store;
+    QVector<quint8> m_flags;          // 每首歌一个字节的状态位
+    // 以文件名的哈希值定位的开放寻址表，槽中只存歌曲 ID（-1 为空），再比对文件名和目录确认
+    // 同名文件各占一个槽；每首歌只多占几个字节，不必为索引再保存一份文件名
+    QVector<int> m_indexSlots;
+    // 虚拟音轨的起止位置，只有 CUE 音轨才有记录，普通歌曲不占额外内存
+    QHash<int, QPair<qint64, qint64>> m_trackRanges;
+};
+
+#endif // SONGLIBRARY_H
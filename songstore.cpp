@@ -0,0 +1,305 @@
+#include "songstore.h"
+#include "playlist.h"
+
+namespace {
+
+// 越界访问时返回的空字符串
+const QString& emptyString() {
+    static const QString empty;
+    return empty;
+}
+
+// 在最后一个路径分隔符处拆分，目录部分保留分隔符，保证拼接后与原路径完全一致
+int splitPosition(const QString& path) {
+    int slash = path.lastIndexOf(QLatin1Char('/'));
+    int backslash = path.lastIndexOf(QLatin1Char('\\'));
+    return qMax(slash, backslash) + 1;
+}
+
+// 一个 QString 的堆占用：数据头 + UTF-16 缓冲区
+qint64 stringBytes(const QString& str) {
+    if (str.isNull()) return 0;
+    return 16 + (str.capacity() + 1) * qint64(sizeof(QChar));
+}
+
+// 文本区中每段文字的长度用 16 位保存：文件名不会超过这个长度，过长的标题截断
+const qsizetype MaxTextLength = 0xFFFF;
+// 文本区中的废弃字符超过这个数量、并且超过一半时整理一次
+const qsizetype CompactThreshold = 1024 * 1024;
+
+template <typename T>
+qint64 vectorBytes(const QVector<T>& vec) {
+    return 16 + vec.capacity() * qint64(sizeof(T));
+}
+
+template <typename T>
+void reorderColumn(QVector<T>& column, const QVector<int>& order) {
+    QVector<T> reordered;
+    reordered.reserve(order.size());
+    for (int oldIndex : order) {
+        reordered.append(std::move(column[oldIndex]));
+    }
+    column = std::move(reordered);
+}
+
+} // namespace
+
+quint32 StringPool::intern(const QString& str) {
+    auto it = m_index.constFind(str);
+    if (it != m_index.constEnd()) {
+        return it.value();
+    }
+    quint32 id = static_cast<quint32>(m_strings.size());
+    m_strings.append(str);
+    m_index.insert(m_strings.constLast(), id);
+    return id;
+}
+
+void StringPool::clear() {
+    m_strings.clear();
+    m_index.clear();
+}
+
+SongStore::SongStore()
+    : m_garbage(0)
+{
+    m_unknownArtistId = m_pool.intern("未知艺术家");
+    m_unknownAlbumId = m_pool.intern("未知专辑");
+}
+
+void SongStore::reserve(int count) {
+    m_nameOffsets.reserve(count);
+    m_nameLengths.reserve(count);
+    m_titleOffsets.reserve(count);
+    m_titleLengths.reserve(count);
+    m_artistIds.reserve(count);
+    m_albumIds.reserve(count);
+    m_dirIds.reserve(count);
+    m_durations.reserve(count);
+    m_fileSizes.reserve(count);
+    m_modifiedTimes.reserve(count);
+}
+
+int SongStore::append(const Song& song) {
+    int pos = splitPosition(song.filePath);
+    QStringView name = QStringView(song.filePath).mid(pos).left(MaxTextLength);
+
+    m_nameOffsets.append(appendText(name));
+    m_nameLengths.append(quint16(name.size()));
+    m_titleOffsets.append(0);
+    m_titleLengths.append(0);
+    m_dirIds.append(m_pool.intern(song.filePath.left(pos)));
+    m_artistIds.append(song.artist.isEmpty() ? m_unknownArtistId : m_pool.intern(song.artist));
+    m_albumIds.append(song.album.isEmpty() ? m_unknownAlbumId : m_pool.intern(song.album));
+    m_durations.append(song.duration);
+    m_fileSizes.append(0);
+    m_modifiedTimes.append(0);
+
+    int index = size() - 1;
+    storeTitle(index, song.title);
+    return index;
+}
+
+void SongStore::removeAt(int index) {
+    if (!isValid(index)) return;
+    m_garbage += m_nameLengths.at(index) + (ownsTitle(index) ? m_titleLengths.at(index) : 0);
+    m_nameOffsets.removeAt(index);
+    m_nameLengths.removeAt(index);
+    m_titleOffsets.removeAt(index);
+    m_titleLengths.removeAt(index);
+    m_artistIds.removeAt(index);
+    m_albumIds.removeAt(index);
+    m_dirIds.removeAt(index);
+    m_durations.removeAt(index);
+    m_fileSizes.removeAt(index);
+    m_modifiedTimes.removeAt(index);
+    compactText();
+}
+
+void SongStore::clear() {
+    m_text.clear();
+    m_garbage = 0;
+    m_nameOffsets.clear();
+    m_nameLengths.clear();
+    m_titleOffsets.clear();
+    m_titleLengths.clear();
+    m_artistIds.clear();
+    m_albumIds.clear();
+    m_dirIds.clear();
+    m_durations.clear();
+    m_fileSizes.clear();
+    m_modifiedTimes.clear();
+
+    // 池中的字符串可能已无人引用，清空后重新放入两个默认值
+    m_pool.clear();
+    m_unknownArtistId = m_pool.intern("未知艺术家");
+    m_unknownAlbumId = m_pool.intern("未知专辑");
+}
+
+Song SongStore::song(int index) const {
+    if (!isValid(index)) return Song();
+
+    Song result;
+    result.filePath = filePath(index);
+    result.title = title(index);
+    result.artist = artist(index);
+    result.album = album(index);
+    result.duration = m_durations.at(index);
+    return result;
+}
+
+QStringView SongStore::titleView(int index) const {
+    if (!isValid(index)) return QStringView();
+    return QStringView(m_text).mid(m_titleOffsets.at(index), m_titleLengths.at(index));
+}
+
+const QString& SongStore::artist(int index) const {
+    return isValid(index) ? m_pool.at(m_artistIds.at(index)) : emptyString();
+}
+
+const QString& SongStore::album(int index) const {
+    return isValid(index) ? m_pool.at(m_albumIds.at(index)) : emptyString();
+}
+
+const QString& SongStore::directory(int index) const {
+    return isValid(index) ? m_pool.at(m_dirIds.at(index)) : emptyString();
+}
+
+QStringView SongStore::fileName(int index) const {
+    if (!isValid(index)) return QStringView();
+    return QStringView(m_text).mid(m_nameOffsets.at(index), m_nameLengths.at(index));
+}
+
+QString SongStore::filePath(int index) const {
+    if (!isValid(index)) return QString();
+    return m_pool.at(m_dirIds.at(index)) + fileName(index);
+}
+
+qint64 SongStore::duration(int index) const {
+    return isValid(index) ? m_durations.at(index) : 0;
+}
+
+qint64 SongStore::fileSize(int index) const {
+    return isValid(index) ? m_fileSizes.at(index) : 0;
+}
+
+qint64 SongStore::modifiedTime(int index) const {
+    return isValid(index) ? m_modifiedTimes.at(index) : 0;
+}
+
+bool SongStore::isUnknownArtist(int index) const {
+    return isValid(index) && m_artistIds.at(index) == m_unknownArtistId;
+}
+
+void SongStore::setTitle(int index, const QString& title) {
+    if (!isValid(index)) return;
+    if (ownsTitle(index)) m_garbage += m_titleLengths.at(index);
+    storeTitle(index, title);
+    compactText();
+}
+
+void SongStore::setArtist(int index, const QString& artist) {
+    if (isValid(index)) m_artistIds[index] = m_pool.intern(artist);
+}
+
+void SongStore::setAlbum(int index, const QString& album) {
+    if (isValid(index)) m_albumIds[index] = m_pool.intern(album);
+}
+
+void SongStore::setDuration(int index, qint64 duration) {
+    if (isValid(index)) m_durations[index] = duration;
+}
+
+void SongStore::setFileSize(int index, qint64 size) {
+    if (isValid(index)) m_fileSizes[index] = size;
+}
+
+void SongStore::setModifiedTime(int index, qint64 modified) {
+    if (isValid(index)) m_modifiedTimes[index] = modified;
+}
+
+void SongStore::setFilePath(int index, const QString& filePath) {
+    if (!isValid(index)) return;
+    int pos = splitPosition(filePath);
+    QStringView name = QStringView(filePath).mid(pos).left(MaxTextLength);
+
+    // 标题可能指向旧文件名中的一段，先取出来，换好文件名后重新放置
+    const QString currentTitle = title(index);
+    m_garbage += m_nameLengths.at(index) + (ownsTitle(index) ? m_titleLengths.at(index) : 0);
+    m_nameOffsets[index] = appendText(name);
+    m_nameLengths[index] = quint16(name.size());
+    m_dirIds[index] = m_pool.intern(filePath.left(pos));
+    storeTitle(index, currentTitle);
+    compactText();
+}
+
+void SongStore::reorder(const QVector<int>& order) {
+    if (order.size() != size()) return;
+    // 文本区不动，只重排偏移和长度
+    reorderColumn(m_nameOffsets, order);
+    reorderColumn(m_nameLengths, order);
+    reorderColumn(m_titleOffsets, order);
+    reorderColumn(m_titleLengths, order);
+    reorderColumn(m_artistIds, order);
+    reorderColumn(m_albumIds, order);
+    reorderColumn(m_dirIds, order);
+    reorderColumn(m_durations, order);
+    reorderColumn(m_fileSizes, order);
+    reorderColumn(m_modifiedTimes, order);
+}
+
+quint32 SongStore::appendText(QStringView text) {
+    quint32 offset = quint32(m_text.size());
+    m_text.append(text);
+    return offset;
+}
+
+void SongStore::storeTitle(int index, QStringView title) {
+    title = title.left(MaxTextLength);
+    qsizetype at = title.isEmpty() ? 0 : fileName(index).indexOf(title);
+    m_titleOffsets[index] = at >= 0 ? m_nameOffsets.at(index) + quint32(at) : appendText(title);
+    m_titleLengths[index] = quint16(title.size());
+}
+
+bool SongStore::ownsTitle(int index) const {
+    quint32 offset = m_titleOffsets.at(index);
+    quint32 nameOffset = m_nameOffsets.at(index);
+    return offset < nameOffset || offset + m_titleLengths.at(index) > nameOffset + m_nameLengths.at(index);
+}
+
+void SongStore::compactText() {
+    if (m_garbage < CompactThreshold || m_garbage * 2 < m_text.size()) return;
+
+    QString text;
+    text.reserve(m_text.size() - m_garbage);
+    for (int i = 0; i < size(); ++i) {
+        const quint32 nameOffset = quint32(text.size());
+        text.append(fileName(i));
+        if (ownsTitle(i)) {
+            const quint32 titleOffset = quint32(text.size());
+            text.append(titleView(i));
+            m_titleOffsets[i] = titleOffset;
+        } else {
+            m_titleOffsets[i] = nameOffset + (m_titleOffsets.at(i) - m_nameOffsets.at(i));
+        }
+        m_nameOffsets[i] = nameOffset;
+    }
+    m_text = std::move(text);
+    m_garbage = 0;
+}
+
+qint64 SongStore::memoryUsage() const {
+    // 文本区按已用长度计算：它是一整块大内存，增长时预留的部分在写入之前不占物理内存
+    qint64 bytes = 16 + qint64(m_text.size()) * qint64(sizeof(QChar))
+                 + vectorBytes(m_nameOffsets) + vectorBytes(m_nameLengths)
+                 + vectorBytes(m_titleOffsets) + vectorBytes(m_titleLengths)
+                 + vectorBytes(m_artistIds) + vectorBytes(m_albumIds)
+                 + vectorBytes(m_dirIds) + vectorBytes(m_durations)
+                 + vectorBytes(m_fileSizes) + vectorBytes(m_modifiedTimes);
+
+    // 池里的每个字符串只算一次，再加上索引哈希表的节点
+    for (int i = 0; i < m_pool.size(); ++i) {
+        bytes += stringBytes(m_pool.at(i)) + qint64(sizeof(QString) + sizeof(quint32) + 8);
+    }
+    return bytes;
+}
@@ -0,0 +1,99 @@
+#ifndef SONGSTORE_H
+#define SONGSTORE_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+struct Song;
+
+// 字符串驻留池：相同的艺术家 / 专辑 / 目录字符串只保存一份
+// 上万首歌共用同一个 "未知艺术家" 时，只占一个 QString 的内存
+class StringPool {
+public:
+    quint32 intern(const QString& str);
+    const QString& at(quint32 id) const { return m_strings.at(id); }
+    int size() const { return m_strings.size(); }
+    void clear();
+
+private:
+    QVector<QString> m_strings;
+    QHash<QString, quint32> m_index;  // 键与 m_strings 共享同一份隐式共享数据
+};
+
+// 紧凑的歌曲存储（列式 / struct-of-arrays 布局）
+// 每一列是一个连续数组，艺术家、专辑、目录只存池中的编号，
+// 文件路径拆成 "目录编号 + 文件名" 两部分保存。
+// 标题和文件名不再各占一个 QString，而是写在同一块 UTF-16 文本区中，每首歌只记偏移和长度；
+// 标题是文件名的一部分时（未读标签的歌曲、"01 标题.mp3" 这样命名的文件）直接指向文件名中的那一段
+class SongStore {
+public:
+    SongStore();
+
+    int size() const { return m_nameOffsets.size(); }
+    bool isEmpty() const { return m_nameOffsets.isEmpty(); }
+    void reserve(int count);
+
+    int append(const Song& song);
+    void removeAt(int index);
+    void clear();
+
+    // 组装出一个完整的 Song（需要拷贝，仅在确实需要完整记录时使用）
+    Song song(int index) const;
+
+    // 越界时返回空字符串
+    // 返回 QStringView 的访问器不拷贝数据，但只在下一次修改歌曲表之前有效
+    QString title(int index) const { return titleView(index).toString(); }
+    QStringView titleView(int index) const;
+    const QString& artist(int index) const;
+    const QString& album(int index) const;
+    const QString& directory(int index) const;
+    QStringView fileName(int index) const;
+    QString filePath(int index) const;   // 目录 + 文件名，需要拼接
+    qint64 duration(int index) const;
+    qint64 fileSize(int index) const;    // 0 表示未知
+    qint64 modifiedTime(int index) const; // 文件最后修改时间（毫秒时间戳），0 表示未知
+
+    bool isUnknownArtist(int index) const;
+
+    void setTitle(int index, const QString& title);
+    void setArtist(int index, const QString& artist);
+    void setAlbum(int index, const QString& album);
+    void setDuration(int index, qint64 duration);
+    void setFileSize(int index, qint64 size);
+    void setModifiedTime(int index, qint64 modified);
+    void setFilePath(int index, const QString& filePath);
+
+    // 按给定顺序重排所有列，order[i] 为新位置 i 上的旧索引
+    void reorder(const QVector<int>& order);
+
+    // 估算占用的堆内存（字节），用于内存基准测试
+    qint64 memoryUsage() const;
+
+private:
+    bool isValid(int index) const { return index >= 0 && index < m_nameOffsets.size(); }
+
+    quint32 appendText(QStringView text);
+    void storeTitle(int index, QStringView title);   // 优先指向文件名中相同的一段
+    bool ownsTitle(int index) const;                 // 标题是否单独占用文本区
+    void compactText();                              // 丢弃已经没有歌曲引用的文本
+
+    StringPool m_pool;              // 艺术家 / 专辑 / 目录共用
+    quint32 m_unknownArtistId;
+    quint32 m_unknownAlbumId;
+
+    QString m_text;                 // 标题和文件名的文本区
+    qsizetype m_garbage;            // 文本区中被修改或删除的歌曲留下的字符数
+    QVector<quint32> m_nameOffsets;
+    QVector<quint16> m_nameLengths;
+    QVector<quint32> m_titleOffsets;
+    QVector<quint16> m_titleLengths;
+    QVector<quint32> m_artistIds;
+    QVector<quint32> m_albumIds;
+    QVector<quint32> m_dirIds;
+    QVector<qint64> m_durations;
+    QVector<qint64> m_fileSizes;
+    QVector<qint64> m_modifiedTimes;
+};
+
+#endif // SONGSTORE_H
@@ -0,0 +1,108 @@
+#include "startupprofiler.h"
+#include <QElapsedTimer>
+#include <QWidget>
+#include <QEvent>
+#include <QTimer>
+#include <QFile>
+#include <QDateTime>
+#include <QCoreApplication>
+#include <QDebug>
+
+namespace {
+
+QElapsedTimer g_timer;
+QVector<StartupProfiler::Phase> g_phases;
+
+const qint64 MaxLogSize = 64 * 1024;
+
+// 第一次收到 Paint 事件后，等这一轮绘制结束再回调
+class FirstPaintFilter : public QObject
+{
+public:
+    FirstPaintFilter(QWidget* window, std::function<void()> callback)
+        : QObject(window), m_callback(std::move(callback)) {}
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override
+    {
+        if (!m_triggered && event->type() == QEvent::Paint) {
+            m_triggered = true;
+            watched->removeEventFilter(this);
+            QTimer::singleShot(0, this, [this]() {
+                StartupProfiler::mark("first paint");
+                if (m_callback) m_callback();
+                deleteLater();
+            });
+        }
+        return false;
+    }
+
+private:
+    std::function<void()> m_callback;
+    bool m_triggered = false;
+};
+
+} // namespace
+
+void StartupProfiler::start()
+{
+    g_phases.clear();
+    g_timer.start();
+}
+
+void StartupProfiler::mark(const QString& phase)
+{
+    if (!g_timer.isValid()) return;
+
+    Phase entry;
+    entry.name = phase;
+    entry.endUs = g_timer.nsecsElapsed() / 1000;
+    entry.durationUs = entry.endUs - (g_phases.isEmpty() ? 0 : g_phases.last().endUs);
+    g_phases.append(entry);
+}
+
+QVector<StartupProfiler::Phase> StartupProfiler::phases()
+{
+    return g_phases;
+}
+
+qint64 StartupProfiler::elapsedMs()
+{
+    return g_timer.isValid() ? g_timer.elapsed() : 0;
+}
+
+void StartupProfiler::watchFirstPaint(QWidget* window, std::function<void()> callback)
+{
+    window->installEventFilter(new FirstPaintFilter(window, std::move(callback)));
+}
+
+void StartupProfiler::report()
+{
+    if (g_phases.isEmpty()) return;
+
+    QStringList parts;
+    for (const Phase& phase : g_phases) {
+        parts.append(QString("%1 %2ms").arg(phase.name).arg(phase.durationUs / 1000.0, 0, 'f', 1));
+    }
+    QString line = QString("%1 启动耗时 %2ms：%3")
+                   .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"))
+                   .arg(g_phases.last().endUs / 1000.0, 0, 'f', 1)
+                   .arg(parts.join("，"));
+    qDebug().noquote() << line;
+
+    // 日志超过上限时只保留后一半
+    QFile log(QCoreApplication::applicationDirPath() + "/config/startup.log");
+    if (log.exists() && log.size() > MaxLogSize && log.open(QIODevice::ReadOnly)) {
+        log.seek(log.size() / 2);
+        log.readLine();   // 跳过被截断的一行
+        QByteArray rest = log.readAll();
+        log.close();
+        if (log.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            log.write(rest);
+            log.close();
+        }
+    }
+    if (log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        log.write(line.toUtf8() + '\n');
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QString>
+#include <QVector>
+#include <functional>
+
+class QWidget;
+
+// 启动耗时统计
+// main() 和主窗口构造过程中依次打点（IPC 检查、设置、播放列表加载、界面构建、首次绘制……），
+// 每个阶段记录从上一个打点到现在的耗时；启动完成后输出到日志和 config/startup.log。
+// 只在界面线程中使用
+class StartupProfiler
+{
+public:
+    struct Phase {
+        QString name;
+        qint64 endUs = 0;        // 从进程启动（start() 调用）到该阶段结束
+        qint64 durationUs = 0;   // 该阶段本身的耗时
+    };
+
+    static void start();                      // main() 的第一行调用
+    static void mark(const QString& phase);   // 结束一个阶段
+    static QVector<Phase> phases();
+    static qint64 elapsedMs();
+
+    // 窗口第一次绘制完成后记录 "first paint" 阶段，再执行 callback
+    static void watchFirstPaint(QWidget* window, std::function<void()> callback);
+
+    // 把各阶段耗时写到日志和 config/startup.log（只保留最近的记录）
+    static void report();
+};
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,260 @@
+#include "tagguessdialog.h"
+#include "applog.h"
+#include "tagpattern.h"
+#include "tagwriter.h"
+#include "playlistmanager.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QSettings>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QDebug>
+
+TagGuessDialog::TagGuessDialog(PlaylistManager* manager, const QVector<int>& songIds, QWidget* parent)
+    : QDialog(parent)
+    , m_playlistManager(manager)
+    , m_songIds(songIds)
+    , m_hasUpdatedSongs(false)
+{
+    setWindowTitle(QString("从文件名猜测标签（%1 首）").arg(songIds.size()));
+    setMinimumSize(640, 480);
+
+    m_writer = new TagWriter(this);
+    connect(m_writer, &TagWriter::progressChanged, this, &TagGuessDialog::onProgressChanged);
+    connect(m_writer, &TagWriter::finished, this, &TagGuessDialog::onWriteFinished);
+
+    setupUI();
+}
+
+TagGuessDialog::~TagGuessDialog()
+{
+    // m_writer 的析构函数会等待后台线程退出
+    m_writer->cancel();
+}
+
+void TagGuessDialog::setupUI()
+{
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setSpacing(12);
+
+    // 模式
+    QHBoxLayout* patternLayout = new QHBoxLayout();
+    patternLayout->addWidget(new QLabel("模式:"));
+    m_patternCombo = new QComboBox();
+    m_patternCombo->setEditable(true);
+    m_patternCombo->addItems(TagPattern::presets());
+    QSettings settings;
+    QString lastPattern = settings.value("TagGuess/pattern").toString();
+    if (!lastPattern.isEmpty()) {
+        m_patternCombo->setCurrentText(lastPattern);
+    }
+    patternLayout->addWidget(m_patternCombo, 1);
+
+    m_previewBtn = new QPushButton("预览");
+    m_previewBtn->setDefault(true);
+    connect(m_previewBtn, &QPushButton::clicked, this, &TagGuessDialog::onPreviewClicked);
+    patternLayout->addWidget(m_previewBtn);
+    mainLayout->addLayout(patternLayout);
+
+    QLabel* hintLabel = new QLabel("可用占位符：%artist% %album% %albumartist% %title% %track% %disc% %year% %genre% %ignore%，"
+                                   "\"/\" 表示上一级文件夹，模式与路径末尾对齐，扩展名不参与匹配");
+    hintLabel->setWordWrap(true);
+    hintLabel->setStyleSheet("color: #888; font-size: 11px;");
+    mainLayout->addWidget(hintLabel);
+
+    // 预览
+    m_previewTree = new QTreeWidget();
+    m_previewTree->setRootIsDecorated(false);
+    m_previewTree->setHeaderLabels({"文件"});
+    mainLayout->addWidget(m_previewTree);
+
+    m_writeFilesCheck = new QCheckBox("同时写入文件标签（在后台进行）");
+    m_writeFilesCheck->setChecked(true);
+    mainLayout->addWidget(m_writeFilesCheck);
+
+    // 进度
+    m_statusLabel = new QLabel("选择或输入模式后点击 \"预览\"");
+    mainLayout->addWidget(m_statusLabel);
+    m_progressBar = new QProgressBar();
+    m_progressBar->setRange(0, 100);
+    m_progressBar->setValue(0);
+    m_progressBar->hide();
+    mainLayout->addWidget(m_progressBar);
+
+    // 按钮
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addStretch();
+    m_applyBtn = new QPushButton("应用勾选的歌曲");
+    m_applyBtn->setEnabled(false);
+    connect(m_applyBtn, &QPushButton::clicked, this, &TagGuessDialog::onApplyClicked);
+    buttonLayout->addWidget(m_applyBtn);
+
+    m_closeBtn = new QPushButton("关闭");
+    connect(m_closeBtn, &QPushButton::clicked, this, &TagGuessDialog::onCloseClicked);
+    buttonLayout->addWidget(m_closeBtn);
+    mainLayout->addLayout(buttonLayout);
+}
+
+QString TagGuessDialog::fieldLabel(const QString& key)
+{
+    if (key == "ARTIST") return "艺术家";
+    if (key == "ALBUM") return "专辑";
+    if (key == "ALBUMARTIST") return "专辑艺术家";
+    if (key == "TITLE") return "标题";
+    if (key == "TRACKNUMBER") return "音轨";
+    if (key == "DISCNUMBER") return "碟号";
+    if (key == "DATE") return "年份";
+    if (key == "GENRE") return "流派";
+    return key;
+}
+
+void TagGuessDialog::onPreviewClicked()
+{
+    // 模式只编译一次，之后并行匹配所有路径
+    TagPattern pattern(m_patternCombo->currentText());
+    if (!pattern.isValid()) {
+        QMessageBox::warning(this, "模式无效", pattern.errorString());
+        return;
+    }
+
+    const SongLibrary* library = m_playlistManager->library();
+    QStringList filePaths;
+    filePaths.reserve(m_songIds.size());
+    for (int id : m_songIds) {
+        filePaths.append(library->filePath(id));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    m_results = pattern.matchAll(filePaths);
+    qCDebug(lcTags) << "模式匹配" << filePaths.size() << "个路径耗时" << timer.elapsed() << "ms";
+
+    // 列：文件 + 模式中的各个字段
+    const QStringList fields = pattern.fields();
+    QStringList headers = {"文件"};
+    for (const QString& key : fields) {
+        headers.append(fieldLabel(key));
+    }
+    m_previewTree->clear();
+    m_previewTree->setColumnCount(headers.size());
+    m_previewTree->setHeaderLabels(headers);
+
+    int matched = 0;
+    QList<QTreeWidgetItem*> items;
+    items.reserve(m_results.size());
+    for (int i = 0; i < m_results.size(); ++i) {
+        const QMap<QString, QString>& result = m_results[i];
+        QTreeWidgetItem* item = new QTreeWidgetItem();
+        item->setText(0, QFileInfo(filePaths[i]).fileName());
+        item->setToolTip(0, filePaths[i]);
+        item->setData(0, Qt::UserRole, i);
+
+        if (result.isEmpty()) {
+            // 不匹配的文件不能勾选
+            item->setText(1, "（不匹配）");
+            item->setForeground(0, QColor("#7B8394"));
+            item->setForeground(1, QColor("#7B8394"));
+            item->setFlags(item->flags() & ~Qt::ItemIsUserCheckable);
+        } else {
+            for (int c = 0; c < fields.size(); ++c) {
+                item->setText(c + 1, result.value(fields[c]));
+            }
+            item->setCheckState(0, Qt::Checked);
+            ++matched;
+        }
+        items.append(item);
+    }
+    m_previewTree->addTopLevelItems(items);
+    m_previewTree->header()->resizeSections(QHeaderView::ResizeToContents);
+
+    m_statusLabel->setText(QString("%1 首中有 %2 首匹配").arg(m_results.size()).arg(matched));
+    m_applyBtn->setEnabled(matched > 0);
+
+    QSettings settings;
+    settings.setValue("TagGuess/pattern", pattern.pattern());
+}
+
+void TagGuessDialog::onApplyClicked()
+{
+    SongLibrary* library = m_playlistManager->library();
+    QVector<TagWriter::Change> changes;
+
+    for (int row = 0; row < m_previewTree->topLevelItemCount(); ++row) {
+        QTreeWidgetItem* item = m_previewTree->topLevelItem(row);
+        if (item->checkState(0) != Qt::Checked) continue;
+
+        int i = item->data(0, Qt::UserRole).toInt();
+        if (i < 0 || i >= m_results.size() || m_results[i].isEmpty()) continue;
+        const QMap<QString, QString>& result = m_results[i];
+        int id = m_songIds[i];
+
+        // 歌曲库只保存标题、艺术家、专辑；空值表示保持不变
+        library->updateMetaData(id, result.value("TITLE"), result.value("ARTIST"), result.value("ALBUM"));
+        m_hasUpdatedSongs = true;
+
+        // CUE 音轨的信息只保存在歌曲库中，文件标签属于整张专辑
+        if (!library->isMissing(id) && !library->isVirtualTrack(id)) {
+            changes.append({id, library->filePath(id), result});
+        }
+    }
+
+    if (!m_writeFilesCheck->isChecked() || changes.isEmpty()) {
+        accept();
+        return;
+    }
+
+    m_patternCombo->setEnabled(false);
+    m_previewBtn->setEnabled(false);
+    m_previewTree->setEnabled(false);
+    m_writeFilesCheck->setEnabled(false);
+    m_applyBtn->setEnabled(false);
+    m_progressBar->setRange(0, changes.size());
+    m_progressBar->setValue(0);
+    m_progressBar->show();
+    m_statusLabel->setText("正在写入文件标签...");
+    m_writer->start(changes);
+}
+
+void TagGuessDialog::onCloseClicked()
+{
+    if (m_writer->isBusy()) {
+        // 歌曲库已经更新，剩下的文件不再写入
+        m_writer->cancel();
+        m_closeBtn->setEnabled(false);
+        return;
+    }
+    if (m_hasUpdatedSongs) {
+        accept();
+    } else {
+        reject();
+    }
+}
+
+void TagGuessDialog::onProgressChanged(int done, int total)
+{
+    m_progressBar->setValue(done);
+    m_statusLabel->setText(QString("正在写入文件标签... %1/%2").arg(done).arg(total));
+}
+
+void TagGuessDialog::onWriteFinished(const QVector<int>& succeededIds, const QStringList& failedPaths)
+{
+    m_progressBar->setValue(m_progressBar->maximum());
+    if (!failedPaths.isEmpty()) {
+        QString message = QString("成功 %1 首，失败 %2 首：\n\n%3")
+                          .arg(succeededIds.size()).arg(failedPaths.size())
+                          .arg(failedPaths.mid(0, 10).join("\n"));
+        if (failedPaths.size() > 10) {
+            message += "\n...";
+        }
+        QMessageBox::warning(this, "部分文件写入失败", message);
+    }
+    accept();
+}
@@ -0,0 +1,59 @@
+#ifndef TAGGUESSDIALOG_H
+#define TAGGUESSDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+#include <QMap>
+#include <QStringList>
+
+class PlaylistManager;
+class TagWriter;
+class QComboBox;
+class QCheckBox;
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QTreeWidget;
+
+// 从文件路径猜测标签：按用户输入的模式批量解析路径，预览确认后
+// 更新歌曲库，并可选择在后台把结果写入文件标签
+class TagGuessDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    TagGuessDialog(PlaylistManager* manager, const QVector<int>& songIds, QWidget* parent = nullptr);
+    ~TagGuessDialog();
+
+    // 是否修改了歌曲库中的元数据（调用者据此保存并刷新界面）
+    bool hasUpdatedSongs() const { return m_hasUpdatedSongs; }
+
+private slots:
+    void onPreviewClicked();
+    void onApplyClicked();
+    void onCloseClicked();
+    void onProgressChanged(int done, int total);
+    void onWriteFinished(const QVector<int>& succeededIds, const QStringList& failedPaths);
+
+private:
+    void setupUI();
+    static QString fieldLabel(const QString& key);
+
+    PlaylistManager* m_playlistManager;
+    QVector<int> m_songIds;
+    QVector<QMap<QString, QString>> m_results;   // 与 m_songIds 一一对应，空表示不匹配
+    TagWriter* m_writer;
+    bool m_hasUpdatedSongs;
+
+    // UI 组件
+    QComboBox* m_patternCombo;
+    QPushButton* m_previewBtn;
+    QTreeWidget* m_previewTree;
+    QCheckBox* m_writeFilesCheck;
+    QLabel* m_statusLabel;
+    QProgressBar* m_progressBar;
+    QPushButton* m_applyBtn;
+    QPushButton* m_closeBtn;
+};
+
+#endif // TAGGUESSDIALOG_H
@@ -0,0 +1,164 @@
+#include "tagpattern.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QThread>
+#include <QThreadPool>
+#include <atomic>
+
+namespace {
+
+// 占位符 -> TagLib 属性名
+struct Placeholder {
+    const char* name;
+    const char* key;
+    bool numeric;
+};
+
+const Placeholder Placeholders[] = {
+    {"artist",      "ARTIST",      false},
+    {"album",       "ALBUM",       false},
+    {"albumartist", "ALBUMARTIST", false},
+    {"title",       "TITLE",       false},
+    {"track",       "TRACKNUMBER", true},
+    {"disc",        "DISCNUMBER",  true},
+    {"year",        "DATE",        true},
+    {"genre",       "GENRE",       false},
+};
+
+const int ChunkSize = 256;   // 每个线程一次领取的路径数
+
+} // namespace
+
+TagPattern::TagPattern(const QString& pattern)
+    : m_pattern(pattern)
+{
+    // 逐段翻译：普通文本转义，占位符替换为捕获组
+    QString regex = "(?:^|/)";
+    QString normalized = QDir::fromNativeSeparators(pattern.trimmed());
+    int pos = 0;
+    while (pos < normalized.size()) {
+        int start = normalized.indexOf('%', pos);
+        int end = start >= 0 ? normalized.indexOf('%', start + 1) : -1;
+        if (start < 0 || end < 0) {
+            regex += QRegularExpression::escape(normalized.mid(pos));
+            break;
+        }
+
+        regex += QRegularExpression::escape(normalized.mid(pos, start - pos));
+        QString name = normalized.mid(start + 1, end - start - 1).toLower();
+        pos = end + 1;
+
+        if (name == "ignore") {
+            regex += "[^/]*?";
+            continue;
+        }
+
+        const Placeholder* placeholder = nullptr;
+        for (const Placeholder& p : Placeholders) {
+            if (name == QLatin1String(p.name)) {
+                placeholder = &p;
+                break;
+            }
+        }
+        if (!placeholder) {
+            m_errorString = QString("未知的占位符：%%1%").arg(name);
+            return;
+        }
+
+        // 同一字段出现多次时只取第一次的值，其余当作 %ignore%
+        QString key = QLatin1String(placeholder->key);
+        if (m_fields.contains(key)) {
+            regex += "[^/]*?";
+            continue;
+        }
+        QString group = QString("f%1").arg(m_fields.size());
+        m_fields.append(key);
+        m_groupNames.append(group);
+        regex += QString("(?<%1>%2)").arg(group, placeholder->numeric ? "\\d+" : "[^/]+?");
+    }
+    regex += "$";
+
+    if (m_fields.isEmpty()) {
+        m_errorString = "模式中至少需要一个占位符";
+        return;
+    }
+
+    m_regex.setPattern(regex);
+    if (!m_regex.isValid()) {
+        m_errorString = m_regex.errorString();
+        return;
+    }
+    // 提前编译，之后多个线程同时匹配时不再需要编译
+    m_regex.optimize();
+}
+
+QMap<QString, QString> TagPattern::match(const QString& filePath) const
+{
+    QMap<QString, QString> result;
+    if (!isValid()) return result;
+
+    // 去掉扩展名再匹配
+    QString path = QDir::fromNativeSeparators(filePath);
+    int dot = path.lastIndexOf('.');
+    if (dot > path.lastIndexOf('/')) {
+        path.truncate(dot);
+    }
+
+    QRegularExpressionMatch match = m_regex.match(path);
+    if (!match.hasMatch()) return result;
+
+    for (int i = 0; i < m_fields.size(); ++i) {
+        QString value = match.captured(m_groupNames[i]).trimmed();
+        if (value.isEmpty()) continue;
+        if (m_fields[i] == "TRACKNUMBER" || m_fields[i] == "DISCNUMBER") {
+            value = QString::number(value.toInt());   // "01" -> "1"
+        }
+        result.insert(m_fields[i], value);
+    }
+    return result;
+}
+
+QVector<QMap<QString, QString>> TagPattern::matchAll(const QStringList& filePaths) const
+{
+    const int count = filePaths.size();
+    QVector<QMap<QString, QString>> results(count);
+    if (count <= ChunkSize) {
+        for (int i = 0; i < count; ++i) {
+            results[i] = match(filePaths[i]);
+        }
+        return results;
+    }
+
+    // 每个线程循环领取一段路径，结果直接写入各自的位置，不需要加锁
+    QMap<QString, QString>* out = results.data();
+    std::atomic_int next(0);
+    QThreadPool pool;
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+    for (int t = 0; t < pool.maxThreadCount(); ++t) {
+        pool.start([&]() {
+            while (true) {
+                int begin = next.fetch_add(ChunkSize);
+                if (begin >= count) break;
+                int end = qMin(begin + ChunkSize, count);
+                for (int i = begin; i < end; ++i) {
+                    out[i] = match(filePaths[i]);
+                }
+            }
+        });
+    }
+    pool.waitForDone();
+    return results;
+}
+
+QStringList TagPattern::presets()
+{
+    return {
+        "%artist% - %title%",
+        "%track% - %title%",
+        "%track%. %artist% - %title%",
+        "%artist%/%album%/%track% - %title%",
+        "%artist%/%album%/%title%",
+        "%artist% - %album%/%track% - %title%",
+        "%album%/%track% - %artist% - %title%",
+    };
+}
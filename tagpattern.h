@@ -0,0 +1,45 @@
+#ifndef TAGPATTERN_H
+#define TAGPATTERN_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include <QRegularExpression>
+
+// 从文件路径猜测标签
+// 模式由占位符和普通文本组成，例如 "%artist%/%album%/%track% - %title%"，
+// "/" 表示目录分隔符，模式与路径的末尾（去掉扩展名）对齐匹配。
+// 支持的占位符：%artist% %album% %albumartist% %title% %track% %disc% %year% %genre%，
+// 以及匹配任意文本但不提取的 %ignore%。
+// 模式在构造时编译为一个正则表达式，之后可以在多个线程中同时匹配
+class TagPattern
+{
+public:
+    explicit TagPattern(const QString& pattern);
+
+    bool isValid() const { return m_errorString.isEmpty(); }
+    QString errorString() const { return m_errorString; }
+    QString pattern() const { return m_pattern; }
+
+    // 模式中出现的字段（TagLib 属性名，按出现顺序，不含 %ignore%）
+    QStringList fields() const { return m_fields; }
+
+    // 匹配单个路径，返回 TagLib 属性名 -> 值；不匹配时返回空表
+    QMap<QString, QString> match(const QString& filePath) const;
+
+    // 在线程池中并行匹配一批路径，结果与 filePaths 一一对应
+    QVector<QMap<QString, QString>> matchAll(const QStringList& filePaths) const;
+
+    // 常用模式，供界面预置
+    static QStringList presets();
+
+private:
+    QString m_pattern;
+    QString m_errorString;
+    QStringList m_fields;
+    QStringList m_groupNames;   // 与 m_fields 对应的捕获组名
+    QRegularExpression m_regex;
+};
+
+#endif // TAGPATTERN_H
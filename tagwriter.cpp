@@ -0,0 +1,158 @@
+#include "tagwriter.h"
+#include "applog.h"
+#include "tracerecorder.h"
+#include <QThread>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <cstdio>
+#endif
+
+// TagLib 头文件
+#include <taglib/fileref.h>
+#include <taglib/tpropertymap.h>
+
+namespace {
+
+// 用临时文件替换目标文件；POSIX 的 rename 和 Windows 的 MoveFileEx 都是原子替换
+bool replaceFile(const QString& tempPath, const QString& targetPath)
+{
+#ifdef Q_OS_WIN
+    return MoveFileExW(reinterpret_cast<const wchar_t*>(tempPath.utf16()),
+                       reinterpret_cast<const wchar_t*>(targetPath.utf16()),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(QFile::encodeName(tempPath).constData(),
+                       QFile::encodeName(targetPath).constData()) == 0;
+#endif
+}
+
+} // namespace
+
+TagWriter::TagWriter(QObject* parent)
+    : QObject(parent)
+    , m_thread(nullptr)
+    , m_cancelled(false)
+{
+    m_pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+TagWriter::~TagWriter()
+{
+    m_cancelled = true;
+    if (m_thread) {
+        m_thread->disconnect(this);
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void TagWriter::start(const QVector<Change>& changes)
+{
+    if (m_thread) return;
+
+    m_cancelled = false;
+    m_thread = QThread::create([this, changes]() { run(changes); });
+    m_thread->setObjectName("TagWriter");   // 调试器和性能跟踪中显示的线程名
+    connect(m_thread, &QThread::finished, this, [this]() {
+        m_thread->deleteLater();
+        m_thread = nullptr;
+    });
+    m_thread->start(QThread::LowPriority);
+}
+
+void TagWriter::cancel()
+{
+    m_cancelled = true;
+}
+
+bool TagWriter::writeFile(const Change& change)
+{
+    // 临时文件与原文件在同一目录（保证重命名不跨磁盘），并保留扩展名供 TagLib 识别格式
+    QFileInfo fileInfo(change.filePath);
+    QString tempPath = fileInfo.absolutePath() + "/." + fileInfo.completeBaseName()
+                       + ".tagtmp." + fileInfo.suffix();
+
+    QFile::remove(tempPath);
+    if (!QFile::copy(change.filePath, tempPath)) {
+        return false;
+    }
+
+    bool saved = false;
+    {
+        TagLib::FileRef file(tempPath.toStdWString().c_str(), false);
+        if (!file.isNull()) {
+            TagLib::PropertyMap properties = file.properties();
+            for (auto it = change.fields.cbegin(); it != change.fields.cend(); ++it) {
+                TagLib::String key(it.key().toStdWString());
+                if (it.value().isEmpty()) {
+                    properties.erase(key);
+                } else {
+                    properties.replace(key, TagLib::StringList(TagLib::String(it.value().toStdWString())));
+                }
+            }
+            file.setProperties(properties);
+            saved = file.save();
+        }
+    }   // 先关闭临时文件再重命名（Windows 上打开的文件不能被替换）
+
+    if (!saved || !replaceFile(tempPath, change.filePath)) {
+        QFile::remove(tempPath);
+        return false;
+    }
+    return true;
+}
+
+void TagWriter::run(const QVector<Change>& changes)
+{
+    const int count = changes.size();
+    std::atomic_int next(0);
+    std::atomic_int done(0);
+
+    QMutex resultMutex;
+    QVector<int> succeededIds;
+    QStringList failedPaths;
+
+    // 每个线程循环领取下一个文件，直到全部完成或被取消
+    for (int i = 0; i < m_pool.maxThreadCount(); ++i) {
+        m_pool.start([&]() {
+            TraceRecorder::setThreadName("TagWriter pool");
+            while (!m_cancelled) {
+                int index = next++;
+                if (index >= count) break;
+
+                const Change& change = changes[index];
+                TraceRecorder::Span span("writeTags", "tags");
+                bool ok = writeFile(change);
+                if (!ok) {
+                    qCWarning(lcTags) << "写入标签失败:" << change.filePath;
+                }
+
+                QMutexLocker locker(&resultMutex);
+                if (ok) {
+                    succeededIds.append(change.songId);
+                } else {
+                    failedPaths.append(change.filePath);
+                }
+                done++;
+            }
+        });
+    }
+
+    while (!m_pool.waitForDone(100)) {
+        int doneCount = done;
+        QMetaObject::invokeMethod(this, [this, doneCount, count]() {
+            emit progressChanged(doneCount, count);
+        }, Qt::QueuedConnection);
+    }
+
+    // 取消时已经写完的文件也要报告，调用者据此更新播放列表
+    QMetaObject::invokeMethod(this, [this, succeededIds, failedPaths]() {
+        emit finished(succeededIds, failedPaths);
+    }, Qt::QueuedConnection);
+}
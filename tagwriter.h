@@ -0,0 +1,53 @@
+#ifndef TAGWRITER_H
+#define TAGWRITER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include <QThreadPool>
+#include <atomic>
+
+class QThread;
+
+// 批量写入标签
+// 写入在线程池中并行进行；每个文件先复制一份临时文件，在临时文件上写标签，
+// 成功后再用重命名替换原文件，写到一半出错或程序崩溃也不会损坏原文件
+class TagWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Change {
+        int songId;
+        QString filePath;
+        // TagLib 属性名（TITLE、ARTIST、ALBUM、ALBUMARTIST、GENRE、DATE、TRACKNUMBER 等）-> 新值
+        // 不在表中的字段保持不变，值为空字符串表示删除该字段
+        QMap<QString, QString> fields;
+    };
+
+    explicit TagWriter(QObject* parent = nullptr);
+    ~TagWriter();
+
+    bool isBusy() const { return m_thread != nullptr; }
+    void start(const QVector<Change>& changes);
+    void cancel();
+
+    // 同步写入单个文件（运行在任意线程）
+    static bool writeFile(const Change& change);
+
+signals:
+    void progressChanged(int done, int total);
+    // succeededIds 为写入成功的歌曲 ID，failedPaths 为写入失败的文件
+    void finished(const QVector<int>& succeededIds, const QStringList& failedPaths);
+
+private:
+    void run(const QVector<Change>& changes);   // 运行在工作线程中
+
+    QThread* m_thread;
+    QThreadPool m_pool;
+    std::atomic_bool m_cancelled;
+};
+
+#endif // TAGWRITER_H
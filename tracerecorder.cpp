@@ -0,0 +1,209 @@
+#include "tracerecorder.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
+#include <QVector>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <atomic>
+
+namespace {
+
+// 缓冲区上限：约 50 MB，足够记录很长一段时间的粗粒度事件，超出后丢弃新事件
+const int MaxEvents = 1000000;
+
+struct Event {
+    const char* name;
+    const char* category;
+    char phase;          // 'X' 完整事件，'b' / 'e' 异步事件的开始 / 结束
+    int tid;
+    qint64 startNs;
+    qint64 durationNs;
+    quint64 id;
+};
+
+std::atomic<bool> g_enabled{false};
+std::atomic<int> g_nextTid{1};
+std::atomic<qint64> g_dropped{0};
+
+QMutex g_mutex;
+QVector<Event> g_events;
+QHash<int, QString> g_threadNames;
+
+QElapsedTimer& traceClock()
+{
+    static QElapsedTimer timer = []() {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer;
+}
+
+qint64 nowNs()
+{
+    return traceClock().nsecsElapsed();
+}
+
+// 每个线程第一次记录事件时分配一个编号，同时登记线程名
+thread_local int t_tid = 0;
+thread_local QString t_threadName;   // setThreadName() 设置过的名字，重复设置时直接返回
+
+int currentTid()
+{
+    if (t_tid == 0) {
+        t_tid = g_nextTid.fetch_add(1, std::memory_order_relaxed);
+
+        QThread* thread = QThread::currentThread();
+        QString name = thread ? thread->objectName() : QString();
+        if (name.isEmpty()) {
+            bool isMain = QCoreApplication::instance() && thread == QCoreApplication::instance()->thread();
+            name = isMain ? QStringLiteral("Main") : QString("Thread %1").arg(t_tid);
+        }
+        QMutexLocker locker(&g_mutex);
+        g_threadNames.insert(t_tid, name);
+    }
+    return t_tid;
+}
+
+void append(const Event& event)
+{
+    QMutexLocker locker(&g_mutex);
+    if (g_events.size() >= MaxEvents) {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    g_events.append(event);
+}
+
+void appendAsync(char phase, const char* name, quint64 id, const char* category)
+{
+    if (!g_enabled.load(std::memory_order_relaxed)) return;
+    append({name, category, phase, currentTid(), nowNs(), 0, id});
+}
+
+} // namespace
+
+void TraceRecorder::setEnabled(bool enabled)
+{
+    if (enabled && !g_enabled.load()) {
+        traceClock();
+        QMutexLocker locker(&g_mutex);
+        g_events.clear();
+        g_dropped.store(0);
+    }
+    g_enabled.store(enabled);
+}
+
+bool TraceRecorder::isEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+int TraceRecorder::eventCount()
+{
+    QMutexLocker locker(&g_mutex);
+    return g_events.size();
+}
+
+void TraceRecorder::setThreadName(const QString& name)
+{
+    // 线程池的任务每次都会调用，名字没变时不加锁
+    if (t_tid != 0 && t_threadName == name) return;
+    t_threadName = name;
+
+    int tid = currentTid();
+    QMutexLocker locker(&g_mutex);
+    g_threadNames.insert(tid, name);
+}
+
+void TraceRecorder::asyncBegin(const char* name, quint64 id, const char* category)
+{
+    appendAsync('b', name, id, category);
+}
+
+void TraceRecorder::asyncEnd(const char* name, quint64 id, const char* category)
+{
+    appendAsync('e', name, id, category);
+}
+
+bool TraceRecorder::exportJson(const QString& filePath, QString* errorString)
+{
+    // 先复制一份，生成 JSON 时不阻塞正在记录的线程
+    QVector<Event> events;
+    QHash<int, QString> threadNames;
+    {
+        QMutexLocker locker(&g_mutex);
+        events = g_events;
+        threadNames = g_threadNames;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+
+    QJsonObject processName;
+    processName["name"] = "process_name";
+    processName["ph"] = "M";
+    processName["pid"] = pid;
+    processName["args"] = QJsonObject{{"name", QCoreApplication::applicationName()}};
+    traceEvents.append(processName);
+
+    for (auto it = threadNames.constBegin(); it != threadNames.constEnd(); ++it) {
+        QJsonObject threadName;
+        threadName["name"] = "thread_name";
+        threadName["ph"] = "M";
+        threadName["pid"] = pid;
+        threadName["tid"] = it.key();
+        threadName["args"] = QJsonObject{{"name", it.value()}};
+        traceEvents.append(threadName);
+    }
+
+    // 时间单位是微秒
+    for (const Event& event : events) {
+        QJsonObject object;
+        object["name"] = QString::fromUtf8(event.name);
+        object["cat"] = QString::fromUtf8(event.category);
+        object["ph"] = QString(QChar(event.phase));
+        object["pid"] = pid;
+        object["tid"] = event.tid;
+        object["ts"] = event.startNs / 1000.0;
+        if (event.phase == 'X') {
+            object["dur"] = event.durationNs / 1000.0;
+        } else {
+            object["id"] = QString::number(event.id);
+        }
+        traceEvents.append(object);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+    root["otherData"] = QJsonObject{{"droppedEvents", g_dropped.load()}};
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || file.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) < 0) {
+        if (errorString) *errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+TraceRecorder::Span::Span(const char* name, const char* category)
+    : m_name(name)
+    , m_category(category)
+    , m_startNs(g_enabled.load(std::memory_order_relaxed) ? nowNs() : -1)
+{
+}
+
+TraceRecorder::Span::~Span()
+{
+    // 中途关闭跟踪时，已经开始的事件仍然记录完整
+    if (m_startNs < 0) return;
+    append({m_name, m_category, 'X', currentTid(), m_startNs, nowNs() - m_startNs, 0});
+}
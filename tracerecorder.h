@@ -0,0 +1,48 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QString>
+#include <QtGlobal>
+
+// 性能跟踪
+// 开启后记录各热点路径的起止时间，导出为 Chrome trace-event 格式的 JSON，
+// 可以直接拖进 Perfetto（ui.perfetto.dev）或 chrome://tracing 查看各线程的时间线。
+// 关闭时 Span 只检查一次原子标志，几乎没有开销；开启时每个事件加锁追加到缓冲区，
+// 只适合记录粒度较粗的操作（播放、保存、扫描、转码……），不要放进逐个元素的循环。
+// 事件名和分类必须是字符串字面量（只保存指针）。
+// 线程名取自 QThread::objectName()，线程池中的任务可以用 setThreadName() 标注
+class TraceRecorder
+{
+public:
+    static void setEnabled(bool enabled);   // 开启时清空之前的记录
+    static bool isEnabled();
+    static int eventCount();
+
+    // 当前线程在跟踪中显示的名字
+    static void setThreadName(const QString& name);
+
+    // 跨越多个事件循环的操作（例如一个转码任务），用同一个 id 配对
+    static void asyncBegin(const char* name, quint64 id, const char* category = "app");
+    static void asyncEnd(const char* name, quint64 id, const char* category = "app");
+
+    // 写出 {"traceEvents": [...]}，失败时返回 false 并设置 errorString
+    static bool exportJson(const QString& filePath, QString* errorString = nullptr);
+
+    // 在作用域内记录一个完整事件
+    class Span
+    {
+    public:
+        explicit Span(const char* name, const char* category = "app");
+        ~Span();
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* m_name;
+        const char* m_category;
+        qint64 m_startNs;   // -1 表示开始时没有开启跟踪
+    };
+};
+
+#endif // TRACERECORDER_H
@@ -1,422 +1,540 @@
-#include "transcodedialog.h"
-#include <QVBoxLayout>
-#include <QHBoxLayout>
-#include <QGridLayout>
-#include <QComboBox>
-#include <QProgressBar>
-#include <QLabel>
-#include <QPushButton>
-#include <QListWidget>
-#include <QLineEdit>
-#include <QGroupBox>
-#include <QFileDialog>
-#include <QFileInfo>
-#include <QDir>
-#include <QMessageBox>
-#include <QCoreApplication>
-#include <QRegularExpression>
-
-TranscodeDialog::TranscodeDialog(const QStringList& filePaths, QWidget* parent)
-    : QDialog(parent)
-    , m_inputFiles(filePaths)
-    , m_currentFileIndex(-1)
-    , m_successCount(0)
-    , m_failCount(0)
-    , m_isTranscoding(false)
-    , m_ffmpegProcess(nullptr)
-    , m_currentFileDuration(0)
-{
-    setWindowTitle("音频转码");
-    setMinimumSize(500, 450);
-    
-    m_ffmpegPath = findFFmpegPath();
-    
-    setupUI();
-}
-
-TranscodeDialog::~TranscodeDialog()
-{
-    if (m_ffmpegProcess) {
-        if (m_ffmpegProcess->state() != QProcess::NotRunning) {
-            m_ffmpegProcess->kill();
-            m_ffmpegProcess->waitForFinished();
-        }
-        delete m_ffmpegProcess;
-    }
-}
-
-void TranscodeDialog::setupUI()
-{
-    QVBoxLayout* mainLayout = new QVBoxLayout(this);
-    mainLayout->setSpacing(12);
-    
-    // 文件列表
-    QLabel* fileListLabel = new QLabel(QString("待转码文件 (%1):").arg(m_inputFiles.size()));
-    mainLayout->addWidget(fileListLabel);
-    
-    m_fileListWidget = new QListWidget();
-    m_fileListWidget->setMaximumHeight(120);
-    for (const QString& filePath : m_inputFiles) {
-        QFileInfo fi(filePath);
-        QListWidgetItem* item = new QListWidgetItem("○ " + fi.fileName());
-        item->setData(Qt::UserRole, filePath);
-        m_fileListWidget->addItem(item);
-    }
-    mainLayout->addWidget(m_fileListWidget);
-    
-    // 格式选择
-    QHBoxLayout* formatLayout = new QHBoxLayout();
-    formatLayout->addWidget(new QLabel("目标格式:"));
-    m_formatCombo = new QComboBox();
-    m_formatCombo->addItem("WAV (无损)", static_cast<int>(AudioFormat::WAV));
-    m_formatCombo->addItem("FLAC (无损)", static_cast<int>(AudioFormat::FLAC));
-    m_formatCombo->addItem("MP3", static_cast<int>(AudioFormat::MP3));
-    m_formatCombo->addItem("AAC (M4A)", static_cast<int>(AudioFormat::AAC));
-    m_formatCombo->addItem("OGG", static_cast<int>(AudioFormat::OGG));
-    formatLayout->addWidget(m_formatCombo);
-    formatLayout->addStretch();
-    mainLayout->addLayout(formatLayout);
-    
-    connect(m_formatCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
-            this, &TranscodeDialog::onFormatChanged);
-    
-    // 质量设置组
-    m_qualityGroup = new QGroupBox("质量设置");
-    QHBoxLayout* qualityLayout = new QHBoxLayout(m_qualityGroup);
-    qualityLayout->addWidget(new QLabel("比特率:"));
-    m_bitrateCombo = new QComboBox();
-    m_bitrateCombo->addItem("128 kbps", 128);
-    m_bitrateCombo->addItem("192 kbps", 192);
-    m_bitrateCombo->addItem("256 kbps", 256);
-    m_bitrateCombo->addItem("320 kbps", 320);
-    m_bitrateCombo->setCurrentIndex(3); // 默认320kbps
-    qualityLayout->addWidget(m_bitrateCombo);
-    qualityLayout->addStretch();
-    m_qualityGroup->setVisible(false); // 默认选WAV，不显示质量设置
-    mainLayout->addWidget(m_qualityGroup);
-    
-    // 输出目录
-    QHBoxLayout* outputLayout = new QHBoxLayout();
-    outputLayout->addWidget(new QLabel("输出目录:"));
-    m_outputDirEdit = new QLineEdit();
-    // 默认输出到源文件所在目录
-    if (!m_inputFiles.isEmpty()) {
-        QFileInfo fi(m_inputFiles.first());
-        m_outputDirEdit->setText(fi.absolutePath());
-    }
-    outputLayout->addWidget(m_outputDirEdit);
-    m_browseBtn = new QPushButton("浏览...");
-    connect(m_browseBtn, &QPushButton::clicked, this, &TranscodeDialog::onBrowseOutputDir);
-    outputLayout->addWidget(m_browseBtn);
-    mainLayout->addLayout(outputLayout);
-    
-    // 当前文件进度
-    mainLayout->addSpacing(10);
-    m_currentFileLabel = new QLabel("当前文件: -");
-    mainLayout->addWidget(m_currentFileLabel);
-    
-    m_currentProgressBar = new QProgressBar();
-    m_currentProgressBar->setRange(0, 100);
-    m_currentProgressBar->setValue(0);
-    mainLayout->addWidget(m_currentProgressBar);
-    
-    // 总体进度
-    m_overallProgressLabel = new QLabel("总体进度: 0/0");
-    mainLayout->addWidget(m_overallProgressLabel);
-    
-    m_overallProgressBar = new QProgressBar();
-    m_overallProgressBar->setRange(0, m_inputFiles.size());
-    m_overallProgressBar->setValue(0);
-    mainLayout->addWidget(m_overallProgressBar);
-    
-    // 按钮
-    mainLayout->addStretch();
-    QHBoxLayout* buttonLayout = new QHBoxLayout();
-    buttonLayout->addStretch();
-    m_startBtn = new QPushButton("开始转码");
-    m_startBtn->setDefault(true);
-    connect(m_startBtn, &QPushButton::clicked, this, &TranscodeDialog::onStartTranscode);
-    buttonLayout->addWidget(m_startBtn);
-    
-    m_cancelBtn = new QPushButton("取消");
-    connect(m_cancelBtn, &QPushButton::clicked, this, &TranscodeDialog::onCancelTranscode);
-    buttonLayout->addWidget(m_cancelBtn);
-    mainLayout->addLayout(buttonLayout);
-}
-
-QString TranscodeDialog::findFFmpegPath()
-{
-    // 首先查找应用程序目录下的 tools/ffmpeg.exe
-    QString appPath = QCoreApplication::applicationDirPath();
-    QString ffmpegPath = appPath + "/tools/ffmpeg.exe";
-    if (QFile::exists(ffmpegPath)) {
-        return ffmpegPath;
-    }
-    
-    // 尝试系统 PATH 中的 ffmpeg
-    return "ffmpeg";
-}
-
-void TranscodeDialog::onFormatChanged(int index)
-{
-    AudioFormat format = static_cast<AudioFormat>(m_formatCombo->itemData(index).toInt());
-    // 有损格式显示质量设置
-    bool showQuality = (format == AudioFormat::MP3 || 
-                        format == AudioFormat::AAC || 
-                        format == AudioFormat::OGG);
-    m_qualityGroup->setVisible(showQuality);
-}
-
-void TranscodeDialog::onBrowseOutputDir()
-{
-    QString dir = QFileDialog::getExistingDirectory(this, "选择输出目录", 
-                                                     m_outputDirEdit->text());
-    if (!dir.isEmpty()) {
-        m_outputDirEdit->setText(dir);
-    }
-}
-
-void TranscodeDialog::onStartTranscode()
-{
-    // 验证FFmpeg是否存在
-    if (m_ffmpegPath == "ffmpeg") {
-        // 尝试运行ffmpeg -version来检查是否在PATH中
-        QProcess testProcess;
-        testProcess.start("ffmpeg", QStringList() << "-version");
-        if (!testProcess.waitForStarted(3000)) {
-            QMessageBox::critical(this, "错误", 
-                "找不到 FFmpeg！\n\n"
-                "请将 ffmpeg.exe 放入程序目录下的 tools 文件夹中，\n"
-                "或将 FFmpeg 添加到系统 PATH 环境变量。");
-            return;
-        }
-        testProcess.waitForFinished();
-    }
-    
-    // 验证输出目录
-    QString outputDir = m_outputDirEdit->text();
-    if (outputDir.isEmpty() || !QDir(outputDir).exists()) {
-        QMessageBox::warning(this, "警告", "请选择有效的输出目录！");
-        return;
-    }
-    
-    // 开始转码
-    m_isTranscoding = true;
-    m_currentFileIndex = -1;
-    m_successCount = 0;
-    m_failCount = 0;
-    
-    m_startBtn->setEnabled(false);
-    m_formatCombo->setEnabled(false);
-    m_bitrateCombo->setEnabled(false);
-    m_browseBtn->setEnabled(false);
-    m_outputDirEdit->setEnabled(false);
-    
-    m_ffmpegProcess = new QProcess(this);
-    connect(m_ffmpegProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &TranscodeDialog::onProcessFinished);
-    connect(m_ffmpegProcess, &QProcess::errorOccurred,
-            this, &TranscodeDialog::onProcessError);
-    connect(m_ffmpegProcess, &QProcess::readyReadStandardError,
-            this, &TranscodeDialog::onProcessReadyRead);
-    
-    transcodeNextFile();
-}
-
-void TranscodeDialog::onCancelTranscode()
-{
-    if (m_isTranscoding && m_ffmpegProcess) {
-        m_ffmpegProcess->kill();
-        m_ffmpegProcess->waitForFinished();
-        m_isTranscoding = false;
-    }
-    reject();
-}
-
-void TranscodeDialog::transcodeNextFile()
-{
-    m_currentFileIndex++;
-    
-    if (m_currentFileIndex >= m_inputFiles.size()) {
-        // 全部完成
-        m_isTranscoding = false;
-        m_startBtn->setEnabled(true);
-        m_formatCombo->setEnabled(true);
-        m_bitrateCombo->setEnabled(true);
-        m_browseBtn->setEnabled(true);
-        m_outputDirEdit->setEnabled(true);
-        
-        QString message = QString("转码完成！\n\n成功: %1\n失败: %2")
-                          .arg(m_successCount).arg(m_failCount);
-        QMessageBox::information(this, "完成", message);
-        
-        if (m_failCount == 0) {
-            accept();
-        }
-        return;
-    }
-    
-    QString inputPath = m_inputFiles[m_currentFileIndex];
-    QFileInfo fi(inputPath);
-    
-    // 更新UI
-    updateFileStatus(m_currentFileIndex, "转码中...", true);
-    m_currentFileLabel->setText("当前文件: " + fi.fileName());
-    m_currentProgressBar->setValue(0);
-    m_overallProgressLabel->setText(QString("总体进度: %1/%2")
-                                    .arg(m_currentFileIndex)
-                                    .arg(m_inputFiles.size()));
-    
-    // 构建输出路径
-    AudioFormat format = static_cast<AudioFormat>(
-        m_formatCombo->itemData(m_formatCombo->currentIndex()).toInt());
-    QString outputDir = m_outputDirEdit->text();
-    QString outputPath = outputDir + "/" + fi.completeBaseName() + getOutputExtension(format);
-    
-    // 检查输出文件是否已存在
-    if (QFile::exists(outputPath)) {
-        QMessageBox::StandardButton reply = QMessageBox::question(this, "文件已存在",
-            QString("文件 %1 已存在，是否覆盖？").arg(QFileInfo(outputPath).fileName()),
-            QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
-        
-        if (reply == QMessageBox::Cancel) {
-            onCancelTranscode();
-            return;
-        } else if (reply == QMessageBox::No) {
-            updateFileStatus(m_currentFileIndex, "已跳过", true);
-            transcodeNextFile();
-            return;
-        }
-    }
-    
-    // 构建FFmpeg命令
-    QStringList args;
-    args << "-y" << "-i" << inputPath;
-    
-    // 根据格式添加编码参数
-    switch (format) {
-        case AudioFormat::WAV:
-            args << "-c:a" << "pcm_s16le";
-            break;
-        case AudioFormat::FLAC:
-            args << "-c:a" << "flac";
-            break;
-        case AudioFormat::MP3:
-            args << "-c:a" << "libmp3lame";
-            args << "-b:a" << QString("%1k").arg(m_bitrateCombo->currentData().toInt());
-            break;
-        case AudioFormat::AAC:
-            args << "-c:a" << "aac";
-            args << "-b:a" << QString("%1k").arg(m_bitrateCombo->currentData().toInt());
-            break;
-        case AudioFormat::OGG:
-            args << "-c:a" << "libvorbis";
-            args << "-qscale:a" << "6"; // 质量等级
-            break;
-    }
-    
-    args << "-progress" << "pipe:2" << outputPath;
-    
-    m_currentFileDuration = 0;
-    m_ffmpegProcess->start(m_ffmpegPath, args);
-}
-
-void TranscodeDialog::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
-{
-    if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-        m_successCount++;
-        updateFileStatus(m_currentFileIndex, "完成", true);
-        m_currentProgressBar->setValue(100);
-    } else {
-        m_failCount++;
-        updateFileStatus(m_currentFileIndex, "失败", false);
-    }
-    
-    m_overallProgressBar->setValue(m_currentFileIndex + 1);
-    
-    transcodeNextFile();
-}
-
-void TranscodeDialog::onProcessError(QProcess::ProcessError error)
-{
-    Q_UNUSED(error);
-    m_failCount++;
-    updateFileStatus(m_currentFileIndex, "错误", false);
-    m_overallProgressBar->setValue(m_currentFileIndex + 1);
-    transcodeNextFile();
-}
-
-void TranscodeDialog::onProcessReadyRead()
-{
-    QString output = QString::fromLocal8Bit(m_ffmpegProcess->readAllStandardError());
-    
-    // 解析FFmpeg输出获取进度
-    // FFmpeg输出格式: out_time_ms=123456 或 Duration: 00:03:45.67
-    
-    // 首先尝试获取总时长
-    if (m_currentFileDuration == 0) {
-        QRegularExpression durationRe("Duration:\\s*(\\d+):(\\d+):(\\d+)\\.(\\d+)");
-        QRegularExpressionMatch match = durationRe.match(output);
-        if (match.hasMatch()) {
-            int hours = match.captured(1).toInt();
-            int mins = match.captured(2).toInt();
-            int secs = match.captured(3).toInt();
-            int centis = match.captured(4).toInt();
-            m_currentFileDuration = ((hours * 3600 + mins * 60 + secs) * 1000) + (centis * 10);
-        }
-    }
-    
-    // 解析当前进度
-    QRegularExpression outTimeRe("out_time_ms=(\\d+)");
-    QRegularExpressionMatch match = outTimeRe.match(output);
-    if (match.hasMatch() && m_currentFileDuration > 0) {
-        qint64 currentTime = match.captured(1).toLongLong() / 1000; // 转为毫秒
-        int progress = static_cast<int>((currentTime * 100) / m_currentFileDuration);
-        if (progress > 100) progress = 100;
-        m_currentProgressBar->setValue(progress);
-    }
-}
-
-void TranscodeDialog::updateFileStatus(int index, const QString& status, bool success)
-{
-    if (index < 0 || index >= m_fileListWidget->count()) return;
-    
-    QListWidgetItem* item = m_fileListWidget->item(index);
-    QString filePath = item->data(Qt::UserRole).toString();
-    QFileInfo fi(filePath);
-    
-    QString prefix;
-    if (status == "转码中...") {
-        prefix = "▶ ";
-    } else if (success) {
-        prefix = "✓ ";
-    } else {
-        prefix = "✗ ";
-    }
-    
-    item->setText(prefix + fi.fileName() + (status.isEmpty() ? "" : " [" + status + "]"));
-}
-
-QString TranscodeDialog::getOutputExtension(AudioFormat format)
-{
-    switch (format) {
-        case AudioFormat::WAV:  return ".wav";
-        case AudioFormat::FLAC: return ".flac";
-        case AudioFormat::MP3:  return ".mp3";
-        case AudioFormat::AAC:  return ".m4a";
-        case AudioFormat::OGG:  return ".ogg";
-        default: return ".wav";
-    }
-}
-
-QString TranscodeDialog::getCodecName(AudioFormat format)
-{
-    switch (format) {
-        case AudioFormat::WAV:  return "pcm_s16le";
-        case AudioFormat::FLAC: return "flac";
-        case AudioFormat::MP3:  return "libmp3lame";
-        case AudioFormat::AAC:  return "aac";
-        case AudioFormat::OGG:  return "libvorbis";
-        default: return "pcm_s16le";
-    }
-}
+#include "transcodedialog.h"
+#include "audioencoder.h"
+#include "nativetranscoder.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGridLayout>
+#include <QComboBox>
+#include <QProgressBar>
+#include <QLabel>
+#include <QPushButton>
+#include <QListWidget>
+#include <QLineEdit>
+#include <QGroupBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QDir>
+#include <QMessageBox>
+#include <QCoreApplication>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QSet>
+
+TranscodeDialog::TranscodeDialog(const QStringList& filePaths, QWidget* parent)
+    : QDialog(parent)
+    , m_inputFiles(filePaths)
+    , m_successCount(0)
+    , m_failCount(0)
+    , m_finishedCount(0)
+    , m_isTranscoding(false)
+    , m_bitrate(0)
+{
+    setWindowTitle("音频转码");
+    setMinimumSize(500, 450);
+    
+    m_ffmpegPath = findFFmpegPath();
+    
+    m_queue = new TranscodeQueue(m_ffmpegPath, this);
+    connect(m_queue, &TranscodeQueue::jobStarted, this, &TranscodeDialog::onJobStarted);
+    connect(m_queue, &TranscodeQueue::jobProgress, this, &TranscodeDialog::onJobProgress);
+    connect(m_queue, &TranscodeQueue::jobStats, this, &TranscodeDialog::onJobStats);
+    connect(m_queue, &TranscodeQueue::jobFinished, this, &TranscodeDialog::onJobFinished);
+    connect(m_queue, &TranscodeQueue::allFinished, this, &TranscodeDialog::onAllFinished);
+    
+    setupUI();
+}
+
+TranscodeDialog::~TranscodeDialog()
+{
+    // 结束所有仍在运行的 FFmpeg 子进程
+    m_queue->cancel();
+}
+
+bool TranscodeDialog::replaceInPlaylists() const
+{
+    return m_replaceCheck->isChecked();
+}
+
+void TranscodeDialog::setupUI()
+{
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setSpacing(12);
+    
+    // 文件列表
+    QLabel* fileListLabel = new QLabel(QString("待转码文件 (%1):").arg(m_inputFiles.size()));
+    mainLayout->addWidget(fileListLabel);
+    
+    // 每个文件一行，显示各自的转码进度
+    m_fileListWidget = new QListWidget();
+    m_fileListWidget->setMinimumHeight(160);
+    for (const QString& filePath : m_inputFiles) {
+        QFileInfo fi(filePath);
+        QListWidgetItem* item = new QListWidgetItem("○ " + fi.fileName());
+        item->setData(Qt::UserRole, filePath);
+        m_fileListWidget->addItem(item);
+    }
+    mainLayout->addWidget(m_fileListWidget);
+    
+    // 格式选择
+    QHBoxLayout* formatLayout = new QHBoxLayout();
+    formatLayout->addWidget(new QLabel("目标格式:"));
+    m_formatCombo = new QComboBox();
+    m_formatCombo->addItem("WAV (无损)", static_cast<int>(AudioFormat::WAV));
+    m_formatCombo->addItem("FLAC (无损)", static_cast<int>(AudioFormat::FLAC));
+    m_formatCombo->addItem("MP3", static_cast<int>(AudioFormat::MP3));
+    m_formatCombo->addItem("AAC (M4A)", static_cast<int>(AudioFormat::AAC));
+    m_formatCombo->addItem("OGG", static_cast<int>(AudioFormat::OGG));
+    formatLayout->addWidget(m_formatCombo);
+    formatLayout->addStretch();
+    
+    // 同时运行的 FFmpeg 进程数，默认等于 CPU 核心数
+    formatLayout->addWidget(new QLabel("同时转码:"));
+    m_concurrencySpin = new QSpinBox();
+    m_concurrencySpin->setRange(1, 64);
+    m_concurrencySpin->setValue(m_queue->maxConcurrent());
+    m_concurrencySpin->setSuffix(" 个");
+    formatLayout->addWidget(m_concurrencySpin);
+    mainLayout->addLayout(formatLayout);
+    
+    connect(m_formatCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &TranscodeDialog::onFormatChanged);
+    
+    // 质量设置组
+    m_qualityGroup = new QGroupBox("质量设置");
+    QHBoxLayout* qualityLayout = new QHBoxLayout(m_qualityGroup);
+    qualityLayout->addWidget(new QLabel("比特率:"));
+    m_bitrateCombo = new QComboBox();
+    m_bitrateCombo->addItem("128 kbps", 128);
+    m_bitrateCombo->addItem("192 kbps", 192);
+    m_bitrateCombo->addItem("256 kbps", 256);
+    m_bitrateCombo->addItem("320 kbps", 320);
+    m_bitrateCombo->setCurrentIndex(3); // 默认320kbps
+    qualityLayout->addWidget(m_bitrateCombo);
+    qualityLayout->addStretch();
+    m_qualityGroup->setVisible(false); // 默认选WAV，不显示质量设置
+    mainLayout->addWidget(m_qualityGroup);
+    
+    // WAV / FLAC 可以直接在程序内转码，省去启动 FFmpeg 进程的开销
+    m_nativeEngineCheck = new QCheckBox("使用内置引擎转码（无需 FFmpeg）");
+    m_nativeEngineCheck->setChecked(true);
+    mainLayout->addWidget(m_nativeEngineCheck);
+    
+    // 整个歌曲库换成更省空间的格式时，不用再手动把新文件加回播放列表
+    m_replaceCheck = new QCheckBox("完成后在所有播放列表中用新文件替换原文件");
+    m_replaceCheck->setToolTip("标签和封面会从原文件复制过去，原文件不会被删除");
+    mainLayout->addWidget(m_replaceCheck);
+    
+    // 输出目录
+    QHBoxLayout* outputLayout = new QHBoxLayout();
+    outputLayout->addWidget(new QLabel("输出目录:"));
+    m_outputDirEdit = new QLineEdit();
+    // 默认输出到源文件所在目录
+    if (!m_inputFiles.isEmpty()) {
+        QFileInfo fi(m_inputFiles.first());
+        m_outputDirEdit->setText(fi.absolutePath());
+    }
+    outputLayout->addWidget(m_outputDirEdit);
+    m_browseBtn = new QPushButton("浏览...");
+    connect(m_browseBtn, &QPushButton::clicked, this, &TranscodeDialog::onBrowseOutputDir);
+    outputLayout->addWidget(m_browseBtn);
+    mainLayout->addLayout(outputLayout);
+    
+    // 总体进度
+    mainLayout->addSpacing(10);
+    m_overallProgressLabel = new QLabel("总体进度: 0/0");
+    mainLayout->addWidget(m_overallProgressLabel);
+    
+    m_overallProgressBar = new QProgressBar();
+    m_overallProgressBar->setRange(0, m_inputFiles.size());
+    m_overallProgressBar->setValue(0);
+    mainLayout->addWidget(m_overallProgressBar);
+    
+    // 按钮
+    mainLayout->addStretch();
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addStretch();
+    m_startBtn = new QPushButton("开始转码");
+    m_startBtn->setDefault(true);
+    connect(m_startBtn, &QPushButton::clicked, this, &TranscodeDialog::onStartTranscode);
+    buttonLayout->addWidget(m_startBtn);
+    
+    m_cancelBtn = new QPushButton("取消");
+    connect(m_cancelBtn, &QPushButton::clicked, this, &TranscodeDialog::onCancelTranscode);
+    buttonLayout->addWidget(m_cancelBtn);
+    mainLayout->addLayout(buttonLayout);
+}
+
+QString TranscodeDialog::findFFmpegPath()
+{
+    // 首先查找应用程序目录下的 tools/ffmpeg.exe
+    QString appPath = QCoreApplication::applicationDirPath();
+    QString ffmpegPath = appPath + "/tools/ffmpeg.exe";
+    if (QFile::exists(ffmpegPath)) {
+        return ffmpegPath;
+    }
+    
+    // 尝试系统 PATH 中的 ffmpeg
+    return "ffmpeg";
+}
+
+void TranscodeDialog::onFormatChanged(int index)
+{
+    AudioFormat format = static_cast<AudioFormat>(m_formatCombo->itemData(index).toInt());
+    // 有损格式显示质量设置
+    bool showQuality = (format == AudioFormat::MP3 || 
+                        format == AudioFormat::AAC || 
+                        format == AudioFormat::OGG);
+    m_qualityGroup->setVisible(showQuality);
+    // 内置引擎只能输出 WAV 和 FLAC
+    m_nativeEngineCheck->setVisible(AudioEncoder::isSupported(getCodecName(format)));
+}
+
+void TranscodeDialog::onBrowseOutputDir()
+{
+    QString dir = QFileDialog::getExistingDirectory(this, "选择输出目录", 
+                                                     m_outputDirEdit->text());
+    if (!dir.isEmpty()) {
+        m_outputDirEdit->setText(dir);
+    }
+}
+
+void TranscodeDialog::onStartTranscode()
+{
+    AudioFormat format = static_cast<AudioFormat>(
+        m_formatCombo->itemData(m_formatCombo->currentIndex()).toInt());
+    m_codecName = getCodecName(format);
+    m_bitrate = (format == AudioFormat::MP3 || format == AudioFormat::AAC)
+                ? m_bitrateCombo->currentData().toInt() : 0;
+    bool useNativeEngine = m_nativeEngineCheck->isChecked() && AudioEncoder::isSupported(m_codecName);
+    
+    // 验证FFmpeg是否存在（使用内置引擎时不需要）
+    if (!useNativeEngine && m_ffmpegPath == "ffmpeg") {
+        // 尝试运行ffmpeg -version来检查是否在PATH中
+        QProcess testProcess;
+        testProcess.start("ffmpeg", QStringList() << "-version");
+        if (!testProcess.waitForStarted(3000)) {
+            QMessageBox::critical(this, "错误", 
+                "找不到 FFmpeg！\n\n"
+                "请将 ffmpeg.exe 放入程序目录下的 tools 文件夹中，\n"
+                "或将 FFmpeg 添加到系统 PATH 环境变量。");
+            return;
+        }
+        testProcess.waitForFinished();
+    }
+    
+    // 验证输出目录
+    QString outputDir = m_outputDirEdit->text();
+    if (outputDir.isEmpty() || !QDir(outputDir).exists()) {
+        QMessageBox::warning(this, "警告", "请选择有效的输出目录！");
+        return;
+    }
+    
+    // 先确定所有输出路径：多个任务同时运行，不能在中途逐个弹窗询问
+    QStringList outputPaths;
+    QVector<bool> upToDate;
+    QSet<QString> usedPaths;
+    int existingCount = 0;
+    for (const QString& inputPath : m_inputFiles) {
+        QFileInfo fi(inputPath);
+        QString baseName = outputDir + "/" + fi.completeBaseName();
+        QString outputPath = baseName + getOutputExtension(format);
+        // 不同目录下的同名文件输出到同一目录时，自动加上序号
+        for (int n = 2; usedPaths.contains(outputPath.toLower()); ++n) {
+            outputPath = QString("%1 (%2)%3").arg(baseName).arg(n).arg(getOutputExtension(format));
+        }
+        usedPaths.insert(outputPath.toLower());
+        outputPaths.append(outputPath);
+        
+        // 以前用相同参数转码过、源文件和输出文件都没变的，直接跳过
+        bool current = m_manifest.isUpToDate(inputPath, outputPath, m_codecName, m_bitrate);
+        upToDate.append(current);
+        if (!current && QFile::exists(outputPath)) {
+            existingCount++;
+        }
+    }
+    
+    // 检查输出文件是否已存在
+    bool overwrite = true;
+    if (existingCount > 0) {
+        QMessageBox::StandardButton reply = QMessageBox::question(this, "文件已存在",
+            QString("有 %1 个输出文件已存在，是否覆盖？\n选择 \"否\" 将跳过这些文件。").arg(existingCount),
+            QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+        
+        if (reply == QMessageBox::Cancel) {
+            return;
+        }
+        overwrite = (reply == QMessageBox::Yes);
+    }
+    
+    // 构建任务列表
+    m_completedFiles.clear();
+    m_jobs.clear();
+    m_jobRows.clear();
+    m_jobProgress.clear();
+    m_jobSpeed.clear();
+    m_jobBitrate.clear();
+    for (int i = 0; i < m_inputFiles.size(); ++i) {
+        if (upToDate[i]) {
+            updateFileStatus(i, "已是最新", true);
+            m_completedFiles.append(qMakePair(m_inputFiles[i], outputPaths[i]));
+            continue;
+        }
+        if (!overwrite && QFile::exists(outputPaths[i])) {
+            updateFileStatus(i, "已跳过", true);
+            continue;
+        }
+        updateFileStatus(i, "等待中", true);
+        
+        // FFmpeg 写入同目录下的临时文件，成功后再重命名
+        QFileInfo outputInfo(outputPaths[i]);
+        QString tempPath = outputInfo.absolutePath() + "/" + outputInfo.completeBaseName()
+                           + ".part" + getOutputExtension(format);
+        TranscodeQueue::Job job;
+        job.inputPath = m_inputFiles[i];
+        job.outputPath = outputPaths[i];
+        job.tempPath = tempPath;
+        // 内置引擎最多输出 24 位，位深更高的源文件仍由 FFmpeg 转码
+        if (useNativeEngine && NativeTranscoder::canTranscode(m_inputFiles[i])) {
+            job.nativeCodec = m_codecName;
+        } else {
+            job.arguments = getFFmpegArgs(m_inputFiles[i], tempPath);
+        }
+        m_jobs.append(job);
+        m_jobRows.append(i);
+        m_jobProgress.append(0);
+        m_jobSpeed.append(0);
+        m_jobBitrate.append(0);
+    }
+    
+    if (m_jobs.isEmpty()) {
+        QMessageBox::information(this, "完成", "所有文件都已是最新，无需转码。");
+        return;
+    }
+    
+    // 开始转码
+    m_isTranscoding = true;
+    m_successCount = 0;
+    m_failCount = 0;
+    m_finishedCount = 0;
+    
+    m_startBtn->setEnabled(false);
+    m_formatCombo->setEnabled(false);
+    m_nativeEngineCheck->setEnabled(false);
+    m_replaceCheck->setEnabled(false);
+    m_bitrateCombo->setEnabled(false);
+    m_browseBtn->setEnabled(false);
+    m_outputDirEdit->setEnabled(false);
+    
+    m_overallProgressBar->setRange(0, m_jobs.size() * 100);
+    m_overallProgressBar->setValue(0);
+    m_elapsedTimer.start();
+    updateOverallProgress();
+    
+    m_queue->setMaxConcurrent(m_concurrencySpin->value());
+    m_queue->start(m_jobs);
+}
+
+void TranscodeDialog::onCancelTranscode()
+{
+    if (m_isTranscoding) {
+        // 结束所有 FFmpeg 子进程并删除未完成的输出
+        m_queue->cancel();
+        m_isTranscoding = false;
+        m_manifest.compact();
+    }
+    reject();
+}
+
+void TranscodeDialog::onJobStarted(int jobIndex)
+{
+    updateFileStatus(m_jobRows[jobIndex], "转码中 0%", true);
+    updateOverallProgress();
+}
+
+void TranscodeDialog::onJobProgress(int jobIndex, int percent)
+{
+    if (m_jobProgress[jobIndex] == percent) return;
+    m_jobProgress[jobIndex] = percent;
+    updateFileStatus(m_jobRows[jobIndex], runningStatus(jobIndex), true);
+    updateOverallProgress();
+}
+
+void TranscodeDialog::onJobStats(int jobIndex, double speed, double bitrate)
+{
+    m_jobSpeed[jobIndex] = speed;
+    m_jobBitrate[jobIndex] = bitrate;
+    updateFileStatus(m_jobRows[jobIndex], runningStatus(jobIndex), true);
+}
+
+// 例如 "转码中 45%，12.3x，320 kbps"
+QString TranscodeDialog::runningStatus(int jobIndex) const
+{
+    QString status = QString("转码中 %1%").arg(m_jobProgress[jobIndex]);
+    if (m_jobSpeed[jobIndex] > 0) {
+        status += QString("，%1x").arg(m_jobSpeed[jobIndex], 0, 'f', 1);
+    }
+    if (m_jobBitrate[jobIndex] > 0) {
+        status += QString("，%1 kbps").arg(qRound(m_jobBitrate[jobIndex]));
+    }
+    return status;
+}
+
+void TranscodeDialog::onJobFinished(int jobIndex, bool success)
+{
+    m_finishedCount++;
+    m_jobProgress[jobIndex] = 100;
+    m_jobSpeed[jobIndex] = 0;
+    if (success) {
+        m_successCount++;
+        // 立即记入清单：即使之后取消或崩溃，下次也不会重新转码这个文件
+        const TranscodeQueue::Job& job = m_jobs[jobIndex];
+        m_manifest.record(job.inputPath, job.outputPath, m_codecName, m_bitrate);
+        m_completedFiles.append(qMakePair(job.inputPath, job.outputPath));
+        updateFileStatus(m_jobRows[jobIndex], "完成", true);
+    } else {
+        m_failCount++;
+        updateFileStatus(m_jobRows[jobIndex], "失败", false);
+    }
+    updateOverallProgress();
+}
+
+void TranscodeDialog::onAllFinished()
+{
+    // 全部完成
+    m_isTranscoding = false;
+    m_manifest.compact();
+    m_startBtn->setEnabled(true);
+    m_formatCombo->setEnabled(true);
+    m_nativeEngineCheck->setEnabled(true);
+    m_replaceCheck->setEnabled(true);
+    m_bitrateCombo->setEnabled(true);
+    m_browseBtn->setEnabled(true);
+    m_outputDirEdit->setEnabled(true);
+    
+    QString message = QString("转码完成！\n\n成功: %1\n失败: %2\n用时: %3")
+                      .arg(m_successCount).arg(m_failCount)
+                      .arg(formatTime(m_elapsedTimer.elapsed()));
+    QMessageBox::information(this, "完成", message);
+    
+    if (m_failCount == 0) {
+        accept();
+    }
+}
+
+// 总体进度按每个任务的完成比例累加，剩余时间按目前的平均速度估算
+void TranscodeDialog::updateOverallProgress()
+{
+    int total = m_jobProgress.size();
+    qint64 progressSum = 0;
+    for (int percent : m_jobProgress) {
+        progressSum += percent;
+    }
+    m_overallProgressBar->setValue(static_cast<int>(progressSum));
+    
+    // 所有正在运行的任务的速度之和即为总吞吐量
+    double totalSpeed = 0;
+    for (double speed : m_jobSpeed) {
+        totalSpeed += speed;
+    }
+    
+    QString text = QString("总体进度: %1/%2（同时进行 %3 个）")
+                   .arg(m_finishedCount).arg(total).arg(m_queue->runningCount());
+    if (totalSpeed > 0) {
+        text += QString("，总速度 %1x").arg(totalSpeed, 0, 'f', 1);
+    }
+    qint64 elapsed = m_elapsedTimer.isValid() ? m_elapsedTimer.elapsed() : 0;
+    if (progressSum > 0 && elapsed > 2000) {
+        qint64 remaining = elapsed * (total * 100 - progressSum) / progressSum;
+        text += "，剩余约 " + formatTime(remaining);
+    }
+    m_overallProgressLabel->setText(text);
+}
+
+QString TranscodeDialog::formatTime(qint64 msecs)
+{
+    qint64 secs = msecs / 1000;
+    return QString("%1:%2").arg(secs / 60, 2, 10, QChar('0')).arg(secs % 60, 2, 10, QChar('0'));
+}
+
+QStringList TranscodeDialog::getFFmpegArgs(const QString& inputPath, const QString& outputPath)
+{
+    AudioFormat format = static_cast<AudioFormat>(
+        m_formatCombo->itemData(m_formatCombo->currentIndex()).toInt());
+    
+    // 构建FFmpeg命令
+    // 输出的是本程序自己的临时文件，可能是上次中断时留下的，直接覆盖
+    // -nostats 关闭普通的状态行，进度只通过 -progress 的 key=value 输出
+    QStringList args;
+    args << "-hide_banner" << "-nostats" << "-y" << "-i" << inputPath;
+    
+    // 根据格式添加编码参数
+    switch (format) {
+        case AudioFormat::WAV:
+            args << "-c:a" << "pcm_s16le";
+            break;
+        case AudioFormat::FLAC:
+            args << "-c:a" << "flac";
+            break;
+        case AudioFormat::MP3:
+            args << "-c:a" << "libmp3lame";
+            args << "-b:a" << QString("%1k").arg(m_bitrateCombo->currentData().toInt());
+            break;
+        case AudioFormat::AAC:
+            args << "-c:a" << "aac";
+            args << "-b:a" << QString("%1k").arg(m_bitrateCombo->currentData().toInt());
+            break;
+        case AudioFormat::OGG:
+            args << "-c:a" << "libvorbis";
+            args << "-qscale:a" << "6"; // 质量等级
+            break;
+    }
+    
+    args << "-progress" << "pipe:2" << outputPath;
+    return args;
+}
+
+void TranscodeDialog::updateFileStatus(int index, const QString& status, bool success)
+{
+    if (index < 0 || index >= m_fileListWidget->count()) return;
+    
+    QListWidgetItem* item = m_fileListWidget->item(index);
+    QString filePath = item->data(Qt::UserRole).toString();
+    QFileInfo fi(filePath);
+    
+    QString prefix;
+    if (status.startsWith("转码中")) {
+        prefix = "▶ ";
+    } else if (status == "等待中") {
+        prefix = "○ ";
+    } else if (success) {
+        prefix = "✓ ";
+    } else {
+        prefix = "✗ ";
+    }
+    
+    item->setText(prefix + fi.fileName() + (status.isEmpty() ? "" : " [" + status + "]"));
+}
+
+QString TranscodeDialog::getOutputExtension(AudioFormat format)
+{
+    switch (format) {
+        case AudioFormat::WAV:  return ".wav";
+        case AudioFormat::FLAC: return ".flac";
+        case AudioFormat::MP3:  return ".mp3";
+        case AudioFormat::AAC:  return ".m4a";
+        case AudioFormat::OGG:  return ".ogg";
+        default: return ".wav";
+    }
+}
+
+QString TranscodeDialog::getCodecName(AudioFormat format)
+{
+    switch (format) {
+        case AudioFormat::WAV:  return "pcm_s16le";
+        case AudioFormat::FLAC: return "flac";
+        case AudioFormat::MP3:  return "libmp3lame";
+        case AudioFormat::AAC:  return "aac";
+        case AudioFormat::OGG:  return "libvorbis";
+        default: return "pcm_s16le";
+    }
+}
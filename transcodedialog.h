@@ -1,81 +1,107 @@
-#ifndef TRANSCODEDIALOG_H
-#define TRANSCODEDIALOG_H
-
-#include <QDialog>
-#include <QStringList>
-#include <QProcess>
-
-class QComboBox;
-class QProgressBar;
-class QLabel;
-class QPushButton;
-class QListWidget;
-class QListWidgetItem;
-class QLineEdit;
-class QGroupBox;
-
-// 支持的输出格式
-enum class AudioFormat {
-    WAV,
-    FLAC,
-    MP3,
-    AAC,
-    OGG
-};
-
-class TranscodeDialog : public QDialog
-{
-    Q_OBJECT
-
-public:
-    explicit TranscodeDialog(const QStringList& filePaths, QWidget* parent = nullptr);
-    ~TranscodeDialog();
-
-private slots:
-    void onFormatChanged(int index);
-    void onBrowseOutputDir();
-    void onStartTranscode();
-    void onCancelTranscode();
-    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
-    void onProcessError(QProcess::ProcessError error);
-    void onProcessReadyRead();
-
-private:
-    void setupUI();
-    QString findFFmpegPath();
-    void transcodeNextFile();
-    void updateFileStatus(int index, const QString& status, bool success);
-    QString getFFmpegArgs(const QString& inputPath, const QString& outputPath);
-    QString getOutputExtension(AudioFormat format);
-    QString getCodecName(AudioFormat format);
-
-    // 输入文件列表
-    QStringList m_inputFiles;
-    
-    // 转码状态
-    int m_currentFileIndex;
-    int m_successCount;
-    int m_failCount;
-    bool m_isTranscoding;
-    
-    // FFmpeg 进程
-    QProcess* m_ffmpegProcess;
-    QString m_ffmpegPath;
-    qint64 m_currentFileDuration; // 当前文件时长（毫秒）
-    
-    // UI 组件
-    QListWidget* m_fileListWidget;
-    QComboBox* m_formatCombo;
-    QGroupBox* m_qualityGroup;
-    QComboBox* m_bitrateCombo;
-    QLineEdit* m_outputDirEdit;
-    QPushButton* m_browseBtn;
-    QLabel* m_currentFileLabel;
-    QProgressBar* m_currentProgressBar;
-    QLabel* m_overallProgressLabel;
-    QProgressBar* m_overallProgressBar;
-    QPushButton* m_startBtn;
-    QPushButton* m_cancelBtn;
-};
-
-#endif // TRANSCODEDIALOG_H
+#ifndef TRANSCODEDIALOG_H
+#define TRANSCODEDIALOG_H
+
+#include <QDialog>
+#include <QStringList>
+#include <QVector>
+#include <QElapsedTimer>
+#include "transcodequeue.h"
+#include "transcodemanifest.h"
+
+class QComboBox;
+class QProgressBar;
+class QLabel;
+class QPushButton;
+class QListWidget;
+class QListWidgetItem;
+class QLineEdit;
+class QGroupBox;
+class QSpinBox;
+class QCheckBox;
+
+// 支持的输出格式
+enum class AudioFormat {
+    WAV,
+    FLAC,
+    MP3,
+    AAC,
+    OGG
+};
+
+class TranscodeDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit TranscodeDialog(const QStringList& filePaths, QWidget* parent = nullptr);
+    ~TranscodeDialog();
+    
+    // 是否要在播放列表中用新文件替换原文件
+    bool replaceInPlaylists() const;
+    // 已生成（或已是最新）的输出文件：(源文件, 输出文件)
+    QVector<QPair<QString, QString>> completedFiles() const { return m_completedFiles; }
+
+private slots:
+    void onFormatChanged(int index);
+    void onBrowseOutputDir();
+    void onStartTranscode();
+    void onCancelTranscode();
+    void onJobStarted(int jobIndex);
+    void onJobProgress(int jobIndex, int percent);
+    void onJobStats(int jobIndex, double speed, double bitrate);
+    void onJobFinished(int jobIndex, bool success);
+    void onAllFinished();
+
+private:
+    void setupUI();
+    QString findFFmpegPath();
+    void updateFileStatus(int index, const QString& status, bool success);
+    void updateOverallProgress();
+    QString runningStatus(int jobIndex) const;
+    static QString formatTime(qint64 msecs);
+    QStringList getFFmpegArgs(const QString& inputPath, const QString& outputPath);
+    QString getOutputExtension(AudioFormat format);
+    QString getCodecName(AudioFormat format);
+
+    // 输入文件列表
+    QStringList m_inputFiles;
+    
+    // 转码状态
+    int m_successCount;
+    int m_failCount;
+    int m_finishedCount;
+    bool m_isTranscoding;
+    QVector<TranscodeQueue::Job> m_jobs;
+    QVector<QPair<QString, QString>> m_completedFiles;
+    QVector<int> m_jobRows;       // 任务序号 -> 文件列表中的行
+    QVector<int> m_jobProgress;   // 每个任务的进度（0-100）
+    QVector<double> m_jobSpeed;   // 每个任务的转码速度（相对实时的倍数）
+    QVector<double> m_jobBitrate; // 每个任务的输出比特率（kbps）
+    QElapsedTimer m_elapsedTimer; // 用于估算剩余时间
+    
+    // FFmpeg 进程池
+    TranscodeQueue* m_queue;
+    QString m_ffmpegPath;
+    
+    // 已完成输出的记录，用于跳过无需重新转码的文件
+    TranscodeManifest m_manifest;
+    QString m_codecName;   // 本批次的编码器
+    int m_bitrate;         // 本批次的比特率（kbps），无损格式为 0
+    
+    // UI 组件
+    QListWidget* m_fileListWidget;
+    QComboBox* m_formatCombo;
+    QSpinBox* m_concurrencySpin;
+    QGroupBox* m_qualityGroup;
+    QCheckBox* m_nativeEngineCheck;
+    QCheckBox* m_replaceCheck;
+    QComboBox* m_bitrateCombo;
+    QLineEdit* m_outputDirEdit;
+    QPushButton* m_browseBtn;
+    QLabel* m_overallProgressLabel;
+    QProgressBar* m_overallProgressBar;
+    QPushButton* m_startBtn;
+    QPushButton* m_cancelBtn;
+};
+
+#endif // TRANSCODEDIALOG_H
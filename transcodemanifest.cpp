@@ -0,0 +1,200 @@
+#include "transcodemanifest.h"
+#include "applog.h"
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDebug>
+
+namespace {
+
+QJsonObject entryToJson(const QString& key, const TranscodeManifest::Entry& entry)
+{
+    QJsonObject object;
+    object["output"] = key;
+    object["source"] = entry.sourcePath;
+    object["sourceSize"] = entry.sourceSize;
+    object["sourceMtime"] = entry.sourceModified;
+    object["format"] = entry.format;
+    object["bitrate"] = entry.bitrate;
+    object["outputSize"] = entry.outputSize;
+    return object;
+}
+
+TranscodeManifest::Entry entryFromJson(const QJsonObject& object)
+{
+    TranscodeManifest::Entry entry;
+    entry.sourcePath = object["source"].toString();
+    entry.sourceSize = object["sourceSize"].toVariant().toLongLong();
+    entry.sourceModified = object["sourceMtime"].toVariant().toLongLong();
+    entry.format = object["format"].toString();
+    entry.bitrate = object["bitrate"].toInt();
+    entry.outputSize = object["outputSize"].toVariant().toLongLong();
+    return entry;
+}
+
+} // namespace
+
+TranscodeManifest::TranscodeManifest()
+{
+    // 和播放列表一样保存在软件目录下的 config 文件夹中
+    QString dataPath = QCoreApplication::applicationDirPath() + "/config";
+    QDir dir(dataPath);
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+    m_filePath = dataPath + "/transcode_manifest.json";
+    m_journalPath = dataPath + "/transcode_manifest.journal";
+    m_savePool.setMaxThreadCount(1);
+    load();
+}
+
+TranscodeManifest::~TranscodeManifest()
+{
+    compact();
+    m_savePool.waitForDone();
+}
+
+QString TranscodeManifest::key(const QString& path)
+{
+    QString cleaned = QDir::cleanPath(QDir::fromNativeSeparators(path));
+#ifdef Q_OS_WIN
+    // Windows 上路径不区分大小写
+    return cleaned.toLower();
+#else
+    return cleaned;
+#endif
+}
+
+bool TranscodeManifest::isUpToDate(const QString& sourcePath, const QString& outputPath,
+                                   const QString& format, int bitrate) const
+{
+    auto it = m_entries.constFind(key(outputPath));
+    if (it == m_entries.constEnd()) {
+        return false;
+    }
+
+    const Entry& entry = it.value();
+    if (key(entry.sourcePath) != key(sourcePath) || entry.format != format || entry.bitrate != bitrate) {
+        return false;
+    }
+
+    QFileInfo sourceInfo(sourcePath);
+    QFileInfo outputInfo(outputPath);
+    return sourceInfo.exists() && outputInfo.exists() &&
+           sourceInfo.size() == entry.sourceSize &&
+           sourceInfo.lastModified().toMSecsSinceEpoch() == entry.sourceModified &&
+           outputInfo.size() == entry.outputSize;
+}
+
+void TranscodeManifest::record(const QString& sourcePath, const QString& outputPath,
+                               const QString& format, int bitrate)
+{
+    QFileInfo sourceInfo(sourcePath);
+    Entry entry;
+    entry.sourcePath = sourcePath;
+    entry.sourceSize = sourceInfo.size();
+    entry.sourceModified = sourceInfo.lastModified().toMSecsSinceEpoch();
+    entry.format = format;
+    entry.bitrate = bitrate;
+    entry.outputSize = QFileInfo(outputPath).size();
+    m_entries.insert(key(outputPath), entry);
+
+    // 只追加一行，不重写整个清单：上万个文件的批量转码也不会越写越慢
+    if (!m_journal.isOpen()) {
+        m_journal.setFileName(m_journalPath);
+        if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qCWarning(lcTranscode, "无法写入转码清单日志！");
+            return;
+        }
+    }
+    m_journal.write(QJsonDocument(entryToJson(key(outputPath), entry)).toJson(QJsonDocument::Compact) + '\n');
+    m_journal.flush();
+}
+
+void TranscodeManifest::compact()
+{
+    if (!m_journal.isOpen()) return;
+
+    // 关闭日志后由后台线程写出当时的全部记录，写完才删除日志；
+    // 这期间完成的新文件写进新的日志，下一次合并时再处理
+    m_journal.close();
+    m_savePool.waitForDone();   // 上一次合并还没写完时，不能让新日志顶替它的位置
+    const QString pendingPath = m_journalPath + ".pending";
+    QFile::remove(pendingPath);
+    if (!QFile::rename(m_journalPath, pendingPath)) {
+        qCWarning(lcTranscode, "无法合并转码清单日志！");
+        return;
+    }
+
+    const QString filePath = m_filePath;
+    const QHash<QString, Entry> entries = m_entries;
+    m_savePool.start([filePath, entries, pendingPath]() {
+        save(filePath, entries);
+        QFile::remove(pendingPath);
+    });
+}
+
+void TranscodeManifest::load()
+{
+    QFile file(m_filePath);
+    if (file.open(QIODevice::ReadOnly)) {
+        const QJsonArray entries = QJsonDocument::fromJson(file.readAll()).object()["entries"].toArray();
+        for (const QJsonValue& value : entries) {
+            QJsonObject object = value.toObject();
+            QString outputPath = object["output"].toString();
+            // 输出文件已被删除的记录不再保留
+            if (outputPath.isEmpty() || !QFile::exists(outputPath)) continue;
+            m_entries.insert(key(outputPath), entryFromJson(object));
+        }
+    }
+
+    // 上次没来得及合并的日志（崩溃或合并到一半退出），按写入顺序补上后立即合并
+    const QString pendingPath = m_journalPath + ".pending";
+    bool hasJournal = QFile::exists(pendingPath) || QFile::exists(m_journalPath);
+    if (!hasJournal) return;
+    loadJournal(pendingPath);
+    loadJournal(m_journalPath);
+    save(m_filePath, m_entries);
+    QFile::remove(pendingPath);
+    QFile::remove(m_journalPath);
+}
+
+void TranscodeManifest::loadJournal(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return;
+    while (!file.atEnd()) {
+        // 崩溃时最后一行可能没写完，解析失败的行直接跳过
+        QJsonObject object = QJsonDocument::fromJson(file.readLine()).object();
+        QString outputPath = object["output"].toString();
+        if (outputPath.isEmpty() || !QFile::exists(outputPath)) continue;
+        m_entries.insert(key(outputPath), entryFromJson(object));
+    }
+}
+
+void TranscodeManifest::save(const QString& filePath, const QHash<QString, Entry>& entries)
+{
+    QJsonArray array;
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+        array.append(entryToJson(it.key(), it.value()));
+    }
+
+    QJsonObject rootObject;
+    rootObject["version"] = 1;
+    rootObject["entries"] = array;
+
+    // 先写临时文件再替换，写到一半崩溃也不会损坏已有的清单
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(lcTranscode, "无法写入转码清单文件！");
+        return;
+    }
+    file.write(QJsonDocument(rootObject).toJson(QJsonDocument::Compact));
+    file.commit();
+}
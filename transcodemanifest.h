@@ -0,0 +1,51 @@
+#ifndef TRANSCODEMANIFEST_H
+#define TRANSCODEMANIFEST_H
+
+#include <QString>
+#include <QHash>
+#include <QFile>
+#include <QThreadPool>
+
+// 转码清单：记录每个已完成的输出文件是由哪个源文件、以什么参数生成的
+// 再次转码同一批文件时，源文件和参数都没变、输出文件也还在的任务会被跳过，
+// 因此中途取消或程序崩溃后重新开始，只会继续转码剩下的文件。
+// 每完成一个文件只在日志文件末尾追加一行，整批结束（或取消）时才在后台线程中
+// 把全部记录重写进清单并删除日志；程序崩溃后留下的日志在下次加载时合并
+class TranscodeManifest
+{
+public:
+    struct Entry {
+        QString sourcePath;
+        qint64 sourceSize = 0;
+        qint64 sourceModified = 0;   // 毫秒时间戳
+        QString format;              // 输出格式（编码器名称）
+        int bitrate = 0;             // kbps，无损格式为 0
+        qint64 outputSize = 0;
+    };
+
+    TranscodeManifest();
+    ~TranscodeManifest();   // 合并日志并等待后台写完
+
+    // 输出文件是否已由同一个源文件、以相同参数生成，且之后都没有变化
+    bool isUpToDate(const QString& sourcePath, const QString& outputPath,
+                    const QString& format, int bitrate) const;
+    // 记录一个刚完成的输出文件（立即追加到日志文件）
+    void record(const QString& sourcePath, const QString& outputPath,
+                const QString& format, int bitrate);
+    // 把日志合并进清单文件（在后台线程中写），一批任务结束或取消时调用
+    void compact();
+
+private:
+    void load();
+    void loadJournal(const QString& path);
+    static void save(const QString& filePath, const QHash<QString, Entry>& entries);
+    static QString key(const QString& path);
+
+    QString m_filePath;
+    QString m_journalPath;
+    QHash<QString, Entry> m_entries;   // 输出路径 -> 记录
+    QFile m_journal;                   // 打开后保持到下一次合并
+    QThreadPool m_savePool;            // 单线程，依次写出清单
+};
+
+#endif // TRANSCODEMANIFEST_H
@@ -0,0 +1,255 @@
+#include "transcodequeue.h"
+#include "applog.h"
+#include "nativetranscoder.h"
+#include "tracerecorder.h"
+#include <QThread>
+#include <QFile>
+#include <QDebug>
+
+// TagLib 头文件
+#include <taglib/fileref.h>
+#include <taglib/audioproperties.h>
+#include <taglib/tpropertymap.h>
+
+namespace {
+
+// 把源文件的全部标签和封面复制到转码结果中（不同容器格式之间也适用）
+bool copyTags(const QString& sourcePath, const QString& targetPath)
+{
+    TagLib::FileRef source(sourcePath.toStdWString().c_str(), false);
+    TagLib::FileRef target(targetPath.toStdWString().c_str(), false);
+    if (source.isNull() || target.isNull()) {
+        return false;
+    }
+
+    target.setProperties(source.properties());
+    // 封面等二进制数据（PICTURE）通过 complex properties 复制
+    const TagLib::StringList keys = source.complexPropertyKeys();
+    for (const TagLib::String& key : keys) {
+        target.setComplexProperties(key, source.complexProperties(key));
+    }
+    return target.save();
+}
+
+} // namespace
+
+TranscodeQueue::TranscodeQueue(const QString& ffmpegPath, QObject* parent)
+    : QObject(parent)
+    , m_ffmpegPath(ffmpegPath)
+    , m_maxConcurrent(qMax(1, QThread::idealThreadCount()))
+    , m_isRunning(false)
+    , m_nextJob(0)
+    , m_finalizing(0)
+    , m_generation(0)
+{
+}
+
+TranscodeQueue::~TranscodeQueue()
+{
+    cancel();
+    m_finalizePool.waitForDone();
+}
+
+void TranscodeQueue::setMaxConcurrent(int count)
+{
+    m_maxConcurrent = qMax(1, count);
+    if (m_isRunning) {
+        startNextJobs();
+    }
+}
+
+void TranscodeQueue::start(const QVector<Job>& jobs)
+{
+    if (m_isRunning) return;
+
+    m_jobs = jobs;
+    m_nextJob = 0;
+    m_isRunning = true;
+
+    startNextJobs();
+}
+
+void TranscodeQueue::cancel()
+{
+    if (!m_isRunning) return;
+
+    m_isRunning = false;
+    m_nextJob = m_jobs.size();
+
+    // 先断开信号，被结束的任务不再当作 "失败" 报告
+    const QList<QObject*> workers = m_running.keys();
+    for (QObject* worker : workers) {
+        worker->disconnect(this);
+        if (QProcess* process = qobject_cast<QProcess*>(worker)) {
+            process->kill();
+        } else if (NativeTranscoder* transcoder = qobject_cast<NativeTranscoder*>(worker)) {
+            transcoder->cancel();
+        }
+    }
+    for (QObject* worker : workers) {
+        if (QProcess* process = qobject_cast<QProcess*>(worker)) {
+            process->waitForFinished();
+        }
+        int index = m_running.value(worker).index;
+        // NativeTranscoder 的析构函数会等待工作线程退出
+        delete worker;
+        // 被中途结束的临时文件是不完整的
+        QFile::remove(m_jobs[index].tempPath);
+        TraceRecorder::asyncEnd("transcodeJob", quint64(index), "transcode");
+    }
+    m_running.clear();
+
+    // 正在复制标签的任务转码已经完成，让它们照常收尾，只是不再报告结果
+    ++m_generation;
+    m_finalizing = 0;
+}
+
+void TranscodeQueue::startNextJobs()
+{
+    while (m_isRunning && runningCount() < m_maxConcurrent && m_nextJob < m_jobs.size()) {
+        int index = m_nextJob++;
+        if (m_jobs[index].nativeCodec.isEmpty()) {
+            startProcessJob(index);
+        } else {
+            startNativeJob(index);
+        }
+    }
+
+    if (m_isRunning && runningCount() == 0 && m_nextJob >= m_jobs.size()) {
+        m_isRunning = false;
+        emit allFinished();
+    }
+}
+
+void TranscodeQueue::startProcessJob(int index)
+{
+    QProcess* process = new QProcess(this);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &TranscodeQueue::onProcessFinished);
+    connect(process, &QProcess::errorOccurred,
+            this, &TranscodeQueue::onProcessError);
+    connect(process, &QProcess::readyReadStandardError,
+            this, &TranscodeQueue::onProcessReadyRead);
+
+    // 总时长直接从文件头读取（只读几 KB），不依赖 FFmpeg 日志中的 "Duration:" 行
+    RunningJob running;
+    running.index = index;
+    TagLib::FileRef ref(m_jobs[index].inputPath.toStdWString().c_str(), true, TagLib::AudioProperties::Fast);
+    if (!ref.isNull() && ref.audioProperties()) {
+        running.progress.setDuration(ref.audioProperties()->lengthInMilliseconds());
+    }
+
+    m_running.insert(process, running);
+    // 任务跨越多个事件循环，在跟踪中用异步事件表示，按任务序号配对
+    TraceRecorder::asyncBegin("transcodeJob", quint64(index), "transcode");
+    emit jobStarted(index);
+    process->start(m_ffmpegPath, m_jobs[index].arguments);
+}
+
+void TranscodeQueue::startNativeJob(int index)
+{
+    const Job& job = m_jobs[index];
+    NativeTranscoder* transcoder = new NativeTranscoder(job.inputPath, job.tempPath, job.nativeCodec, this);
+    connect(transcoder, &NativeTranscoder::progressChanged, this, [this, index](int percent, double speed) {
+        emit jobProgress(index, percent);
+        emit jobStats(index, speed, 0);
+    });
+    connect(transcoder, &NativeTranscoder::finished, this, [this, transcoder](bool success) {
+        finishJob(transcoder, success);
+    });
+
+    RunningJob running;
+    running.index = index;
+    m_running.insert(transcoder, running);
+    TraceRecorder::asyncBegin("transcodeJob", quint64(index), "transcode");
+    emit jobStarted(index);
+    transcoder->start();
+}
+
+void TranscodeQueue::finishJob(QObject* worker, bool success)
+{
+    auto it = m_running.find(worker);
+    if (it == m_running.end()) return;
+
+    int index = it->index;
+    m_running.erase(it);
+    worker->deleteLater();
+
+    if (!success) {
+        completeJob(index, false);
+        return;
+    }
+
+    // TagLib 保存时可能重写整个文件，多个任务同时结束时会卡住界面，交给线程池
+    const Job job = m_jobs[index];
+    const int generation = m_generation;
+    ++m_finalizing;
+    m_finalizePool.start([this, job, index, generation]() {
+        bool ok = true;
+        {
+            TraceRecorder::Span span("copyTranscodeTags", "transcode");
+            // FFmpeg 不一定会带上封面，内置引擎则完全不写标签，这里统一从源文件复制
+            if (!copyTags(job.inputPath, job.tempPath)) {
+                qCWarning(lcTranscode) << "无法复制标签:" << job.inputPath;
+            }
+        }
+        // 转码完整结束后才替换最终的输出文件
+        QFile::remove(job.outputPath);
+        if (!QFile::rename(job.tempPath, job.outputPath)) {
+            qCWarning(lcTranscode) << "无法重命名转码输出:" << job.tempPath << "->" << job.outputPath;
+            ok = false;
+        }
+        QMetaObject::invokeMethod(this, [this, index, generation, ok]() {
+            // 取消之后才完成的任务：计数已在 cancel() 中清零
+            if (generation != m_generation) {
+                TraceRecorder::asyncEnd("transcodeJob", quint64(index), "transcode");
+                return;
+            }
+            --m_finalizing;
+            completeJob(index, ok);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void TranscodeQueue::completeJob(int index, bool success)
+{
+    const Job& job = m_jobs[index];
+    if (!success) {
+        qCWarning(lcTranscode) << "转码失败:" << job.inputPath;
+        QFile::remove(job.tempPath);
+    }
+    TraceRecorder::asyncEnd("transcodeJob", quint64(index), "transcode");
+    emit jobFinished(index, success);
+
+    startNextJobs();
+}
+
+void TranscodeQueue::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    finishJob(sender(), exitStatus == QProcess::NormalExit && exitCode == 0);
+}
+
+void TranscodeQueue::onProcessError(QProcess::ProcessError error)
+{
+    // 其它错误（例如进程崩溃）之后还会收到 finished 信号，只有启动失败时不会
+    if (error == QProcess::FailedToStart) {
+        finishJob(sender(), false);
+    }
+}
+
+void TranscodeQueue::onProcessReadyRead()
+{
+    QProcess* process = qobject_cast<QProcess*>(sender());
+    auto it = m_running.find(process);
+    if (it == m_running.end()) return;
+
+    // 只有收到完整的进度块时才更新界面
+    FFmpegProgressParser& progress = it->progress;
+    if (!progress.feed(process->readAllStandardError())) return;
+
+    int percent = progress.percent();
+    if (percent >= 0) {
+        emit jobProgress(it->index, percent);
+    }
+    emit jobStats(it->index, progress.speed(), progress.bitrate());
+}
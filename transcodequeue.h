@@ -0,0 +1,85 @@
+#ifndef TRANSCODEQUEUE_H
+#define TRANSCODEQUEUE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QProcess>
+#include <QThreadPool>
+#include "ffmpegprogressparser.h"
+
+// 转码任务队列：同时最多运行 N 个任务（默认等于 CPU 核心数），
+// 一个任务结束后立即启动下一个。每个任务单独报告进度，取消时结束所有子进程和线程
+// 任务可以由 FFmpeg 进程完成，也可以由进程内的 NativeTranscoder 完成
+// FFmpeg 先写入临时文件，成功后才重命名为最终的输出文件，
+// 因此中途取消或崩溃留下的都是临时文件，不会被误认为已完成
+// 复制标签和重命名可能要重写整个输出文件，放在线程池中完成，不占用界面线程
+class TranscodeQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Job {
+        QString inputPath;
+        QString outputPath;
+        QString tempPath;        // FFmpeg 实际写入的临时文件
+        QStringList arguments;   // 完整的 FFmpeg 参数（包含输入路径和临时文件路径）
+        QString nativeCodec;     // 非空时改用内置引擎编码（pcm_s16le / flac），不启动 FFmpeg
+    };
+
+    explicit TranscodeQueue(const QString& ffmpegPath, QObject* parent = nullptr);
+    ~TranscodeQueue();
+
+    void setMaxConcurrent(int count);
+    int maxConcurrent() const { return m_maxConcurrent; }
+
+    bool isRunning() const { return m_isRunning; }
+    int runningCount() const { return m_running.size() + m_finalizing; }
+
+    void start(const QVector<Job>& jobs);
+    // 结束所有正在运行的任务并删除未完成的临时文件，不再启动新任务
+    void cancel();
+
+signals:
+    void jobStarted(int index);
+    void jobProgress(int index, int percent);
+    // 转码速度（相对实时的倍数）和输出比特率（kbps），未知时为 0
+    void jobStats(int index, double speed, double bitrate);
+    void jobFinished(int index, bool success);
+    void allFinished();
+
+private slots:
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onProcessError(QProcess::ProcessError error);
+    void onProcessReadyRead();
+
+private:
+    // 每个正在运行的任务对应的状态
+    struct RunningJob {
+        int index;
+        FFmpegProgressParser progress;    // 只用于 FFmpeg 进程
+    };
+
+    void startNextJobs();
+    void startProcessJob(int index);
+    void startNativeJob(int index);
+    void finishJob(QObject* worker, bool success);
+    void completeJob(int index, bool success);
+
+    QString m_ffmpegPath;
+    int m_maxConcurrent;
+    bool m_isRunning;
+
+    QVector<Job> m_jobs;
+    int m_nextJob;
+    QHash<QObject*, RunningJob> m_running;   // QProcess 或 NativeTranscoder
+
+    // 正在复制标签、重命名的任务，也计入同时运行的任务数
+    QThreadPool m_finalizePool;
+    int m_finalizing;
+    int m_generation;                        // 每次 start / cancel 加一，丢弃上一批任务迟到的结果
+};
+
+#endif // TRANSCODEQUEUE_H